@@ -0,0 +1,239 @@
+/**
+ * @brief Throughput and power bench of the firmware on simulated peripherals
+ * @details Runs the main loop of main.c over virtual time: sensor is measured on its timer, samples are appended to
+ * the flash log, phone taps the tag now and then. Reports events/s, flash bytes written per sample and wake ups per
+ * hour from firmware metrics, and physical flash programming from the flash model.
+ *
+ * Sensors init is commented out in INIT_Initialize and no actor commits samples to storage yet, so the bench starts
+ * sensors itself and commits each measurement read out of the sensor model, as the sampling app will do.
+ *
+ * Tag is configured for mailbox as by a previous boot, --factory-tag starts from factory configuration instead.
+ * Run fails if no sample is stored or NFC actor ends in error, e.g. on I2C retries exhausted.
+ *
+ * Usage: bench [--hours H] [--period-ms P] [--taps N] [--tap-s S] [--usb-hours U] [--factory-tag]
+ */
+
+#define _DEFAULT_SOURCE // timegm
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "definitions.h"
+#include "init_manager/init_manager.h"
+#include "scheduler/scheduler.h"
+#include "timers/timers.h"
+#include "app_manager/app_manager.h"
+#include "metrics/metrics.h"
+#include "power/power.h"
+#include "storage/storage_manager.h"
+#include "sensors/sht3x-temperature-humidity/sht3x.h"
+#include "nfc/nfc.h"
+#include "../sim/sim.h"
+#include "../sim/sim_drivers.h"
+#include "../sim/sim_st25dv.h"
+#include "../sim/sim_sht3x.h"
+
+#define BENCH_HOURS_DFLT                    (24)
+#define BENCH_TAP_S_DFLT                    (10)
+#define BENCH_STUCK_LOOPS_MAX               (1000000UL) // loop passes without time advance
+
+extern TActiveObject *systemActorsList[ACTIVE_OBJECTS_MAX];
+
+static struct {
+    uint32_t hours;
+    uint32_t periodMs;
+    uint32_t taps;
+    uint32_t tapS;
+    uint32_t usbHours;
+    bool isFactoryTag;
+} options = {.hours = BENCH_HOURS_DFLT, .periodMs = SHT3X_MEASURE_PERIOD_MS_DFLT, .tapS = BENCH_TAP_S_DFLT};
+
+static uint32_t samplesCommitted = 0;
+static uint32_t samplesDropped = 0;
+
+static void _usage(const char *name) {
+    fprintf(stderr, "usage: %s [--hours H] [--period-ms P] [--taps N] [--tap-s S] [--usb-hours U] [--factory-tag]\n", name);
+    exit(EXIT_FAILURE);
+};
+
+static void _parseOptions(int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--factory-tag")) {
+            options.isFactoryTag = true;
+            continue;
+        }
+
+        if (i + 1 == argc) _usage(argv[0]);
+
+        const uint32_t value = (uint32_t) strtoul(argv[i + 1], NULL, 10);
+
+        if (!strcmp(argv[i], "--hours")) options.hours = value;
+        else if (!strcmp(argv[i], "--period-ms")) options.periodMs = value;
+        else if (!strcmp(argv[i], "--taps")) options.taps = value;
+        else if (!strcmp(argv[i], "--tap-s")) options.tapS = value;
+        else if (!strcmp(argv[i], "--usb-hours")) options.usbHours = value;
+        else _usage(argv[0]);
+
+        i++;
+    }
+
+    if ((0 == options.hours) || (options.usbHours >= options.hours)) _usage(argv[0]);
+};
+
+static inline TSimTime _tapTime(uint32_t tap) {
+    return ((2 * (TSimTime) tap + 1) * options.hours * SIM_US_IN_HOUR) / (2 * options.taps);
+};
+
+static void _onTap(uintptr_t tap);
+
+// the next tap is scheduled once the phone is gone, events table stays small for any taps count
+static void _onTapEnd(uintptr_t tap) {
+    SIM_ST25DV_SetField(false);
+
+    if (tap + 1 < options.taps) SIM_Schedule(_tapTime(tap + 1), _onTap, tap + 1);
+};
+
+static void _onTap(uintptr_t tap) {
+    SIM_ST25DV_SetField(true);
+    SIM_Schedule(SIM_GetTime() + (TSimTime) options.tapS * SIM_US_IN_S, _onTapEnd, tap);
+};
+
+static void _onVBUS(uintptr_t isPowered) {
+    SIM_PLIB_SetVBUS((bool) isPowered);
+};
+
+// taps are spread evenly over the run, cable is plugged for the last hours
+static void _scheduleScenario(void) {
+    if (0 != options.taps) SIM_Schedule(_tapTime(0), _onTap, 0);
+
+    if (0 != options.usbHours)
+        SIM_Schedule((TSimTime) (options.hours - options.usbHours) * SIM_US_IN_HOUR, _onVBUS, true);
+};
+
+// sampling app stand-in, commits each measurement read out of the sensor
+static void _storeSamples(void) {
+    static uint32_t measurements = 0;
+    static bool isPeriodSet = false;
+
+    if (!isPeriodSet && (NULL != systemActorsList[SHT3X_AO_ID])) isPeriodSet = SHT3X_SetMeasurePeriod(options.periodMs);
+
+    if (measurements == SIM_SHT3X_GetMeasurements()) return;
+
+    measurements = SIM_SHT3X_GetMeasurements();
+
+    TSensorsStorageData *const record = (NULL != systemActorsList[STORAGE_AO_ID]) ? STORAGE_ReserveRecord() : NULL;
+    struct tm now;
+
+    if (NULL == record) {
+        samplesDropped++;
+        return;
+    }
+
+    RTC_RTCCTimeGet(&now);
+    record->timestamp = (uint32_t) timegm(&now);
+    SIM_SHT3X_GetLastRaw(&(record->sht3XTemperatureHumiditySensorData.temperature),
+                         &(record->sht3XTemperatureHumiditySensorData.humidity));
+    record->ambientLightSensorData.ambientLight = 0;
+    if (!STORAGE_CommitRecord(record)) {
+        samplesDropped++;
+        return;
+    }
+    samplesCommitted++;
+};
+
+static void _report(double wallS) {
+    const double hours = (double) SIM_GetTime() / SIM_US_IN_HOUR;
+    const double seconds = (double) SIM_GetTime() / SIM_US_IN_S;
+    const TSimMemoryStats *const flash = SIM_MEMORY_GetStats();
+    const TSimI2CStats *const i2c = SIM_I2C_GetStats();
+    const TSimStats *const sim = SIM_GetStats();
+    uint64_t events = 0;
+
+    for (uint8_t id = 0; id < ACTIVE_OBJECTS_MAX; id++) events += metrics.eventsProcessed[id];
+
+    printf("simulated: %.2f h, host: %.3f s\n", hours, wallS);
+    printf("events: %llu, %.3f events/s simulated, %.0f events/s host, dropped: %u\n", (unsigned long long) events,
+           events / seconds, (wallS > 0) ? events / wallS : 0.0, metrics.eventsDropped);
+    printf("samples: %u stored, %u committed, %u dropped by bench\n", metrics.samplesStored, samplesCommitted,
+           samplesDropped);
+    printf("flash written: %u B, %.2f B/sample; programmed: %llu B in %u pages, %u sectors erased\n",
+           metrics.flashBytesWritten,
+           (0 == metrics.samplesStored) ? 0.0 : (double) metrics.flashBytesWritten / metrics.samplesStored,
+           (unsigned long long) flash->bytesProgrammed, flash->pagesProgrammed, flash->sectorsErased);
+    printf("flash requests: %u, rejected: %u\n", flash->commands, flash->rejected);
+    printf("wake ups: %u (%u standby), %.1f/h; asleep: %.1f%%; sleeps: %u\n", metrics.wakes, metrics.standbyWakes,
+           metrics.wakes / hours, (100.0 * metrics.sleepTimeMs) / (seconds * 1000.0), sim->sleeps);
+    printf("i2c transfers: %u, nacks: %u, bytes: %llu, bus busy: %.3f%%\n", i2c->transfers, i2c->nacks,
+           (unsigned long long) i2c->bytes, (100.0 * i2c->busTimeUs) / (seconds * SIM_US_IN_S));
+    printf("nfc gpo pulses: %u, eeprom written: %u B\n", SIM_ST25DV_GetStats()->gpoPulses,
+           SIM_ST25DV_GetStats()->eepromBytesWritten);
+    printf("loop passes: %u, sim events: %u, interrupts: %u\n", metrics.loopIterations, sim->eventsFired,
+           sim->interrupts);
+};
+
+int main(int argc, char **argv) {
+    struct timespec wallStart, wallEnd;
+    TSimTime lastTime = 0;
+    uint32_t stuckLoops = 0;
+
+    _parseOptions(argc, argv);
+
+    SIM_Initialize((TSimTime) options.hours * SIM_US_IN_HOUR);
+    SIM_TIME_Initialize();
+    SIM_MEMORY_Initialize();
+    SIM_MEMORY_EraseChip();
+    SIM_I2C_Initialize();
+    SIM_PLIB_Initialize();
+    SIM_ST25DV_Initialize();
+    if (!options.isFactoryTag) {
+        SIM_ST25DV_SetConfig(ST25DV_GPO_OFFSET, ST25DV_GPO_CONFIG);
+        SIM_ST25DV_SetConfig(ST25DV_MB_MODE_OFFSET, ST25DV_MB_MODE_RW_MASK);
+    }
+    SIM_SHT3X_Initialize();
+    _scheduleScenario();
+
+    clock_gettime(CLOCK_MONOTONIC, &wallStart);
+
+    /* main.c */
+    SYS_Initialize(NULL);
+    METRICS_Initialize();
+    POWER_Initialize();
+    TIMERS_Initialize();
+    SCHEDULER_Dispatch(systemActorsList[INIT_AO_ID], (TEvent) {.sig = INIT_SIG_SENSORS});
+
+    while (!SIM_IsOver()) {
+        SYS_Tasks();
+
+        TIMERS_Tasks();
+        SCHEDULER_Tasks();
+        APP_PollTasks();
+
+        METRICS_INC(loopIterations);
+        METRICS_Tasks();
+
+        POWER_Idle();
+
+        _storeSamples();
+
+        stuckLoops = (lastTime == SIM_GetTime()) ? stuckLoops + 1 : 0;
+        lastTime = SIM_GetTime();
+        if (BENCH_STUCK_LOOPS_MAX == stuckLoops) {
+            fprintf(stderr, "main loop spins without sleep at %llu us\n", (unsigned long long) lastTime);
+            return EXIT_FAILURE;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &wallEnd);
+
+    _report((double) (wallEnd.tv_sec - wallStart.tv_sec) + (wallEnd.tv_nsec - wallStart.tv_nsec) / 1e9);
+
+    const TActiveObject *const nfcAO = systemActorsList[NFC_AO_ID];
+    if ((NULL == nfcAO) || (NFC_ST_ERROR == nfcAO->state->name)) {
+        fprintf(stderr, "nfc actor failed\n");
+        return EXIT_FAILURE;
+    }
+
+    return (0 == metrics.samplesStored) ? EXIT_FAILURE : EXIT_SUCCESS;
+};
@@ -0,0 +1,49 @@
+/**
+ * @file configuration.h
+ * @brief Host build stand-in of Harmony generated configuration
+ *
+ * @details Values are copied from firmware/src/config/default/configuration.h, only the ones firmware sources use.
+ * Keep them in sync when the MPLAB configuration is regenerated.
+ */
+
+#ifndef CONFIGURATION_H
+#define CONFIGURATION_H
+
+#include "device.h"
+
+#ifdef    __cplusplus
+extern "C" {
+#endif
+
+/* System Timer */
+#define SYS_TIME_INDEX_0                            (0)
+#define SYS_TIME_MAX_TIMERS                         (5)
+#define SYS_TIME_HW_COUNTER_FREQUENCY               (1024) // TC3 clocked from 32 kHz oscillator, see TC3_TimerFrequencyGet
+
+/* Console */
+#define SYS_CONSOLE_INDEX_0                         0
+
+/* I2C Driver */
+#define DRV_I2C_INDEX_0                             0
+#define DRV_I2C_CLIENTS_NUMBER_IDX0                 4
+#define DRV_I2C_QUEUE_SIZE_IDX0                     2
+
+/* Memory Driver */
+#define DRV_MEMORY_INDEX_0                          0
+#define DRV_MEMORY_CLIENTS_NUMBER_IDX0              2
+#define DRV_MEMORY_BUF_Q_SIZE_IDX0                  8
+
+/* AT25DF Driver */
+#define DRV_AT25DF_FLASH_SIZE                       8388608
+#define DRV_AT25DF_PAGE_SIZE                        256
+#define DRV_AT25DF_ERASE_BUFFER_SIZE                4096
+
+/* Memory Driver boot sector of USB MSD */
+#define DRV_MEMORY_BOOT_SECTOR_SIZE_PAGES           (10)
+#define DRV_MEMORY_BOOT_SECTOR_FLASH_ADDRESS        (0)
+
+#ifdef    __cplusplus
+}
+#endif
+
+#endif //CONFIGURATION_H
@@ -0,0 +1,229 @@
+/**
+ * @file definitions.h
+ * @brief Host build stand-in of Harmony generated definitions
+ *
+ * @details Declares the subset of Harmony services, drivers and peripheral libraries firmware sources use, with
+ * the same names and signatures as firmware/src/config/default headers. All of them are implemented by simulated
+ * back-ends in firmware/host/sim: SYS_TIME over virtual clock, DRV_MEMORY over RAM image of AT25DF flash, DRV_I2C
+ * over ST25DV and SHT3x models, EIC over pins driven by the models and the bench scenario.
+ */
+
+#ifndef DEFINITIONS_H
+#define DEFINITIONS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#include "configuration.h"
+#include "device.h"
+#include "driver/driver_common.h"
+
+#ifdef    __cplusplus
+extern "C" {
+#endif
+
+/* System */
+typedef uintptr_t SYS_MODULE_OBJ;
+typedef unsigned short int SYS_MODULE_INDEX;
+
+typedef struct {
+    SYS_MODULE_OBJ drvI2C0;
+    SYS_MODULE_OBJ usbDevObject0;
+    SYS_MODULE_OBJ sysTime;
+    SYS_MODULE_OBJ drvMemory0;
+    SYS_MODULE_OBJ drvUSBFSV1Object;
+    SYS_MODULE_OBJ sysConsole0;
+    SYS_MODULE_OBJ sysDebug;
+    SYS_MODULE_OBJ drvAT25DF;
+} SYSTEM_OBJECTS;
+
+extern SYSTEM_OBJECTS sysObj;
+
+void SYS_Initialize(void *data);
+
+void SYS_Tasks(void);
+
+/* Debug, messages are removed as by Harmony default SYS_DEBUG_PRINT */
+typedef enum {
+    SYS_ERROR_FATAL = 0,
+    SYS_ERROR_ERROR = 1,
+    SYS_ERROR_WARNING = 2,
+    SYS_ERROR_INFO = 3,
+    SYS_ERROR_DEBUG = 4
+} SYS_ERROR_LEVEL;
+
+#define SYS_DEBUG_PRINT(level, format, ...)     do { } while (0)
+#define SYS_ASSERT(test, message)
+
+/* Console and USB stack, run only while USB is powered */
+void SYS_CONSOLE_Tasks(SYS_MODULE_OBJ object);
+
+void USB_DEVICE_Tasks(SYS_MODULE_OBJ object);
+
+void DRV_USBFSV1_Tasks(SYS_MODULE_OBJ object);
+
+/* System Timer */
+typedef uintptr_t SYS_TIME_HANDLE;
+#define SYS_TIME_HANDLE_INVALID                 ((SYS_TIME_HANDLE) (-1))
+
+typedef enum {
+    SYS_TIME_SUCCESS,
+    SYS_TIME_ERROR
+} SYS_TIME_RESULT;
+
+typedef enum {
+    SYS_TIME_SINGLE,
+    SYS_TIME_PERIODIC
+} SYS_TIME_CALLBACK_TYPE;
+
+typedef void (*SYS_TIME_CALLBACK)(uintptr_t context);
+
+uint32_t SYS_TIME_FrequencyGet(void);
+
+uint32_t SYS_TIME_CounterGet(void);
+
+uint64_t SYS_TIME_Counter64Get(void);
+
+uint32_t SYS_TIME_CountToUS(uint32_t count);
+
+uint32_t SYS_TIME_CountToMS(uint32_t count);
+
+uint32_t SYS_TIME_MSToCount(uint32_t ms);
+
+SYS_TIME_HANDLE SYS_TIME_TimerCreate(uint32_t count, uint32_t period, SYS_TIME_CALLBACK callBack, uintptr_t context,
+                                     SYS_TIME_CALLBACK_TYPE type);
+
+SYS_TIME_RESULT SYS_TIME_TimerReload(SYS_TIME_HANDLE handle, uint32_t count, uint32_t period,
+                                     SYS_TIME_CALLBACK callBack, uintptr_t context, SYS_TIME_CALLBACK_TYPE type);
+
+SYS_TIME_RESULT SYS_TIME_TimerStart(SYS_TIME_HANDLE handle);
+
+SYS_TIME_RESULT SYS_TIME_TimerStop(SYS_TIME_HANDLE handle);
+
+SYS_TIME_RESULT SYS_TIME_TimerDestroy(SYS_TIME_HANDLE handle);
+
+SYS_TIME_HANDLE SYS_TIME_CallbackRegisterMS(SYS_TIME_CALLBACK callback, uintptr_t context, uint32_t ms,
+                                            SYS_TIME_CALLBACK_TYPE type);
+
+/* I2C Driver */
+typedef uintptr_t DRV_I2C_TRANSFER_HANDLE;
+#define DRV_I2C_TRANSFER_HANDLE_INVALID         ((DRV_I2C_TRANSFER_HANDLE) (-1))
+
+typedef enum {
+    DRV_I2C_TRANSFER_EVENT_PENDING = 0,
+    DRV_I2C_TRANSFER_EVENT_COMPLETE = 1,
+    DRV_I2C_TRANSFER_EVENT_HANDLE_EXPIRED = 2,
+    DRV_I2C_TRANSFER_EVENT_ERROR = -1,
+    DRV_I2C_TRANSFER_EVENT_HANDLE_INVALID = -2
+} DRV_I2C_TRANSFER_EVENT;
+
+typedef enum {
+    DRV_I2C_ERROR_NONE,
+    DRV_I2C_ERROR_NACK,
+    DRV_I2C_ERROR_BUS
+} DRV_I2C_ERROR;
+
+typedef struct {
+    uint32_t clockSpeed;
+} DRV_I2C_TRANSFER_SETUP;
+
+typedef void (*DRV_I2C_TRANSFER_EVENT_HANDLER)(DRV_I2C_TRANSFER_EVENT event, DRV_I2C_TRANSFER_HANDLE transferHandle,
+                                               uintptr_t context);
+
+DRV_HANDLE DRV_I2C_Open(const SYS_MODULE_INDEX drvIndex, const DRV_IO_INTENT ioIntent);
+
+bool DRV_I2C_TransferSetup(const DRV_HANDLE handle, DRV_I2C_TRANSFER_SETUP *setup);
+
+void DRV_I2C_TransferEventHandlerSet(const DRV_HANDLE handle, const DRV_I2C_TRANSFER_EVENT_HANDLER eventHandler,
+                                     const uintptr_t context);
+
+void DRV_I2C_WriteTransferAdd(const DRV_HANDLE handle, const uint16_t address, void *const buffer, const size_t size,
+                              DRV_I2C_TRANSFER_HANDLE *const transferHandle);
+
+void DRV_I2C_ReadTransferAdd(const DRV_HANDLE handle, const uint16_t address, void *const buffer, const size_t size,
+                             DRV_I2C_TRANSFER_HANDLE *const transferHandle);
+
+void DRV_I2C_WriteReadTransferAdd(const DRV_HANDLE handle, const uint16_t address, void *const writeBuffer,
+                                  const size_t writeSize, void *const readBuffer, const size_t readSize,
+                                  DRV_I2C_TRANSFER_HANDLE *const transferHandle);
+
+DRV_I2C_ERROR DRV_I2C_ErrorGet(const DRV_I2C_TRANSFER_HANDLE transferHandle);
+
+/* Memory Driver */
+typedef uintptr_t DRV_MEMORY_COMMAND_HANDLE;
+#define DRV_MEMORY_COMMAND_HANDLE_INVALID       ((DRV_MEMORY_COMMAND_HANDLE) (-1))
+
+typedef enum {
+    DRV_MEMORY_EVENT_COMMAND_COMPLETE,
+    DRV_MEMORY_EVENT_COMMAND_ERROR
+} DRV_MEMORY_EVENT;
+
+typedef enum {
+    DRV_MEMORY_COMMAND_COMPLETED,
+    DRV_MEMORY_COMMAND_QUEUED,
+    DRV_MEMORY_COMMAND_IN_PROGRESS,
+    DRV_MEMORY_COMMAND_ERROR_UNKNOWN
+} DRV_MEMORY_COMMAND_STATUS;
+
+typedef void (*DRV_MEMORY_TRANSFER_HANDLER)(DRV_MEMORY_EVENT event, DRV_MEMORY_COMMAND_HANDLE commandHandle,
+                                            uintptr_t context);
+
+void DRV_MEMORY_Tasks(SYS_MODULE_OBJ object);
+
+DRV_HANDLE DRV_MEMORY_Open(const SYS_MODULE_INDEX drvIndex, const DRV_IO_INTENT ioIntent);
+
+void DRV_MEMORY_Close(const DRV_HANDLE handle);
+
+void DRV_MEMORY_TransferHandlerSet(const DRV_HANDLE handle, const void *transferHandler, const uintptr_t context);
+
+void DRV_MEMORY_AsyncErase(const DRV_HANDLE handle, DRV_MEMORY_COMMAND_HANDLE *commandHandle, uint32_t blockStart,
+                           uint32_t nBlock);
+
+void DRV_MEMORY_AsyncEraseWrite(const DRV_HANDLE handle, DRV_MEMORY_COMMAND_HANDLE *commandHandle, void *sourceBuffer,
+                                uint32_t blockStart, uint32_t nBlock);
+
+void DRV_MEMORY_AsyncWrite(const DRV_HANDLE handle, DRV_MEMORY_COMMAND_HANDLE *commandHandle, void *sourceBuffer,
+                           uint32_t blockStart, uint32_t nBlock);
+
+void DRV_MEMORY_AsyncRead(const DRV_HANDLE handle, DRV_MEMORY_COMMAND_HANDLE *commandHandle, void *targetBuffer,
+                          uint32_t blockStart, uint32_t nBlock);
+
+DRV_MEMORY_COMMAND_STATUS DRV_MEMORY_CommandStatusGet(const DRV_HANDLE handle,
+                                                      const DRV_MEMORY_COMMAND_HANDLE commandHandle);
+
+/* EIC */
+typedef enum {
+    EIC_PIN_3 = 3,
+    EIC_PIN_15 = 15,
+    EIC_PIN_MAX = 16
+} EIC_PIN;
+
+typedef void (*EIC_CALLBACK)(uintptr_t context);
+
+void EIC_CallbackRegister(EIC_PIN pin, EIC_CALLBACK callback, uintptr_t context);
+
+/* RTC */
+bool RTC_RTCCTimeSet(struct tm *initialTime);
+
+void RTC_RTCCTimeGet(struct tm *currentTime);
+
+/* SERCOM */
+bool SERCOM0_I2C_IsBusy(void);
+
+bool SERCOM1_SPI_IsBusy(void);
+
+/* PORT, LED is not simulated */
+bool USB_VBUS_SENSE_Get(void);
+
+#define _LED_Set()                              do { } while (0)
+#define _LED_Clear()                            do { } while (0)
+#define _LED_Toggle()                           do { } while (0)
+
+#ifdef    __cplusplus
+}
+#endif
+
+#endif //DEFINITIONS_H
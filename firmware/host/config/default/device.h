@@ -0,0 +1,106 @@
+/**
+ * @file device.h
+ * @brief Host build stand-in of SAMD21 device header and CMSIS core
+ *
+ * @details Registers firmware touches are plain host structures (see sim_plib.c), bit fields are copied from
+ * ATSAMD21E18A_DFP and CMSIS headers. Intrinsics are backed by the simulation: PRIMASK is a lock shared by main loop
+ * and simulated ISRs (threads may act as ISRs), WFE sleeps till the next simulated interrupt.
+ */
+
+#ifndef DEVICE_H
+#define DEVICE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef    __cplusplus
+extern "C" {
+#endif
+
+/* Interrupts */
+typedef enum {
+    SYSCTRL_IRQn = 1,
+    EIC_IRQn = 4,
+    SERCOM0_IRQn = 9,
+    SERCOM1_IRQn = 10,
+} IRQn_Type;
+
+/* SCB */
+#define SCB_SCR_SLEEPDEEP_Pos               2U
+#define SCB_SCR_SLEEPDEEP_Msk               (1UL << SCB_SCR_SLEEPDEEP_Pos)
+#define SCB_SCR_SEVONPEND_Pos               4U
+#define SCB_SCR_SEVONPEND_Msk               (1UL << SCB_SCR_SEVONPEND_Pos)
+
+typedef struct {
+    volatile uint32_t SCR;
+} SCB_Type;
+
+extern SCB_Type simSCB;
+#define SCB                                 (&simSCB)
+
+/* PM */
+#define PM_SLEEP_IDLE_Pos                   (0U)
+#define PM_SLEEP_IDLE_Msk                   (0x3U << PM_SLEEP_IDLE_Pos)
+#define PM_SLEEP_IDLE(value)                (PM_SLEEP_IDLE_Msk & ((uint8_t) (value) << PM_SLEEP_IDLE_Pos))
+
+typedef struct {
+    volatile uint8_t PM_SLEEP;
+} pm_registers_t;
+
+extern pm_registers_t simPM;
+#define PM_REGS                             (&simPM)
+
+/* SYSCTRL */
+#define SYSCTRL_INTENCLR_BOD33DET_Msk       (0x1UL << 10)
+#define SYSCTRL_INTENSET_BOD33DET_Msk       (0x1UL << 10)
+#define SYSCTRL_INTFLAG_BOD33DET_Msk        (0x1UL << 10)
+#define SYSCTRL_PCLKSR_BOD33RDY_Msk         (0x1UL << 9)
+#define SYSCTRL_PCLKSR_B33SRDY_Msk          (0x1UL << 11)
+#define SYSCTRL_BOD33_ENABLE_Msk            (0x1UL << 1)
+#define SYSCTRL_BOD33_HYST_Msk              (0x1UL << 2)
+#define SYSCTRL_BOD33_ACTION_Pos            (3U)
+#define SYSCTRL_BOD33_ACTION_Msk            (0x3UL << SYSCTRL_BOD33_ACTION_Pos)
+#define SYSCTRL_BOD33_ACTION_RESET          (0x1UL << SYSCTRL_BOD33_ACTION_Pos)
+#define SYSCTRL_BOD33_ACTION_INTERRUPT      (0x2UL << SYSCTRL_BOD33_ACTION_Pos)
+#define SYSCTRL_BOD33_LEVEL_Pos             (16U)
+#define SYSCTRL_BOD33_LEVEL_Msk             (0x3FUL << SYSCTRL_BOD33_LEVEL_Pos)
+#define SYSCTRL_BOD33_LEVEL(value)          (SYSCTRL_BOD33_LEVEL_Msk & ((uint32_t) (value) << SYSCTRL_BOD33_LEVEL_Pos))
+
+typedef struct {
+    volatile uint32_t SYSCTRL_INTENCLR;
+    volatile uint32_t SYSCTRL_INTENSET;
+    volatile uint32_t SYSCTRL_INTFLAG;
+    volatile uint32_t SYSCTRL_PCLKSR;
+    volatile uint32_t SYSCTRL_BOD33;
+} sysctrl_registers_t;
+
+extern sysctrl_registers_t simSYSCTRL;
+#define SYSCTRL_REGS                        (&simSYSCTRL)
+
+/* NVIC, interrupts are always routed by the simulation */
+static inline void NVIC_SetPriority(IRQn_Type IRQn, uint32_t priority) { (void) IRQn; (void) priority; }
+
+static inline void NVIC_EnableIRQ(IRQn_Type IRQn) { (void) IRQn; }
+
+/* CMSIS intrinsics */
+uint32_t __get_PRIMASK(void);
+
+void __set_PRIMASK(uint32_t priMask);
+
+void __disable_irq(void);
+
+void __enable_irq(void);
+
+void __SEV(void);
+
+void __WFE(void);
+
+static inline void __DMB(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+
+static inline uint8_t __CLZ(uint32_t value) { return (0U == value) ? 32U : (uint8_t) __builtin_clz(value); }
+
+#ifdef    __cplusplus
+}
+#endif
+
+#endif //DEVICE_H
@@ -0,0 +1,164 @@
+/**
+ * @brief Discrete event simulation core and CMSIS intrinsics backed by it
+ * @details Events table is small and scanned linearly, there are a few peripherals and timers in flight at once.
+ */
+
+#include <pthread.h>
+#include <string.h>
+
+#include "definitions.h"
+#include "./sim.h"
+
+typedef struct {
+    TSimEventId id; /**< SIM_NO_EVENT if slot is free */
+    TSimTime time;
+    uint64_t order; /**< ties are fired in schedule order */
+    TSimCallback callback;
+    uintptr_t context;
+} TSimEvent;
+
+static TSimEvent events[SIM_EVENTS_MAX];
+static TSimTime now = 0;
+static TSimTime horizon = SIM_TIME_NEVER;
+static uint64_t scheduledCount = 0;
+static TSimEventId lastId = SIM_NO_EVENT;
+static bool isInterruptPending = false; // WFE event register
+static TSimStats stats;
+
+static pthread_mutex_t primaskLock = PTHREAD_MUTEX_INITIALIZER;
+static _Thread_local uint32_t primask = 0;
+
+// the nearest event due not later than limit, -1 if none
+static int _findNext(TSimTime limit) {
+    int next = -1;
+
+    for (int i = 0; i < SIM_EVENTS_MAX; i++) {
+        if ((SIM_NO_EVENT == events[i].id) || (events[i].time > limit)) continue;
+        if ((next >= 0) && ((events[i].time > events[next].time) ||
+                            ((events[i].time == events[next].time) && (events[i].order > events[next].order))))
+            continue;
+
+        next = i;
+    }
+
+    return next;
+};
+
+void SIM_Initialize(TSimTime simHorizon) {
+    memset(events, 0, sizeof(events));
+    memset(&stats, 0, sizeof(stats));
+    now = 0;
+    horizon = simHorizon;
+    scheduledCount = 0;
+    isInterruptPending = false;
+};
+
+TSimTime SIM_GetTime(void) {
+    return now;
+};
+
+bool SIM_IsOver(void) {
+    return now >= horizon;
+};
+
+TSimEventId SIM_Schedule(TSimTime time, TSimCallback callback, uintptr_t context) {
+    for (int i = 0; i < SIM_EVENTS_MAX; i++) {
+        if (SIM_NO_EVENT != events[i].id) continue;
+
+        if (SIM_NO_EVENT == ++lastId) lastId++;
+
+        events[i] = (TSimEvent) {
+                .id = lastId,
+                .time = time,
+                .order = scheduledCount++,
+                .callback = callback,
+                .context = context
+        };
+
+        return lastId;
+    }
+
+    return SIM_NO_EVENT;
+};
+
+void SIM_Cancel(TSimEventId id) {
+    if (SIM_NO_EVENT == id) return;
+
+    for (int i = 0; i < SIM_EVENTS_MAX; i++)
+        if (id == events[i].id) events[i].id = SIM_NO_EVENT;
+};
+
+bool SIM_Step(TSimTime limit) {
+    if (limit > horizon) limit = horizon;
+
+    const int next = _findNext(limit);
+
+    if (next < 0) {
+        if (limit > now) now = limit;
+        return false;
+    }
+
+    const TSimEvent event = events[next];
+
+    events[next].id = SIM_NO_EVENT;
+    if (event.time > now) now = event.time;
+    stats.eventsFired++;
+    event.callback(event.context);
+
+    return true;
+};
+
+void SIM_RunUntil(TSimTime time) {
+    while (SIM_Step(time));
+};
+
+void SIM_RaiseInterrupt(void) {
+    stats.interrupts++;
+    isInterruptPending = true;
+};
+
+void SIM_BusyWait(TSimTime until) {
+    stats.busyWaits++;
+    SIM_Step(until);
+};
+
+const TSimStats *SIM_GetStats(void) {
+    return &stats;
+};
+
+/* CMSIS intrinsics */
+
+uint32_t __get_PRIMASK(void) {
+    return primask;
+};
+
+void __set_PRIMASK(uint32_t priMask) {
+    priMask &= 1U;
+
+    if (priMask && !primask) pthread_mutex_lock(&primaskLock);
+    if (!priMask && primask) pthread_mutex_unlock(&primaskLock);
+
+    primask = priMask;
+};
+
+void __disable_irq(void) {
+    __set_PRIMASK(1U);
+};
+
+void __enable_irq(void) {
+    __set_PRIMASK(0U);
+};
+
+void __SEV(void) {
+    isInterruptPending = true;
+};
+
+// sleeps till an interrupt, returns at once if one is pending since the previous WFE
+void __WFE(void) {
+    if (!isInterruptPending) {
+        stats.sleeps++;
+        while (!isInterruptPending && !SIM_IsOver()) SIM_Step(horizon);
+    }
+
+    isInterruptPending = false;
+};
@@ -0,0 +1,92 @@
+/**
+ * @file sim.h
+ * @brief Discrete event simulation the host build runs firmware on
+ *
+ * @details Time is virtual: it stands still while firmware code runs and jumps to the next scheduled event when main
+ * loop sleeps (WFE) or busy waits for a peripheral. Events are peripheral completions (I2C, SPI flash), SYS_TIME
+ * compares, pin changes of sensors models and bench scenario steps, they are fired in time order, ties in schedule
+ * order. Event callback runs in "ISR" context, it raises interrupt flag to wake the main loop if it calls firmware
+ * handlers, as SEVONPEND does on the target.
+ *
+ * PRIMASK is a lock, so main loop critical sections are exclusive with ISRs run by other threads (stress tests),
+ * simulation itself is single threaded.
+ */
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef    __cplusplus
+extern "C" {
+#endif
+
+#define SIM_US_IN_MS                        (1000ULL)
+#define SIM_US_IN_S                         (1000000ULL)
+#define SIM_US_IN_HOUR                      (3600ULL * SIM_US_IN_S)
+#define SIM_EVENTS_MAX                      (64)
+#define SIM_NO_EVENT                        (0)
+#define SIM_TIME_NEVER                      (UINT64_MAX)
+
+/** @brief virtual time, us since simulation start */
+typedef uint64_t TSimTime;
+
+/** @brief scheduled event handle, SIM_NO_EVENT if none */
+typedef uint32_t TSimEventId;
+
+typedef void (*TSimCallback)(uintptr_t context);
+
+/** @brief simulation counters */
+typedef struct {
+    uint32_t eventsFired;
+    uint32_t interrupts; /**< events which called firmware handlers */
+    uint32_t sleeps; /**< WFE calls which waited for an interrupt */
+    uint32_t busyWaits; /**< time jumps while firmware polled a peripheral */
+} TSimStats;
+
+/** @brief Reset clock to 0, drop all events, run till horizon is reached */
+void SIM_Initialize(TSimTime horizon);
+
+/** @return current virtual time */
+TSimTime SIM_GetTime(void);
+
+/** @return true once time reached the horizon, main loop should stop */
+bool SIM_IsOver(void);
+
+/**
+ * @brief Schedule callback at given time, times in the past fire on the next step
+ * @return event handle to cancel it, SIM_NO_EVENT if events table is full
+ */
+TSimEventId SIM_Schedule(TSimTime time, TSimCallback callback, uintptr_t context);
+
+/** @brief Cancel scheduled event, fired or unknown event is ignored */
+void SIM_Cancel(TSimEventId id);
+
+/**
+ * @brief Fire the nearest event due not later than limit, time advances to the event, or to the limit if none
+ * @return true if event is fired
+ */
+bool SIM_Step(TSimTime limit);
+
+/** @brief Fire all events due not later than time, time is advanced to it */
+void SIM_RunUntil(TSimTime time);
+
+/** @brief Mark interrupt pending, main loop WFE returns at once, called by peripherals calling firmware handlers */
+void SIM_RaiseInterrupt(void);
+
+/**
+ * @brief Firmware polls a peripheral which completes at given time, time advances to the nearest event or to it
+ * @details Events due meanwhile are fired, so ISRs run during busy waits as on the target.
+ */
+void SIM_BusyWait(TSimTime until);
+
+/** @return counters since initialization */
+const TSimStats *SIM_GetStats(void);
+
+#ifdef    __cplusplus
+}
+#endif
+
+#endif //SIM_H
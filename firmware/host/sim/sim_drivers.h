@@ -0,0 +1,100 @@
+/**
+ * @file sim_drivers.h
+ * @brief Controls and counters of simulated Harmony drivers and peripheral libraries, for benches and tests
+ */
+
+#ifndef SIM_DRIVERS_H
+#define SIM_DRIVERS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "definitions.h"
+#include "./sim.h"
+
+#ifdef    __cplusplus
+extern "C" {
+#endif
+
+/* AT25DF timings, typical datasheet values, SPI at 1 MHz */
+#define SIM_MEMORY_SPI_BYTE_TIME_US         (8)
+#define SIM_MEMORY_COMMAND_SIZE             (4) // opcode and 24-bit address
+#define SIM_MEMORY_PAGE_PROGRAM_TIME_US     (1000)
+#define SIM_MEMORY_SECTOR_ERASE_TIME_US     (50000)
+#define SIM_MEMORY_READ_BLOCK_SIZE          (1)
+
+/* I2C transfer time: 9 clocks per byte, slave address and start/stop conditions */
+#define SIM_I2C_TRANSFER_TIME_US(bytes, clockSpeed) \
+    ((((uint64_t) (bytes) + 2) * 9U * SIM_US_IN_S + (clockSpeed) - 1) / (clockSpeed))
+
+/** @brief SPI flash counters, physical operations of the simulated chip */
+typedef struct {
+    uint32_t commands; /**< MEMORY driver requests queued */
+    uint32_t rejected; /**< requests refused on full queue */
+    uint64_t bytesRead;
+    uint64_t bytesProgrammed;
+    uint32_t pagesProgrammed;
+    uint32_t sectorsErased;
+} TSimMemoryStats;
+
+/** @brief I2C bus counters */
+typedef struct {
+    uint32_t transfers;
+    uint32_t nacks;
+    uint32_t rejected; /**< requests refused on full queue */
+    uint64_t bytes; /**< payload bytes, register addresses included */
+    uint64_t busTimeUs;
+} TSimI2CStats;
+
+/**
+ * @brief I2C slave model, handles the whole transfer: write part, then read part (repeated start)
+ * @return false to NACK
+ */
+typedef bool (*TSimI2CDevice)(const uint8_t *write, size_t writeSize, uint8_t *read, size_t readSize);
+
+/** @brief Drop all timers */
+void SIM_TIME_Initialize(void);
+
+/** @brief Drop queued requests and counters, flash content is kept (it survives reboots) */
+void SIM_MEMORY_Initialize(void);
+
+/** @brief Erase the whole flash to 0xFF */
+void SIM_MEMORY_EraseChip(void);
+
+/** @return flash image, DRV_AT25DF_FLASH_SIZE bytes, tests may fill and inspect it directly */
+uint8_t *SIM_MEMORY_GetFlash(void);
+
+/** @return true while a request is queued or in progress */
+bool SIM_MEMORY_IsBusy(void);
+
+const TSimMemoryStats *SIM_MEMORY_GetStats(void);
+
+/** @brief Drop clients, queued transfers, attached devices and counters */
+void SIM_I2C_Initialize(void);
+
+/** @brief Attach slave model at 7-bit address, transfers to other addresses are NACKed */
+void SIM_I2C_AttachDevice(uint16_t address, TSimI2CDevice device);
+
+/** @return true while a transfer is queued or in progress */
+bool SIM_I2C_IsBusy(void);
+
+const TSimI2CStats *SIM_I2C_GetStats(void);
+
+/** @brief Reset pins, EIC callbacks, RTC and registers */
+void SIM_PLIB_Initialize(void);
+
+/** @brief Pin change interrupt, callback is run in ISR context */
+void SIM_EIC_Trigger(EIC_PIN pin);
+
+/** @brief Set USB VBUS sense pin, its EIC interrupt is triggered on change */
+void SIM_PLIB_SetVBUS(bool isPowered);
+
+/** @brief Set RTC calendar at simulation start, seconds since 1970 */
+void SIM_RTC_SetEpoch(uint32_t epoch);
+
+#ifdef    __cplusplus
+}
+#endif
+
+#endif //SIM_DRIVERS_H
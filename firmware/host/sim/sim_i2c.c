@@ -0,0 +1,215 @@
+/**
+ * @brief DRV_I2C over attached slave models
+ * @details Transfers are queued as by the driver and run one by one at the clock of the client which added them.
+ * Transfer is passed to the slave model once its bus time elapsed, then the client handler is called in ISR context.
+ * Transfer to an address no model is attached to is NACKed.
+ */
+
+#include <string.h>
+
+#include "definitions.h"
+#include "./sim.h"
+#include "./sim_drivers.h"
+
+#define SIM_I2C_DEVICES_MAX                 (4)
+#define SIM_I2C_ERRORS_MAX                  (16) // completed transfers errors kept for ErrorGet
+#define SIM_I2C_DEFAULT_CLOCK_SPEED         (100000)
+
+typedef struct {
+    bool isOpen;
+    uint32_t clockSpeed;
+    DRV_I2C_TRANSFER_EVENT_HANDLER handler;
+    uintptr_t context;
+} TSimI2CClient;
+
+typedef struct {
+    DRV_I2C_TRANSFER_HANDLE handle;
+    uint8_t client;
+    uint16_t address;
+    const uint8_t *write;
+    size_t writeSize;
+    uint8_t *read;
+    size_t readSize;
+} TSimI2CTransfer;
+
+static TSimI2CClient clients[DRV_I2C_CLIENTS_NUMBER_IDX0];
+static TSimI2CTransfer queue[DRV_I2C_QUEUE_SIZE_IDX0];
+static uint8_t queueHead = 0;
+static uint8_t queueSize = 0;
+static DRV_I2C_TRANSFER_HANDLE lastHandle = 0;
+static TSimEventId doneEvent = SIM_NO_EVENT;
+static struct {
+    uint16_t address;
+    TSimI2CDevice device;
+} devices[SIM_I2C_DEVICES_MAX];
+static struct {
+    DRV_I2C_TRANSFER_HANDLE handle;
+    DRV_I2C_ERROR error;
+} errors[SIM_I2C_ERRORS_MAX];
+static TSimI2CStats stats;
+
+static void _onTransferDone(uintptr_t context);
+
+static inline TSimI2CClient *_getClient(const DRV_HANDLE handle) {
+    if ((handle >= DRV_I2C_CLIENTS_NUMBER_IDX0) || !clients[handle].isOpen) return NULL;
+
+    return &clients[handle];
+};
+
+static TSimI2CDevice _getDevice(uint16_t address) {
+    for (int i = 0; i < SIM_I2C_DEVICES_MAX; i++)
+        if ((NULL != devices[i].device) && (address == devices[i].address)) return devices[i].device;
+
+    return NULL;
+};
+
+static void _start(void) {
+    const TSimI2CTransfer *const transfer = &queue[queueHead];
+    const uint64_t busTime = SIM_I2C_TRANSFER_TIME_US(transfer->writeSize + transfer->readSize,
+                                                      clients[transfer->client].clockSpeed);
+
+    stats.busTimeUs += busTime;
+    doneEvent = SIM_Schedule(SIM_GetTime() + busTime, _onTransferDone, 0);
+};
+
+static void _onTransferDone(uintptr_t context) {
+    const TSimI2CTransfer transfer = queue[queueHead];
+    const TSimI2CClient *const client = &clients[transfer.client];
+    const TSimI2CDevice device = _getDevice(transfer.address);
+    const bool isAcked = (NULL != device) && device(transfer.write, transfer.writeSize, transfer.read,
+                                                    transfer.readSize);
+
+    doneEvent = SIM_NO_EVENT;
+    queueHead = (queueHead + 1) % DRV_I2C_QUEUE_SIZE_IDX0;
+    queueSize--;
+    if (0 != queueSize) _start();
+
+    stats.transfers++;
+    stats.bytes += transfer.writeSize + transfer.readSize;
+    if (!isAcked) stats.nacks++;
+
+    errors[transfer.handle % SIM_I2C_ERRORS_MAX].handle = transfer.handle;
+    errors[transfer.handle % SIM_I2C_ERRORS_MAX].error = isAcked ? DRV_I2C_ERROR_NONE : DRV_I2C_ERROR_NACK;
+
+    if (NULL == client->handler) return;
+
+    SIM_RaiseInterrupt();
+    client->handler(isAcked ? DRV_I2C_TRANSFER_EVENT_COMPLETE : DRV_I2C_TRANSFER_EVENT_ERROR, transfer.handle,
+                    client->context);
+};
+
+static void _add(const DRV_HANDLE handle, const uint16_t address, const void *write, size_t writeSize, void *read,
+                 size_t readSize, DRV_I2C_TRANSFER_HANDLE *const transferHandle) {
+    const bool isValid = (NULL != _getClient(handle)) && ((0 != writeSize) || (0 != readSize));
+
+    *transferHandle = DRV_I2C_TRANSFER_HANDLE_INVALID;
+    if (!isValid || (DRV_I2C_QUEUE_SIZE_IDX0 == queueSize)) {
+        stats.rejected++;
+        return;
+    }
+
+    if (DRV_I2C_TRANSFER_HANDLE_INVALID == ++lastHandle) lastHandle = 0;
+
+    queue[(queueHead + queueSize) % DRV_I2C_QUEUE_SIZE_IDX0] = (TSimI2CTransfer) {
+            .handle = lastHandle,
+            .client = (uint8_t) handle,
+            .address = address,
+            .write = write,
+            .writeSize = writeSize,
+            .read = read,
+            .readSize = readSize
+    };
+    *transferHandle = lastHandle;
+
+    if (0 == queueSize++) _start();
+};
+
+DRV_HANDLE DRV_I2C_Open(const SYS_MODULE_INDEX drvIndex, const DRV_IO_INTENT ioIntent) {
+    if (DRV_I2C_INDEX_0 != drvIndex) return DRV_HANDLE_INVALID;
+
+    for (DRV_HANDLE handle = 0; handle < DRV_I2C_CLIENTS_NUMBER_IDX0; handle++) {
+        if (clients[handle].isOpen) continue;
+
+        clients[handle] = (TSimI2CClient) {.isOpen = true, .clockSpeed = SIM_I2C_DEFAULT_CLOCK_SPEED};
+
+        return handle;
+    }
+
+    return DRV_HANDLE_INVALID;
+};
+
+bool DRV_I2C_TransferSetup(const DRV_HANDLE handle, DRV_I2C_TRANSFER_SETUP *setup) {
+    TSimI2CClient *const client = _getClient(handle);
+
+    if ((NULL == client) || (NULL == setup) || (0 == setup->clockSpeed)) return false;
+
+    client->clockSpeed = setup->clockSpeed;
+
+    return true;
+};
+
+void DRV_I2C_TransferEventHandlerSet(const DRV_HANDLE handle, const DRV_I2C_TRANSFER_EVENT_HANDLER eventHandler,
+                                     const uintptr_t context) {
+    TSimI2CClient *const client = _getClient(handle);
+
+    if (NULL == client) return;
+
+    client->handler = eventHandler;
+    client->context = context;
+};
+
+void DRV_I2C_WriteTransferAdd(const DRV_HANDLE handle, const uint16_t address, void *const buffer, const size_t size,
+                              DRV_I2C_TRANSFER_HANDLE *const transferHandle) {
+    _add(handle, address, buffer, size, NULL, 0, transferHandle);
+};
+
+void DRV_I2C_ReadTransferAdd(const DRV_HANDLE handle, const uint16_t address, void *const buffer, const size_t size,
+                             DRV_I2C_TRANSFER_HANDLE *const transferHandle) {
+    _add(handle, address, NULL, 0, buffer, size, transferHandle);
+};
+
+void DRV_I2C_WriteReadTransferAdd(const DRV_HANDLE handle, const uint16_t address, void *const writeBuffer,
+                                  const size_t writeSize, void *const readBuffer, const size_t readSize,
+                                  DRV_I2C_TRANSFER_HANDLE *const transferHandle) {
+    _add(handle, address, writeBuffer, writeSize, readBuffer, readSize, transferHandle);
+};
+
+DRV_I2C_ERROR DRV_I2C_ErrorGet(const DRV_I2C_TRANSFER_HANDLE transferHandle) {
+    if (errors[transferHandle % SIM_I2C_ERRORS_MAX].handle != transferHandle) return DRV_I2C_ERROR_NONE;
+
+    return errors[transferHandle % SIM_I2C_ERRORS_MAX].error;
+};
+
+bool SERCOM0_I2C_IsBusy(void) {
+    return SIM_I2C_IsBusy();
+};
+
+void SIM_I2C_Initialize(void) {
+    SIM_Cancel(doneEvent);
+    doneEvent = SIM_NO_EVENT;
+    queueHead = 0;
+    queueSize = 0;
+    memset(clients, 0, sizeof(clients));
+    memset(devices, 0, sizeof(devices));
+    memset(errors, 0, sizeof(errors));
+    memset(&stats, 0, sizeof(stats));
+};
+
+void SIM_I2C_AttachDevice(uint16_t address, TSimI2CDevice device) {
+    for (int i = 0; i < SIM_I2C_DEVICES_MAX; i++) {
+        if ((NULL != devices[i].device) && (address != devices[i].address)) continue;
+
+        devices[i].address = address;
+        devices[i].device = device;
+
+        return;
+    }
+};
+
+bool SIM_I2C_IsBusy(void) {
+    return 0 != queueSize;
+};
+
+const TSimI2CStats *SIM_I2C_GetStats(void) {
+    return &stats;
+};
@@ -0,0 +1,254 @@
+/**
+ * @brief DRV_MEMORY over RAM image of AT25DF flash
+ * @details Requests are queued as by the driver and run one by one, each takes SPI transfer time plus program or
+ * erase time of the chip. Request is applied to the image and its handler is called from DRV_MEMORY_Tasks once it is
+ * due, as the driver is polled. Tasks called before that is a busy wait of the main loop, so time jumps ahead.
+ * Program clears bits only (NOR flash), so writes over not erased pages corrupt data as on the chip.
+ */
+
+#include <string.h>
+
+#include "definitions.h"
+#include "./sim.h"
+#include "./sim_drivers.h"
+
+#define SIM_MEMORY_HANDLE                   ((DRV_HANDLE) 0)
+#define SIM_MEMORY_STATUSES_MAX             (32) // completed requests statuses kept for CommandStatusGet
+
+typedef enum {
+    SIM_MEMORY_READ,
+    SIM_MEMORY_WRITE,
+    SIM_MEMORY_ERASE,
+    SIM_MEMORY_ERASE_WRITE
+} SIM_MEMORY_OPERATION;
+
+typedef struct {
+    DRV_MEMORY_COMMAND_HANDLE handle;
+    SIM_MEMORY_OPERATION operation;
+    uint8_t *buffer;
+    uint32_t address;
+    uint32_t size;
+    TSimTime doneAt; /**< set once request is started */
+} TSimMemoryRequest;
+
+static uint8_t flash[DRV_AT25DF_FLASH_SIZE];
+static TSimMemoryRequest queue[DRV_MEMORY_BUF_Q_SIZE_IDX0];
+static uint8_t queueHead = 0;
+static uint8_t queueSize = 0;
+static uint8_t clients = 0;
+static DRV_MEMORY_COMMAND_HANDLE lastHandle = 0;
+static DRV_MEMORY_TRANSFER_HANDLER transferHandler = NULL;
+static uintptr_t transferContext = 0;
+static struct {
+    DRV_MEMORY_COMMAND_HANDLE handle;
+    DRV_MEMORY_COMMAND_STATUS status;
+} statuses[SIM_MEMORY_STATUSES_MAX];
+static TSimMemoryStats stats;
+
+static inline TSimTime _transferTime(uint32_t bytes) {
+    return (TSimTime) (SIM_MEMORY_COMMAND_SIZE + bytes) * SIM_MEMORY_SPI_BYTE_TIME_US;
+};
+
+static TSimTime _duration(const TSimMemoryRequest *const request) {
+    const uint32_t pages = (request->size + DRV_AT25DF_PAGE_SIZE - 1) / DRV_AT25DF_PAGE_SIZE;
+    const uint32_t sectors = (request->size + DRV_AT25DF_ERASE_BUFFER_SIZE - 1) / DRV_AT25DF_ERASE_BUFFER_SIZE;
+
+    switch (request->operation) {
+        case SIM_MEMORY_READ:
+            return _transferTime(request->size);
+        case SIM_MEMORY_WRITE:
+            return _transferTime(request->size) + (TSimTime) pages * SIM_MEMORY_PAGE_PROGRAM_TIME_US;
+        case SIM_MEMORY_ERASE:
+            return (TSimTime) sectors * (_transferTime(0) + SIM_MEMORY_SECTOR_ERASE_TIME_US);
+        case SIM_MEMORY_ERASE_WRITE:
+        default:
+            // sectors are read back, erased and programmed whole
+            return (TSimTime) sectors * (2 * _transferTime(DRV_AT25DF_ERASE_BUFFER_SIZE) + SIM_MEMORY_SECTOR_ERASE_TIME_US +
+                                         (DRV_AT25DF_ERASE_BUFFER_SIZE / DRV_AT25DF_PAGE_SIZE) * SIM_MEMORY_PAGE_PROGRAM_TIME_US);
+    }
+};
+
+static void _program(uint32_t address, const uint8_t *data, uint32_t size) {
+    for (uint32_t i = 0; i < size; i++) flash[address + i] &= data[i];
+
+    stats.bytesProgrammed += size;
+    stats.pagesProgrammed += (size + DRV_AT25DF_PAGE_SIZE - 1) / DRV_AT25DF_PAGE_SIZE;
+};
+
+static void _erase(uint32_t address, uint32_t size) {
+    memset(&flash[address], 0xFF, size);
+    stats.sectorsErased += size / DRV_AT25DF_ERASE_BUFFER_SIZE;
+};
+
+static void _apply(const TSimMemoryRequest *const request) {
+    switch (request->operation) {
+        case SIM_MEMORY_READ:
+            memcpy(request->buffer, &flash[request->address], request->size);
+            stats.bytesRead += request->size;
+            return;
+        case SIM_MEMORY_WRITE:
+            return _program(request->address, request->buffer, request->size);
+        case SIM_MEMORY_ERASE:
+            return _erase(request->address, request->size);
+        case SIM_MEMORY_ERASE_WRITE: {
+            const uint32_t start = request->address & ~(uint32_t) (DRV_AT25DF_ERASE_BUFFER_SIZE - 1);
+            const uint32_t end = (request->address + request->size + DRV_AT25DF_ERASE_BUFFER_SIZE - 1) &
+                                 ~(uint32_t) (DRV_AT25DF_ERASE_BUFFER_SIZE - 1);
+            static uint8_t sector[DRV_AT25DF_ERASE_BUFFER_SIZE];
+
+            for (uint32_t address = start; address < end; address += DRV_AT25DF_ERASE_BUFFER_SIZE) {
+                memcpy(sector, &flash[address], DRV_AT25DF_ERASE_BUFFER_SIZE);
+                for (uint32_t i = 0; i < DRV_AT25DF_ERASE_BUFFER_SIZE; i++) {
+                    const uint32_t offset = address + i - request->address;
+
+                    if ((address + i >= request->address) && (offset < request->size))
+                        sector[i] = request->buffer[offset];
+                }
+                _erase(address, DRV_AT25DF_ERASE_BUFFER_SIZE);
+                _program(address, sector, DRV_AT25DF_ERASE_BUFFER_SIZE);
+            }
+            return;
+        }
+    }
+};
+
+static void _setStatus(DRV_MEMORY_COMMAND_HANDLE handle, DRV_MEMORY_COMMAND_STATUS status) {
+    statuses[handle % SIM_MEMORY_STATUSES_MAX].handle = handle;
+    statuses[handle % SIM_MEMORY_STATUSES_MAX].status = status;
+};
+
+static inline void _start(TSimMemoryRequest *const request) {
+    request->doneAt = SIM_GetTime() + _duration(request);
+};
+
+static void _add(const DRV_HANDLE handle, DRV_MEMORY_COMMAND_HANDLE *commandHandle, SIM_MEMORY_OPERATION operation,
+                 void *buffer, uint32_t address, uint32_t size) {
+    const bool isValid = (SIM_MEMORY_HANDLE == handle) && (0 != clients) && (0 != size) &&
+                         ((address + size) <= DRV_AT25DF_FLASH_SIZE);
+
+    if (!isValid || (DRV_MEMORY_BUF_Q_SIZE_IDX0 == queueSize)) {
+        stats.rejected++;
+        if (NULL != commandHandle) *commandHandle = DRV_MEMORY_COMMAND_HANDLE_INVALID;
+        return;
+    }
+
+    TSimMemoryRequest *const request = &queue[(queueHead + queueSize) % DRV_MEMORY_BUF_Q_SIZE_IDX0];
+
+    *request = (TSimMemoryRequest) {
+            .handle = ++lastHandle,
+            .operation = operation,
+            .buffer = buffer,
+            .address = address,
+            .size = size
+    };
+    if (0 == queueSize) _start(request);
+    queueSize++;
+    stats.commands++;
+
+    _setStatus(request->handle, DRV_MEMORY_COMMAND_QUEUED);
+    if (NULL != commandHandle) *commandHandle = request->handle;
+};
+
+void DRV_MEMORY_Tasks(SYS_MODULE_OBJ object) {
+    if (0 == queueSize) return;
+
+    TSimMemoryRequest *const request = &queue[queueHead];
+
+    // driver is polled till the request is done, events due meanwhile are served
+    if (request->doneAt > SIM_GetTime()) return SIM_BusyWait(request->doneAt);
+
+    const TSimMemoryRequest done = *request;
+
+    _apply(&done);
+    queueHead = (queueHead + 1) % DRV_MEMORY_BUF_Q_SIZE_IDX0;
+    queueSize--;
+    if (0 != queueSize) _start(&queue[queueHead]);
+
+    _setStatus(done.handle, DRV_MEMORY_COMMAND_COMPLETED);
+    if (NULL != transferHandler) transferHandler(DRV_MEMORY_EVENT_COMMAND_COMPLETE, done.handle, transferContext);
+};
+
+DRV_HANDLE DRV_MEMORY_Open(const SYS_MODULE_INDEX drvIndex, const DRV_IO_INTENT ioIntent) {
+    if ((DRV_MEMORY_INDEX_0 != drvIndex) || (DRV_MEMORY_CLIENTS_NUMBER_IDX0 == clients)) return DRV_HANDLE_INVALID;
+
+    clients++;
+
+    return SIM_MEMORY_HANDLE;
+};
+
+void DRV_MEMORY_Close(const DRV_HANDLE handle) {
+    if ((SIM_MEMORY_HANDLE != handle) || (0 == clients)) return;
+
+    clients--;
+    if (0 == clients) transferHandler = NULL;
+};
+
+void DRV_MEMORY_TransferHandlerSet(const DRV_HANDLE handle, const void *handler, const uintptr_t context) {
+    if (SIM_MEMORY_HANDLE != handle) return;
+
+    transferHandler = (DRV_MEMORY_TRANSFER_HANDLER) handler;
+    transferContext = context;
+};
+
+void DRV_MEMORY_AsyncErase(const DRV_HANDLE handle, DRV_MEMORY_COMMAND_HANDLE *commandHandle, uint32_t blockStart,
+                           uint32_t nBlock) {
+    _add(handle, commandHandle, SIM_MEMORY_ERASE, NULL, blockStart * DRV_AT25DF_ERASE_BUFFER_SIZE,
+         nBlock * DRV_AT25DF_ERASE_BUFFER_SIZE);
+};
+
+void DRV_MEMORY_AsyncEraseWrite(const DRV_HANDLE handle, DRV_MEMORY_COMMAND_HANDLE *commandHandle, void *sourceBuffer,
+                                uint32_t blockStart, uint32_t nBlock) {
+    _add(handle, commandHandle, SIM_MEMORY_ERASE_WRITE, sourceBuffer, blockStart * DRV_AT25DF_PAGE_SIZE,
+         nBlock * DRV_AT25DF_PAGE_SIZE);
+};
+
+void DRV_MEMORY_AsyncWrite(const DRV_HANDLE handle, DRV_MEMORY_COMMAND_HANDLE *commandHandle, void *sourceBuffer,
+                           uint32_t blockStart, uint32_t nBlock) {
+    _add(handle, commandHandle, SIM_MEMORY_WRITE, sourceBuffer, blockStart * DRV_AT25DF_PAGE_SIZE,
+         nBlock * DRV_AT25DF_PAGE_SIZE);
+};
+
+void DRV_MEMORY_AsyncRead(const DRV_HANDLE handle, DRV_MEMORY_COMMAND_HANDLE *commandHandle, void *targetBuffer,
+                          uint32_t blockStart, uint32_t nBlock) {
+    _add(handle, commandHandle, SIM_MEMORY_READ, targetBuffer, blockStart * SIM_MEMORY_READ_BLOCK_SIZE,
+         nBlock * SIM_MEMORY_READ_BLOCK_SIZE);
+};
+
+DRV_MEMORY_COMMAND_STATUS DRV_MEMORY_CommandStatusGet(const DRV_HANDLE handle,
+                                                      const DRV_MEMORY_COMMAND_HANDLE commandHandle) {
+    if ((0 != queueSize) && (queue[queueHead].handle == commandHandle)) return DRV_MEMORY_COMMAND_IN_PROGRESS;
+    if (statuses[commandHandle % SIM_MEMORY_STATUSES_MAX].handle != commandHandle)
+        return DRV_MEMORY_COMMAND_ERROR_UNKNOWN;
+
+    return statuses[commandHandle % SIM_MEMORY_STATUSES_MAX].status;
+};
+
+bool SERCOM1_SPI_IsBusy(void) {
+    return SIM_MEMORY_IsBusy();
+};
+
+void SIM_MEMORY_Initialize(void) {
+    queueHead = 0;
+    queueSize = 0;
+    clients = 0;
+    transferHandler = NULL;
+    transferContext = 0;
+    memset(statuses, 0, sizeof(statuses));
+    memset(&stats, 0, sizeof(stats));
+};
+
+void SIM_MEMORY_EraseChip(void) {
+    memset(flash, 0xFF, sizeof(flash));
+};
+
+uint8_t *SIM_MEMORY_GetFlash(void) {
+    return flash;
+};
+
+bool SIM_MEMORY_IsBusy(void) {
+    return 0 != queueSize;
+};
+
+const TSimMemoryStats *SIM_MEMORY_GetStats(void) {
+    return &stats;
+};
@@ -0,0 +1,120 @@
+/**
+ * @brief Peripheral libraries, system initialization and tasks of the host build
+ * @details SYS_Initialize and SYS_Tasks follow config/default/initialization.c and tasks.c, Harmony modules are
+ * replaced by the simulated back-ends. USB stack is not simulated: its tasks only let time pass, as the main loop
+ * spins while USB is powered.
+ */
+
+#define _DEFAULT_SOURCE // timegm, gmtime_r
+
+#include <string.h>
+#include <time.h>
+
+#include "definitions.h"
+#include "./sim.h"
+#include "./sim_drivers.h"
+#include "init_manager/init_manager.h"
+#include "app_manager/app_manager.h"
+#include "usb_manager/usb_manager.h"
+
+#define SIM_RTC_DEFAULT_EPOCH               (1704067200UL) // 2024-01-01 00:00:00 UTC
+
+SCB_Type simSCB;
+pm_registers_t simPM;
+sysctrl_registers_t simSYSCTRL;
+SYSTEM_OBJECTS sysObj;
+
+static struct {
+    EIC_CALLBACK callback;
+    uintptr_t context;
+} eicCallbacks[EIC_PIN_MAX];
+static bool isVBUSPowered = false;
+static int64_t rtcOffset = SIM_RTC_DEFAULT_EPOCH; // calendar seconds at simulation time 0
+
+void SYS_Initialize(void *data) {
+    sysObj = (SYSTEM_OBJECTS) {
+            .drvI2C0 = DRV_I2C_INDEX_0,
+            .sysTime = SYS_TIME_INDEX_0,
+            .drvMemory0 = DRV_MEMORY_INDEX_0,
+            .sysConsole0 = SYS_CONSOLE_INDEX_0
+    };
+
+    /* Init Main App Manager */
+    APP_Initialize();
+
+    /* Initialize Actors */
+    INIT_Initialize((uintptr_t) NULL);
+
+    /* Init USB Manager */
+    USB_Initialize();
+};
+
+void SYS_Tasks(void) {
+    /* Maintain Device Drivers */
+    DRV_MEMORY_Tasks(sysObj.drvMemory0);
+};
+
+void SYS_CONSOLE_Tasks(SYS_MODULE_OBJ object) {};
+
+// USB stack is polled by the spinning main loop, time would stand still without it
+void USB_DEVICE_Tasks(SYS_MODULE_OBJ object) {
+    SIM_BusyWait(SIM_TIME_NEVER);
+};
+
+void DRV_USBFSV1_Tasks(SYS_MODULE_OBJ object) {};
+
+void EIC_CallbackRegister(EIC_PIN pin, EIC_CALLBACK callback, uintptr_t context) {
+    if (pin >= EIC_PIN_MAX) return;
+
+    eicCallbacks[pin].callback = callback;
+    eicCallbacks[pin].context = context;
+};
+
+bool RTC_RTCCTimeSet(struct tm *initialTime) {
+    struct tm time = *initialTime;
+    const time_t calendar = timegm(&time);
+
+    if ((time_t) -1 == calendar) return false;
+
+    rtcOffset = (int64_t) calendar - (int64_t) (SIM_GetTime() / SIM_US_IN_S);
+
+    return true;
+};
+
+void RTC_RTCCTimeGet(struct tm *currentTime) {
+    const time_t calendar = (time_t) (rtcOffset + (int64_t) (SIM_GetTime() / SIM_US_IN_S));
+
+    gmtime_r(&calendar, currentTime);
+};
+
+bool USB_VBUS_SENSE_Get(void) {
+    return isVBUSPowered;
+};
+
+void SIM_PLIB_Initialize(void) {
+    memset(&simSCB, 0, sizeof(simSCB));
+    memset(&simPM, 0, sizeof(simPM));
+    memset(eicCallbacks, 0, sizeof(eicCallbacks));
+    // BOD33 synchronization is instant
+    simSYSCTRL = (sysctrl_registers_t) {.SYSCTRL_PCLKSR = SYSCTRL_PCLKSR_B33SRDY_Msk | SYSCTRL_PCLKSR_BOD33RDY_Msk};
+    isVBUSPowered = false;
+    rtcOffset = SIM_RTC_DEFAULT_EPOCH;
+};
+
+void SIM_EIC_Trigger(EIC_PIN pin) {
+    if ((pin >= EIC_PIN_MAX) || (NULL == eicCallbacks[pin].callback)) return;
+
+    SIM_RaiseInterrupt();
+    eicCallbacks[pin].callback(eicCallbacks[pin].context);
+};
+
+void SIM_PLIB_SetVBUS(bool isPowered) {
+    if (isPowered == isVBUSPowered) return;
+
+    isVBUSPowered = isPowered;
+    SIM_EIC_Trigger(EIC_PIN_15);
+};
+
+void SIM_RTC_SetEpoch(uint32_t epoch) {
+    rtcOffset = (int64_t) epoch - (int64_t) (SIM_GetTime() / SIM_US_IN_S);
+};
@@ -0,0 +1,108 @@
+#include <string.h>
+
+#include "definitions.h"
+#include "./sim.h"
+#include "./sim_drivers.h"
+#include "./sim_sht3x.h"
+
+#define SIM_SHT3X_CMD_SIZE                  (2)
+#define SIM_SHT3X_WORD_SIZE                 (3) // 2 data bytes and CRC
+#define SIM_SHT3X_CMD_READ_STATUS           (0xF32D)
+#define SIM_SHT3X_CMD_MEASURE_LPM           (0x2416) // single shot, low repeatability, no clock stretching
+#define SIM_SHT3X_CMD_MEASURE_MPM           (0x240B)
+#define SIM_SHT3X_CMD_MEASURE_HPM           (0x2400)
+#define SIM_SHT3X_STATUS_DFLT               (0x8010) // alert pending, reset detected, as after power up
+
+static struct {
+    uint16_t temperature;
+    uint16_t humidity;
+    uint16_t lastTemperature;
+    uint16_t lastHumidity;
+    bool isMeasuring;
+    TSimTime readyAt;
+    uint32_t measurements;
+} sensor;
+
+static void _putWord(uint8_t *read, uint16_t word) {
+    read[0] = (uint8_t) (word >> 8);
+    read[1] = (uint8_t) (word & 0xFF);
+    read[2] = SIM_SHT3X_CRC(read, 2);
+};
+
+static bool _onTransfer(const uint8_t *write, size_t writeSize, uint8_t *read, size_t readSize) {
+    if (0 != writeSize) {
+        if (SIM_SHT3X_CMD_SIZE != writeSize) return false;
+
+        const uint16_t cmd = (uint16_t) ((write[0] << 8) | write[1]);
+
+        switch (cmd) {
+            case SIM_SHT3X_CMD_READ_STATUS:
+                if (readSize != SIM_SHT3X_WORD_SIZE - 1 && readSize != SIM_SHT3X_WORD_SIZE) return false;
+                read[0] = (uint8_t) (SIM_SHT3X_STATUS_DFLT >> 8);
+                read[1] = (uint8_t) (SIM_SHT3X_STATUS_DFLT & 0xFF);
+                if (SIM_SHT3X_WORD_SIZE == readSize) read[2] = SIM_SHT3X_CRC(read, 2);
+                return true;
+            case SIM_SHT3X_CMD_MEASURE_LPM:
+            case SIM_SHT3X_CMD_MEASURE_MPM:
+            case SIM_SHT3X_CMD_MEASURE_HPM:
+                sensor.isMeasuring = true;
+                sensor.readyAt = SIM_GetTime() + SIM_SHT3X_MEASURE_TIME_US;
+                return 0 == readSize;
+            default:
+                return false;
+        }
+    }
+
+    // result read, sensor NACKs its address till measurement is done
+    if (!sensor.isMeasuring || (SIM_GetTime() < sensor.readyAt) || (readSize > 2 * SIM_SHT3X_WORD_SIZE)) return false;
+
+    uint8_t words[2 * SIM_SHT3X_WORD_SIZE];
+
+    _putWord(words, sensor.temperature);
+    _putWord(words + SIM_SHT3X_WORD_SIZE, sensor.humidity);
+    memcpy(read, words, readSize);
+
+    sensor.isMeasuring = false;
+    sensor.lastTemperature = sensor.temperature;
+    sensor.lastHumidity = sensor.humidity;
+    sensor.measurements++;
+
+    return true;
+};
+
+void SIM_SHT3X_Initialize(void) {
+    sensor = (typeof(sensor)) {0};
+    SIM_SHT3X_Set(22.5f, 45.0f);
+    SIM_I2C_AttachDevice(SIM_SHT3X_I2C_ADDR, _onTransfer);
+};
+
+void SIM_SHT3X_SetRaw(uint16_t temperature, uint16_t humidity) {
+    sensor.temperature = temperature;
+    sensor.humidity = humidity;
+};
+
+// T = -45 + 175 * raw / 65535, RH = 100 * raw / 65535
+void SIM_SHT3X_Set(float temperatureC, float humidityRH) {
+    SIM_SHT3X_SetRaw((uint16_t) ((temperatureC + 45.0f) * 65535.0f / 175.0f + 0.5f),
+                     (uint16_t) (humidityRH * 65535.0f / 100.0f + 0.5f));
+};
+
+uint32_t SIM_SHT3X_GetMeasurements(void) {
+    return sensor.measurements;
+};
+
+void SIM_SHT3X_GetLastRaw(uint16_t *temperature, uint16_t *humidity) {
+    *temperature = sensor.lastTemperature;
+    *humidity = sensor.lastHumidity;
+};
+
+uint8_t SIM_SHT3X_CRC(const uint8_t *data, uint8_t size) {
+    uint8_t crc = 0xFF;
+
+    for (uint8_t i = 0; i < size; i++) {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; bit++) crc = (crc & 0x80) ? (uint8_t) ((crc << 1) ^ 0x31) : (uint8_t) (crc << 1);
+    }
+
+    return crc;
+};
@@ -0,0 +1,45 @@
+/**
+ * @file sim_sht3x.h
+ * @brief SHT3x temperature & humidity sensor model on the simulated I2C bus
+ *
+ * @details Single shot measurement (clock stretching disabled): result is read by separate transfer once
+ * measurement time is elapsed, reads before it are NACKed as by the sensor. Status register read is supported.
+ * Values are raw sensor words with CRC-8, set by the bench.
+ */
+
+#ifndef SIM_SHT3X_H
+#define SIM_SHT3X_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef    __cplusplus
+extern "C" {
+#endif
+
+#define SIM_SHT3X_I2C_ADDR                  (0x44)
+#define SIM_SHT3X_MEASURE_TIME_US           (4500) // low repeatability, max
+
+/** @brief Attach sensor to I2C bus, measurements counter is dropped */
+void SIM_SHT3X_Initialize(void);
+
+/** @brief Set raw words returned by the next measurements */
+void SIM_SHT3X_SetRaw(uint16_t temperature, uint16_t humidity);
+
+/** @brief Set the measurement in physical units, converted to raw words by datasheet formulas */
+void SIM_SHT3X_Set(float temperatureC, float humidityRH);
+
+/** @return count of measurements read out by firmware */
+uint32_t SIM_SHT3X_GetMeasurements(void);
+
+/** @brief Raw words of the last measurement read out */
+void SIM_SHT3X_GetLastRaw(uint16_t *temperature, uint16_t *humidity);
+
+/** @return CRC-8 of SHT3x data word, polynomial 0x31, init 0xFF */
+uint8_t SIM_SHT3X_CRC(const uint8_t *data, uint8_t size);
+
+#ifdef    __cplusplus
+}
+#endif
+
+#endif //SIM_SHT3X_H
@@ -0,0 +1,295 @@
+#include <string.h>
+
+#include "definitions.h"
+#include "./sim.h"
+#include "./sim_drivers.h"
+#include "./sim_st25dv.h"
+
+#define SIM_ST25DV_CMD_SIZE                 (2)
+#define SIM_ST25DV_STATIC_SIZE              (0x10) // GPO..LOCK_CFG
+#define SIM_ST25DV_GPO_REG                  (0x0000)
+#define SIM_ST25DV_MB_MODE_REG              (0x000D)
+#define SIM_ST25DV_UID_REG                  (0x0018)
+#define SIM_ST25DV_UID_SIZE                 (8)
+#define SIM_ST25DV_I2C_PWD_REG              (0x0900)
+#define SIM_ST25DV_PWD_SIZE                 (8)
+#define SIM_ST25DV_PWD_PRESENT              (0x09)
+#define SIM_ST25DV_DYN_REG                  (0x2000) // GPO_CTRL_Dyn
+#define SIM_ST25DV_EH_CTRL_DYN_REG          (0x2002)
+#define SIM_ST25DV_RF_MNGT_DYN_REG          (0x2003)
+#define SIM_ST25DV_I2C_SSO_DYN_REG          (0x2004)
+#define SIM_ST25DV_IT_STS_DYN_REG           (0x2005)
+#define SIM_ST25DV_MB_CTRL_DYN_REG          (0x2006)
+#define SIM_ST25DV_MB_LEN_DYN_REG           (0x2007)
+#define SIM_ST25DV_MAILBOX_REG              (0x2008)
+
+/* GPO static register */
+#define SIM_ST25DV_GPO_FIELD_CHANGE         (0x08)
+#define SIM_ST25DV_GPO_RF_PUT_MSG           (0x10)
+#define SIM_ST25DV_GPO_RF_GET_MSG           (0x20)
+#define SIM_ST25DV_GPO_ENABLE               (0x80)
+
+/* IT_STS_Dyn */
+#define SIM_ST25DV_IT_FIELD_FALLING         (0x08)
+#define SIM_ST25DV_IT_FIELD_RISING          (0x10)
+#define SIM_ST25DV_IT_RF_PUT_MSG            (0x20)
+#define SIM_ST25DV_IT_RF_GET_MSG            (0x40)
+
+/* MB_CTRL_Dyn */
+#define SIM_ST25DV_MB_EN                    (0x01)
+#define SIM_ST25DV_MB_HOST_PUT_MSG          (0x02)
+#define SIM_ST25DV_MB_RF_PUT_MSG            (0x04)
+
+static const uint8_t factoryConfig[SIM_ST25DV_STATIC_SIZE] = {
+        0x88, 0x01, 0x00, 0x00, 0x03, 0x0F, 0x03, 0x0F, 0x03, 0x0F, 0x03, 0x00, 0x00, 0x00, 0x07, 0x00
+};
+static const uint8_t uid[SIM_ST25DV_UID_SIZE] = {0xE0, 0x02, 0x24, 0x00, 0x12, 0x34, 0x56, 0x78};
+
+/* EEPROM, kept over power cycles */
+static uint8_t eeprom[SIM_ST25DV_EEPROM_SIZE];
+static uint8_t config[SIM_ST25DV_STATIC_SIZE];
+static uint8_t password[SIM_ST25DV_PWD_SIZE];
+static bool isManufactured = false;
+
+/* dynamic state */
+static struct {
+    bool isSessionOpen;
+    bool isFieldPresent;
+    uint8_t itSts;
+    uint8_t mbCtrl;
+    uint8_t mbLen;
+    uint8_t mailbox[SIM_ST25DV_MAILBOX_SIZE];
+    TSimTime busyUntil; /**< EEPROM programming end */
+} tag;
+static TSimST25DVStats stats;
+
+// latch interrupt and pulse GPO if the event is routed to it
+static void _interrupt(uint8_t itStatus, uint8_t gpoMask) {
+    if (!(config[SIM_ST25DV_GPO_REG] & SIM_ST25DV_GPO_ENABLE) || !(config[SIM_ST25DV_GPO_REG] & gpoMask)) return;
+
+    tag.itSts |= itStatus;
+    stats.gpoPulses++;
+    SIM_EIC_Trigger(EIC_PIN_3);
+};
+
+// programming time of all 16-byte pages written
+static void _program(uint16_t address, size_t size) {
+    const uint32_t pages = (uint32_t) ((address + size - 1) / SIM_ST25DV_PAGE_SIZE - address / SIM_ST25DV_PAGE_SIZE + 1);
+
+    tag.busyUntil = SIM_GetTime() + (TSimTime) pages * SIM_ST25DV_PAGE_WRITE_TIME_US;
+    stats.eepromWrites++;
+    stats.eepromBytesWritten += (uint32_t) size;
+    stats.eepromPagesProgrammed += pages;
+};
+
+static inline bool _isBusy(void) {
+    if (SIM_GetTime() >= tag.busyUntil) return false;
+
+    stats.busyNacks++;
+
+    return true;
+};
+
+static uint8_t _readSystem(uint16_t address) {
+    if (address < SIM_ST25DV_STATIC_SIZE) return config[address];
+    if ((address >= SIM_ST25DV_UID_REG) && (address < SIM_ST25DV_UID_REG + SIM_ST25DV_UID_SIZE))
+        return uid[address - SIM_ST25DV_UID_REG];
+
+    return 0x00;
+};
+
+// I2C password is presented as password, validation code, password
+static bool _presentPassword(const uint8_t *data, size_t size) {
+    tag.isSessionOpen = (2 * SIM_ST25DV_PWD_SIZE + 1 == size) && (SIM_ST25DV_PWD_PRESENT == data[SIM_ST25DV_PWD_SIZE]) &&
+                        !memcmp(data, password, SIM_ST25DV_PWD_SIZE) &&
+                        !memcmp(data + SIM_ST25DV_PWD_SIZE + 1, password, SIM_ST25DV_PWD_SIZE);
+
+    return true;
+};
+
+static bool _onSystemTransfer(const uint8_t *write, size_t writeSize, uint8_t *read, size_t readSize) {
+    if (_isBusy() || (writeSize < SIM_ST25DV_CMD_SIZE)) return false;
+
+    const uint16_t address = (uint16_t) ((write[0] << 8) | write[1]);
+    const uint8_t *data = write + SIM_ST25DV_CMD_SIZE;
+    const size_t size = writeSize - SIM_ST25DV_CMD_SIZE;
+
+    if (0 == size) {
+        for (size_t i = 0; i < readSize; i++) read[i] = _readSystem((uint16_t) (address + i));
+        return true;
+    }
+
+    if (SIM_ST25DV_I2C_PWD_REG == address) return _presentPassword(data, size);
+
+    // static registers are protected by I2C password
+    if (!tag.isSessionOpen || (address + size > SIM_ST25DV_STATIC_SIZE)) return false;
+
+    memcpy(&config[address], data, size);
+    _program(address, size);
+
+    return true;
+};
+
+static uint8_t _readData(uint16_t address) {
+    if (address < SIM_ST25DV_EEPROM_SIZE) return eeprom[address];
+
+    switch (address) {
+        case SIM_ST25DV_I2C_SSO_DYN_REG:
+            return tag.isSessionOpen ? 0x01 : 0x00;
+        case SIM_ST25DV_IT_STS_DYN_REG:
+            return tag.itSts;
+        case SIM_ST25DV_MB_CTRL_DYN_REG:
+            return tag.mbCtrl;
+        case SIM_ST25DV_MB_LEN_DYN_REG:
+            return tag.mbLen;
+        default:
+            break;
+    }
+
+    if ((address >= SIM_ST25DV_MAILBOX_REG) && (address < SIM_ST25DV_MAILBOX_REG + SIM_ST25DV_MAILBOX_SIZE))
+        return tag.mailbox[address - SIM_ST25DV_MAILBOX_REG];
+
+    return 0x00;
+};
+
+static void _readDataRange(uint16_t address, uint8_t *read, size_t size) {
+    const uint32_t end = (uint32_t) address + size;
+
+    for (size_t i = 0; i < size; i++) read[i] = _readData((uint16_t) (address + i));
+
+    // IT_STS_Dyn is cleared on read
+    if ((address <= SIM_ST25DV_IT_STS_DYN_REG) && (end > SIM_ST25DV_IT_STS_DYN_REG)) tag.itSts = 0x00;
+
+    if ((end <= SIM_ST25DV_MAILBOX_REG) || (address >= SIM_ST25DV_MAILBOX_REG + SIM_ST25DV_MAILBOX_SIZE)) return;
+
+    stats.mailboxBytesRead += (uint32_t) size;
+
+    // RF message is released once its last byte is read
+    if ((tag.mbCtrl & SIM_ST25DV_MB_RF_PUT_MSG) && (end > (uint32_t) SIM_ST25DV_MAILBOX_REG + tag.mbLen))
+        tag.mbCtrl &= (uint8_t) ~SIM_ST25DV_MB_RF_PUT_MSG;
+};
+
+static bool _writeMailbox(uint16_t address, const uint8_t *data, size_t size) {
+    const bool isBusy = tag.mbCtrl & (SIM_ST25DV_MB_HOST_PUT_MSG | SIM_ST25DV_MB_RF_PUT_MSG);
+
+    if (!(tag.mbCtrl & SIM_ST25DV_MB_EN) || isBusy || (SIM_ST25DV_MAILBOX_REG != address) ||
+        (size > SIM_ST25DV_MAILBOX_SIZE))
+        return false;
+
+    memcpy(tag.mailbox, data, size);
+    tag.mbLen = (uint8_t) (size - 1);
+    tag.mbCtrl |= SIM_ST25DV_MB_HOST_PUT_MSG;
+    stats.mailboxBytesWritten += (uint32_t) size;
+
+    return true;
+};
+
+static bool _writeDynamic(uint16_t address, const uint8_t *data, size_t size) {
+    if (1 != size) return false;
+
+    switch (address) {
+        case SIM_ST25DV_MB_CTRL_DYN_REG:
+            // mailbox is enabled only if MB_MODE allows it, disabling drops its content
+            if (!(config[SIM_ST25DV_MB_MODE_REG] & 0x01)) return false;
+            tag.mbCtrl = (data[0] & SIM_ST25DV_MB_EN) ? (tag.mbCtrl | SIM_ST25DV_MB_EN) : 0x00;
+            return true;
+        case SIM_ST25DV_DYN_REG:
+        case SIM_ST25DV_EH_CTRL_DYN_REG:
+        case SIM_ST25DV_RF_MNGT_DYN_REG:
+            return true;
+        default:
+            return false;
+    }
+};
+
+static bool _onDataTransfer(const uint8_t *write, size_t writeSize, uint8_t *read, size_t readSize) {
+    if (_isBusy() || (writeSize < SIM_ST25DV_CMD_SIZE)) return false;
+
+    const uint16_t address = (uint16_t) ((write[0] << 8) | write[1]);
+    const uint8_t *data = write + SIM_ST25DV_CMD_SIZE;
+    const size_t size = writeSize - SIM_ST25DV_CMD_SIZE;
+
+    if (0 == size) {
+        _readDataRange(address, read, readSize);
+        return true;
+    }
+
+    if (address >= SIM_ST25DV_MAILBOX_REG) return _writeMailbox(address, data, size);
+    if (address >= SIM_ST25DV_DYN_REG) return _writeDynamic(address, data, size);
+    if (address + size > SIM_ST25DV_EEPROM_SIZE) return false;
+
+    memcpy(&eeprom[address], data, size);
+    _program(address, size);
+
+    return true;
+};
+
+void SIM_ST25DV_Initialize(void) {
+    if (!isManufactured) SIM_ST25DV_Reset();
+
+    memset(&tag, 0, sizeof(tag));
+    memset(&stats, 0, sizeof(stats));
+    SIM_I2C_AttachDevice(SIM_ST25DV_I2C_ADDR_DATA, _onDataTransfer);
+    SIM_I2C_AttachDevice(SIM_ST25DV_I2C_ADDR_SYST, _onSystemTransfer);
+};
+
+void SIM_ST25DV_Reset(void) {
+    memset(eeprom, 0, sizeof(eeprom));
+    memcpy(config, factoryConfig, sizeof(config));
+    memset(password, 0, sizeof(password));
+    isManufactured = true;
+};
+
+void SIM_ST25DV_SetConfig(uint16_t address, uint8_t value) {
+    if (address < SIM_ST25DV_STATIC_SIZE) config[address] = value;
+};
+
+void SIM_ST25DV_SetField(bool isPresent) {
+    if (isPresent == tag.isFieldPresent) return;
+
+    tag.isFieldPresent = isPresent;
+    _interrupt(isPresent ? SIM_ST25DV_IT_FIELD_RISING : SIM_ST25DV_IT_FIELD_FALLING, SIM_ST25DV_GPO_FIELD_CHANGE);
+};
+
+bool SIM_ST25DV_PutMessage(const uint8_t *message, size_t size) {
+    const bool isBusy = tag.mbCtrl & (SIM_ST25DV_MB_HOST_PUT_MSG | SIM_ST25DV_MB_RF_PUT_MSG);
+
+    if (!tag.isFieldPresent || !(tag.mbCtrl & SIM_ST25DV_MB_EN) || isBusy || (0 == size) ||
+        (size > SIM_ST25DV_MAILBOX_SIZE))
+        return false;
+
+    memcpy(tag.mailbox, message, size);
+    tag.mbLen = (uint8_t) (size - 1);
+    tag.mbCtrl |= SIM_ST25DV_MB_RF_PUT_MSG;
+    stats.rfMessagesPut++;
+    _interrupt(SIM_ST25DV_IT_RF_PUT_MSG, SIM_ST25DV_GPO_RF_PUT_MSG);
+
+    return true;
+};
+
+size_t SIM_ST25DV_GetMessage(uint8_t *message) {
+    const size_t size = SIM_ST25DV_GetMessageSize();
+
+    if (0 == size) return 0;
+
+    memcpy(message, tag.mailbox, size);
+    tag.mbCtrl &= (uint8_t) ~SIM_ST25DV_MB_HOST_PUT_MSG;
+    stats.rfMessagesGot++;
+    _interrupt(SIM_ST25DV_IT_RF_GET_MSG, SIM_ST25DV_GPO_RF_GET_MSG);
+
+    return size;
+};
+
+size_t SIM_ST25DV_GetMessageSize(void) {
+    if (!tag.isFieldPresent || !(tag.mbCtrl & SIM_ST25DV_MB_HOST_PUT_MSG)) return 0;
+
+    return (size_t) tag.mbLen + 1;
+};
+
+const uint8_t *SIM_ST25DV_GetEEPROM(void) {
+    return eeprom;
+};
+
+const TSimST25DVStats *SIM_ST25DV_GetStats(void) {
+    return &stats;
+};
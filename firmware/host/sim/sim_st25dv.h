@@ -0,0 +1,85 @@
+/**
+ * @file sim_st25dv.h
+ * @brief ST25DV dynamic NFC tag model on the simulated I2C bus
+ *
+ * @details User EEPROM, system configuration (GPO..MB_MODE, UID, I2C password), dynamic registers and mailbox RAM,
+ * each at the I2C addresses and 2-byte register addresses of the datasheet. EEPROM (user and system) is programmed
+ * per 16-byte page after the write transfer, the tag NACKs meanwhile. Static registers are written only in open
+ * I2C security session. RF events set IT_STS_Dyn bits and pulse GPO if enabled by the GPO register.
+ *
+ * Phone side of the Fast Transfer mailbox is a pair of calls at the end of RF commands, the caller keeps RF time
+ * by SIM_ST25DV_RF_... timings: ISO 15693 high data rate both ways, request frame and turnaround per command.
+ */
+
+#ifndef SIM_ST25DV_H
+#define SIM_ST25DV_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef    __cplusplus
+extern "C" {
+#endif
+
+#define SIM_ST25DV_I2C_ADDR_DATA            (0x53)
+#define SIM_ST25DV_I2C_ADDR_SYST            (0x57)
+#define SIM_ST25DV_EEPROM_SIZE              (512) // ST25DV04K
+#define SIM_ST25DV_MAILBOX_SIZE             (256)
+#define SIM_ST25DV_PAGE_SIZE                (16) // EEPROM programmed at once
+#define SIM_ST25DV_PAGE_WRITE_TIME_US       (5000)
+#define SIM_ST25DV_RF_BYTE_TIME_US          (302) // 8 bits at 26.48 kbps
+#define SIM_ST25DV_RF_COMMAND_TIME_US       (1500) // request frame with flags, command and UID, turnaround, SOF/EOF/CRC
+#define SIM_ST25DV_RF_TIME_US(bytes)        (SIM_ST25DV_RF_COMMAND_TIME_US + (bytes) * SIM_ST25DV_RF_BYTE_TIME_US)
+
+/** @brief Tag counters */
+typedef struct {
+    uint32_t eepromWrites; /**< write transfers to EEPROM, user and system */
+    uint32_t eepromBytesWritten;
+    uint32_t eepromPagesProgrammed;
+    uint32_t busyNacks; /**< transfers NACKed while EEPROM is programmed */
+    uint32_t gpoPulses;
+    uint32_t mailboxBytesWritten; /**< by I2C host */
+    uint32_t mailboxBytesRead; /**< by I2C host */
+    uint32_t rfMessagesPut;
+    uint32_t rfMessagesGot;
+} TSimST25DVStats;
+
+/** @brief Power up the tag: dynamic registers and mailbox cleared, EEPROM and configuration are kept (factory ones at first) */
+void SIM_ST25DV_Initialize(void);
+
+/** @brief Erase user EEPROM to 0x00 and restore factory configuration */
+void SIM_ST25DV_Reset(void);
+
+/** @brief Program static configuration register as by production tool, address GPO..LOCK_CFG */
+void SIM_ST25DV_SetConfig(uint16_t address, uint8_t value);
+
+/** @brief Phone enters or leaves the field */
+void SIM_ST25DV_SetField(bool isPresent);
+
+/**
+ * @brief Phone writes message to mailbox (Write Message), RF_PUT_MSG interrupt is raised
+ * @return false if phone is not in field, mailbox is disabled or holds a message not read yet
+ */
+bool SIM_ST25DV_PutMessage(const uint8_t *message, size_t size);
+
+/**
+ * @brief Phone reads message put by host (Read Message), RF_GET_MSG interrupt is raised
+ * @param[out] message SIM_ST25DV_MAILBOX_SIZE bytes
+ * @return message size, 0 if there is no host message
+ */
+size_t SIM_ST25DV_GetMessage(uint8_t *message);
+
+/** @return size of message put by host, 0 if none, as phone polls MB_CTRL_Dyn and MB_LEN_Dyn */
+size_t SIM_ST25DV_GetMessageSize(void);
+
+/** @return user EEPROM, SIM_ST25DV_EEPROM_SIZE bytes */
+const uint8_t *SIM_ST25DV_GetEEPROM(void);
+
+const TSimST25DVStats *SIM_ST25DV_GetStats(void);
+
+#ifdef    __cplusplus
+}
+#endif
+
+#endif //SIM_ST25DV_H
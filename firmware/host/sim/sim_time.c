@@ -0,0 +1,186 @@
+/**
+ * @brief SYS_TIME over virtual clock
+ * @details Counter runs at the TC3 frequency of the target, so firmware sees the same tick granularity. Each started
+ * timer is a simulation event at its deadline, callback runs in ISR context.
+ */
+
+#include "definitions.h"
+#include "./sim.h"
+
+#define SIM_TIME_AUTO_DESTROY               (true)
+
+typedef struct {
+    bool isUsed;
+    bool isActive;
+    bool isAutoDestroyed; /**< single shot callback registered by ms, freed once fired */
+    uint32_t pending; /**< counts from start to the first expiry */
+    uint32_t period;
+    uint64_t deadline; /**< counter value */
+    SYS_TIME_CALLBACK callback;
+    uintptr_t context;
+    SYS_TIME_CALLBACK_TYPE type;
+    TSimEventId event;
+} TSimTimer;
+
+static TSimTimer simTimers[SYS_TIME_MAX_TIMERS];
+
+static void _onDeadline(uintptr_t context);
+
+static inline TSimTime _countToTime(uint64_t count) {
+    return (count * SIM_US_IN_S + SYS_TIME_HW_COUNTER_FREQUENCY - 1) / SYS_TIME_HW_COUNTER_FREQUENCY;
+};
+
+static inline TSimTimer *_getTimer(SYS_TIME_HANDLE handle) {
+    if ((handle >= SYS_TIME_MAX_TIMERS) || !simTimers[handle].isUsed) return NULL;
+
+    return &simTimers[handle];
+};
+
+static void _schedule(TSimTimer *const timer, uint64_t deadline) {
+    SIM_Cancel(timer->event);
+    timer->deadline = deadline;
+    timer->isActive = true;
+    timer->event = SIM_Schedule(_countToTime(deadline), _onDeadline, (uintptr_t) timer);
+};
+
+static void _onDeadline(uintptr_t context) {
+    TSimTimer *const timer = (TSimTimer *) context;
+    const SYS_TIME_CALLBACK callback = timer->callback;
+    const uintptr_t callbackContext = timer->context;
+
+    timer->event = SIM_NO_EVENT;
+
+    if (SYS_TIME_PERIODIC == timer->type) {
+        _schedule(timer, timer->deadline + timer->period);
+    } else {
+        timer->isActive = false;
+        if (timer->isAutoDestroyed) timer->isUsed = false;
+    }
+
+    if (NULL == callback) return;
+
+    SIM_RaiseInterrupt();
+    callback(callbackContext);
+};
+
+static SYS_TIME_HANDLE _create(uint32_t count, uint32_t period, SYS_TIME_CALLBACK callBack, uintptr_t context,
+                               SYS_TIME_CALLBACK_TYPE type, bool isAutoDestroyed) {
+    if ((0 == period) || (period < count) || ((SYS_TIME_SINGLE == type) && (NULL == callBack)))
+        return SYS_TIME_HANDLE_INVALID;
+
+    for (SYS_TIME_HANDLE handle = 0; handle < SYS_TIME_MAX_TIMERS; handle++) {
+        if (simTimers[handle].isUsed) continue;
+
+        simTimers[handle] = (TSimTimer) {
+                .isUsed = true,
+                .isAutoDestroyed = isAutoDestroyed,
+                .pending = period - count,
+                .period = period,
+                .callback = callBack,
+                .context = context,
+                .type = type,
+                .event = SIM_NO_EVENT
+        };
+
+        return handle;
+    }
+
+    return SYS_TIME_HANDLE_INVALID;
+};
+
+uint32_t SYS_TIME_FrequencyGet(void) {
+    return SYS_TIME_HW_COUNTER_FREQUENCY;
+};
+
+uint64_t SYS_TIME_Counter64Get(void) {
+    return (SIM_GetTime() * SYS_TIME_HW_COUNTER_FREQUENCY) / SIM_US_IN_S;
+};
+
+uint32_t SYS_TIME_CounterGet(void) {
+    return (uint32_t) SYS_TIME_Counter64Get();
+};
+
+uint32_t SYS_TIME_CountToUS(uint32_t count) {
+    return (uint32_t) (((uint64_t) count * SIM_US_IN_S) / SYS_TIME_HW_COUNTER_FREQUENCY);
+};
+
+uint32_t SYS_TIME_CountToMS(uint32_t count) {
+    return (uint32_t) (((uint64_t) count * SIM_US_IN_MS) / SYS_TIME_HW_COUNTER_FREQUENCY);
+};
+
+uint32_t SYS_TIME_MSToCount(uint32_t ms) {
+    return (uint32_t) (((uint64_t) ms * SYS_TIME_HW_COUNTER_FREQUENCY + SIM_US_IN_MS - 1) / SIM_US_IN_MS);
+};
+
+SYS_TIME_HANDLE SYS_TIME_TimerCreate(uint32_t count, uint32_t period, SYS_TIME_CALLBACK callBack, uintptr_t context,
+                                     SYS_TIME_CALLBACK_TYPE type) {
+    return _create(count, period, callBack, context, type, !SIM_TIME_AUTO_DESTROY);
+};
+
+// reloaded timer is started, as by Harmony
+SYS_TIME_RESULT SYS_TIME_TimerReload(SYS_TIME_HANDLE handle, uint32_t count, uint32_t period,
+                                     SYS_TIME_CALLBACK callBack, uintptr_t context, SYS_TIME_CALLBACK_TYPE type) {
+    TSimTimer *const timer = _getTimer(handle);
+
+    if ((NULL == timer) || (0 == period) || (period < count) || ((SYS_TIME_SINGLE == type) && (NULL == callBack)))
+        return SYS_TIME_ERROR;
+
+    timer->pending = period - count;
+    timer->period = period;
+    timer->callback = callBack;
+    timer->context = context;
+    timer->type = type;
+    _schedule(timer, SYS_TIME_Counter64Get() + timer->pending);
+
+    return SYS_TIME_SUCCESS;
+};
+
+SYS_TIME_RESULT SYS_TIME_TimerStart(SYS_TIME_HANDLE handle) {
+    TSimTimer *const timer = _getTimer(handle);
+
+    if (NULL == timer) return SYS_TIME_ERROR;
+
+    _schedule(timer, SYS_TIME_Counter64Get() + timer->pending);
+
+    return SYS_TIME_SUCCESS;
+};
+
+SYS_TIME_RESULT SYS_TIME_TimerStop(SYS_TIME_HANDLE handle) {
+    TSimTimer *const timer = _getTimer(handle);
+
+    if (NULL == timer) return SYS_TIME_ERROR;
+
+    SIM_Cancel(timer->event);
+    timer->event = SIM_NO_EVENT;
+    timer->isActive = false;
+
+    return SYS_TIME_SUCCESS;
+};
+
+SYS_TIME_RESULT SYS_TIME_TimerDestroy(SYS_TIME_HANDLE handle) {
+    if (SYS_TIME_SUCCESS != SYS_TIME_TimerStop(handle)) return SYS_TIME_ERROR;
+
+    simTimers[handle].isUsed = false;
+
+    return SYS_TIME_SUCCESS;
+};
+
+SYS_TIME_HANDLE SYS_TIME_CallbackRegisterMS(SYS_TIME_CALLBACK callback, uintptr_t context, uint32_t ms,
+                                            SYS_TIME_CALLBACK_TYPE type) {
+    if (0 == ms) return SYS_TIME_HANDLE_INVALID;
+
+    const SYS_TIME_HANDLE handle = _create(0, SYS_TIME_MSToCount(ms), callback, context, type,
+                                           (SYS_TIME_SINGLE == type) ? SIM_TIME_AUTO_DESTROY : !SIM_TIME_AUTO_DESTROY);
+
+    if (SYS_TIME_HANDLE_INVALID != handle) SYS_TIME_TimerStart(handle);
+
+    return handle;
+};
+
+/** @brief Drop all timers, for a fresh simulation run */
+void SIM_TIME_Initialize(void) {
+    for (SYS_TIME_HANDLE handle = 0; handle < SYS_TIME_MAX_TIMERS; handle++) {
+        SIM_Cancel(simTimers[handle].event);
+        simTimers[handle] = (TSimTimer) {.isUsed = false, .event = SIM_NO_EVENT};
+    }
+};
@@ -0,0 +1,24 @@
+/**
+ * @file active_object.h
+ * @brief Event type of active-object-fsm for host tests of modules which only carry events
+ *
+ * @details Linked in place of the submodule when it is not found, actors are not built then. Fields are the ones
+ * firmware sets on events: signal, payload pointer and its size. Actor is opaque, events are dispatched to it by
+ * pointer only.
+ */
+
+#ifndef ACTIVE_OBJECT_H
+#define ACTIVE_OBJECT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef struct {
+    int sig;
+    void *payload;
+    size_t size;
+} TEvent;
+
+typedef struct TActiveObject TActiveObject;
+
+#endif //ACTIVE_OBJECT_H
@@ -0,0 +1,32 @@
+/**
+ * @file test.h
+ * @brief Assertions of host tests
+ *
+ * @details Failed assertion reports its location and exits with failure, so each test is a plain executable run by
+ * ctest. Measurements are printed to stdout, ctest shows them with --verbose.
+ */
+
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define TEST_ASSERT(condition) do {                                                                 \
+    if (!(condition)) {                                                                             \
+        fprintf(stderr, "%s:%d: assertion failed: %s\n", __FILE__, __LINE__, #condition);          \
+        exit(EXIT_FAILURE);                                                                         \
+    }                                                                                               \
+} while (0)
+
+#define TEST_ASSERT_EQUAL(expected, actual) do {                                                    \
+    const long long _expected = (long long) (expected);                                             \
+    const long long _actual = (long long) (actual);                                                 \
+    if (_expected != _actual) {                                                                     \
+        fprintf(stderr, "%s:%d: %s expected %lld, got %lld\n", __FILE__, __LINE__, #actual,         \
+                _expected, _actual);                                                                \
+        exit(EXIT_FAILURE);                                                                         \
+    }                                                                                               \
+} while (0)
+
+#endif //TEST_H
@@ -0,0 +1,204 @@
+/**
+ * @brief Actor event queue under ISRs preempting main loop: no event lost or duplicated, order kept per producer
+ * @details Threads play ISRs pushing numbered events at full rate into a small queue, main thread plays the actor:
+ * it pops lock free and pushes main loop events now and then. Simulated PRIMASK is a lock (see sim.h), so pushes
+ * are exclusive as on the target, while pop runs concurrently with them as an ISR would preempt it.
+ *
+ * Each event carries producer by signal, sequence number by payload and a check of both by size, so a torn slot
+ * copy is detected. Events received should be exactly those pushed successfully, in push order per producer, and
+ * overflows should count every push refused. ISRs either drop events on full queue or retry till pushed, main loop
+ * always drops: it cannot wait for itself to pop.
+ */
+
+#define _DEFAULT_SOURCE // clock_gettime
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "scheduler/event_queue.h"
+#include "./test.h"
+
+#define TEST_ISRS                           (3)
+#define TEST_MAIN_ID                        (TEST_ISRS) // main loop producer
+#define TEST_PRODUCERS                      (TEST_ISRS + 1)
+#define TEST_EVENTS_PER_ISR                 (200000)
+#define TEST_MAIN_PUSH_EVERY                (16) // pops per main loop push
+#define TEST_CAPACITY                       (8)
+#define TEST_BURST                          (TEST_CAPACITY + 2) // events per dropping ISR run
+#define TEST_CHECK(sig, sequence)           ((size_t) (sequence) * 2654435761u ^ (size_t) (sig))
+
+typedef struct {
+    uint32_t sequence; /**< of the next event */
+    uint32_t pushed; /**< events pushed successfully */
+    uint32_t refused; /**< pushes refused on full queue */
+    uint32_t received; /**< events popped */
+    uint32_t lastSequence; /**< of the last event popped */
+    uint8_t accepted[TEST_EVENTS_PER_ISR]; /**< by sequence, written by producer */
+    uint8_t popped[TEST_EVENTS_PER_ISR]; /**< by sequence, written by consumer */
+} TTestProducer;
+
+static struct {
+    TEventQueue queue;
+    TEvent events[TEST_CAPACITY];
+    uint32_t timestamps[TEST_CAPACITY];
+    TTestProducer producers[TEST_PRODUCERS];
+    bool isRetry; /**< ISRs retry refused pushes, no event is dropped */
+    uint32_t finished; /**< ISRs done, atomic */
+} stress;
+
+static uint32_t _nowUs(void) {
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (uint32_t) (time.tv_sec * 1000000 + time.tv_nsec / 1000);
+};
+
+static double _now(void) {
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double) time.tv_sec + time.tv_nsec / 1e9;
+};
+
+// pushes next event of producer, refused event is dropped unless it is retried
+static bool _push(uint32_t id, bool isRetry) {
+    TTestProducer *const producer = &stress.producers[id];
+    const uint32_t sequence = producer->sequence;
+    const TEvent event = {
+            .sig = (int) id,
+            .payload = (void *) (uintptr_t) sequence,
+            .size = TEST_CHECK(id, sequence)
+    };
+
+    if (!EVENT_QUEUE_Push(&stress.queue, event, _nowUs())) {
+        producer->refused++;
+        if (!isRetry) producer->sequence++;
+        return false;
+    }
+
+    producer->accepted[sequence] = 1;
+    producer->sequence++;
+    producer->pushed++;
+    return true;
+};
+
+static void *_isr(void *context) {
+    const uint32_t id = (uint32_t) (uintptr_t) context;
+
+    // dropping ISR returns after a burst of events, retrying one after a refused push, main loop gets CPU meanwhile
+    while (stress.producers[id].sequence < TEST_EVENTS_PER_ISR) {
+        const bool isPushed = _push(id, stress.isRetry);
+
+        if (stress.isRetry ? !isPushed : (0 == stress.producers[id].sequence % TEST_BURST)) sched_yield();
+    }
+    __atomic_add_fetch(&stress.finished, 1, __ATOMIC_RELEASE);
+
+    return NULL;
+};
+
+// actor side: sequence of each producer is received strictly in push order, at most once
+static void _receive(const TEvent *const event) {
+    TEST_ASSERT((event->sig >= 0) && (event->sig < TEST_PRODUCERS));
+
+    TTestProducer *const producer = &stress.producers[event->sig];
+    const uint32_t sequence = (uint32_t) (uintptr_t) event->payload;
+
+    TEST_ASSERT(sequence < TEST_EVENTS_PER_ISR);
+    TEST_ASSERT_EQUAL(TEST_CHECK(event->sig, sequence), event->size);
+    TEST_ASSERT_EQUAL(0, producer->popped[sequence]);
+    if (0 != producer->received) TEST_ASSERT(sequence > producer->lastSequence);
+
+    producer->popped[sequence] = 1;
+    producer->lastSequence = sequence;
+    producer->received++;
+};
+
+static void _testStress(const char *name, bool isRetry) {
+    pthread_t isrs[TEST_ISRS];
+    uint32_t pops = 0;
+    TEvent event;
+
+    memset(&stress, 0, sizeof(stress));
+    stress.isRetry = isRetry;
+    EVENT_QUEUE_Initialize(&stress.queue, stress.events, stress.timestamps, TEST_CAPACITY);
+
+    const double start = _now();
+    for (uint32_t id = 0; id < TEST_ISRS; id++)
+        TEST_ASSERT_EQUAL(0, pthread_create(&isrs[id], NULL, _isr, (void *) (uintptr_t) id));
+
+    // main loop: pop till ISRs are done and queue is drained, push own events meanwhile
+    while ((TEST_ISRS != __atomic_load_n(&stress.finished, __ATOMIC_ACQUIRE)) ||
+           (0 != EVENT_QUEUE_GetSize(&stress.queue))) {
+        if (!EVENT_QUEUE_Pop(&stress.queue, &event, _nowUs())) {
+            sched_yield(); // WFE
+            continue;
+        }
+
+        _receive(&event);
+        if ((0 == ++pops % TEST_MAIN_PUSH_EVERY) && (stress.producers[TEST_MAIN_ID].sequence < TEST_EVENTS_PER_ISR))
+            _push(TEST_MAIN_ID, false);
+    }
+    const double elapsed = _now() - start;
+
+    for (uint32_t id = 0; id < TEST_ISRS; id++)
+        TEST_ASSERT_EQUAL(0, pthread_join(isrs[id], NULL));
+    TEST_ASSERT(!EVENT_QUEUE_Pop(&stress.queue, &event, _nowUs()));
+
+    uint32_t pushed = 0;
+    uint32_t refused = 0;
+    for (uint32_t id = 0; id < TEST_PRODUCERS; id++) {
+        const TTestProducer *const producer = &stress.producers[id];
+
+        TEST_ASSERT_EQUAL(producer->pushed, producer->received);
+        TEST_ASSERT_EQUAL(0, memcmp(producer->accepted, producer->popped, sizeof(producer->accepted)));
+        TEST_ASSERT_EQUAL(producer->sequence, producer->pushed +
+                                              ((stress.isRetry && (id < TEST_ISRS)) ? 0 : producer->refused));
+        if (stress.isRetry && (id < TEST_ISRS)) TEST_ASSERT_EQUAL(TEST_EVENTS_PER_ISR, producer->pushed);
+        pushed += producer->pushed;
+        refused += producer->refused;
+    }
+
+    const TEventQueueStats *const stats = &stress.queue.stats;
+    TEST_ASSERT_EQUAL(pushed, stats->enqueues);
+    TEST_ASSERT_EQUAL(pushed, stats->dequeues);
+    TEST_ASSERT_EQUAL(refused, stats->overflows);
+    TEST_ASSERT(stats->highWater <= TEST_CAPACITY);
+
+    printf("%-6s %u ISRs: %u events in %.2f s (%.2f M/s), %u pushes refused, high water %u of %u, "
+           "max latency %u us\n", name, TEST_ISRS, pushed, elapsed, pushed / elapsed / 1e6, refused, stats->highWater,
+           stats->capacity, stats->maxLatency);
+};
+
+// queue without slots drops everything, stats survive reinitialization
+static void _testNotInitialized(void) {
+    TEvent event = {0};
+
+    memset(&stress, 0, sizeof(stress));
+    EVENT_QUEUE_Initialize(&stress.queue, stress.events, NULL, 0);
+    TEST_ASSERT(!EVENT_QUEUE_Push(&stress.queue, event, 0));
+    TEST_ASSERT(!EVENT_QUEUE_Pop(&stress.queue, &event, 0));
+    TEST_ASSERT_EQUAL(1, stress.queue.stats.overflows);
+
+    EVENT_QUEUE_Initialize(&stress.queue, stress.events, NULL, TEST_CAPACITY);
+    for (uint32_t i = 0; i < TEST_CAPACITY; i++)
+        TEST_ASSERT(EVENT_QUEUE_Push(&stress.queue, event, 0));
+    TEST_ASSERT(!EVENT_QUEUE_Push(&stress.queue, event, 0));
+    TEST_ASSERT_EQUAL(TEST_CAPACITY, EVENT_QUEUE_GetSize(&stress.queue));
+
+    EVENT_QUEUE_Initialize(&stress.queue, stress.events, NULL, TEST_CAPACITY);
+    TEST_ASSERT_EQUAL(0, EVENT_QUEUE_GetSize(&stress.queue));
+    TEST_ASSERT_EQUAL(2, stress.queue.stats.overflows);
+    TEST_ASSERT_EQUAL(TEST_CAPACITY, stress.queue.stats.enqueues);
+    TEST_ASSERT_EQUAL(TEST_CAPACITY, stress.queue.stats.highWater);
+};
+
+int main(void) {
+    _testNotInitialized();
+    _testStress("drop", false);
+    _testStress("retry", true);
+
+    return EXIT_SUCCESS;
+};
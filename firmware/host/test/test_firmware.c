@@ -0,0 +1,101 @@
+#include <string.h>
+
+#include "./test_firmware.h"
+#include "./test_fixture.h"
+#include "init_manager/init_manager.h"
+#include "scheduler/scheduler.h"
+#include "timers/timers.h"
+#include "app_manager/app_manager.h"
+#include "metrics/metrics.h"
+#include "power/power.h"
+#include "nfc/nfc.h"
+#include "storage/storage_manager.h"
+#include "../sim/sim_drivers.h"
+#include "../sim/sim_st25dv.h"
+#include "../sim/sim_sht3x.h"
+
+extern TActiveObject *systemActorsList[ACTIVE_OBJECTS_MAX];
+
+static TSensorsStorageData sample;
+static uint32_t samples;
+// page block as storage flushes it: records sealed at once
+static void _fillPage(uint8_t *const page, uint32_t offset) {
+    TStorageRecordCodec codec;
+    size_t recordSize;
+
+    STORAGE_RECORD_Reset(&codec);
+    while (0 != (recordSize = STORAGE_RECORD_Encode(&codec, &sample, page + offset, DRV_AT25DF_PAGE_SIZE - offset))) {
+        offset += recordSize;
+        TEST_FIXTURE_FridgeStep(&sample);
+        samples++;
+    }
+    STORAGE_RECORD_Seal(&codec, page + offset, DRV_AT25DF_PAGE_SIZE - offset);
+};
+
+uint32_t TEST_FIRMWARE_FillLog(uint32_t tailSequence, uint32_t tailPages) {
+    uint8_t *const flash = SIM_MEMORY_GetFlash();
+    const uint32_t oldestSequence = LOG_OLDEST_SECTOR_SEQUENCE(tailSequence);
+
+    SIM_MEMORY_EraseChip();
+    memcpy(flash + DRV_MEMORY_BOOT_SECTOR_FLASH_ADDRESS, FATBootSectorImage, sizeof(FATBootSectorImage));
+    sample = (TSensorsStorageData) {.timestamp = TEST_FIXTURE_EPOCH, .sht3XTemperatureHumiditySensorData = {26000, 30000}};
+    samples = 0;
+    TEST_FIXTURE_Seed(TEST_FIXTURE_SEED);
+
+    if (0 == tailPages) return 0;
+
+    for (uint32_t sequence = oldestSequence; sequence <= tailSequence; sequence++) {
+        const uint32_t sectorAddress = LOG_SECTOR_ADDRESS(sequence % LOG_SECTORS_MAX);
+        const uint32_t pages = (sequence == tailSequence) ? tailPages : LOG_PAGES_IN_SECTOR;
+        const TStorageSectorHeader header = {.sequence = sequence, .sequenceInverted = ~sequence};
+
+        memcpy(flash + sectorAddress, &header, sizeof(header));
+        for (uint32_t page = 0; page < pages; page++)
+            _fillPage(flash + sectorAddress + page * DRV_AT25DF_PAGE_SIZE, (0 == page) ? LOG_SECTOR_HEADER_SIZE : 0);
+    }
+
+    return samples;
+};
+
+void TEST_FIRMWARE_Boot(TSimTime horizon) {
+    SIM_Initialize(horizon);
+    SIM_TIME_Initialize();
+    SIM_MEMORY_Initialize();
+    SIM_I2C_Initialize();
+    SIM_PLIB_Initialize();
+    SIM_ST25DV_Initialize();
+    SIM_ST25DV_SetConfig(ST25DV_GPO_OFFSET, ST25DV_GPO_CONFIG);
+    SIM_ST25DV_SetConfig(ST25DV_MB_MODE_OFFSET, ST25DV_MB_MODE_RW_MASK);
+    SIM_SHT3X_Initialize();
+
+    /* main.c */
+    SYS_Initialize(NULL);
+    METRICS_Initialize();
+    POWER_Initialize();
+    TIMERS_Initialize();
+};
+
+bool TEST_FIRMWARE_RunUntil(TTestFirmwareCondition condition) {
+    while (!SIM_IsOver()) {
+        SYS_Tasks();
+
+        TIMERS_Tasks();
+        SCHEDULER_Tasks();
+        APP_PollTasks();
+
+        METRICS_INC(loopIterations);
+        METRICS_Tasks();
+
+        if (condition()) return true;
+
+        POWER_Idle();
+    }
+
+    return condition();
+};
+
+bool TEST_FIRMWARE_IsStorageIdle(void) {
+    const TActiveObject *const AO = systemActorsList[STORAGE_AO_ID];
+
+    return (NULL != AO) && (STORAGE_ST_IDLE == AO->state->name);
+};
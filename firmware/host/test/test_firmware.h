@@ -0,0 +1,54 @@
+/**
+ * @file test_firmware.h
+ * @brief Firmware main loop on simulated peripherals, for tests of actors
+ *
+ * @details Boot follows main.c: peripherals models are reset (flash content is kept, so a test may prefill it or
+ * reboot over the log written before), then the main loop runs till the test condition holds.
+ * Tag is configured for mailbox as by a previous boot, see bench.c.
+ */
+
+#ifndef TEST_FIRMWARE_H
+#define TEST_FIRMWARE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "definitions.h"
+#include "../sim/sim.h"
+
+#ifdef    __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Erase flash and write log of sectors of the ring up to the tail one, as storage leaves it
+ * @details Pages are sealed record blocks of samples taken each minute, checkpoint journal is left erased.
+ * @param tailSequence sequence of the tail sector
+ * @param tailPages pages written in the tail sector, 0 for empty log
+ * @return samples written
+ */
+uint32_t TEST_FIRMWARE_FillLog(uint32_t tailSequence, uint32_t tailPages);
+
+/** @brief Test condition, checked after each main loop pass */
+typedef bool (*TTestFirmwareCondition)(void);
+
+/**
+ * @brief Reset simulation and peripherals models, then initialize firmware as main.c does
+ * @param horizon simulation stops there
+ */
+void TEST_FIRMWARE_Boot(TSimTime horizon);
+
+/**
+ * @brief Run main loop passes till condition holds or simulation horizon is reached
+ * @return true if condition holds
+ */
+bool TEST_FIRMWARE_RunUntil(TTestFirmwareCondition condition);
+
+/** @return true if storage has booted and serves no request, condition for TEST_FIRMWARE_RunUntil */
+bool TEST_FIRMWARE_IsStorageIdle(void);
+
+#ifdef    __cplusplus
+}
+#endif
+
+#endif //TEST_FIRMWARE_H
@@ -0,0 +1,48 @@
+#include "./test_fixture.h"
+#include "storage/storage_summary.h"
+
+static uint32_t randomState = TEST_FIXTURE_SEED;
+
+void TEST_FIXTURE_Seed(uint32_t seed) {
+    randomState = seed;
+};
+
+uint32_t TEST_FIXTURE_Random(void) {
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+};
+
+int32_t TEST_FIXTURE_Noise(uint32_t amplitude) {
+    return (int32_t) (TEST_FIXTURE_Random() % (2 * amplitude + 1)) - (int32_t) amplitude;
+};
+
+void TEST_FIXTURE_ColdChain(TSensorsStorageData *const samples) {
+    TEST_FIXTURE_Seed(TEST_FIXTURE_SEED);
+
+    for (uint32_t i = 0; i < TEST_FIXTURE_SAMPLES; i++) {
+        const uint32_t minuteOfCycle = i % (4 * 60);
+        double celsius = 5.0 + TEST_FIXTURE_Noise(20) / 100.0;
+
+        if (minuteOfCycle < 10) celsius += 0.4 * minuteOfCycle;
+        if ((i >= TEST_FIXTURE_HOT_START) && (i < TEST_FIXTURE_HOT_START + TEST_FIXTURE_HOT_SAMPLES))
+            celsius = 24.0 + TEST_FIXTURE_Noise(100) / 100.0;
+        if ((i >= TEST_FIXTURE_FROZEN_START) && (i < TEST_FIXTURE_FROZEN_START + TEST_FIXTURE_FROZEN_SAMPLES))
+            celsius = -18.0 + TEST_FIXTURE_Noise(100) / 100.0;
+
+        samples[i] = (TSensorsStorageData) {
+                .timestamp = TEST_FIXTURE_EPOCH + TEST_FIXTURE_INTERVAL_S * i,
+                .sht3XTemperatureHumiditySensorData = {
+                        .temperature = STORAGE_SUMMARY_RAW_TEMPERATURE(celsius),
+                        .humidity = (uint16_t) (30000 + TEST_FIXTURE_Noise(2000))
+                }
+        };
+    }
+};
+
+void TEST_FIXTURE_FridgeStep(TSensorsStorageData *const sample) {
+    sample->timestamp += TEST_FIXTURE_INTERVAL_S;
+    sample->sht3XTemperatureHumiditySensorData.temperature += TEST_FIXTURE_Noise(2);
+    sample->sht3XTemperatureHumiditySensorData.humidity = (uint16_t) (30000 + TEST_FIXTURE_Noise(6));
+};
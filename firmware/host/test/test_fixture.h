@@ -0,0 +1,53 @@
+/**
+ * @file test_fixture.h
+ * @brief Sample traces shared by host tests
+ *
+ * @details Random numbers are xorshift32, reseeded by TEST_FIXTURE_Seed(), so traces and logs are reproducible.
+ * Cold chain trace is a product kept in a fridge for 30 days, sampled each minute: 5 C, door opened every 4 hours,
+ * 6 hours in a hot truck on day 10 and 2 hours in a freezer on day 20, so it has both excursions. Fridge step is the
+ * steady part of it only, temperature wanders by a few LSBs, as most of a real log is.
+ */
+
+#ifndef TEST_FIXTURE_H
+#define TEST_FIXTURE_H
+
+#include <stdint.h>
+
+#include "storage/storage_data.defs.h"
+
+#ifdef    __cplusplus
+extern "C" {
+#endif
+
+#define TEST_FIXTURE_SEED                   (0x2545F491)
+#define TEST_FIXTURE_EPOCH                  (1704067200UL) // 2024-01-01 00:00:00 UTC
+#define TEST_FIXTURE_INTERVAL_S             (60)
+#define TEST_FIXTURE_SAMPLES                (30 * 24 * 60) // 30 days sampled each minute
+#define TEST_FIXTURE_HOT_START              (10 * 24 * 60 + 60) // sample index, day 10 01:00
+#define TEST_FIXTURE_HOT_SAMPLES            (6 * 60)
+#define TEST_FIXTURE_FROZEN_START           (20 * 24 * 60 + 60) // day 20 01:00
+#define TEST_FIXTURE_FROZEN_SAMPLES         (2 * 60)
+
+/** @brief Restart random sequence */
+void TEST_FIXTURE_Seed(uint32_t seed);
+
+/** @return next xorshift32 number */
+uint32_t TEST_FIXTURE_Random(void);
+
+/** @return uniform noise from -amplitude to amplitude */
+int32_t TEST_FIXTURE_Noise(uint32_t amplitude);
+
+/**
+ * @brief Fill 30 days cold chain trace, random sequence is reseeded
+ * @param samples TEST_FIXTURE_SAMPLES of them
+ */
+void TEST_FIXTURE_ColdChain(TSensorsStorageData *const samples);
+
+/** @brief Fridge sample following the given one: a sampling interval later, temperature and humidity noise */
+void TEST_FIXTURE_FridgeStep(TSensorsStorageData *const sample);
+
+#ifdef    __cplusplus
+}
+#endif
+
+#endif //TEST_FIXTURE_H
@@ -0,0 +1,182 @@
+/**
+ * @brief NFC mailbox commands: test vectors of requests and responses, per command latency
+ * @details Phone sends each vector request as raw little endian bytes and checks the response header (command echo,
+ * status, single response) and payload size. Unknown commands should be answered UNSUPPORTED, requests shorter than
+ * their command BAD_REQUEST, out of range parameters OUT_OF_RANGE. Settings are read back by GET_STATUS: device time
+ * is UTC whatever local time zone libc has, sampling period is the one set.
+ *
+ * Latency is from the phone starting to send the request till it has read the response, RF included, so it grows
+ * with request and response sizes. Each vector is repeated at random phase to the firmware timers to get mean and max:
+ * a request landing while firmware is busy (sampling, storage) is answered later.
+ */
+
+#define _DEFAULT_SOURCE // setenv
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "definitions.h"
+#include "nfc/nfc.h"
+#include "storage/storage_manager.h"
+#include "../sim/sim_st25dv.h"
+#include "./test.h"
+#include "./test_firmware.h"
+#include "./test_fixture.h"
+#include "./test_phone.h"
+
+#define TEST_HORIZON_US                     (600 * SIM_US_IN_S)
+#define TEST_WARM_UP_US                     (30 * SIM_US_IN_S)
+#define TEST_REPEATS                        (8)
+#define TEST_PHASE_US_MAX                   (SIM_US_IN_S) // random delay before request, a sampling period
+#define TEST_ANY_SIZE                       (-1)
+#define TEST_TIME                           (1767225600UL) // 2026-01-01 00:00:00 UTC, 0x6955B900
+#define TEST_PERIOD_MS                      (60000) // 0xEA60
+#define TEST_TIME_ZONE                      "EST5" // mktime() would be 5 hours off UTC
+
+typedef struct {
+    const char *name;
+    uint8_t request[12];
+    uint8_t size;
+    uint8_t status; /**< NFC_PROTOCOL_STATUS expected */
+    int16_t payloadSize; /**< expected, TEST_ANY_SIZE if it varies */
+} TTestVector;
+
+static const TTestVector vectors[] = {
+        {"GET_STATUS", {0x02, 0x00}, 2, NFC_PROTOCOL_STATUS_LAST, sizeof(TNFCProtocolStatus)},
+        {"GET_SUMMARY", {0x03, 0x00}, 2, NFC_PROTOCOL_STATUS_LAST, sizeof(TNFCProtocolSummary)},
+        {"GET_QUEUES", {0x07, 0x00}, 2, NFC_PROTOCOL_STATUS_LAST, TEST_ANY_SIZE},
+        {"SET_SAMPLING", {0x04, 0x00, 0x60, 0xEA, 0x00, 0x00}, 6, NFC_PROTOCOL_STATUS_LAST, 0},
+        {"SET_SAMPLING 1 ms", {0x04, 0x00, 0x01, 0x00, 0x00, 0x00}, 6, NFC_PROTOCOL_STATUS_OUT_OF_RANGE, 0},
+        {"SET_SAMPLING 2 days", {0x04, 0x00, 0x00, 0x5C, 0x49, 0x0A}, 6, NFC_PROTOCOL_STATUS_OUT_OF_RANGE, 0},
+        {"SET_TIME", {0x05, 0x00, 0x00, 0xB9, 0x55, 0x69}, 6, NFC_PROTOCOL_STATUS_LAST, 0},
+        {"unknown 0x00", {0x00, 0x00}, 2, NFC_PROTOCOL_STATUS_UNSUPPORTED, 0},
+        {"unknown 0x7F", {0x7F, 0x00}, 2, NFC_PROTOCOL_STATUS_UNSUPPORTED, 0},
+        {"unknown 0xFF", {0xFF, 0x00, 0x01, 0x02}, 4, NFC_PROTOCOL_STATUS_UNSUPPORTED, 0},
+        {"short GET_STATUS", {0x02}, 1, NFC_PROTOCOL_STATUS_BAD_REQUEST, 0},
+        {"short SET_TIME", {0x05, 0x00, 0x00, 0xB9}, 4, NFC_PROTOCOL_STATUS_BAD_REQUEST, 0},
+        {"short GET_LOG", {0x01, 0x00, 0x00, 0x00, 0x00, 0x00}, 6, NFC_PROTOCOL_STATUS_BAD_REQUEST, 0},
+};
+
+static struct {
+    uint8_t response[ST25DV_MAILBOX_SIZE];
+    size_t size;
+    TSimTime at; /**< phone has read the response */
+} last;
+
+static TSimTime wakeAt;
+static TSimTime timeSetAt; /**< SET_TIME was answered */
+
+extern TActiveObject *systemActorsList[ACTIVE_OBJECTS_MAX];
+
+static bool _isIdle(void) {
+    const TActiveObject *const nfcAO = systemActorsList[NFC_AO_ID];
+
+    return TEST_FIRMWARE_IsStorageIdle() && (NULL != nfcAO) && (NFC_ST_IDLE == nfcAO->state->name);
+};
+
+static bool _isDue(void) {
+    return SIM_GetTime() >= wakeAt;
+};
+
+static void _onDue(uintptr_t context) {
+    SIM_RaiseInterrupt();
+};
+
+// firmware runs for a while, main loop is woken up at the end as it may sleep longer
+static void _runFor(TSimTime duration) {
+    wakeAt = SIM_GetTime() + duration;
+    SIM_Schedule(wakeAt, _onDue, 0);
+    TEST_ASSERT(TEST_FIRMWARE_RunUntil(_isDue));
+};
+
+static bool _onResponse(const uint8_t *response, size_t size) {
+    memcpy(last.response, response, size);
+    last.size = size;
+    last.at = SIM_GetTime();
+
+    return false;
+};
+
+/** @return request to response time on phone */
+static TSimTime _request(const void *request, size_t size) {
+    const TSimTime start = SIM_GetTime();
+
+    TEST_PHONE_Request(request, size, _onResponse);
+    TEST_ASSERT(TEST_FIRMWARE_RunUntil(TEST_PHONE_IsDone));
+
+    return last.at - start;
+};
+
+static void _testVector(const TTestVector *const vector) {
+    TSimTime latencySum = 0;
+    TSimTime latencyMax = 0;
+
+    for (uint32_t i = 0; i < TEST_REPEATS; i++) {
+        _runFor(TEST_FIXTURE_Random() % TEST_PHASE_US_MAX);
+
+        const TSimTime latency = _request(vector->request, vector->size);
+        TNFCProtocolResponseHeader header;
+
+        TEST_ASSERT(last.size >= sizeof(header));
+        memcpy(&header, last.response, sizeof(header));
+        TEST_ASSERT_EQUAL(vector->request[0], header.command);
+        TEST_ASSERT_EQUAL(vector->status, header.status);
+        TEST_ASSERT_EQUAL(0, header.sequence);
+        TEST_ASSERT_EQUAL(0, header.offset);
+        if (TEST_ANY_SIZE != vector->payloadSize)
+            TEST_ASSERT_EQUAL(vector->payloadSize, last.size - sizeof(header));
+
+        if ((NFC_PROTOCOL_CMD_SET_TIME == header.command) && (NFC_PROTOCOL_STATUS_LAST == header.status))
+            timeSetAt = last.at;
+        latencySum += latency;
+        if (latency > latencyMax) latencyMax = latency;
+    }
+
+    printf("%-20s status %u, %3u B response: latency mean %5.1f ms, max %5.1f ms\n", vector->name,
+           last.response[1], (uint32_t) last.size, (double) latencySum / TEST_REPEATS / SIM_US_IN_MS,
+           (double) latencyMax / SIM_US_IN_MS);
+};
+
+// settings written by vectors are read back, time as UTC
+static void _testReadBack(void) {
+    const uint8_t getStatus[] = {0x02, 0x00};
+    const uint8_t getSummary[] = {0x03, 0x00};
+    TNFCProtocolStatus status;
+    TNFCProtocolSummary summary;
+
+    _request(getStatus, sizeof(getStatus));
+    memcpy(&status, last.response + sizeof(TNFCProtocolResponseHeader), sizeof(status));
+    TEST_ASSERT_EQUAL(NFC_PROTOCOL_VERSION, status.protocolVersion);
+    TEST_ASSERT_EQUAL(TEST_PERIOD_MS, status.samplingPeriodMs);
+    TEST_ASSERT(status.time >= TEST_TIME);
+    TEST_ASSERT(status.time <= TEST_TIME + 1 + (last.at - timeSetAt) / SIM_US_IN_S);
+    TEST_ASSERT(0 != status.logSize);
+    TEST_ASSERT(0 != status.logPagesChecked); // verified on boot
+    TEST_ASSERT_EQUAL(STORAGE_GetVerifyReport()->pagesChecked, status.logPagesChecked);
+    TEST_ASSERT_EQUAL(0, status.logPagesCorrupted);
+
+    _request(getSummary, sizeof(getSummary));
+    memcpy(&summary, last.response + sizeof(TNFCProtocolResponseHeader), sizeof(summary));
+    TEST_ASSERT_EQUAL(STORAGE_GetSummary()->samples, summary.samples);
+    TEST_ASSERT(summary.firstTimestamp <= summary.lastTimestamp);
+    TEST_ASSERT(summary.temperatureMin <= summary.temperatureMax);
+};
+
+int main(void) {
+    setenv("TZ", TEST_TIME_ZONE, 1);
+    tzset();
+
+    TEST_FIRMWARE_FillLog(0, 0);
+    TEST_FIRMWARE_Boot(TEST_HORIZON_US);
+    TEST_PHONE_Initialize();
+    _runFor(TEST_WARM_UP_US);
+    TEST_ASSERT(TEST_FIRMWARE_RunUntil(_isIdle));
+    TEST_PHONE_Enter();
+
+    for (uint32_t i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++)
+        _testVector(&vectors[i]);
+    _testReadBack();
+
+    return EXIT_SUCCESS;
+};
@@ -0,0 +1,258 @@
+/**
+ * @brief Log download over ST25DV mailbox: throughput, I2C overhead and resume after the phone left the field
+ * @details Phone downloads the whole log by GET_LOG, leaves the field at a third of it and resumes by new request
+ * from the last offset received. Each response is checked for contiguous sequence and offset, payload against flash.
+ * Throughput is payload KB/s while phone is in field, RF bound: ISO 15693 high data rate, see sim_st25dv.h.
+ * Response latency is from the phone reading the previous response (sending the request) till it has read the next
+ * one, mean and max over responses. The test is built twice, with NFC_RESPONSE_PREFETCH on and off, to compare:
+ * simulation charges no CPU time to copy or pack, so prefetch only shows where storage reads delay a response.
+ * Mean latency should stay close to RF read of a full mailbox, firmware keeps the mailbox fed.
+ *
+ * 30 days log is downloaded raw and packed (NFC_PROTOCOL_FLAG_PACKED), packed stream is unpacked block by block
+ * as the phone does and compared with flash, transfer times are reported.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "definitions.h"
+#include "nfc/nfc.h"
+#include "nfc/nfc_pack.h"
+#include "storage/storage_manager.h"
+#include "../sim/sim_drivers.h"
+#include "../sim/sim_st25dv.h"
+#include "./test.h"
+#include "./test_firmware.h"
+#include "./test_phone.h"
+
+#define TEST_HORIZON_US                     (600 * SIM_US_IN_S)
+#define TEST_AWAY_US                        (2 * SIM_US_IN_S)
+#define TEST_TAIL_SEQUENCE                  (15)
+#define TEST_TAIL_PAGES                     (9)
+#define TEST_LOG_SIZE                       (TEST_TAIL_SEQUENCE * LOG_SECTOR_SIZE + TEST_TAIL_PAGES * DRV_AT25DF_PAGE_SIZE)
+#define TEST_30_DAYS_SAMPLES                (30 * 24 * 60) // sampled each minute
+#define TEST_30_DAYS_TAIL_SEQUENCE          (31)
+#define TEST_30_DAYS_TAIL_PAGES             (8)
+#define TEST_STREAM_SIZE_MAX                ((TEST_30_DAYS_TAIL_SEQUENCE + 1) * LOG_SECTOR_SIZE)
+#define TEST_KB_PER_S_MIN                   (2.5) // 26.48 kbps RF is 3.3 KB/s at most
+#define TEST_I2C_BYTES_PER_BYTE_MAX         (1.1) // response header, register address, interrupt status reads
+#define TEST_LATENCY_OVER_RF_US_MAX         (5 * SIM_US_IN_MS) // mean, phone polls, interrupt status read, I2C write
+
+extern TActiveObject *systemActorsList[ACTIVE_OBJECTS_MAX];
+
+static struct {
+    uint32_t logSize;
+    uint32_t offset; /**< log bytes received */
+    uint32_t stopOffset; /**< phone leaves the field once it is reached */
+    uint16_t sequence; /**< next response sequence of the request */
+    bool isLast;
+    bool isPacked;
+    uint8_t stream[TEST_STREAM_SIZE_MAX]; /**< packed stream received */
+    TSimTime awayUntil;
+    TSimTime respondedAt; /**< phone has read the previous response or sent the request */
+    TSimTime latencySum;
+    TSimTime latencyMax;
+    uint32_t responses; /**< latencies summed */
+} download;
+
+static bool _isIdle(void) {
+    const TActiveObject *const nfcAO = systemActorsList[NFC_AO_ID];
+
+    return TEST_FIRMWARE_IsStorageIdle() && (NULL != nfcAO) && (NFC_ST_IDLE == nfcAO->state->name);
+};
+
+static bool _isBack(void) {
+    return SIM_GetTime() >= download.awayUntil;
+};
+
+static bool _onStatus(const uint8_t *response, size_t size) {
+    TNFCProtocolResponseHeader header;
+    TNFCProtocolStatus status;
+
+    TEST_ASSERT_EQUAL(sizeof(header) + sizeof(status), size);
+    memcpy(&header, response, sizeof(header));
+    memcpy(&status, response + sizeof(header), sizeof(status));
+    TEST_ASSERT_EQUAL(NFC_PROTOCOL_CMD_GET_STATUS, header.command);
+    TEST_ASSERT_EQUAL(NFC_PROTOCOL_STATUS_LAST, header.status);
+
+    download.logSize = status.logSize;
+
+    return false;
+};
+
+static bool _onLog(const uint8_t *response, size_t size) {
+    const uint8_t *const flash = SIM_MEMORY_GetFlash();
+    const uint8_t *const payload = response + sizeof(TNFCProtocolResponseHeader);
+    const uint32_t payloadSize = (uint32_t) (size - sizeof(TNFCProtocolResponseHeader));
+    const TSimTime latency = SIM_GetTime() - download.respondedAt;
+    TNFCProtocolResponseHeader header;
+
+    download.respondedAt = SIM_GetTime();
+    download.latencySum += latency;
+    if (latency > download.latencyMax) download.latencyMax = latency;
+    download.responses++;
+
+    TEST_ASSERT(size >= sizeof(header));
+    memcpy(&header, response, sizeof(header));
+    TEST_ASSERT_EQUAL(NFC_PROTOCOL_CMD_GET_LOG, header.command);
+    TEST_ASSERT_EQUAL(download.sequence, header.sequence);
+    TEST_ASSERT_EQUAL(download.offset, header.offset);
+    TEST_ASSERT((NFC_PROTOCOL_STATUS_OK == header.status) || (NFC_PROTOCOL_STATUS_LAST == header.status));
+
+    if (download.isPacked) {
+        TEST_ASSERT(download.offset + payloadSize <= sizeof(download.stream));
+        memcpy(download.stream + download.offset, payload, payloadSize);
+    } else {
+        for (uint32_t i = 0; i < payloadSize; i++)
+            TEST_ASSERT_EQUAL(flash[STORAGE_GetLogAddress(download.offset + i)], payload[i]);
+    }
+
+    download.sequence++;
+    download.offset += payloadSize;
+    download.isLast = (NFC_PROTOCOL_STATUS_LAST == header.status);
+
+    return !download.isLast && (download.offset < download.stopOffset);
+};
+
+// GET_LOG from the offset, till phone leaves at stop offset or the last response
+static void _downloadLog(uint32_t stopOffset, TSimTime *const inField) {
+    const TNFCProtocolLogRequest request = {
+            .command = NFC_PROTOCOL_CMD_GET_LOG,
+            .flags = download.isPacked ? NFC_PROTOCOL_FLAG_PACKED : 0,
+            .offset = download.offset,
+            .size = NFC_PROTOCOL_LOG_SIZE_TILL_END
+    };
+    const TSimTime start = SIM_GetTime();
+
+    download.sequence = 0;
+    download.stopOffset = stopOffset;
+    download.respondedAt = start;
+    TEST_PHONE_Request(&request, sizeof(request), _onLog);
+    TEST_ASSERT(TEST_FIRMWARE_RunUntil(TEST_PHONE_IsDone));
+    *inField += SIM_GetTime() - start;
+};
+
+// boot over log, phone enters the field and gets log size by GET_STATUS
+static void _bootAndGetStatus(void) {
+    const TNFCProtocolRequestHeader statusRequest = {.command = NFC_PROTOCOL_CMD_GET_STATUS};
+
+    TEST_FIRMWARE_Boot(TEST_HORIZON_US);
+    TEST_PHONE_Initialize();
+    memset(&download, 0, sizeof(download));
+    TEST_ASSERT(TEST_FIRMWARE_RunUntil(_isIdle));
+
+    TEST_PHONE_Enter();
+    TEST_PHONE_Request(&statusRequest, sizeof(statusRequest), _onStatus);
+    TEST_ASSERT(TEST_FIRMWARE_RunUntil(TEST_PHONE_IsDone));
+};
+
+// packed blocks are independent, one per storage chunk, raw sizes sum up to the log size
+static void _unpackStream(uint32_t streamSize) {
+    const uint8_t *const flash = SIM_MEMORY_GetFlash();
+    uint8_t chunk[STORAGE_STREAM_CHUNK_SIZE];
+    uint32_t position = 0;
+    uint32_t offset = 0;
+
+    while (position < streamSize) {
+        const size_t chunkSize = NFC_PACK_Decode(download.stream + position, streamSize - position, chunk,
+                                                 sizeof(chunk));
+        const uint16_t packedSize = (uint16_t) (download.stream[position + 2] | (download.stream[position + 3] << 8));
+
+        TEST_ASSERT(0 != chunkSize);
+        for (uint32_t i = 0; i < chunkSize; i++)
+            TEST_ASSERT_EQUAL(flash[STORAGE_GetLogAddress(offset + i)], chunk[i]);
+
+        position += NFC_PACK_HEADER_SIZE + ((0 == packedSize) ? chunkSize : packedSize);
+        offset += (uint32_t) chunkSize;
+    }
+
+    TEST_ASSERT_EQUAL(streamSize, position);
+    TEST_ASSERT_EQUAL(download.logSize, offset);
+};
+
+// response latency since the last check is reported and checked, then reset for the next one
+static void _testLatency(const char *name) {
+    const TSimTime latencyMean = download.latencySum / download.responses;
+
+    printf("%s response latency (prefetch %s): mean %.1f ms, max %.1f ms over %u responses\n", name,
+           NFC_RESPONSE_PREFETCH ? "on" : "off", (double) latencyMean / SIM_US_IN_MS,
+           (double) download.latencyMax / SIM_US_IN_MS, download.responses);
+    TEST_ASSERT(latencyMean <= SIM_ST25DV_RF_TIME_US(ST25DV_MAILBOX_SIZE) + TEST_LATENCY_OVER_RF_US_MAX);
+
+    download.latencySum = 0;
+    download.latencyMax = 0;
+    download.responses = 0;
+};
+
+static void _testDownload(void) {
+    TSimTime inField = 0;
+
+    TEST_FIRMWARE_FillLog(TEST_TAIL_SEQUENCE, TEST_TAIL_PAGES);
+    _bootAndGetStatus();
+    TEST_ASSERT_EQUAL(TEST_LOG_SIZE, download.logSize);
+
+    const TSimI2CStats i2cStart = *SIM_I2C_GetStats();
+    const uint32_t responsesStart = TEST_PHONE_GetStats()->responses;
+
+    _downloadLog(download.logSize / 3, &inField);
+    TEST_ASSERT(!download.isLast);
+    const uint32_t resumeOffset = download.offset;
+
+    // response written meanwhile is left in mailbox, phone reads it out before the new request
+    TEST_PHONE_Leave();
+    download.awayUntil = SIM_GetTime() + TEST_AWAY_US;
+    TEST_ASSERT(TEST_FIRMWARE_RunUntil(_isBack));
+    TEST_PHONE_Enter();
+
+    _downloadLog(UINT32_MAX, &inField);
+    TEST_ASSERT(download.isLast);
+    TEST_ASSERT_EQUAL(download.logSize, download.offset);
+
+    const TSimI2CStats *const i2c = SIM_I2C_GetStats();
+    const double kbPerS = (double) download.logSize / 1024 / ((double) inField / SIM_US_IN_S);
+    const double i2cPerByte = (double) (i2c->bytes - i2cStart.bytes) / download.logSize;
+
+    printf("log %u B in %u responses, resumed at %u: %.2f KB/s in field, %.3f I2C B per payload B, "
+           "%.1f ms I2C bus per KB\n", download.logSize, TEST_PHONE_GetStats()->responses - responsesStart,
+           resumeOffset, kbPerS, i2cPerByte,
+           (double) (i2c->busTimeUs - i2cStart.busTimeUs) / SIM_US_IN_MS / (download.logSize / 1024.0));
+
+    _testLatency("log");
+
+    TEST_ASSERT(kbPerS >= TEST_KB_PER_S_MIN);
+    TEST_ASSERT(i2cPerByte <= TEST_I2C_BYTES_PER_BYTE_MAX);
+};
+
+static void _test30DaysPacked(void) {
+    const uint32_t samples = TEST_FIRMWARE_FillLog(TEST_30_DAYS_TAIL_SEQUENCE, TEST_30_DAYS_TAIL_PAGES);
+    TSimTime rawTime = 0;
+    TSimTime packedTime = 0;
+
+    TEST_ASSERT(samples >= TEST_30_DAYS_SAMPLES);
+    _bootAndGetStatus();
+
+    _downloadLog(UINT32_MAX, &rawTime);
+    TEST_ASSERT(download.isLast);
+    TEST_ASSERT_EQUAL(download.logSize, download.offset);
+    _testLatency("30 days raw");
+
+    download.isPacked = true;
+    download.offset = 0;
+    _downloadLog(UINT32_MAX, &packedTime);
+    TEST_ASSERT(download.isLast);
+    _unpackStream(download.offset);
+    _testLatency("30 days packed");
+
+    printf("30 days log (%u samples, %u B): raw %.1f s, packed %u B in %.1f s (%.1f%% of raw time)\n", samples,
+           download.logSize, (double) rawTime / SIM_US_IN_S, download.offset, (double) packedTime / SIM_US_IN_S,
+           100.0 * packedTime / rawTime);
+
+    TEST_ASSERT(packedTime < rawTime);
+};
+
+int main(void) {
+    _testDownload();
+    _test30DaysPacked();
+
+    return EXIT_SUCCESS;
+};
@@ -0,0 +1,142 @@
+/**
+ * @brief NDEF quick status: record layout and write amplification of delta writes over 30 days
+ * @details Status image is rebuilt every NFC_NDEF_UPDATE_PERIOD_MS from the summary of cold chain samples and
+ * written by runs of changed blocks as NFC actor does. EEPROM image should equal the built one after each update,
+ * runs should be block aligned and never cross I2C write page. Bytes programmed are reported against whole image
+ * rewrites and bytes actually changed, the most written block gives EEPROM wear-out time.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "nfc/nfc.config.h"
+#include "nfc/nfc_ndef.h"
+#include "./test.h"
+#include "./test_fixture.h"
+
+#define TEST_BLOCKS                         (NFC_NDEF_IMAGE_SIZE / NFC_NDEF_BLOCK_SIZE)
+#define TEST_FIXED_SIZE                     (4 + 2 + 7) // CC, TLV, record header and language never change
+#define TEST_ENDURANCE_CYCLES               (1000000UL) // ST25DV EEPROM, per block at 25 C
+#define TEST_WEAR_OUT_YEARS_MIN             (10)
+
+static TSensorsStorageData samples[TEST_FIXTURE_SAMPLES];
+
+static const char *_text(const uint8_t *const image) {
+    static char text[NFC_NDEF_TEXT_SIZE + 1];
+
+    memcpy(text, image + TEST_FIXED_SIZE, NFC_NDEF_TEXT_SIZE);
+    text[NFC_NDEF_TEXT_SIZE] = '\0';
+    return text;
+};
+
+// Type 5 tag layout, text of negative temperatures keeps sign, excursion raises alarm
+static void _testRecord(void) {
+    const TSensorsStorageData last = {
+            .timestamp = TEST_FIXTURE_EPOCH,
+            .sht3XTemperatureHumiditySensorData = {STORAGE_SUMMARY_RAW_TEMPERATURE(-0.5), 32768}
+    };
+    uint8_t image[NFC_NDEF_IMAGE_SIZE];
+    TStorageSummary summary;
+
+    STORAGE_SUMMARY_Reset(&summary);
+    STORAGE_SUMMARY_Update(&summary, &last);
+    NFC_NDEF_Build(image, &summary, &last);
+
+    TEST_ASSERT_EQUAL(0xE1, image[0]); // CC magic
+    TEST_ASSERT_EQUAL(0x03, image[4]); // NDEF message TLV
+    TEST_ASSERT_EQUAL(NFC_NDEF_RECORD_SIZE, image[5]);
+    TEST_ASSERT_EQUAL(0xD1, image[6]); // MB, ME, SR, well known type
+    TEST_ASSERT_EQUAL('T', image[9]);
+    TEST_ASSERT_EQUAL(0xFE, image[6 + NFC_NDEF_RECORD_SIZE]); // terminator TLV
+    TEST_ASSERT(0 == strncmp("ALARM T -0.5C RH 50% MIN -0.5C MAX -0.5C    ", _text(image), 44));
+    TEST_ASSERT_EQUAL(' ', image[TEST_FIXED_SIZE + NFC_NDEF_TEXT_SIZE - 1]);
+};
+
+// the longest text of extreme values fits fixed size record
+static void _testLongestText(void) {
+    const TSensorsStorageData last = {.sht3XTemperatureHumiditySensorData = {0, UINT16_MAX}};
+    uint8_t image[NFC_NDEF_IMAGE_SIZE];
+    TStorageSummary summary;
+
+    STORAGE_SUMMARY_Reset(&summary);
+    summary.excursions = 1;
+    summary.temperatureMin = 0;
+    summary.temperatureMax = UINT16_MAX;
+    NFC_NDEF_Build(image, &summary, &last);
+
+    TEST_ASSERT(0 == strncmp("ALARM T -45.0C RH 100% MIN -45.0C MAX 130.0C", _text(image), 44));
+    TEST_ASSERT_EQUAL(0xFE, image[6 + NFC_NDEF_RECORD_SIZE]);
+};
+
+static void _testWriteAmplification(void) {
+    uint8_t image[NFC_NDEF_IMAGE_SIZE];
+    uint8_t written[NFC_NDEF_IMAGE_SIZE] = {0}; // factory EEPROM
+    uint32_t blockWrites[TEST_BLOCKS] = {0};
+    uint32_t bytesChanged = 0;
+    uint32_t bytesWritten = 0;
+    uint32_t transfers = 0;
+    uint32_t updates = 0;
+    TStorageSummary summary;
+
+    STORAGE_SUMMARY_Reset(&summary);
+    TEST_FIXTURE_ColdChain(samples);
+
+    for (uint32_t i = 0; i < TEST_FIXTURE_SAMPLES; i++) {
+        STORAGE_SUMMARY_Update(&summary, &samples[i]);
+
+        // rate limit of updates is the sampling period
+        if (0 != (i * TEST_FIXTURE_INTERVAL_S * 1000) % NFC_NDEF_UPDATE_PERIOD_MS) continue;
+
+        uint16_t from = 0;
+        uint16_t offset;
+        uint16_t size;
+
+        NFC_NDEF_Build(image, &summary, &samples[i]);
+        for (uint32_t j = 0; j < NFC_NDEF_IMAGE_SIZE; j++) bytesChanged += (image[j] != written[j]);
+
+        while (NFC_NDEF_FindDelta(image, written, from, &offset, &size)) {
+            TEST_ASSERT(offset >= from);
+            TEST_ASSERT_EQUAL(0, offset % NFC_NDEF_BLOCK_SIZE);
+            TEST_ASSERT_EQUAL(0, size % NFC_NDEF_BLOCK_SIZE);
+            TEST_ASSERT(0 != size);
+            TEST_ASSERT(offset + size <= NFC_NDEF_IMAGE_SIZE);
+            TEST_ASSERT_EQUAL(offset / NFC_NDEF_WRITE_PAGE_SIZE, (offset + size - 1) / NFC_NDEF_WRITE_PAGE_SIZE);
+
+            memcpy(written + offset, image + offset, size);
+            for (uint32_t block = offset / NFC_NDEF_BLOCK_SIZE; block < (offset + size) / NFC_NDEF_BLOCK_SIZE; block++)
+                blockWrites[block]++;
+            bytesWritten += size;
+            transfers++;
+            from = offset + size;
+        }
+
+        TEST_ASSERT(0 == memcmp(image, written, NFC_NDEF_IMAGE_SIZE));
+        updates++;
+    }
+
+    uint32_t hottest = 0;
+    for (uint32_t block = 0; block < TEST_BLOCKS; block++) {
+        if (block < TEST_FIXED_SIZE / NFC_NDEF_BLOCK_SIZE) TEST_ASSERT_EQUAL(1, blockWrites[block]);
+        if (blockWrites[block] > blockWrites[hottest]) hottest = block;
+    }
+
+    const double wearOutYears = (double) TEST_ENDURANCE_CYCLES / blockWrites[hottest] * 30 / 365;
+
+    printf("30 days, %u updates: %u B written in %u transfers (whole image: %u B), %u B changed, "
+           "amplification %.2f (%.1f%% of rewrites)\n", updates, bytesWritten, transfers,
+           updates * NFC_NDEF_IMAGE_SIZE, bytesChanged, (double) bytesWritten / bytesChanged,
+           100.0 * bytesWritten / ((double) updates * NFC_NDEF_IMAGE_SIZE));
+    printf("hottest block %u written %u times, EEPROM wear-out in %.0f years\n", hottest, blockWrites[hottest],
+           wearOutYears);
+
+    TEST_ASSERT(bytesWritten <= NFC_NDEF_BLOCK_SIZE * bytesChanged);
+    TEST_ASSERT(wearOutYears >= TEST_WEAR_OUT_YEARS_MIN);
+};
+
+int main(void) {
+    _testRecord();
+    _testLongestText();
+    _testWriteAmplification();
+
+    return EXIT_SUCCESS;
+};
@@ -0,0 +1,127 @@
+/**
+ * @brief Round trip of log chunks packing and malformed blocks rejection
+ * @details Storage chunks of erased flash, sealed record pages with sector header and random bytes are packed and
+ * unpacked at all sizes up to the chunk limit. Random bytes should fall back to stored raw block, the worst case.
+ * Truncated blocks and corrupted tokens should be rejected by the phone side decoder without writing out of buffer.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "nfc/nfc_pack.h"
+#include "storage/storage_record.h"
+#include "./test.h"
+#include "./test_fixture.h"
+
+#define TEST_PAGE_SIZE                      (256)
+#define TEST_CHUNK_SIZE                     (NFC_PACK_CHUNK_SIZE_MAX)
+#define TEST_SECTOR_HEADER_SIZE             (8)
+#define TEST_GUARD                          (0xA5)
+#define TEST_GUARD_SIZE                     (64)
+
+// sector start: header, pages of sealed records, the last one half written, erased tail
+static void _fillLogChunk(uint8_t *const chunk) {
+    TSensorsStorageData sample = {
+            .timestamp = TEST_FIXTURE_EPOCH,
+            .sht3XTemperatureHumiditySensorData = {26214, 30000}
+    };
+    const uint32_t header[2] = {7, ~7U};
+
+    memset(chunk, 0xFF, TEST_CHUNK_SIZE);
+    memcpy(chunk, header, sizeof(header));
+
+    for (uint32_t page = 0; page < TEST_CHUNK_SIZE / TEST_PAGE_SIZE; page++) {
+        uint8_t *const block = chunk + page * TEST_PAGE_SIZE;
+        const uint32_t end = (TEST_CHUNK_SIZE / TEST_PAGE_SIZE - 1 == page) ? TEST_PAGE_SIZE / 2 : TEST_PAGE_SIZE;
+        uint32_t offset = (0 == page) ? TEST_SECTOR_HEADER_SIZE : 0;
+        TStorageRecordCodec codec;
+        size_t recordSize;
+
+        STORAGE_RECORD_Reset(&codec);
+        while (0 != (recordSize = STORAGE_RECORD_Encode(&codec, &sample, block + offset, end - offset))) {
+            offset += recordSize;
+            TEST_FIXTURE_FridgeStep(&sample);
+        }
+        STORAGE_RECORD_Seal(&codec, block + offset, end - offset);
+    }
+};
+
+/** @return block size */
+static size_t _testRoundTrip(const uint8_t *const chunk, size_t size) {
+    static uint8_t block[NFC_PACK_BLOCK_SIZE(TEST_CHUNK_SIZE)];
+    static uint8_t unpacked[TEST_CHUNK_SIZE + TEST_GUARD_SIZE];
+    const size_t blockSize = NFC_PACK_Encode(chunk, size, block);
+
+    TEST_ASSERT(blockSize >= NFC_PACK_HEADER_SIZE);
+    TEST_ASSERT(blockSize <= NFC_PACK_BLOCK_SIZE(size));
+
+    memset(unpacked, TEST_GUARD, sizeof(unpacked));
+    TEST_ASSERT_EQUAL(size, NFC_PACK_Decode(block, blockSize, unpacked, size));
+    TEST_ASSERT(0 == memcmp(chunk, unpacked, size));
+    TEST_ASSERT_EQUAL(TEST_GUARD, unpacked[size]);
+
+    // any truncation is detected, chunk does not fit smaller buffer
+    for (size_t truncated = 0; truncated < blockSize; truncated++)
+        TEST_ASSERT_EQUAL(0, NFC_PACK_Decode(block, truncated, unpacked, size));
+    if (0 != size) TEST_ASSERT_EQUAL(0, NFC_PACK_Decode(block, blockSize, unpacked, size - 1));
+
+    return blockSize;
+};
+
+static void _testChunk(const char *name, const uint8_t *const chunk, size_t expectedMax) {
+    size_t blockSize = 0;
+
+    for (size_t size = 0; size <= TEST_CHUNK_SIZE; size++)
+        blockSize = _testRoundTrip(chunk, size);
+
+    printf("%-8s chunk %u B packed to %4u B (%.1f%%)\n", name, TEST_CHUNK_SIZE, (unsigned) blockSize,
+           100.0 * blockSize / TEST_CHUNK_SIZE);
+    TEST_ASSERT(blockSize <= expectedMax);
+};
+
+// decoder never writes past the chunk size of the header, whatever the tokens are
+static void _testCorrupted(const uint8_t *const chunk) {
+    static uint8_t block[NFC_PACK_BLOCK_SIZE(TEST_CHUNK_SIZE)];
+    static uint8_t unpacked[TEST_CHUNK_SIZE + TEST_GUARD_SIZE];
+    const size_t blockSize = NFC_PACK_Encode(chunk, TEST_CHUNK_SIZE, block);
+    uint32_t rejected = 0;
+
+    for (size_t i = NFC_PACK_HEADER_SIZE; i < blockSize; i++) {
+        const uint8_t original = block[i];
+
+        for (uint32_t bit = 0; bit < 8; bit++) {
+            block[i] = original ^ (uint8_t) (1 << bit);
+            memset(unpacked, TEST_GUARD, sizeof(unpacked));
+
+            const size_t size = NFC_PACK_Decode(block, blockSize, unpacked, TEST_CHUNK_SIZE);
+
+            TEST_ASSERT((0 == size) || (TEST_CHUNK_SIZE == size));
+            for (size_t j = TEST_CHUNK_SIZE; j < sizeof(unpacked); j++) TEST_ASSERT_EQUAL(TEST_GUARD, unpacked[j]);
+            rejected += (0 == size);
+        }
+        block[i] = original;
+    }
+
+    printf("corrupted tokens: %u of %u bit flips rejected by block structure\n", rejected,
+           (unsigned) (8 * (blockSize - NFC_PACK_HEADER_SIZE)));
+};
+
+int main(void) {
+    static uint8_t chunk[TEST_CHUNK_SIZE];
+    static uint8_t block[NFC_PACK_BLOCK_SIZE(TEST_CHUNK_SIZE + 1)];
+
+    TEST_ASSERT_EQUAL(0, NFC_PACK_Encode(block, TEST_CHUNK_SIZE + 1, block));
+
+    memset(chunk, 0xFF, sizeof(chunk));
+    _testChunk("erased", chunk, TEST_CHUNK_SIZE / 10);
+
+    _fillLogChunk(chunk);
+    _testChunk("log", chunk, TEST_CHUNK_SIZE * 7 / 8);
+    _testCorrupted(chunk);
+
+    for (size_t i = 0; i < sizeof(chunk); i++) chunk[i] = (uint8_t) TEST_FIXTURE_Random();
+    _testChunk("random", chunk, NFC_PACK_BLOCK_SIZE(TEST_CHUNK_SIZE));
+    TEST_ASSERT_EQUAL(NFC_PACK_BLOCK_SIZE(TEST_CHUNK_SIZE), _testRoundTrip(chunk, TEST_CHUNK_SIZE));
+
+    return EXIT_SUCCESS;
+};
@@ -0,0 +1,91 @@
+#include <string.h>
+
+#include "./test_phone.h"
+#include "../sim/sim.h"
+#include "../sim/sim_st25dv.h"
+
+static struct {
+    uint8_t request[SIM_ST25DV_MAILBOX_SIZE];
+    size_t requestSize;
+    uint8_t response[SIM_ST25DV_MAILBOX_SIZE];
+    TTestPhoneHandler onResponse;
+    TSimEventId event; /**< RF command in flight */
+    bool isDone;
+} phone;
+static TTestPhoneStats stats;
+
+static void _onPoll(uintptr_t context);
+
+static inline void _send(TSimTime rfTime, TSimCallback callback) {
+    phone.event = SIM_Schedule(SIM_GetTime() + rfTime, callback, 0);
+};
+
+static void _onGet(uintptr_t context) {
+    const size_t size = SIM_ST25DV_GetMessage(phone.response);
+
+    phone.event = SIM_NO_EVENT;
+    if (0 == size) return _send(SIM_ST25DV_RF_TIME_US(1), _onPoll);
+
+    stats.responses++;
+    stats.responseBytes += size;
+    if (phone.onResponse(phone.response, size)) return _send(SIM_ST25DV_RF_TIME_US(1), _onPoll);
+
+    phone.isDone = true;
+};
+
+static void _onPoll(uintptr_t context) {
+    const size_t size = SIM_ST25DV_GetMessageSize();
+
+    phone.event = SIM_NO_EVENT;
+    if (0 != size) return _send(SIM_ST25DV_RF_TIME_US(size), _onGet);
+
+    stats.polls++;
+    _send(SIM_ST25DV_RF_TIME_US(1), _onPoll);
+};
+
+static void _onPut(uintptr_t context) {
+    uint8_t stale[SIM_ST25DV_MAILBOX_SIZE];
+
+    phone.event = SIM_NO_EVENT;
+    if (SIM_ST25DV_PutMessage(phone.request, phone.requestSize)) {
+        stats.requests++;
+        return _send(SIM_ST25DV_RF_TIME_US(1), _onPoll);
+    }
+
+    // mailbox holds response to the request dropped before, read it out and put the request again
+    const size_t size = SIM_ST25DV_GetMessage(stale);
+    _send(SIM_ST25DV_RF_TIME_US(size + phone.requestSize), _onPut);
+};
+
+void TEST_PHONE_Initialize(void) {
+    memset(&phone, 0, sizeof(phone));
+    memset(&stats, 0, sizeof(stats));
+};
+
+void TEST_PHONE_Enter(void) {
+    SIM_ST25DV_SetField(true);
+};
+
+void TEST_PHONE_Leave(void) {
+    SIM_Cancel(phone.event);
+    phone.event = SIM_NO_EVENT;
+    SIM_ST25DV_SetField(false);
+};
+
+void TEST_PHONE_Request(const void *request, size_t size, TTestPhoneHandler onResponse) {
+    memcpy(phone.request, request, size);
+    phone.requestSize = size;
+    phone.onResponse = onResponse;
+    phone.isDone = false;
+
+    SIM_Cancel(phone.event);
+    _send(SIM_ST25DV_RF_TIME_US(size), _onPut);
+};
+
+bool TEST_PHONE_IsDone(void) {
+    return phone.isDone;
+};
+
+const TTestPhoneStats *TEST_PHONE_GetStats(void) {
+    return &stats;
+};
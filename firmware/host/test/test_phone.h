@@ -0,0 +1,60 @@
+/**
+ * @file test_phone.h
+ * @brief Phone reading the tag over ST25DV Fast Transfer mailbox, for tests of NFC commands
+ *
+ * @details Phone puts request to the mailbox, then polls for host message and reads each response, as the app does
+ * with Read Message Length / Read Message commands. RF time is kept by SIM_ST25DV_RF_TIME_US of each command,
+ * so download throughput is limited by RF as on the target. Response handler decides if more responses follow.
+ */
+
+#ifndef TEST_PHONE_H
+#define TEST_PHONE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef    __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Response read from mailbox
+ * @return true if more responses are expected, phone keeps polling
+ */
+typedef bool (*TTestPhoneHandler)(const uint8_t *response, size_t size);
+
+/** @brief Phone counters */
+typedef struct {
+    uint32_t requests;
+    uint32_t responses;
+    uint32_t polls; /**< Read Message Length commands with no message */
+    uint64_t responseBytes;
+} TTestPhoneStats;
+
+/** @brief Phone is away, counters are reset */
+void TEST_PHONE_Initialize(void);
+
+/** @brief Phone enters the field */
+void TEST_PHONE_Enter(void);
+
+/** @brief Phone leaves the field, request in flight is dropped */
+void TEST_PHONE_Leave(void);
+
+/**
+ * @brief Put request to mailbox once its RF command is sent, then poll for responses
+ * @details Message left in mailbox by host (response to a dropped request) is read and discarded first.
+ */
+void TEST_PHONE_Request(const void *request, size_t size, TTestPhoneHandler onResponse);
+
+/** @return true if handler has got the last response of the request, condition for TEST_FIRMWARE_RunUntil */
+bool TEST_PHONE_IsDone(void);
+
+/** @return counters since initialization */
+const TTestPhoneStats *TEST_PHONE_GetStats(void);
+
+#ifdef    __cplusplus
+}
+#endif
+
+#endif //TEST_PHONE_H
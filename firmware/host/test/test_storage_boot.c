@@ -0,0 +1,80 @@
+/**
+ * @brief Boot latency of log tail search over empty, half-full, full and wrapped logs
+ * @details Flash is filled with sealed log pages as storage writes them, checkpoint journal is left erased, so the
+ * tail is found by search. Firmware boots over each log till the tail is found: it should be at the last written page,
+ * with flash reads growing by log2 of log size rather than by its pages.
+ *
+ * Log is verified once the tail is found (STORAGE_VERIFY_LOG_ON_BOOT): every page from the oldest sector to the tail
+ * should be checked, and a page with a flipped byte should be the only one reported corrupted.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "definitions.h"
+#include "storage/storage_manager.h"
+#include "../sim/sim_drivers.h"
+#include "./test.h"
+#include "./test_firmware.h"
+
+#define TEST_BOOT_HORIZON_US                (10 * SIM_US_IN_S)
+// boot sector, checkpoint journal bisection, 1st and last sector headers, sectors and pages bisection
+#define TEST_FLASH_READS_MAX                (1 + 7 + 2 + 11 + 4)
+#define TEST_VERIFY_HORIZON_US              (600 * SIM_US_IN_S)
+
+extern TActiveObject *systemActorsList[ACTIVE_OBJECTS_MAX];
+
+// verification starts on the same event the tail is found, its first page read is the only one issued yet
+static bool _isTailFound(void) {
+    const TActiveObject *const AO = systemActorsList[STORAGE_AO_ID];
+
+    return (NULL != AO) && ((STORAGE_ST_VERIFY_LOG == AO->state->name) || (STORAGE_ST_IDLE == AO->state->name));
+};
+
+static void _testBoot(const char *name, uint32_t tailSequence, uint32_t tailPages, uint32_t corruptedPage) {
+    const uint32_t tailPageAddress = (0 == tailPages) ? LOG_DATA_START_ADDRESS :
+                                     LOG_SECTOR_ADDRESS(tailSequence % LOG_SECTORS_MAX) +
+                                     (tailPages - 1) * DRV_AT25DF_PAGE_SIZE;
+
+    TEST_FIRMWARE_FillLog(tailSequence, tailPages);
+    if (0 != corruptedPage) SIM_MEMORY_GetFlash()[LOG_DATA_START_ADDRESS + corruptedPage * DRV_AT25DF_PAGE_SIZE + 7] ^= 0x10;
+    TEST_FIRMWARE_Boot(TEST_VERIFY_HORIZON_US);
+    TEST_ASSERT(TEST_FIRMWARE_RunUntil(_isTailFound));
+    TEST_ASSERT(SIM_GetTime() <= TEST_BOOT_HORIZON_US);
+
+    const TSTORAGEActiveObject *const storageAO = (TSTORAGEActiveObject *) systemActorsList[STORAGE_AO_ID];
+    const TSimMemoryStats *const flash = SIM_MEMORY_GetStats();
+
+    const uint32_t sectors = (0 == tailPages) ? 0 : tailSequence + 1 - LOG_OLDEST_SECTOR_SEQUENCE(tailSequence);
+    const uint32_t pages = (0 == tailPages) ? 0 : (sectors - 1) * LOG_PAGES_IN_SECTOR + tailPages;
+
+    const uint32_t bootReads = flash->commands - ((STORAGE_ST_VERIFY_LOG == storageAO->super.state->name) ? 1 : 0);
+    const double bootMs = (double) SIM_GetTime() / SIM_US_IN_MS;
+
+    TEST_ASSERT_EQUAL(tailPageAddress, storageAO->flash.writeAddress);
+    TEST_ASSERT_EQUAL(tailSequence, storageAO->flash.sequence);
+    TEST_ASSERT(bootReads <= TEST_FLASH_READS_MAX);
+
+    TEST_ASSERT(TEST_FIRMWARE_RunUntil(TEST_FIRMWARE_IsStorageIdle));
+    const TStorageVerifyReport *const verify = STORAGE_GetVerifyReport();
+
+    printf("%-9s log %5u pages: boot %7.3f ms, %2u flash reads (page scan: %5u reads); "
+           "verify %8.1f ms, %5u pages, %u corrupted\n", name, pages, bootMs, bootReads, pages + 1,
+           (double) SIM_GetTime() / SIM_US_IN_MS - bootMs, verify->pagesChecked, verify->pagesCorrupted);
+
+    TEST_ASSERT_EQUAL(0, flash->pagesProgrammed);
+    TEST_ASSERT_EQUAL(1, verify->runs);
+    TEST_ASSERT_EQUAL((0 == pages) ? 1 : pages, verify->pagesChecked); // erased first page of empty log
+    TEST_ASSERT_EQUAL((0 == corruptedPage) ? 0 : 1, verify->pagesCorrupted);
+};
+
+int main(void) {
+    _testBoot("empty", 0, 0, 0);
+    _testBoot("1 page", 0, 1, 0);
+    _testBoot("half", LOG_SECTORS_MAX / 2, 7, 0);
+    _testBoot("full", LOG_SECTORS_MAX - 2, LOG_PAGES_IN_SECTOR, 0);
+    _testBoot("wrapped", LOG_SECTORS_MAX + 5, 3, 0);
+    _testBoot("corrupted", LOG_SECTORS_MAX / 2, 7, LOG_PAGES_IN_SECTOR + 3);
+
+    return EXIT_SUCCESS;
+};
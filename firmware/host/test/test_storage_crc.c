@@ -0,0 +1,159 @@
+/**
+ * @brief CRC-16 of log blocks against bitwise reference, log verification throughput
+ * @details Slicing-by-4 CRC is checked by the CRC-16/MCRF4XX check value and against bitwise CRC over all lengths and
+ * alignments, split into chunks anyhow. Host MB/s is measured for CRC and for page verification of an 8MB log.
+ *
+ * Cortex-M0+ cycles are estimated by instruction count of the loops (Thumb-1, 48MHz, 1 NVM wait state for tables
+ * in flash): there is no target in the host build to measure them on.
+ */
+
+#define _DEFAULT_SOURCE // clock_gettime
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "storage/storage_crc.h"
+#include "storage/storage_record.h"
+#include "./test.h"
+#include "./test_fixture.h"
+
+#define TEST_PAGE_SIZE                      (256)
+#define TEST_LOG_SIZE                       (8UL * 1024 * 1024)
+#define TEST_LENGTH_MAX                     (300)
+#define TEST_BENCH_PASSES                   (8)
+#define TEST_CHECK_VALUE                    (0x6F91) // CRC-16/MCRF4XX of "123456789"
+
+/*
+ * Cortex-M0+ cycles: LDR 2, LDRH from NVM table 3, ALU 1, taken branch 2.
+ * Word step: load and xor 3, 4 byte extracts 6, 4 index shifts 4, 3 table bases 3, 4 lookups 12, 3 xors 3, loop 5.
+ * Byte step (unaligned head and tail): load 2, xor and extract 2, shift 1, lookup 3, fold 2, loop 4.
+ * Bitwise: load and xor 3, 8 times shift, conditional xor and loop 5.
+ */
+#define TEST_M0_CYCLES_PER_WORD             (3 + 6 + 4 + 3 + 12 + 3 + 5)
+#define TEST_M0_CYCLES_PER_BYTE             (2 + 2 + 1 + 3 + 2 + 4)
+#define TEST_M0_CYCLES_PER_BYTE_BITWISE     (3 + 8 * 5)
+#define TEST_M0_CALL_CYCLES                 (20)
+#define TEST_M0_CLOCK_HZ                    (48000000UL)
+#define TEST_SPI_PAGE_READ_US               ((4 + TEST_PAGE_SIZE) * 8) // SPI at 1MHz, command and page
+
+// reflected 0x1021, init 0xFFFF, no final xor
+static uint16_t _crcBitwise(uint16_t crc, const uint8_t *data, size_t size) {
+    while (0 != size--) {
+        crc ^= *data++;
+        for (uint8_t bit = 0; bit < 8; bit++)
+            crc = (crc & 1) ? (crc >> 1) ^ 0x8408 : crc >> 1;
+    }
+    return crc;
+};
+
+static double _now(void) {
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double) time.tv_sec + time.tv_nsec / 1e9;
+};
+
+static void _testCheckValue(void) {
+    const char *const check = "123456789";
+
+    TEST_ASSERT_EQUAL(TEST_CHECK_VALUE, STORAGE_CRC16_Update(STORAGE_CRC16_INIT, (const uint8_t *) check, 9));
+    TEST_ASSERT_EQUAL(TEST_CHECK_VALUE, _crcBitwise(STORAGE_CRC16_INIT, (const uint8_t *) check, 9));
+    TEST_ASSERT_EQUAL(STORAGE_CRC16_INIT, STORAGE_CRC16_Update(STORAGE_CRC16_INIT, NULL, 0));
+};
+
+// word steps start at any alignment of data, result does not depend on how data is chunked
+static void _testAgainstBitwise(void) {
+    static uint8_t buffer[TEST_LENGTH_MAX + sizeof(uint32_t)] __attribute__((aligned(4)));
+
+    for (size_t i = 0; i < sizeof(buffer); i++)
+        buffer[i] = (uint8_t) TEST_FIXTURE_Random();
+
+    for (size_t alignment = 0; alignment < sizeof(uint32_t); alignment++) {
+        const uint8_t *const data = buffer + alignment;
+
+        for (size_t size = 0; size <= TEST_LENGTH_MAX; size++) {
+            const uint16_t expected = _crcBitwise(STORAGE_CRC16_INIT, data, size);
+            const size_t split = (0 == size) ? 0 : TEST_FIXTURE_Random() % size;
+
+            TEST_ASSERT_EQUAL(expected, STORAGE_CRC16_Update(STORAGE_CRC16_INIT, data, size));
+            TEST_ASSERT_EQUAL(expected, STORAGE_CRC16_Update(STORAGE_CRC16_Update(STORAGE_CRC16_INIT, data, split),
+                                                             data + split, size - split));
+        }
+    }
+};
+
+// fridge-like samples: small deltas, one page block sealed per page, as storage flushes full pages
+static void _fillLog(uint8_t *const log) {
+    TSensorsStorageData sample = {
+            .timestamp = TEST_FIXTURE_EPOCH,
+            .sht3XTemperatureHumiditySensorData = {26214, 30000}
+    };
+
+    memset(log, 0xFF, TEST_LOG_SIZE);
+    for (uint32_t address = 0; address < TEST_LOG_SIZE; address += TEST_PAGE_SIZE) {
+        TStorageRecordCodec codec;
+        uint32_t offset = 0;
+        size_t recordSize;
+
+        STORAGE_RECORD_Reset(&codec);
+        while (0 != (recordSize = STORAGE_RECORD_Encode(&codec, &sample, log + address + offset,
+                                                        TEST_PAGE_SIZE - offset))) {
+            offset += recordSize;
+            TEST_FIXTURE_FridgeStep(&sample);
+        }
+        STORAGE_RECORD_Seal(&codec, log + address + offset, TEST_PAGE_SIZE - offset);
+    }
+};
+
+static void _bench(void) {
+    static uint8_t log[TEST_LOG_SIZE] __attribute__((aligned(4)));
+    const double megabytes = (double) TEST_BENCH_PASSES * TEST_LOG_SIZE / (1024 * 1024);
+    uint32_t crcSum = 0;
+    uint32_t bitwiseSum = 0;
+    uint32_t validPages = 0;
+    double start;
+
+    _fillLog(log);
+
+    start = _now();
+    for (uint32_t pass = 0; pass < TEST_BENCH_PASSES; pass++)
+        for (uint32_t address = 0; address < TEST_LOG_SIZE; address += TEST_PAGE_SIZE)
+            crcSum += STORAGE_CRC16_Update(STORAGE_CRC16_INIT, log + address, TEST_PAGE_SIZE);
+    const double crcS = _now() - start;
+
+    start = _now();
+    for (uint32_t address = 0; address < TEST_LOG_SIZE; address += TEST_PAGE_SIZE)
+        bitwiseSum += _crcBitwise(STORAGE_CRC16_INIT, log + address, TEST_PAGE_SIZE);
+    const double bitwiseS = (_now() - start) * TEST_BENCH_PASSES;
+
+    start = _now();
+    for (uint32_t pass = 0; pass < TEST_BENCH_PASSES; pass++)
+        for (uint32_t address = 0; address < TEST_LOG_SIZE; address += TEST_PAGE_SIZE)
+            validPages += STORAGE_RECORD_IsValidBlock(log + address, TEST_PAGE_SIZE);
+    const double verifyS = _now() - start;
+
+    TEST_ASSERT_EQUAL(TEST_BENCH_PASSES * bitwiseSum, crcSum);
+    TEST_ASSERT_EQUAL(TEST_BENCH_PASSES * (TEST_LOG_SIZE / TEST_PAGE_SIZE), validPages);
+
+    const uint32_t pageCycles = TEST_M0_CALL_CYCLES + (TEST_PAGE_SIZE / sizeof(uint32_t)) * TEST_M0_CYCLES_PER_WORD;
+    const uint32_t pageCyclesBitwise = TEST_M0_CALL_CYCLES + TEST_PAGE_SIZE * TEST_M0_CYCLES_PER_BYTE_BITWISE;
+    const uint32_t pageCyclesBytewise = TEST_M0_CALL_CYCLES + TEST_PAGE_SIZE * TEST_M0_CYCLES_PER_BYTE;
+    const double pageUs = (double) pageCycles * 1e6 / TEST_M0_CLOCK_HZ;
+
+    printf("host: CRC %.0f MB/s (bitwise %.0f MB/s), page verification %.0f MB/s\n", megabytes / crcS,
+           megabytes / bitwiseS, megabytes / verifyS);
+    printf("cortex-m0+ estimate: %u cycles/page (%.1f cycles/byte), byte table %u, bitwise %u\n", pageCycles,
+           (double) pageCycles / TEST_PAGE_SIZE, pageCyclesBytewise, pageCyclesBitwise);
+    printf("cortex-m0+ estimate: 8MB log CRC %.2f s at 48MHz, SPI read %.1f s at 1MHz\n",
+           pageUs * (TEST_LOG_SIZE / TEST_PAGE_SIZE) / 1e6,
+           (double) TEST_SPI_PAGE_READ_US * (TEST_LOG_SIZE / TEST_PAGE_SIZE) / 1e6);
+};
+
+int main(void) {
+    _testCheckValue();
+    _testAgainstBitwise();
+    _bench();
+
+    return EXIT_SUCCESS;
+};
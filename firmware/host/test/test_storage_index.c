@@ -0,0 +1,262 @@
+/**
+ * @brief Log index built as storage appends samples: zone map and excursions against the log recalculated
+ * @details 30 days of samples are encoded into log pages and sectors as storage does, index batches are taken at
+ * each page checkpoint and written to an index ring image. Entries parsed back (erased padding skipped by CRC)
+ * should match zones and excursions recalculated over all samples. Index pages a phone reads to find all excursions
+ * are reported against the log pages it would scan otherwise.
+ * Reboot in the middle of excursion should mark resumed entries partial, pending overflow should count drops.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "storage/storage_index.h"
+#include "storage/storage_record.h"
+#include "./test.h"
+#include "./test_fixture.h"
+
+#define TEST_PAGE_SIZE                      (256)
+#define TEST_SECTOR_SIZE                    (4096)
+#define TEST_SECTOR_HEADER_SIZE             (8)
+#define TEST_INDEX_SIZE                     (64 * 1024)
+#define TEST_ENTRIES_MAX                    (TEST_INDEX_SIZE / STORAGE_INDEX_ENTRY_SIZE)
+
+static TSensorsStorageData samples[TEST_FIXTURE_SAMPLES];
+static uint32_t positions[TEST_FIXTURE_SAMPLES]; /**< log position of each sample record */
+static uint8_t indexRing[TEST_INDEX_SIZE];
+static TStorageIndexEntry entries[TEST_ENTRIES_MAX];
+
+static uint8_t _range(uint16_t temperature) {
+    if (temperature > STORAGE_SUMMARY_TEMPERATURE_HIGH) return STORAGE_SUMMARY_RANGE_ABOVE;
+    if (temperature < STORAGE_SUMMARY_TEMPERATURE_LOW) return STORAGE_SUMMARY_RANGE_BELOW;
+    return STORAGE_SUMMARY_RANGE_IN;
+};
+
+// pending entries are written at the batch position, as storage does at checkpoint
+static void _checkpoint(TStorageIndex *const index) {
+    while (STORAGE_INDEX_TakeBatch(index, TEST_PAGE_SIZE)) {
+        TEST_ASSERT(index->position <= TEST_INDEX_SIZE);
+        memcpy(indexRing + index->batchPosition, index->entries, index->batchSize * STORAGE_INDEX_ENTRY_SIZE);
+        STORAGE_INDEX_BatchWritten(index);
+    }
+};
+
+/**
+ * @brief Append samples to log pages and sectors as storage does, index is checkpointed on each page
+ * @return log bytes
+ */
+static uint32_t _appendLog(TStorageIndex *const index) {
+    TStorageRecordCodec codec;
+    uint8_t page[TEST_PAGE_SIZE];
+    uint32_t position = TEST_SECTOR_HEADER_SIZE;
+    uint8_t range = STORAGE_SUMMARY_RANGE_IN;
+
+    STORAGE_RECORD_Reset(&codec);
+    for (uint32_t i = 0; i < TEST_FIXTURE_SAMPLES; i++) {
+        const uint32_t offset = position % TEST_PAGE_SIZE;
+        const size_t recordSize = STORAGE_RECORD_Encode(&codec, &samples[i], page + offset, TEST_PAGE_SIZE - offset);
+
+        if (0 == recordSize) {
+            // page is full: next page, next sector with header on sector end, checkpoint
+            position += TEST_PAGE_SIZE - offset;
+            STORAGE_RECORD_Reset(&codec);
+            if (0 == position % TEST_SECTOR_SIZE) {
+                STORAGE_INDEX_CloseZone(index, position - TEST_SECTOR_SIZE, TEST_SECTOR_SIZE);
+                position += TEST_SECTOR_HEADER_SIZE;
+            }
+            _checkpoint(index);
+            i--;
+            continue;
+        }
+
+        const uint8_t previousRange = range;
+
+        range = _range(samples[i].sht3XTemperatureHumiditySensorData.temperature);
+        positions[i] = position;
+        STORAGE_INDEX_Update(index, &samples[i], position, previousRange, range);
+        position += (uint32_t) recordSize;
+    }
+    _checkpoint(index);
+
+    return position;
+};
+
+/** @return valid entries of the index ring, erased padding is skipped */
+static uint32_t _parseIndex(uint32_t size) {
+    uint32_t count = 0;
+
+    for (uint32_t offset = 0; offset + STORAGE_INDEX_ENTRY_SIZE <= size; offset += STORAGE_INDEX_ENTRY_SIZE) {
+        TStorageIndexEntry entry;
+
+        memcpy(&entry, indexRing + offset, sizeof(entry));
+        if (entry.crc != STORAGE_CRC16_Update(STORAGE_CRC16_INIT, (const uint8_t *) &entry,
+                                              offsetof(TStorageIndexEntry, crc))) {
+            TEST_ASSERT_EQUAL(STORAGE_INDEX_ENTRY_ERASED, entry.type);
+            continue;
+        }
+        entries[count++] = entry;
+    }
+
+    return count;
+};
+
+static uint32_t _findSample(uint32_t position) {
+    for (uint32_t i = 0; i < TEST_FIXTURE_SAMPLES; i++)
+        if (positions[i] == position) return i;
+
+    TEST_ASSERT(false);
+    return 0;
+};
+
+// entry extremes, times and samples match the samples of its records
+static void _checkEntry(const TStorageIndexEntry *const entry, uint32_t first, uint32_t end) {
+    uint16_t temperatureMin = UINT16_MAX, temperatureMax = 0, humidityMin = UINT16_MAX, humidityMax = 0;
+
+    for (uint32_t i = first; i < end; i++) {
+        const TSHT3xTemperatureHumiditySensorData *const data = &samples[i].sht3XTemperatureHumiditySensorData;
+
+        if (data->temperature < temperatureMin) temperatureMin = data->temperature;
+        if (data->temperature > temperatureMax) temperatureMax = data->temperature;
+        if (data->humidity < humidityMin) humidityMin = data->humidity;
+        if (data->humidity > humidityMax) humidityMax = data->humidity;
+    }
+
+    TEST_ASSERT_EQUAL(end - first, entry->samples);
+    TEST_ASSERT_EQUAL(samples[first].timestamp, entry->startTimestamp);
+    TEST_ASSERT_EQUAL(samples[end - 1].timestamp, entry->endTimestamp);
+    TEST_ASSERT_EQUAL(temperatureMin, entry->temperatureMin);
+    TEST_ASSERT_EQUAL(temperatureMax, entry->temperatureMax);
+    TEST_ASSERT_EQUAL(humidityMin, entry->humidityMin);
+    TEST_ASSERT_EQUAL(humidityMax, entry->humidityMax);
+    TEST_ASSERT_EQUAL(0, entry->flags);
+};
+
+static void _testTrace(void) {
+    TStorageIndex index;
+    uint32_t zones = 0;
+    uint32_t excursions = 0;
+    uint32_t excursionPages = 0;
+    uint32_t first = 0;
+
+    TEST_FIXTURE_ColdChain(samples);
+    STORAGE_INDEX_Reset(&index, 0);
+    const uint32_t logSize = _appendLog(&index);
+    const uint32_t count = _parseIndex(index.position);
+
+    TEST_ASSERT_EQUAL(0, index.dropped);
+
+    // excursions are closed in order of their ends, zones in order of sectors
+    for (uint32_t i = 0; i < count; i++) {
+        const TStorageIndexEntry *const entry = &entries[i];
+
+        if (STORAGE_INDEX_ENTRY_ZONE == entry->type) {
+            const uint32_t end = _findSample(entry->endPosition + TEST_SECTOR_HEADER_SIZE);
+
+            TEST_ASSERT_EQUAL(zones * TEST_SECTOR_SIZE, entry->startPosition);
+            TEST_ASSERT_EQUAL(first, _findSample(entry->startPosition + TEST_SECTOR_HEADER_SIZE));
+            _checkEntry(entry, first, end);
+            first = end;
+            zones++;
+            continue;
+        }
+
+        TEST_ASSERT_EQUAL(STORAGE_INDEX_ENTRY_EXCURSION, entry->type);
+
+        const uint32_t start = _findSample(entry->startPosition);
+        const uint32_t end = _findSample(entry->endPosition);
+
+        TEST_ASSERT(STORAGE_SUMMARY_RANGE_IN != entry->range);
+        TEST_ASSERT(entry->range != _range(samples[start - 1].sht3XTemperatureHumiditySensorData.temperature));
+        TEST_ASSERT(entry->range != _range(samples[end].sht3XTemperatureHumiditySensorData.temperature));
+        for (uint32_t j = start; j < end; j++)
+            TEST_ASSERT_EQUAL(entry->range, _range(samples[j].sht3XTemperatureHumiditySensorData.temperature));
+        _checkEntry(entry, start, end);
+
+        excursionPages += (entry->endPosition - 1) / TEST_PAGE_SIZE - entry->startPosition / TEST_PAGE_SIZE + 1;
+        excursions++;
+    }
+
+    // every range change to out of range is an excursion, all of them are closed but the last open one
+    uint32_t expected = 0;
+    for (uint32_t i = 1; i < TEST_FIXTURE_SAMPLES; i++) {
+        const uint8_t range = _range(samples[i].sht3XTemperatureHumiditySensorData.temperature);
+
+        if ((STORAGE_SUMMARY_RANGE_IN != range) &&
+            (range != _range(samples[i - 1].sht3XTemperatureHumiditySensorData.temperature)))
+            expected++;
+    }
+
+    TEST_ASSERT_EQUAL(logSize / TEST_SECTOR_SIZE, zones);
+    TEST_ASSERT_EQUAL(expected - (STORAGE_INDEX_ENTRY_NONE != index.excursion.type), excursions);
+
+    printf("30 days: %u B log, index %u entries (%u zones, %u excursions) in %u B: %u index pages + %u log pages "
+           "of excursions to read instead of %u log pages\n", logSize, count, zones, excursions, index.position,
+           (index.position + TEST_PAGE_SIZE - 1) / TEST_PAGE_SIZE, excursionPages,
+           (logSize + TEST_PAGE_SIZE - 1) / TEST_PAGE_SIZE);
+};
+
+// reboot in the middle of excursion: zone and excursion resumed are partial, the next ones are not
+static void _testResume(void) {
+    const uint16_t in = STORAGE_SUMMARY_RAW_TEMPERATURE(5);
+    const uint16_t above = STORAGE_SUMMARY_RAW_TEMPERATURE(12);
+    TSensorsStorageData sample = {.timestamp = TEST_FIXTURE_EPOCH, .sht3XTemperatureHumiditySensorData = {above, 0}};
+    TStorageIndex index;
+
+    STORAGE_INDEX_Reset(&index, 0);
+    STORAGE_INDEX_ResumeZone(&index);
+    STORAGE_INDEX_Update(&index, &sample, 100, STORAGE_SUMMARY_RANGE_ABOVE, STORAGE_SUMMARY_RANGE_ABOVE);
+    sample.sht3XTemperatureHumiditySensorData.temperature = in;
+    STORAGE_INDEX_Update(&index, &sample, 103, STORAGE_SUMMARY_RANGE_ABOVE, STORAGE_SUMMARY_RANGE_IN);
+    sample.sht3XTemperatureHumiditySensorData.temperature = above;
+    STORAGE_INDEX_Update(&index, &sample, 106, STORAGE_SUMMARY_RANGE_IN, STORAGE_SUMMARY_RANGE_ABOVE);
+    sample.sht3XTemperatureHumiditySensorData.temperature = in;
+    STORAGE_INDEX_Update(&index, &sample, 109, STORAGE_SUMMARY_RANGE_ABOVE, STORAGE_SUMMARY_RANGE_IN);
+    STORAGE_INDEX_CloseZone(&index, 0, TEST_SECTOR_SIZE);
+    STORAGE_INDEX_Update(&index, &sample, TEST_SECTOR_SIZE + TEST_SECTOR_HEADER_SIZE, STORAGE_SUMMARY_RANGE_IN,
+                         STORAGE_SUMMARY_RANGE_IN);
+    STORAGE_INDEX_CloseZone(&index, TEST_SECTOR_SIZE, TEST_SECTOR_SIZE);
+
+    TEST_ASSERT_EQUAL(4, index.pending);
+    TEST_ASSERT_EQUAL(STORAGE_INDEX_ENTRY_EXCURSION, index.entries[0].type);
+    TEST_ASSERT_EQUAL(STORAGE_INDEX_FLAG_PARTIAL, index.entries[0].flags);
+    TEST_ASSERT_EQUAL(103, index.entries[0].endPosition);
+    TEST_ASSERT_EQUAL(STORAGE_INDEX_ENTRY_EXCURSION, index.entries[1].type);
+    TEST_ASSERT_EQUAL(0, index.entries[1].flags);
+    TEST_ASSERT_EQUAL(106, index.entries[1].startPosition);
+    TEST_ASSERT_EQUAL(STORAGE_INDEX_ENTRY_ZONE, index.entries[2].type);
+    TEST_ASSERT_EQUAL(STORAGE_INDEX_FLAG_PARTIAL, index.entries[2].flags);
+    TEST_ASSERT_EQUAL(STORAGE_INDEX_ENTRY_ZONE, index.entries[3].type);
+    TEST_ASSERT_EQUAL(0, index.entries[3].flags);
+};
+
+// batch never crosses page, entries closed while pending are full are dropped and counted
+static void _testBatches(void) {
+    const TSensorsStorageData sample = {.timestamp = TEST_FIXTURE_EPOCH};
+    TStorageIndex index;
+
+    STORAGE_INDEX_Reset(&index, TEST_PAGE_SIZE - STORAGE_INDEX_ENTRY_SIZE);
+    for (uint32_t i = 0; i < STORAGE_INDEX_PENDING_MAX + 2; i++) {
+        STORAGE_INDEX_Update(&index, &sample, i * TEST_SECTOR_SIZE, STORAGE_SUMMARY_RANGE_IN, STORAGE_SUMMARY_RANGE_IN);
+        STORAGE_INDEX_CloseZone(&index, i * TEST_SECTOR_SIZE, TEST_SECTOR_SIZE);
+    }
+
+    TEST_ASSERT_EQUAL(STORAGE_INDEX_PENDING_MAX, index.pending);
+    TEST_ASSERT_EQUAL(2, index.dropped);
+    TEST_ASSERT(STORAGE_INDEX_TakeBatch(&index, TEST_PAGE_SIZE));
+    TEST_ASSERT_EQUAL(TEST_PAGE_SIZE, index.batchPosition);
+    TEST_ASSERT_EQUAL(2 * TEST_PAGE_SIZE, index.position);
+    TEST_ASSERT(!STORAGE_INDEX_TakeBatch(&index, TEST_PAGE_SIZE)); // one batch at a time
+    STORAGE_INDEX_BatchWritten(&index);
+    TEST_ASSERT_EQUAL(0, index.pending);
+    TEST_ASSERT(!STORAGE_INDEX_TakeBatch(&index, TEST_PAGE_SIZE));
+};
+
+int main(void) {
+    _testResume();
+    _testBatches();
+
+    memset(indexRing, 0xFF, sizeof(indexRing));
+    _testTrace();
+
+    return EXIT_SUCCESS;
+};
@@ -0,0 +1,223 @@
+/**
+ * @brief Round trip of log record blocks and bytes per sample on cold chain traces
+ * @details 30-day traces are encoded into 256-byte page blocks as storage does, sealed once per page (records
+ * combined till page is full) or after each record (flush per sample). Each block is checked by decoding and by
+ * IsValidBlock, then damaged: a flipped bit or records left unsealed by power loss should be detected.
+ * Bytes per sample are reported against 16 bytes of the former fixed size record.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "storage/storage_record.h"
+#include "./test.h"
+#include "./test_fixture.h"
+
+#define TEST_PAGE_SIZE                      (256)
+#define TEST_FIXED_RECORD_SIZE              (SENSOR_RECURRING_STORAGE_DATA_SIZE)
+
+typedef void (*TTestTrace)(uint32_t i, TSensorsStorageData *const sample);
+
+// fridge at 5 C: temperature wanders by a few LSBs (~3 mC each), humidity by sensor noise, dark
+static void _fridge(uint32_t i, TSensorsStorageData *const sample) {
+    static int32_t temperature;
+
+    if (0 == i) temperature = 26214; // ~5 C
+    temperature += TEST_FIXTURE_Noise(2);
+
+    sample->timestamp = TEST_FIXTURE_EPOCH + TEST_FIXTURE_INTERVAL_S * i;
+    sample->sht3XTemperatureHumiditySensorData.temperature = (uint16_t) temperature;
+    sample->sht3XTemperatureHumiditySensorData.humidity = (uint16_t) (32768 + TEST_FIXTURE_Noise(6));
+    sample->ambientLightSensorData.ambientLight = 0;
+};
+
+// fridge door opened for 10 minutes every 4 hours: temperature ramps up, light is on, RTC jitters by a second
+static void _doorOpenings(uint32_t i, TSensorsStorageData *const sample) {
+    const uint32_t minuteOfCycle = i % (4 * 60);
+    const bool isOpen = minuteOfCycle < 10;
+
+    _fridge(i, sample);
+    sample->timestamp += TEST_FIXTURE_Noise(1);
+    if (isOpen) {
+        sample->sht3XTemperatureHumiditySensorData.temperature += 120 * minuteOfCycle;
+        sample->sht3XTemperatureHumiditySensorData.humidity += 400 * minuteOfCycle;
+        sample->ambientLightSensorData.ambientLight = 30000 + TEST_FIXTURE_Noise(500);
+    }
+};
+
+// worst case: random values, sampling restarted with hour-long gaps now and then
+static void _randomValues(uint32_t i, TSensorsStorageData *const sample) {
+    static uint32_t timestamp;
+
+    if (0 == i) timestamp = TEST_FIXTURE_EPOCH;
+    timestamp += (0 == TEST_FIXTURE_Random() % 500) ? 3600 : 60;
+
+    sample->timestamp = timestamp;
+    sample->sht3XTemperatureHumiditySensorData.temperature = (uint16_t) TEST_FIXTURE_Random();
+    sample->sht3XTemperatureHumiditySensorData.humidity = (uint16_t) TEST_FIXTURE_Random();
+    sample->ambientLightSensorData.ambientLight = TEST_FIXTURE_Random();
+};
+
+static bool _isEqual(const TSensorsStorageData *const a, const TSensorsStorageData *const b) {
+    return (a->timestamp == b->timestamp) &&
+           (a->sht3XTemperatureHumiditySensorData.temperature == b->sht3XTemperatureHumiditySensorData.temperature) &&
+           (a->sht3XTemperatureHumiditySensorData.humidity == b->sht3XTemperatureHumiditySensorData.humidity) &&
+           (a->ambientLightSensorData.ambientLight == b->ambientLightSensorData.ambientLight);
+};
+
+/**
+ * @brief Decode page block and compare with the samples it was encoded from
+ * @return samples decoded
+ */
+static uint32_t _decodePage(const uint8_t *const page, const TSensorsStorageData *const expected) {
+    TStorageRecordCodec codec;
+    TSensorsStorageData sample;
+    uint32_t offset = 0;
+    uint32_t samples = 0;
+    size_t recordSize;
+
+    STORAGE_RECORD_Reset(&codec);
+    while (0 != (recordSize = STORAGE_RECORD_Decode(&codec, page + offset, TEST_PAGE_SIZE - offset, &sample))) {
+        offset += recordSize;
+        if (STORAGE_RECORD_SEAL_TAG == page[offset - recordSize]) continue;
+
+        TEST_ASSERT(_isEqual(&expected[samples], &sample));
+        samples++;
+    }
+
+    TEST_ASSERT(codec.isSealed);
+    TEST_ASSERT((TEST_PAGE_SIZE == offset) || (0xFF == page[offset]));
+
+    return samples;
+};
+
+// bit flips and torn writes are detected by block verifier
+static void _testDamagedPage(const uint8_t *const page, uint32_t used, uint32_t sealEvery) {
+    uint8_t damaged[TEST_PAGE_SIZE];
+
+    for (uint32_t offset = 0; offset < used; offset += 7) {
+        memcpy(damaged, page, TEST_PAGE_SIZE);
+        damaged[offset] ^= 1 << (offset % 8);
+        TEST_ASSERT(!STORAGE_RECORD_IsValidBlock(damaged, TEST_PAGE_SIZE));
+    }
+
+    // power lost before the last seal got to flash
+    if (1 == sealEvery) return;
+    memcpy(damaged, page, TEST_PAGE_SIZE);
+    memset(damaged + used - STORAGE_RECORD_SEAL_SIZE, 0xFF, STORAGE_RECORD_SEAL_SIZE);
+    TEST_ASSERT(!STORAGE_RECORD_IsValidBlock(damaged, TEST_PAGE_SIZE));
+};
+
+/**
+ * @brief Encode trace into page blocks, check each block
+ * @param sealEvery records per seal, as combined in RAM before flush, UINT32_MAX to seal once per page
+ */
+static void _testTrace(const char *name, TTestTrace trace, uint32_t sealEvery) {
+    static TSensorsStorageData samples[TEST_FIXTURE_SAMPLES];
+    uint8_t page[TEST_PAGE_SIZE];
+    uint32_t pages = 0;
+    uint32_t bytes = 0;
+    uint32_t decoded = 0;
+    uint32_t i = 0;
+
+    TEST_FIXTURE_Seed(TEST_FIXTURE_SEED);
+    for (uint32_t j = 0; j < TEST_FIXTURE_SAMPLES; j++)
+        trace(j, &samples[j]);
+
+    while (i < TEST_FIXTURE_SAMPLES) {
+        TStorageRecordCodec codec;
+        const uint32_t first = i;
+        uint32_t offset = 0;
+        uint32_t unsealed = 0;
+        size_t recordSize;
+
+        memset(page, 0xFF, sizeof(page));
+        STORAGE_RECORD_Reset(&codec);
+        while ((i < TEST_FIXTURE_SAMPLES) &&
+               (0 != (recordSize = STORAGE_RECORD_Encode(&codec, &samples[i], page + offset, TEST_PAGE_SIZE - offset)))) {
+            offset += recordSize;
+            i++;
+            if (++unsealed == sealEvery) {
+                offset += STORAGE_RECORD_Seal(&codec, page + offset, TEST_PAGE_SIZE - offset);
+                unsealed = 0;
+            }
+        }
+        offset += STORAGE_RECORD_Seal(&codec, page + offset, TEST_PAGE_SIZE - offset);
+
+        TEST_ASSERT(i > first);
+        TEST_ASSERT(STORAGE_RECORD_IsValidBlock(page, TEST_PAGE_SIZE));
+        TEST_ASSERT_EQUAL(i - first, _decodePage(page, &samples[first]));
+        _testDamagedPage(page, offset, sealEvery);
+
+        pages++;
+        bytes += offset;
+        decoded += i - first;
+    }
+
+    TEST_ASSERT_EQUAL(TEST_FIXTURE_SAMPLES, decoded);
+
+    printf("%-14s %-9s %5.2f B/sample encoded, %5.2f B/sample of flash pages, %4.1fx of %u B records\n", name,
+           (1 == sealEvery) ? "flush" : "page fill", (double) bytes / TEST_FIXTURE_SAMPLES,
+           (double) pages * TEST_PAGE_SIZE / TEST_FIXTURE_SAMPLES,
+           (double) TEST_FIXED_RECORD_SIZE * TEST_FIXTURE_SAMPLES / ((double) pages * TEST_PAGE_SIZE),
+           TEST_FIXED_RECORD_SIZE);
+};
+
+// deltas wrap around field width, extreme steps survive round trip
+static void _testExtremeDeltas(void) {
+    const TSensorsStorageData extremes[] = {
+            {.timestamp = 0, .sht3XTemperatureHumiditySensorData = {0, UINT16_MAX}, .ambientLightSensorData = {0}},
+            {.timestamp = 1, .sht3XTemperatureHumiditySensorData = {UINT16_MAX, 0}, .ambientLightSensorData = {UINT32_MAX}},
+            {.timestamp = 2, .sht3XTemperatureHumiditySensorData = {0x8000, 0x7FFF}, .ambientLightSensorData = {0x80000000}},
+            {.timestamp = UINT32_MAX, .sht3XTemperatureHumiditySensorData = {1, 1}, .ambientLightSensorData = {1}},
+            {.timestamp = 5, .sht3XTemperatureHumiditySensorData = {1, 1}, .ambientLightSensorData = {1}},
+    };
+    uint8_t page[TEST_PAGE_SIZE];
+    TStorageRecordCodec codec;
+    uint32_t offset = 0;
+
+    memset(page, 0xFF, sizeof(page));
+    STORAGE_RECORD_Reset(&codec);
+    for (uint32_t i = 0; i < sizeof(extremes) / sizeof(extremes[0]); i++) {
+        const size_t recordSize = STORAGE_RECORD_Encode(&codec, &extremes[i], page + offset, TEST_PAGE_SIZE - offset);
+
+        TEST_ASSERT(0 != recordSize);
+        TEST_ASSERT(0xFF != page[offset]); // record never starts as erased flash
+        offset += recordSize;
+    }
+    offset += STORAGE_RECORD_Seal(&codec, page + offset, TEST_PAGE_SIZE - offset);
+
+    TEST_ASSERT(STORAGE_RECORD_IsValidBlock(page, TEST_PAGE_SIZE));
+    TEST_ASSERT_EQUAL(sizeof(extremes) / sizeof(extremes[0]), _decodePage(page, extremes));
+};
+
+// encoder keeps room for the seal, a record which does not fit leaves codec state unchanged
+static void _testPageEnd(void) {
+    const TSensorsStorageData sample = {.timestamp = TEST_FIXTURE_EPOCH};
+    uint8_t page[TEST_PAGE_SIZE];
+    TStorageRecordCodec codec;
+
+    STORAGE_RECORD_Reset(&codec);
+    TEST_ASSERT_EQUAL(0, STORAGE_RECORD_Encode(&codec, &sample, page,
+                                               STORAGE_RECORD_BLOCK_START_SIZE + STORAGE_RECORD_SEAL_SIZE - 1));
+    TEST_ASSERT(!codec.isBlockStarted);
+    TEST_ASSERT_EQUAL(0, STORAGE_RECORD_Seal(&codec, page, TEST_PAGE_SIZE)); // nothing to seal
+    TEST_ASSERT_EQUAL(STORAGE_RECORD_BLOCK_START_SIZE,
+                      STORAGE_RECORD_Encode(&codec, &sample, page,
+                                            STORAGE_RECORD_BLOCK_START_SIZE + STORAGE_RECORD_SEAL_SIZE));
+    TEST_ASSERT_EQUAL(STORAGE_RECORD_SEAL_SIZE, STORAGE_RECORD_Seal(&codec, page + STORAGE_RECORD_BLOCK_START_SIZE,
+                                                                    STORAGE_RECORD_SEAL_SIZE));
+};
+
+int main(void) {
+    _testExtremeDeltas();
+    _testPageEnd();
+
+    _testTrace("fridge", _fridge, UINT32_MAX);
+    _testTrace("fridge", _fridge, 1);
+    _testTrace("door openings", _doorOpenings, UINT32_MAX);
+    _testTrace("door openings", _doorOpenings, 1);
+    _testTrace("random", _randomValues, UINT32_MAX);
+
+    return EXIT_SUCCESS;
+};
@@ -0,0 +1,158 @@
+/**
+ * @brief Incremental summary statistics against the whole log recalculated
+ * @details 30 days of cold chain samples with door openings, a transit heat excursion and a freezer mistake are
+ * accounted one by one and compared with statistics recalculated over all samples in double precision:
+ * extremes and time out of range exactly, mean within a LSB, mean kinetic temperature within 0.01 C.
+ * Steady temperature should give MKT of itself, a year at 40 C should not overflow fixed point sum.
+ */
+
+#include <stdio.h>
+#include <math.h>
+
+#include "storage/storage_summary.h"
+#include "./test.h"
+#include "./test_fixture.h"
+
+#define TEST_YEAR_SAMPLES                   (365 * 24 * 60)
+#define TEST_MKT_TOLERANCE_C                (0.01)
+#define TEST_RAW_PER_C                      (65535.0 / 175.0)
+
+typedef struct {
+    uint32_t secondsAbove;
+    uint32_t secondsBelow;
+    uint32_t excursions;
+    uint16_t temperatureMin;
+    uint16_t temperatureMax;
+    uint16_t humidityMin;
+    uint16_t humidityMax;
+    double meanTemperature; /**< raw */
+    double meanKineticTemperature; /**< C */
+} TTestReference;
+
+static TSensorsStorageData samples[TEST_FIXTURE_SAMPLES];
+
+static inline double _celsius(uint16_t raw) {
+    return -45.0 + 175.0 * raw / 65535.0;
+};
+
+static uint8_t _range(uint16_t temperature) {
+    if (temperature > STORAGE_SUMMARY_TEMPERATURE_HIGH) return STORAGE_SUMMARY_RANGE_ABOVE;
+    if (temperature < STORAGE_SUMMARY_TEMPERATURE_LOW) return STORAGE_SUMMARY_RANGE_BELOW;
+    return STORAGE_SUMMARY_RANGE_IN;
+};
+
+// recalculated over the whole log, as the phone would after full download
+static TTestReference _recalculate(const TSensorsStorageData *const trace, uint32_t size) {
+    TTestReference reference = {.temperatureMin = UINT16_MAX, .humidityMin = UINT16_MAX};
+    const double activationEnergyK = STORAGE_SUMMARY_ACTIVATION_ENERGY_K;
+    double temperatureSum = 0;
+    double arrheniusSum = 0;
+    uint8_t range = STORAGE_SUMMARY_RANGE_IN;
+
+    for (uint32_t i = 0; i < size; i++) {
+        const uint16_t temperature = trace[i].sht3XTemperatureHumiditySensorData.temperature;
+        const uint16_t humidity = trace[i].sht3XTemperatureHumiditySensorData.humidity;
+
+        if (0 != i) {
+            const uint32_t interval = trace[i].timestamp - trace[i - 1].timestamp;
+
+            if (STORAGE_SUMMARY_RANGE_ABOVE == range) reference.secondsAbove += interval;
+            if (STORAGE_SUMMARY_RANGE_BELOW == range) reference.secondsBelow += interval;
+        }
+        if ((STORAGE_SUMMARY_RANGE_IN != _range(temperature)) && (_range(temperature) != range)) reference.excursions++;
+        range = _range(temperature);
+
+        if (temperature < reference.temperatureMin) reference.temperatureMin = temperature;
+        if (temperature > reference.temperatureMax) reference.temperatureMax = temperature;
+        if (humidity < reference.humidityMin) reference.humidityMin = humidity;
+        if (humidity > reference.humidityMax) reference.humidityMax = humidity;
+
+        temperatureSum += temperature;
+        arrheniusSum += exp(-activationEnergyK / (_celsius(temperature) + 273.15));
+    }
+
+    reference.meanTemperature = temperatureSum / size;
+    reference.meanKineticTemperature = activationEnergyK / -log(arrheniusSum / size) - 273.15;
+
+    return reference;
+};
+
+static void _testTrace(void) {
+    TStorageSummary summary;
+
+    TEST_FIXTURE_ColdChain(samples);
+    STORAGE_SUMMARY_Reset(&summary);
+    for (uint32_t i = 0; i < TEST_FIXTURE_SAMPLES; i++)
+        STORAGE_SUMMARY_Update(&summary, &samples[i]);
+
+    const TTestReference reference = _recalculate(samples, TEST_FIXTURE_SAMPLES);
+    const double meanKinetic = _celsius(STORAGE_SUMMARY_GetMeanKineticTemperature(&summary));
+
+    printf("30 days: %u excursions, %u min above, %u min below, mean %.3f C, MKT %.3f C (recalculated %.3f C)\n",
+           summary.excursions, summary.secondsAbove / 60, summary.secondsBelow / 60,
+           _celsius(STORAGE_SUMMARY_GetMeanTemperature(&summary)), meanKinetic, reference.meanKineticTemperature);
+
+    TEST_ASSERT_EQUAL(TEST_FIXTURE_SAMPLES, summary.samples);
+    TEST_ASSERT_EQUAL(samples[0].timestamp, summary.firstTimestamp);
+    TEST_ASSERT_EQUAL(samples[TEST_FIXTURE_SAMPLES - 1].timestamp, summary.lastTimestamp);
+    TEST_ASSERT_EQUAL(reference.temperatureMin, summary.temperatureMin);
+    TEST_ASSERT_EQUAL(reference.temperatureMax, summary.temperatureMax);
+    TEST_ASSERT_EQUAL(reference.humidityMin, summary.humidityMin);
+    TEST_ASSERT_EQUAL(reference.humidityMax, summary.humidityMax);
+    TEST_ASSERT_EQUAL(reference.secondsAbove, summary.secondsAbove);
+    TEST_ASSERT_EQUAL(reference.secondsBelow, summary.secondsBelow);
+    TEST_ASSERT_EQUAL(reference.excursions, summary.excursions);
+    TEST_ASSERT(fabs(STORAGE_SUMMARY_GetMeanTemperature(&summary) - reference.meanTemperature) <= 1.0);
+    TEST_ASSERT(fabs(meanKinetic - reference.meanKineticTemperature) <= TEST_MKT_TOLERANCE_C);
+};
+
+static void _testSteady(double celsius, uint32_t size) {
+    const uint16_t raw = STORAGE_SUMMARY_RAW_TEMPERATURE(celsius);
+    TSensorsStorageData sample = {.timestamp = TEST_FIXTURE_EPOCH, .sht3XTemperatureHumiditySensorData = {raw, 30000}};
+    TStorageSummary summary;
+
+    STORAGE_SUMMARY_Reset(&summary);
+    for (uint32_t i = 0; i < size; i++, sample.timestamp += TEST_FIXTURE_INTERVAL_S)
+        STORAGE_SUMMARY_Update(&summary, &sample);
+
+    TEST_ASSERT_EQUAL(raw, STORAGE_SUMMARY_GetMeanTemperature(&summary));
+    TEST_ASSERT(abs((int32_t) STORAGE_SUMMARY_GetMeanKineticTemperature(&summary) - raw) <=
+                (int32_t) (TEST_MKT_TOLERANCE_C * TEST_RAW_PER_C + 1));
+};
+
+// no samples, time going back, direct jump from above to below range
+static void _testEdges(void) {
+    const uint16_t in = STORAGE_SUMMARY_RAW_TEMPERATURE(5);
+    const uint16_t above = STORAGE_SUMMARY_RAW_TEMPERATURE(12);
+    const uint16_t below = STORAGE_SUMMARY_RAW_TEMPERATURE(-5);
+    const TSensorsStorageData trace[] = {
+            {.timestamp = TEST_FIXTURE_EPOCH, .sht3XTemperatureHumiditySensorData = {above, 0}},
+            {.timestamp = TEST_FIXTURE_EPOCH + 60, .sht3XTemperatureHumiditySensorData = {above, 0}},
+            {.timestamp = TEST_FIXTURE_EPOCH + 30, .sht3XTemperatureHumiditySensorData = {below, 0}}, // RTC set back
+            {.timestamp = TEST_FIXTURE_EPOCH + 90, .sht3XTemperatureHumiditySensorData = {in, 0}},
+            {.timestamp = TEST_FIXTURE_EPOCH + 150, .sht3XTemperatureHumiditySensorData = {below, 0}},
+    };
+    TStorageSummary summary;
+
+    STORAGE_SUMMARY_Reset(&summary);
+    TEST_ASSERT_EQUAL(0, STORAGE_SUMMARY_GetMeanTemperature(&summary));
+    TEST_ASSERT_EQUAL(0, STORAGE_SUMMARY_GetMeanKineticTemperature(&summary));
+
+    for (uint32_t i = 0; i < sizeof(trace) / sizeof(trace[0]); i++)
+        STORAGE_SUMMARY_Update(&summary, &trace[i]);
+
+    TEST_ASSERT_EQUAL(3, summary.excursions);
+    TEST_ASSERT_EQUAL(60, summary.secondsAbove);
+    TEST_ASSERT_EQUAL(60, summary.secondsBelow);
+    TEST_ASSERT_EQUAL(STORAGE_SUMMARY_RANGE_BELOW, summary.range);
+};
+
+int main(void) {
+    _testEdges();
+    _testSteady(5.0, 1);
+    _testSteady(-18.0, TEST_FIXTURE_SAMPLES);
+    _testSteady(40.0, TEST_YEAR_SAMPLES);
+    _testTrace();
+
+    return EXIT_SUCCESS;
+};
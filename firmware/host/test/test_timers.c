@@ -0,0 +1,156 @@
+/**
+ * @brief Actor timers wheel against reference model on virtual time: no early, late, missed or stale expiry
+ * @details Timers are armed, re-armed and cancelled at random, with timeouts from a millisecond up to the max, while
+ * time jumps by random steps from microseconds to days, as tickless main loop sleeps. The only hardware compare is
+ * SYS_TIME over virtual clock: main loop runs TIMERS_Tasks() after each simulation event, as it does on wake up.
+ * Run starts an hour before the 32-bit SYS_TIME counter wraps and goes over many wraps.
+ *
+ * Scheduler is stubbed: each dispatched event should be of an armed timer, of its last arm, and fire at or after its
+ * timeout, at most TEST_LATE_US_MAX after it. Compares programmed per expiry are reported.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "definitions.h"
+#include "scheduler/scheduler.h"
+#include "timers/timers.h"
+#include "../sim/sim_drivers.h"
+#include "./test.h"
+#include "./test_fixture.h"
+
+#define TEST_OPERATIONS                     (200000)
+#define TEST_TICK_US                        ((SIM_US_IN_S + SYS_TIME_HW_COUNTER_FREQUENCY - 1) / SYS_TIME_HW_COUNTER_FREQUENCY)
+#define TEST_LATE_US_MAX                    (3 * TEST_TICK_US) // timeout rounded up to ticks, plus the arm tick phase
+#define TEST_COUNTER_WRAP_US                ((1ULL << 32) * SIM_US_IN_S / SYS_TIME_HW_COUNTER_FREQUENCY)
+#define TEST_JUMP_BITS_MAX                  (40) // us, ~6 days
+
+typedef struct {
+    bool isArmed;
+    uint32_t serial; /**< arm number, carried by event payload */
+    TSimTime armedAt;
+    uint32_t ms;
+} TTestTimer;
+
+static struct {
+    TTestTimer timers[TIMERS_MAX];
+    uint32_t serial;
+    uint32_t expiries;
+    uint32_t cancels;
+    uint32_t reArms;
+} model;
+
+static uint32_t actor; // events are dispatched by actor pointer only
+
+// log uniform: as many short timeouts and jumps as long ones
+static uint64_t _randomBits(uint32_t bitsMax) {
+    const uint32_t bits = TEST_FIXTURE_Random() % (bitsMax + 1);
+    const uint64_t value = ((uint64_t) TEST_FIXTURE_Random() << 32) | TEST_FIXTURE_Random();
+
+    return (0 == bits) ? 0 : value & ((1ULL << bits) - 1);
+};
+
+bool SCHEDULER_Dispatch(TActiveObject *const AO, TEvent event) {
+    TEST_ASSERT(AO == (TActiveObject *) &actor);
+    TEST_ASSERT((event.sig >= 0) && (event.sig < TIMERS_MAX));
+
+    TTestTimer *const timer = &model.timers[event.sig];
+    const TSimTime elapsed = SIM_GetTime() - timer->armedAt;
+
+    TEST_ASSERT(timer->isArmed);
+    TEST_ASSERT_EQUAL(timer->serial, (uintptr_t) event.payload);
+    TEST_ASSERT(elapsed >= (TSimTime) timer->ms * SIM_US_IN_MS);
+    TEST_ASSERT(elapsed <= (TSimTime) timer->ms * SIM_US_IN_MS + TEST_LATE_US_MAX);
+
+    timer->isArmed = false;
+    model.expiries++;
+    return true;
+};
+
+static void _arm(SYSTEM_TIMER_IDS id) {
+    TTestTimer *const timer = &model.timers[id];
+    const uint32_t ms = (uint32_t) _randomBits(30);
+
+    if (timer->isArmed) model.reArms++;
+    *timer = (TTestTimer) {
+            .isArmed = true,
+            .serial = ++model.serial,
+            .armedAt = SIM_GetTime(),
+            .ms = (ms > TIMERS_TIMEOUT_MS_MAX) ? TIMERS_TIMEOUT_MS_MAX : ms
+    };
+
+    TIMERS_Arm(id, (TActiveObject *) &actor,
+               (TEvent) {.sig = (int) id, .payload = (void *) (uintptr_t) timer->serial}, timer->ms);
+};
+
+static void _cancel(SYSTEM_TIMER_IDS id) {
+    if (model.timers[id].isArmed) model.cancels++;
+    model.timers[id].isArmed = false;
+
+    TIMERS_Cancel(id);
+};
+
+// main loop sleeps till the time, wakes up on compares on the way
+static void _sleep(TSimTime until) {
+    while (SIM_Step(until))
+        TIMERS_Tasks();
+
+    for (uint32_t id = 0; id < TIMERS_MAX; id++) {
+        const TTestTimer *const timer = &model.timers[id];
+
+        // not missed
+        if (timer->isArmed)
+            TEST_ASSERT(until - timer->armedAt <= (TSimTime) timer->ms * SIM_US_IN_MS + TEST_LATE_US_MAX);
+    }
+};
+
+static void _testRandom(void) {
+    const TSimTime start = TEST_COUNTER_WRAP_US - SIM_US_IN_HOUR;
+
+    SIM_Initialize(SIM_TIME_NEVER);
+    SIM_TIME_Initialize();
+    SIM_RunUntil(start);
+    TIMERS_Initialize();
+
+    for (uint32_t i = 0; i < TEST_OPERATIONS; i++) {
+        const SYSTEM_TIMER_IDS id = (SYSTEM_TIMER_IDS) (TEST_FIXTURE_Random() % TIMERS_MAX);
+
+        switch (TEST_FIXTURE_Random() % 8) {
+            case 0:
+            case 1:
+            case 2:
+                _arm(id);
+                break;
+            case 3:
+                _cancel(id);
+                break;
+            default:
+                _sleep(SIM_GetTime() + _randomBits(TEST_JUMP_BITS_MAX));
+                break;
+        }
+
+        for (uint32_t j = 0; j < TIMERS_MAX; j++)
+            TEST_ASSERT_EQUAL(model.timers[j].isArmed, TIMERS_IsArmed((SYSTEM_TIMER_IDS) j));
+    }
+
+    // drain: each armed timer expires
+    _sleep(SIM_GetTime() + (TSimTime) TIMERS_TIMEOUT_MS_MAX * SIM_US_IN_MS + TEST_LATE_US_MAX);
+    for (uint32_t id = 0; id < TIMERS_MAX; id++)
+        TEST_ASSERT(!TIMERS_IsArmed((SYSTEM_TIMER_IDS) id));
+
+    const uint32_t wraps = (uint32_t) ((SIM_GetTime() - start) / TEST_COUNTER_WRAP_US);
+    const uint32_t compares = SIM_GetStats()->eventsFired;
+
+    printf("%u operations over %.0f days (%u counter wraps): %u expiries, %u re-arms, %u cancels, "
+           "%u compares (%.2f per expiry)\n", TEST_OPERATIONS, (double) (SIM_GetTime() - start) / (24 * SIM_US_IN_HOUR),
+           wraps, model.expiries, model.reArms, model.cancels, compares, (double) compares / model.expiries);
+
+    TEST_ASSERT(wraps >= 1);
+    TEST_ASSERT(model.expiries > 0);
+};
+
+int main(void) {
+    _testRandom();
+
+    return EXIT_SUCCESS;
+};
@@ -2,10 +2,15 @@
 
 static TActiveObject appAO;
 static TEvent events[APP_QUEUE_MAX_CAPACITY];
+static bool isRFFieldPresent = false; // phone presence is tracked in USB mode too, sensors stay suspended on USB disconnect
 
 static const TState *_processAppManagerFSM(TActiveObject *AO, TEvent event);
 
-extern TActiveObject systemActorsList[ACTIVE_OBJECTS_MAX];
+static void _suspendSubApps(void);
+
+static void _resumeSubApps(void);
+
+extern TActiveObject *systemActorsList[ACTIVE_OBJECTS_MAX];
 
 /* states */
 const TState appAOStatesList[APP_STATES_MAX] = {
@@ -16,56 +21,74 @@ const TState appAOStatesList[APP_STATES_MAX] = {
 
 TActiveObject *APP_Initialize(void) {
     // init super AO
-    ActiveObject_Initialize(&appAO, MAIN_APP_AO_ID, events, APP_QUEUE_MAX_CAPACITY);
+    SCHEDULER_InitializeActor(&appAO, MAIN_APP_AO_ID, events, APP_QUEUE_MAX_CAPACITY);
     appAO.state = &appAOStatesList[APP_ST_NFC_AND_SENSORS];
 
     return (TActiveObject *) &appAO;
 }
 
-void APP_Tasks(void) {
-    const TEvent event = ActiveObject_ProcessQueue(&appAO);
-
-    // Perform main app tasks
-    switch (appAO.state->name) {
-        case APP_ST_NFC_AND_SENSORS:
-            // SHT3X_Tasks();
-            // TODO AMBIENT_LIGHT_Tasks();
-            // TODO ACCELEROMETER_Tasks();
-            STORAGE_Tasks();
-            NFC_Tasks();
-            break;
-        case APP_ST_NFC_ONLY:
-            STORAGE_Tasks();
-            NFC_Tasks();
-            break;
-        case APP_ST_USB_ONLY:
-            USB_Tasks();
-            break;
-    }
+bool APP_Tasks(void) {
+    if (NULL == appAO.state) return false; // not initialized yet
+
+    const TEvent event = SCHEDULER_ProcessQueue(&appAO);
+    if (APP_NO_EVENT == event.sig) return false;
+    METRICS_EVENT_PROCESSED(MAIN_APP_AO_ID);
+    POWER_EVENT_PROCESSED();
 
     // switch main app state on event received
-    if (event.sig) {
-        const TState *nextState = _processAppManagerFSM(&appAO, event);
-        appAO.state = nextState;
-    }
+    const TState *nextState = _processAppManagerFSM(&appAO, event);
+    appAO.state = nextState;
+
+    return true;
+}
+
+void APP_PollTasks(void) {
+    if (NULL == appAO.state) return; // not initialized yet
+
+    if (APP_ST_USB_ONLY == appAO.state->name) USB_Tasks();
 }
 
 static const TState *_processAppManagerFSM(TActiveObject *appAO, TEvent event) {
-    TActiveObject* initAO = &systemActorsList[INIT_AO_ID];
+    TActiveObject* initAO = systemActorsList[INIT_AO_ID];
+    TActiveObject* storageAO = systemActorsList[STORAGE_AO_ID];
     switch (event.sig) {
-        // handle USB cable event
+        // handle USB cable event, storage flushes tail page on deinit
         case APP_SIG_USB_CABLE_CONNECTED:
-            ActiveObject_Dispatch(initAO, (TEvent) {.sig = DEINIT_SIG_STORAGE});
+            SCHEDULER_Dispatch(initAO, (TEvent) {.sig = DEINIT_SIG_STORAGE});
+            _suspendSubApps();
             return &appAOStatesList[APP_ST_USB_ONLY];
         case APP_SIG_USB_CABLE_DISCONNECTED:
-            ActiveObject_Dispatch(initAO, (TEvent) {.sig = INIT_SIG_STORAGE});
-            return &appAOStatesList[APP_ST_NFC_AND_SENSORS];
-        // Handle phone (NFC RF field) event
-        case APP_SIG_NFC_RF_FIELD_APPEARS: // TODO resolve situation when NFC and USB appears at the same time
+            SCHEDULER_Dispatch(initAO, (TEvent) {.sig = INIT_SIG_STORAGE});
+            _resumeSubApps();
+            return isRFFieldPresent ? &appAOStatesList[APP_ST_NFC_ONLY] : &appAOStatesList[APP_ST_NFC_AND_SENSORS];
+        // Handle phone (NFC RF field) event, USB mode keeps all sub apps suspended till cable disconnect
+        case APP_SIG_NFC_RF_FIELD_APPEARS:
+            isRFFieldPresent = true;
+            if (APP_ST_USB_ONLY == appAO->state->name) return appAO->state;
+            // let phone read up to date logs
+            if (NULL != storageAO) SCHEDULER_Dispatch(storageAO, (TEvent) {.sig = STORAGE_FLUSH});
+            SCHEDULER_Suspend(SHT3X_AO_ID);
             return &appAOStatesList[APP_ST_NFC_ONLY];
         case APP_SIG_NFC_RF_FIELD_DISAPPEAR:
+            isRFFieldPresent = false;
+            if (APP_ST_USB_ONLY == appAO->state->name) return appAO->state;
+            SCHEDULER_Resume(SHT3X_AO_ID);
             return &appAOStatesList[APP_ST_NFC_AND_SENSORS];
         default:    
-            return &appAOStatesList[APP_ST_NFC_AND_SENSORS];
+            return appAO->state;
     }
 }
+
+// only USB runs on cable connect, sub apps events are kept queued
+static void _suspendSubApps(void) {
+    SCHEDULER_Suspend(STORAGE_AO_ID);
+    SCHEDULER_Suspend(NFC_AO_ID);
+    SCHEDULER_Suspend(SHT3X_AO_ID);
+}
+
+// sensors stay suspended if phone is still in field
+static void _resumeSubApps(void) {
+    SCHEDULER_Resume(STORAGE_AO_ID);
+    SCHEDULER_Resume(NFC_AO_ID);
+    if (!isRFFieldPresent) SCHEDULER_Resume(SHT3X_AO_ID);
+}
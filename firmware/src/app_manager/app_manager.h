@@ -3,8 +3,8 @@
  *
  * @brief handle sub application tasks
  *
- * @details This module runs all sub applications tasks
- * According to the app state, some of them may be disabled e.g. on USB cable connect we'll run only USB app tasks
+ * @details Sub applications actors are run by scheduler, app manager suspends them according to the app state,
+ * e.g. on USB cable connect we'll run only USB app tasks
  */
 
 #ifndef APP_MANAGER_H
@@ -23,6 +23,9 @@
 #include "../init_manager/init_manager.h"
 #include "../usb_manager/usb_manager.h"
 #include "../config/common.defs.h"
+#include "../metrics/metrics.h"
+#include "../power/power.h"
+#include "../scheduler/scheduler.h"
 
 #ifdef    __cplusplus
 extern "C" {
@@ -57,8 +60,14 @@ TActiveObject *APP_Initialize(void);
 
 /* Microchip Harmony 3 specific */
 
-/** @brief Perform App Actor tasks, mainly listen for events and process them */
-void APP_Tasks(void);
+/**
+ * @brief Perform App Actor tasks, handle a single event, run by scheduler while actor is ready
+ * @return true if event is handled
+ */
+bool APP_Tasks(void);
+
+/** @brief Maintain polled modules of the app state (USB stack), should be called from main loop */
+void APP_PollTasks(void);
 
 #ifdef    __cplusplus
 }
@@ -20,4 +20,14 @@ typedef enum {
     ACTIVE_OBJECTS_MAX
 } SYSTEM_ACTIVE_OBJECT_IDS;
 
+/** @brief global actors timers IDs, @see timers.h */
+typedef enum {
+    SHT3X_MEASURE_TIMER_ID,
+    SHT3X_READ_MEASURE_TIMER_ID,
+    STORAGE_FLUSH_TIMER_ID,
+    NFC_NDEF_UPDATE_TIMER_ID,
+    NFC_NDEF_WRITE_TIMER_ID,
+    TIMERS_MAX
+} SYSTEM_TIMER_IDS;
+
 #endif //COMMON_DEFS_H
\ No newline at end of file
@@ -134,7 +134,7 @@ extern "C" {
 /* Memory Driver Instance 0 Configuration */
 #define DRV_MEMORY_INDEX_0                   0
 #define DRV_MEMORY_CLIENTS_NUMBER_IDX0       2
-#define DRV_MEMORY_BUF_Q_SIZE_IDX0    1
+#define DRV_MEMORY_BUF_Q_SIZE_IDX0    8
 
 /* AT25DF Driver Configuration Options */
 #define DRV_AT25DF_INSTANCES_NUMBER              1
@@ -151,9 +151,66 @@ static void DRV_MEMORY_BufferObjectsInit( DRV_MEMORY_OBJECT *dObj )
     }
 }
 
+/* This function checks whether the request can be merged into the queued one,
+ * so both are serviced with a single transfer. Requests should be of the same
+ * client and operation, contiguous in the memory device and in the buffer.
+ * Only the queue tail is tried, so requests are still serviced in order.
+ */
+static bool DRV_MEMORY_IsMergeable
+(
+    DRV_MEMORY_OBJECT *dObj,
+    DRV_MEMORY_BUFFER_OBJECT *queued,
+    DRV_MEMORY_BUFFER_OBJECT *bufferObj
+)
+{
+    uint32_t blockSize = 0;
+
+    /* Queue tail is not reset once the last request is processed */
+    if ((dObj->queueHead == NULL) || (queued == NULL) || (queued->status != DRV_MEMORY_COMMAND_QUEUED))
+    {
+        return false;
+    }
+
+    if ((queued->hClient != bufferObj->hClient) || (queued->opType != bufferObj->opType) ||
+        ((queued->blockStart + queued->nBlocksMerged) != bufferObj->blockStart))
+    {
+        return false;
+    }
+
+    switch (bufferObj->opType)
+    {
+        case DRV_MEM_OP_TYPE_READ:
+        {
+            blockSize = dObj->mediaGeometryTable[SYS_MEDIA_GEOMETRY_TABLE_READ_ENTRY].blockSize;
+            break;
+        }
+
+        case DRV_MEM_OP_TYPE_WRITE:
+        {
+            blockSize = dObj->writeBlockSize;
+            break;
+        }
+
+        case DRV_MEM_OP_TYPE_ERASE:
+        {
+            /* Erase has no buffer */
+            return true;
+        }
+
+        default:
+        {
+            /* Erase-write works sector by sector with its own buffer */
+            return false;
+        }
+    }
+
+    return ((queued->buffer + (queued->nBlocksMerged * blockSize)) == bufferObj->buffer);
+}
+
 /* This function finds a free buffer object and populates it with the transfer
  * parameters. It also generates a new command handle for the request and
- * adds it to the queue head for processing.
+ * adds it to the queue head for processing. Request contiguous with the queue
+ * tail is merged into it instead.
  */
 static void DRV_MEMORY_AllocateBufferObject
 (
@@ -183,6 +240,8 @@ static void DRV_MEMORY_AllocateBufferObject
     bufferObj->blockStart    = blockStart;
     bufferObj->nBlocks       = nBlocks;
     bufferObj->opType        = opType;
+    bufferObj->nBlocksMerged = nBlocks;
+    bufferObj->mergedNext    = (DRV_MEMORY_BUFFER_OBJECT *)NULL;
     bufferObj->status        = DRV_MEMORY_COMMAND_QUEUED;
     bufferObj->next          = (DRV_MEMORY_BUFFER_OBJECT *)NULL;
 
@@ -194,7 +253,20 @@ static void DRV_MEMORY_AllocateBufferObject
         *handle = bufferObj->commandHandle;
     }
 
-    if (dObj->queueHead == NULL)
+    if (DRV_MEMORY_IsMergeable(dObj, dObj->queueTail, bufferObj))
+    {
+        /* Extend the tail transfer, request completes together with it */
+        DRV_MEMORY_BUFFER_OBJECT *merged = dObj->queueTail;
+
+        while (merged->mergedNext != NULL)
+        {
+            merged = merged->mergedNext;
+        }
+
+        merged->mergedNext = bufferObj;
+        dObj->queueTail->nBlocksMerged += nBlocks;
+    }
+    else if (dObj->queueHead == NULL)
     {
         /* This is the first buffer in the queue */
         dObj->queueHead = bufferObj;
@@ -293,9 +365,15 @@ static void DRV_MEMORY_RemoveClientBufferObjects
 
             current = current->next;
 
-            /* return the dirty object to the free list */
-            dirty->next = dObj->buffObjFree;
-            dObj->buffObjFree = dirty;
+            /* return the dirty object and the merged ones to the free list */
+            while (dirty != NULL)
+            {
+                DRV_MEMORY_BUFFER_OBJECT *merged = dirty->mergedNext;
+
+                dirty->next = dObj->buffObjFree;
+                dObj->buffObjFree = dirty;
+                dirty = merged;
+            }
         }
         else
         {
@@ -1135,6 +1213,8 @@ void DRV_MEMORY_Tasks( SYS_MODULE_OBJ object )
     DRV_MEMORY_OBJECT *dObj = NULL;
     DRV_MEMORY_CLIENT_OBJECT *clientObj = NULL;
     DRV_MEMORY_BUFFER_OBJECT *bufferObj = NULL;
+    DRV_MEMORY_BUFFER_OBJECT *merged = NULL;
+    DRV_MEMORY_COMMAND_STATUS status = DRV_MEMORY_COMMAND_ERROR_UNKNOWN;
     DRV_MEMORY_EVENT event = DRV_MEMORY_EVENT_COMMAND_ERROR;
     bool isDone = false;
     MEMORY_DEVICE_TRANSFER_STATUS transferStatus = MEMORY_DEVICE_TRANSFER_ERROR_UNKNOWN;
@@ -1194,7 +1274,7 @@ void DRV_MEMORY_Tasks( SYS_MODULE_OBJ object )
         {
             bufferObj = dObj->currentBufObj;
 
-            transferStatus = gMemoryXferFuncPtr[bufferObj->opType](dObj, &bufferObj->buffer[0], bufferObj->blockStart, bufferObj->nBlocks);
+            transferStatus = gMemoryXferFuncPtr[bufferObj->opType](dObj, &bufferObj->buffer[0], bufferObj->blockStart, bufferObj->nBlocksMerged);
 
             if (transferStatus == MEMORY_DEVICE_TRANSFER_COMPLETED)
             {
@@ -1226,6 +1306,10 @@ void DRV_MEMORY_Tasks( SYS_MODULE_OBJ object )
                 /* Get the next buffer in the queue */
                 dObj->queueHead = dObj->queueHead->next;
 
+                /* Keep the merged requests, buffer object may be reused by the event handler */
+                merged = bufferObj->mergedNext;
+                status = bufferObj->status;
+
                 /* Return the processed buffer to free list */
                 bufferObj->next = dObj->buffObjFree;
                 dObj->buffObjFree = bufferObj;
@@ -1235,6 +1319,22 @@ void DRV_MEMORY_Tasks( SYS_MODULE_OBJ object )
                     /* Call the event handler */
                     clientObj->transferHandler((SYS_MEDIA_BLOCK_EVENT)event, (DRV_MEMORY_COMMAND_HANDLE)bufferObj->commandHandle, clientObj->context);
                 }
+
+                /* Complete the requests merged into the processed one */
+                while (merged != NULL)
+                {
+                    bufferObj = merged;
+                    merged = bufferObj->mergedNext;
+
+                    bufferObj->status = status;
+                    bufferObj->next = dObj->buffObjFree;
+                    dObj->buffObjFree = bufferObj;
+
+                    if(clientObj->transferHandler != NULL)
+                    {
+                        clientObj->transferHandler((SYS_MEDIA_BLOCK_EVENT)event, (DRV_MEMORY_COMMAND_HANDLE)bufferObj->commandHandle, clientObj->context);
+                    }
+                }
             }
             break;
         }
@@ -227,6 +227,13 @@ typedef struct DRV_MEMORY_BUFFER_OBJECT_T
     /* Operation type - read/write/erase/erasewrite */
     DRV_MEM_OP_TYPE opType;
 
+    /* Number of blocks of this and merged requests, transferred at once */
+    uint32_t nBlocksMerged;
+
+    /* Requests merged into this one, they are not in the queue and complete
+     * together with this request */
+    struct DRV_MEMORY_BUFFER_OBJECT_T *mergedNext;
+
     /* Pointer to the next buffer in the queue */
     struct DRV_MEMORY_BUFFER_OBJECT_T *next;
 
@@ -25,29 +25,33 @@ const TState initAOStatesList[INIT_STATES_MAX] = {
 
 void INIT_Initialize(uintptr_t context) {
     systemActorsList[INIT_AO_ID] = (TActiveObject *) &initAO; // place to global AO list
-    ActiveObject_Initialize(&initAO.super, INIT_AO_ID, events, INIT_QUEUE_MAX_CAPACITY);
+    SCHEDULER_InitializeActor(&initAO.super, INIT_AO_ID, events, INIT_QUEUE_MAX_CAPACITY);
 
     // init main app on next cycle
-    ActiveObject_Dispatch(&initAO.super, (TEvent) {.sig = INIT_SIG_MAIN_APP});
+    SCHEDULER_Dispatch(&initAO.super, (TEvent) {.sig = INIT_SIG_MAIN_APP});
     // init storage on next cycle
-    ActiveObject_Dispatch(&initAO.super, (TEvent) {.sig = INIT_SIG_STORAGE});
+    SCHEDULER_Dispatch(&initAO.super, (TEvent) {.sig = INIT_SIG_STORAGE});
     // init sensors on next cycle
-//    ActiveObject_Dispatch(&initAO.super, (TEvent) {.sig = INIT_SIG_SENSORS});
+//    SCHEDULER_Dispatch(&initAO.super, (TEvent) {.sig = INIT_SIG_SENSORS});
     // init NFC on next cycle
-    ActiveObject_Dispatch(&initAO.super, (TEvent) {.sig = INIT_SIG_NFC});
+    SCHEDULER_Dispatch(&initAO.super, (TEvent) {.sig = INIT_SIG_NFC});
     // TODO init ambient light, accelerometer
 
     initAO.super.state = &initAOStatesList[INIT_ST_INIT];
 }
 
-void INIT_Tasks(void) {
-    if (NULL == initAO.super.state) return; // not initialized yet
+bool INIT_Tasks(void) {
+    if (NULL == initAO.super.state) return false; // not initialized yet
 
-    const TEvent event = ActiveObject_ProcessQueue(&initAO.super);
-    if (INIT_NO_EVENT == event.sig) return; // nothing to do on no new events
+    const TEvent event = SCHEDULER_ProcessQueue(&initAO.super);
+    if (INIT_NO_EVENT == event.sig) return false; // nothing to do on no new events
+    METRICS_EVENT_PROCESSED(INIT_AO_ID);
+    POWER_EVENT_PROCESSED();
 
     const TState *nextState = _processInitManagerFSM(&initAO, event);
     initAO.super.state = nextState;
+
+    return true;
 }
 
 static const TState *_processInitManagerFSM(TInitActiveObject *AO, TEvent event) {
@@ -57,18 +61,18 @@ static const TState *_processInitManagerFSM(TInitActiveObject *AO, TEvent event)
             return &initAOStatesList[INIT_ST_IDLE];
         case INIT_SIG_SENSORS:
             systemActorsList[SHT3X_AO_ID] = SHT3X_Initialize();
-            ActiveObject_Dispatch(systemActorsList[SHT3X_AO_ID],
-                                  (TEvent) {.sig = SHT3X_READ_STATUS}); // TODO rename to emphasize self-test procedure
+            SCHEDULER_Dispatch(systemActorsList[SHT3X_AO_ID],
+                               (TEvent) {.sig = SHT3X_READ_STATUS}); // TODO rename to emphasize self-test procedure
             // TODO init ambient light, accelerometer
             return &initAOStatesList[INIT_ST_IDLE];
         case INIT_SIG_NFC:
             systemActorsList[NFC_AO_ID] = NFC_Initialize();
-            ActiveObject_Dispatch(systemActorsList[NFC_AO_ID],
-                                  (TEvent) {.sig = NFC_READ_UID}); // TODO rename to emphasize self-test procedure
+            SCHEDULER_Dispatch(systemActorsList[NFC_AO_ID],
+                               (TEvent) {.sig = NFC_READ_UID}); // TODO rename to emphasize self-test procedure
             return &initAOStatesList[INIT_ST_IDLE];
         case INIT_SIG_STORAGE:
             systemActorsList[STORAGE_AO_ID] = STORAGE_Initialize();
-            ActiveObject_Dispatch(systemActorsList[STORAGE_AO_ID], (TEvent) {.sig = STORAGE_CHECK_MEMORY_BOOT_SECTOR});
+            SCHEDULER_Dispatch(systemActorsList[STORAGE_AO_ID], (TEvent) {.sig = STORAGE_CHECK_MEMORY_BOOT_SECTOR});
             return &initAOStatesList[INIT_ST_IDLE];
         case DEINIT_SIG_SENSORS:
             SHT3X_Deinitialize();
@@ -16,6 +16,9 @@
 #include "../nfc/nfc.h"
 #include "../app_manager//app_manager.h"
 #include "./init.config.h"
+#include "../metrics/metrics.h"
+#include "../power/power.h"
+#include "../scheduler/scheduler.h"
 
 #ifdef    __cplusplus
 extern "C" {
@@ -60,8 +63,11 @@ void INIT_Initialize(uintptr_t context);
 
 /* Microchip Harmony 3 specific */
 
-/** @brief Perform Actor tasks, mainly listen for events and process them */
-void INIT_Tasks(void);
+/**
+ * @brief Perform Actor tasks, handle a single event, run by scheduler while actor is ready
+ * @return true if event is handled
+ */
+bool INIT_Tasks(void);
 
 #ifdef    __cplusplus
 }
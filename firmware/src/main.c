@@ -30,6 +30,10 @@
 #include "init_manager/init_manager.h"
 #include "config/common.defs.h"         // Common definitions
 #include "app_manager/app_manager.h"
+#include "metrics/metrics.h"
+#include "power/power.h"
+#include "scheduler/scheduler.h"
+#include "timers/timers.h"
 
 void _toggleLED(uintptr_t context) {
     _LED_Toggle();
@@ -44,6 +48,9 @@ void _toggleLED(uintptr_t context) {
 int main(void) {
     /* Initialize all modules */
     SYS_Initialize(NULL);
+    METRICS_Initialize();
+    POWER_Initialize();
+    TIMERS_Initialize();
 
     // Debug: verify that app isn't stuck
 //    SYS_TIME_CallbackRegisterMS(_toggleLED, (uintptr_t) NULL, 1000, SYS_TIME_PERIODIC);
@@ -52,8 +59,14 @@ int main(void) {
         /* Maintain state machines of all polled MPLAB Harmony modules. */
         SYS_Tasks();
 
-        INIT_Tasks();
-        APP_Tasks();
+        TIMERS_Tasks();
+        SCHEDULER_Tasks();
+        APP_PollTasks();
+
+        METRICS_INC(loopIterations);
+        METRICS_Tasks();
+
+        POWER_Idle();
     }
 
     /* Execution should not come here during normal operation */
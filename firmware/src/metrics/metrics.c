@@ -0,0 +1,98 @@
+#include "./metrics.h"
+#include "../scheduler/scheduler.h"
+
+#if METRICS_ENABLED
+TMetrics metrics;
+
+static const char *const metricsActorsNames[ACTIVE_OBJECTS_MAX] = {
+        [NO_ID] = "none",
+        [INIT_AO_ID] = "init",
+        [MAIN_APP_AO_ID] = "app",
+        [STORAGE_AO_ID] = "storage",
+        [NFC_AO_ID] = "nfc",
+        [SHT3X_AO_ID] = "sht3x",
+        [AMBIENT_LIGHT_AO_ID] = "light",
+        [ACCELEROMETER_AO_ID] = "accel"
+};
+
+static volatile bool isReportPending = false;
+
+static void _onReportPeriodElapsed(uintptr_t context);
+
+void METRICS_Initialize(void) {
+    memset(&metrics, 0, sizeof(TMetrics));
+
+#ifdef __DEBUG
+    SYS_TIME_CallbackRegisterMS(_onReportPeriodElapsed, (uintptr_t) NULL, METRICS_REPORT_PERIOD_MS, SYS_TIME_PERIODIC);
+#endif
+}
+
+void METRICS_Tasks(void) {
+    if (!isReportPending) return;
+
+    isReportPending = false;
+    METRICS_Report();
+}
+
+void METRICS_Report(void) {
+    const uint32_t uptimeMs = (uint32_t) ((SYS_TIME_Counter64Get() * 1000U) / SYS_TIME_FrequencyGet());
+    uint32_t eventsTotal = 0;
+
+    for (uint8_t id = 0; id < ACTIVE_OBJECTS_MAX; id++)
+        eventsTotal += metrics.eventsProcessed[id];
+
+    SYS_DEBUG_PRINT(SYS_ERROR_INFO, "METRICS uptime: %lu ms, loops: %lu, events: %lu (%lu/s), dropped: %lu\r\n",
+                    uptimeMs,
+                    metrics.loopIterations,
+                    eventsTotal,
+                    (0 == uptimeMs) ? 0 : (uint32_t) (((uint64_t) eventsTotal * 1000U) / uptimeMs),
+                    metrics.eventsDropped);
+    SYS_DEBUG_PRINT(SYS_ERROR_INFO, "METRICS flash rd: %lu B, wr: %lu B, xfers: %lu, samples: %lu (%lu B/sample)\r\n",
+                    metrics.flashBytesRead,
+                    metrics.flashBytesWritten,
+                    metrics.flashTransactions,
+                    metrics.samplesStored,
+                    (0 == metrics.samplesStored) ? 0 : metrics.flashBytesWritten / metrics.samplesStored);
+    SYS_DEBUG_PRINT(SYS_ERROR_INFO, "METRICS i2c xfers: %lu, bytes: %lu, bus busy: %lu ms (%lu%%), clock fallbacks: %lu\r\n",
+                    metrics.i2cTransactions,
+                    metrics.i2cBytes,
+                    metrics.i2cBusTimeUs / 1000U,
+                    (0 == uptimeMs) ? 0 : (uint32_t) (metrics.i2cBusTimeUs / ((uint64_t) uptimeMs * 10U)),
+                    metrics.i2cClockFallbacks);
+    SYS_DEBUG_PRINT(SYS_ERROR_INFO, "METRICS nfc gpo pulses: %lu, status reads: %lu, eeprom wr: %lu B\r\n",
+                    metrics.gpoPulses,
+                    metrics.gpoStatusReads,
+                    metrics.eepromBytesWritten);
+    SYS_DEBUG_PRINT(SYS_ERROR_INFO, "METRICS sleep wakes: %lu (%lu standby), asleep: %lu ms (%lu%%)\r\n",
+                    metrics.wakes,
+                    metrics.standbyWakes,
+                    metrics.sleepTimeMs,
+                    (0 == uptimeMs) ? 0 : (uint32_t) (((uint64_t) metrics.sleepTimeMs * 100U) / uptimeMs));
+
+    for (uint8_t id = 0; id < ACTIVE_OBJECTS_MAX; id++) {
+        const TEventQueueStats *const stats = SCHEDULER_GetQueueStats(id);
+
+        if (NULL == stats) continue;
+
+        SYS_DEBUG_PRINT(SYS_ERROR_INFO, "METRICS queue %s: peak %u/%u, in: %lu, out: %lu, dropped: %lu, max latency: %lu us\r\n",
+                        metricsActorsNames[id],
+                        stats->highWater,
+                        stats->capacity,
+                        stats->enqueues,
+                        stats->dequeues,
+                        stats->overflows,
+                        SYS_TIME_CountToUS(stats->maxLatency));
+    }
+}
+
+/** @note called from SYS_TIME ISR, only marks report as pending */
+static void _onReportPeriodElapsed(uintptr_t context) {
+    isReportPending = true;
+}
+#else
+void METRICS_Initialize(void) {}
+
+void METRICS_Tasks(void) {}
+
+void METRICS_Report(void) {}
+#endif
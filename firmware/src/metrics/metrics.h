@@ -0,0 +1,88 @@
+/**
+ * @file metrics.h
+ * @brief Runtime throughput counters
+ *
+ * @details Cheap, always-on counters for events/second, flash bytes written per sample and loop activity.
+ * Values are kept in one static structure so they can be read by a debugger or the host bench (`metrics` symbol,
+ * see firmware/host/bench/bench.c), or printed periodically to the CDC console in debug builds.
+ * Report includes actors queues usage kept by scheduler, to right-size queues capacities.
+ * Define METRICS_ENABLED as 0 to compile all counters out.
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "../config/default/configuration.h"
+#include "../config/default/definitions.h"
+#include "../config/common.defs.h"
+
+#ifdef    __cplusplus
+extern "C" {
+#endif
+
+#ifndef METRICS_ENABLED
+#define METRICS_ENABLED                     (1)
+#endif
+
+#define METRICS_REPORT_PERIOD_MS            (10000)
+
+/** @brief system wide throughput counters */
+typedef struct {
+    uint32_t loopIterations; /**< main loop spins */
+    uint32_t eventsProcessed[ACTIVE_OBJECTS_MAX]; /**< events handled, per active object */
+    uint32_t flashBytesRead; /**< bytes requested from SPI flash */
+    uint32_t flashBytesWritten; /**< bytes programmed into SPI flash */
+    uint32_t flashTransactions; /**< MEMORY driver requests queued */
+    uint32_t samplesStored; /**< sensor records appended to the log */
+    uint32_t i2cTransactions; /**< I2C driver requests queued */
+    uint32_t i2cBytes; /**< I2C payload bytes, register addresses included */
+    uint32_t i2cBusTimeUs; /**< I2C bus occupancy estimated from bytes and client clock */
+    uint32_t i2cClockFallbacks; /**< clients fallen back to standard mode clock */
+    uint32_t gpoPulses; /**< ST25DV GPO interrupts */
+    uint32_t gpoStatusReads; /**< IT_STS_Dyn reads, one per burst of GPO pulses */
+    uint32_t eepromBytesWritten; /**< ST25DV user EEPROM bytes written, NDEF status deltas */
+    uint32_t wakes; /**< main loop wake ups from sleep */
+    uint32_t standbyWakes; /**< wake ups from STANDBY, the rest are from IDLE */
+    uint32_t sleepTimeMs; /**< main loop time asleep */
+    uint32_t eventsDropped; /**< events dispatched to full actors queues */
+} TMetrics;
+
+#if METRICS_ENABLED
+extern TMetrics metrics;
+
+#define METRICS_INC(field)                  (metrics.field++)
+#define METRICS_ADD(field, value)           (metrics.field += (uint32_t) (value))
+#define METRICS_EVENT_PROCESSED(aoId)       (metrics.eventsProcessed[(aoId)]++)
+// 9 clocks per byte (ACK included), +2 bytes for slave address and start/stop (restart) conditions
+#define METRICS_I2C_TRANSFER(bytes, clockSpeed) \
+    do { \
+        metrics.i2cTransactions++; \
+        metrics.i2cBytes += (uint32_t) (bytes); \
+        metrics.i2cBusTimeUs += ((uint32_t) ((bytes) + 2) * 9U * 1000000U) / (clockSpeed); \
+    } while (0)
+#else
+#define METRICS_INC(field)
+#define METRICS_ADD(field, value)
+#define METRICS_EVENT_PROCESSED(aoId)
+#define METRICS_I2C_TRANSFER(bytes, clockSpeed)
+#endif
+
+/** @brief Reset all counters, start periodic report timer in debug builds */
+void METRICS_Initialize(void);
+
+/** @brief Print report to console if report period elapsed, should be called from main loop */
+void METRICS_Tasks(void);
+
+/** @brief Print counters and derived rates (events/s, flash bytes per sample) to console */
+void METRICS_Report(void);
+
+#ifdef    __cplusplus
+}
+#endif
+
+#endif //METRICS_H
@@ -13,11 +13,13 @@ static DRV_HANDLE _openI2CDriver(void);
 
 static void _onNFCGPOPinChange(uintptr_t context);
 
+static void _fallbackI2CClockOnError(DRV_I2C_TRANSFER_HANDLE transferHandle);
+
 /* NFC Global Functions */
 
 TActiveObject *NFC_Initialize(void) {
     // init super AO
-    ActiveObject_Initialize(&nfcAO.super, NFC_AO_ID, events, NFC_QUEUE_MAX_CAPACITY);
+    SCHEDULER_InitializeActor(&nfcAO.super, NFC_AO_ID, events, NFC_QUEUE_MAX_CAPACITY);
     nfcAO.super.state = &nfcStatesList[NFC_ST_INIT];
 
     // open I2C driver, get handler
@@ -27,12 +29,22 @@ TActiveObject *NFC_Initialize(void) {
     nfcAO.drvI2CHandle = drvI2CHandle;
     nfcAO.transferHandle = DRV_I2C_TRANSFER_HANDLE_INVALID;
     nfcAO.retriesLeft = NFC_TRANSFER_RETRIES_MAX;
+    nfcAO.download.isActive = false;
+    nfcAO.download.isMailboxFree = true;
+    nfcAO.download.isResponseReady = false;
+    nfcAO.download.isResponseWriting = false;
+    nfcAO.transferMailbox = &nfcAO.transferBuf;
+    nfcAO.download.chunk = NULL;
+    nfcAO.isGPOPending = false;
+    nfcAO.isRFFieldPresent = false;
+    TIMERS_Cancel(NFC_NDEF_UPDATE_TIMER_ID); // status is due, written once mailbox is prepared, EEPROM image cache is kept
+    NFC_ResetPrepareMailboxFSM(&nfcAO); // config cache is kept, static registers are in ST25DV EEPROM
     memset(nfcAO.st25dvRegs.pwd, 0x00, NFC_PASSWORD_SIZE); // factory default password is 0x00
     // TODO check that all fields are cleared
 
     // error on driver opening error
     if (DRV_HANDLE_INVALID == drvI2CHandle) {
-        ActiveObject_Dispatch(&nfcAO.super, (TEvent) {.sig = NFC_ERROR});
+        SCHEDULER_Dispatch(&nfcAO.super, (TEvent) {.sig = NFC_ERROR});
     };
 
     // set I2C handler @see https://microchip-mplab-harmony.github.io/core/index.html?GUID-C99FBA78-A80D-40EE-B863-E40151E30C73
@@ -42,7 +54,13 @@ TActiveObject *NFC_Initialize(void) {
             (uintptr_t) &nfcAO
     );
 
-    // Register callback for NFC GPO fall events (RF presence / absence)
+    // own clock for NFC transfers, driver switches bus clock between clients
+    nfcAO.i2cSetup.clockSpeed = NFC_I2C_CLOCK_SPEED;
+    nfcAO.isI2CClockVerified = false;
+    if (!DRV_I2C_TransferSetup(nfcAO.drvI2CHandle, &nfcAO.i2cSetup))
+        nfcAO.i2cSetup.clockSpeed = NFC_I2C_CLOCK_SPEED_FALLBACK;
+
+    // Register callback for NFC GPO events (RF field change, mailbox put/get message)
     EIC_CallbackRegister(EIC_PIN_3, _onNFCGPOPinChange, (uintptr_t) &nfcAO);
 
     return (TActiveObject *) &nfcAO;
@@ -50,14 +68,18 @@ TActiveObject *NFC_Initialize(void) {
 
 void NFC_Deinitialize(void) {
     nfcAO.super.state = NULL;
+    TIMERS_Cancel(NFC_NDEF_UPDATE_TIMER_ID);
+    TIMERS_Cancel(NFC_NDEF_WRITE_TIMER_ID);
     // TODO check should we close I2C driver here?
 }
 
-void NFC_Tasks(void) {
-    if (NULL == nfcAO.super.state) return; // not initialized yet
+bool NFC_Tasks(void) {
+    if (NULL == nfcAO.super.state) return false; // not initialized yet
 
-    const TEvent event = ActiveObject_ProcessQueue(&nfcAO.super);
-    if (NFC_NO_EVENT == event.sig) return;
+    const TEvent event = SCHEDULER_ProcessQueue(&nfcAO.super);
+    if (NFC_NO_EVENT == event.sig) return false;
+    METRICS_EVENT_PROCESSED(NFC_AO_ID);
+    POWER_EVENT_PROCESSED();
 
     const TState *nextState = FSM_ProcessEventToNextStateFromTransitionTable(&nfcAO.super, event, NFC_STATES_MAX,
                                                                              NFC_SIG_MAX, nfcTransitionTable);
@@ -70,6 +92,8 @@ void NFC_Tasks(void) {
 //    int name = nextState->name;
 //    SYS_DEBUG_PRINT(SYS_ERROR_INFO, "NFC Event: %d, Next State: %d\n", sig, name);
 #endif
+
+    return true;
 }
 
 /**
@@ -90,17 +114,22 @@ void NFC_TransferEventHandler(
 
             /* All data from or to the buffer was transferred successfully. */
         case DRV_I2C_TRANSFER_EVENT_COMPLETE:
-            return ActiveObject_Dispatch(&nfcAO.super, (TEvent) {.sig = NFC_I2C_TRANSFER_SUCCESS});
+            nfcAO.isI2CClockVerified = true;
+            SCHEDULER_Dispatch(&nfcAO.super, (TEvent) {.sig = NFC_I2C_TRANSFER_SUCCESS});
+            return;
 
             /* There was an error while processing the buffer transfer request. */
         case DRV_I2C_TRANSFER_EVENT_ERROR:
-            return ActiveObject_Dispatch(&nfcAO.super, (TEvent) {.sig = NFC_I2C_TRANSFER_FAIL});
+            _fallbackI2CClockOnError(transferHandle);
+            SCHEDULER_Dispatch(&nfcAO.super, (TEvent) {.sig = NFC_I2C_TRANSFER_FAIL});
+            return;
 
             /* Transfer Handle given is expired. It means transfer
             is completed but with or without error is not known. */
         case DRV_I2C_TRANSFER_EVENT_HANDLE_EXPIRED:
         case DRV_I2C_TRANSFER_EVENT_HANDLE_INVALID:
-            return ActiveObject_Dispatch(&nfcAO.super, (TEvent) {.sig = NFC_ERROR});
+            SCHEDULER_Dispatch(&nfcAO.super, (TEvent) {.sig = NFC_ERROR});
+            return;
         default:
             SYS_DEBUG_PRINT(SYS_ERROR_INFO, "NFC_TransferEventHandler: unknown event %d\n", event);
             return;
@@ -115,10 +144,32 @@ static DRV_HANDLE _openI2CDriver(void) {
     return drvI2CHandle;
 };
 
-/** @brief FIELD_CHANGE_EN: A pulse is emitted on GPO, when RF field appears or disappears */
+/**
+ * @brief Lower client clock to standard mode on bus error, or on any error till a transfer succeeds at current clock
+ * @details ST25DV NACKs while its EEPROM is programmed, so NACKs after the clock is proven are not blamed on it.
+ * Retried transfer goes at the new clock.
+ */
+static void _fallbackI2CClockOnError(DRV_I2C_TRANSFER_HANDLE transferHandle) {
+    if (NFC_I2C_CLOCK_SPEED_FALLBACK == nfcAO.i2cSetup.clockSpeed) return;
+    if (nfcAO.isI2CClockVerified && (DRV_I2C_ERROR_BUS != DRV_I2C_ErrorGet(transferHandle))) return;
+
+    nfcAO.i2cSetup.clockSpeed = NFC_I2C_CLOCK_SPEED_FALLBACK;
+    nfcAO.isI2CClockVerified = false;
+    DRV_I2C_TransferSetup(nfcAO.drvI2CHandle, &nfcAO.i2cSetup);
+    METRICS_INC(i2cClockFallbacks);
+};
+
+/**
+ * @brief GPO pulse is emitted on RF field change and on RF put/get of mailbox message
+ * @details Pulse is latched, only the first pulse of a burst is dispatched: IT_STS_Dyn accumulates all interrupts
+ * till it is read, so a single read serves the whole burst.
+ */
 static void _onNFCGPOPinChange(uintptr_t context) {
-//    static volatile uint8_t gpo = 0;
-    SYS_DEBUG_PRINT(SYS_ERROR_INFO, "GPO %d\n");
     TNFCActiveObject *nfcAO = (TNFCActiveObject *) context;
-    ActiveObject_Dispatch(&nfcAO->super, (TEvent) {.sig = NFC_GPO_PULSE});
+
+    METRICS_INC(gpoPulses);
+    if (nfcAO->isGPOPending) return;
+
+    nfcAO->isGPOPending = true;
+    SCHEDULER_Dispatch(&nfcAO->super, (TEvent) {.sig = NFC_GPO_PULSE});
 };
@@ -15,6 +15,16 @@ extern "C" {
 
 #define NFC_TRANSFER_RETRIES_MAX            (0x20)
 
+#define NFC_I2C_CLOCK_SPEED                 (1000000) // ST25DV supports Fast-mode Plus
+#define NFC_I2C_CLOCK_SPEED_FALLBACK        (100000) // standard mode, if bus fails at Fast-mode Plus
+
+#define NFC_NDEF_UPDATE_PERIOD_MS           (600000) // status record rate limit, last reading block lasts ~20 years of 1M EEPROM cycles
+#define NFC_NDEF_WRITE_TIME_MS              (6) // ST25DV EEPROM write page programming time is 5 ms, static registers too
+
+#ifndef NFC_RESPONSE_PREFETCH
+#define NFC_RESPONSE_PREFETCH               (1) // next response is assembled while phone reads the previous one, 0 waits for RF_GET_MSG
+#endif
+
 /* all SIZE is in Bytes */
 #define NFC_UID_SIZE                        (0x08)
 #define NFC_ITSTS_SIZE                      (0x01)
@@ -23,6 +33,7 @@ extern "C" {
 #define NFC_PASSWORD_VALIDATION_INDEX       (0x08)
 #define NFC_PASSWORD_VALIDATION_SIZE        (0x01)
 #define NFC_SINGLE_BYTE_REG_SIZE            (0x01)
+#define NFC_STATIC_CONFIG_SIZE              (0x0E) // GPO..MB_MODE system registers, read by single transfer
 #define ST25DV_MAILBOX_SIZE                 (0x100)
 
 #define NFC_MAILBOX_HEAD                    (0x00)
@@ -32,6 +43,10 @@ extern "C" {
 #define ST25DV_ADDR_DATA_I2C                (0xA6 >> 1) // E2=0
 #define ST25DV_ADDR_SYST_I2C                (0xAE >> 1) // E2=1
 
+/* static config registers offsets in system area */
+#define ST25DV_GPO_OFFSET                    (0x00)
+#define ST25DV_MB_MODE_OFFSET                (0x0D)
+
 /* MB_MODE */
 #define ST25DV_MB_MODE_RW_SHIFT              (0)
 #define ST25DV_MB_MODE_RW_FIELD              (0xFE)
@@ -86,6 +101,7 @@ extern "C" {
 #define ST25DV_GPO_ENABLE_FIELD              0x7F
 #define ST25DV_GPO_ENABLE_MASK               0x80
 #define ST25DV_GPO_ALL_MASK                  0xFF
+#define ST25DV_GPO_CONFIG                    (ST25DV_GPO_ENABLE_MASK | ST25DV_GPO_RFPUTMSG_MASK | ST25DV_GPO_RFGETMSG_MASK | ST25DV_GPO_FIELDCHANGE_MASK)
 
 /** @brief nfc states */
 typedef enum {
@@ -96,7 +112,10 @@ typedef enum {
     NFC_ST_READ_INTERRUPT_STATUS,
     NFC_SUPER_ST_PREPARE_MAILBOX,
     NFC_ST_WRITE_MAILBOX,
+    NFC_ST_READ_MAILBOX_LENGTH,
     NFC_ST_READ_MAILBOX,
+    NFC_ST_READ_NDEF,
+    NFC_ST_WRITE_NDEF,
     NFC_ST_ERROR,
     NFC_STATES_MAX
 } NFC_STATE;
@@ -113,13 +132,23 @@ typedef enum {
     NFC_READ_ITSTS,
 
     NFC_PREPARE_MAILBOX_SUCCESS,
+    NFC_PREPARE_MAILBOX_NEXT, // static register EEPROM is programmed
 
     NFC_WRITE_MAILBOX,
 
     NFC_GPO_PULSE,
+    NFC_FIELD_FALLING,
+    NFC_FIELD_RISING,
+    NFC_RF_GET_MSG,
+    NFC_RF_PUT_MSG,
 
     NFC_READ_MAILBOX,
 
+    NFC_LOG_CHUNK_READY,
+
+    NFC_NDEF_UPDATE,
+    NFC_NDEF_WRITE,
+
     NFC_ERROR,
     NFC_SIG_MAX,
 } NFC_SIG;
@@ -21,12 +21,30 @@
 #include "../../../../libraries/active-object-fsm/src/active_object/active_object.h"
 #include "../../../../libraries/active-object-fsm/src/fsm/fsm.h"
 #include "../init_manager/init.config.h"
+#include "../metrics/metrics.h"
+#include "../power/power.h"
+#include "../scheduler/scheduler.h"
+#include "../timers/timers.h"
+#include "../storage/storage_manager.h"
+#include "../app_manager/app_manager.h"
 #include "./nfc.config.h"
+#include "./nfc_protocol.defs.h"
+#include "./nfc_pack.h"
+#include "./nfc_ndef.h"
 
 #ifdef    __cplusplus
 extern "C" {
 #endif
 
+/** @brief mailbox message prefixed by I2C register address, written by single transfer */
+typedef union {
+    uint8_t raw[NFC_CMD_SIZE + ST25DV_MAILBOX_SIZE];
+    struct {
+        uint8_t cmd[NFC_CMD_SIZE];
+        uint8_t mailbox[ST25DV_MAILBOX_SIZE];
+    };
+} TNFCMailboxBuffer;
+
 /**
 * @brief NFC Active Object Type
 * @extends TActiveObject
@@ -35,14 +53,46 @@ typedef struct {
     TActiveObject super;
     DRV_HANDLE drvI2CHandle;
     DRV_I2C_TRANSFER_HANDLE transferHandle;
+    DRV_I2C_TRANSFER_SETUP i2cSetup; /**< client clock, applied by driver on each transfer of this client */
+    bool isI2CClockVerified; /**< transfer succeeded at current clock, so NACKs are not blamed on it */
     uint8_t retriesLeft;
-    union {
-        uint8_t raw[NFC_CMD_SIZE + ST25DV_MAILBOX_SIZE];
-        struct {
-            uint8_t cmd[NFC_CMD_SIZE];
-            uint8_t mailbox[ST25DV_MAILBOX_SIZE];
-        };
-    } transferBuf;
+    TNFCMailboxBuffer transferBuf;
+    TNFCMailboxBuffer *transferMailbox; /**< mailbox message being written, kept for retries */
+    uint16_t transferSize; /**< mailbox message size being written, kept for retries */
+    uint8_t mailboxLength; /**< MB_LEN_Dyn: size of the message put by RF minus 1 */
+    volatile bool isGPOPending; /**< GPO pulsed since IT_STS_Dyn was read, latched by EIC ISR */
+    bool isRFFieldPresent; /**< RF field is on, EEPROM is left to RF */
+    uint8_t prepareMailboxState; /**< prepare mailbox sub FSM state, reset on each initialization */
+    struct {
+        bool isActive; /**< request is being answered, more responses to write */
+        bool isMailboxFree; /**< phone has read the previous response (or has put the request) */
+        bool isResponseReady; /**< response is prefetched completely, waits for mailbox to be free */
+        bool isResponseWriting; /**< response is being written to mailbox */
+        bool isLastResponse; /**< prefetched response is the last one to the request */
+        bool isPacked; /**< log is sent as packed blocks */
+        uint8_t command; /**< request command */
+        uint8_t status; /**< NFC_PROTOCOL_STATUS of the request */
+        uint16_t sequence; /**< next response number */
+        uint32_t offset; /**< log (or packed stream) offset of the next byte to prefetch */
+        uint32_t bytesLeft; /**< log bytes left to take from storage */
+        uint32_t chunkAddress; /**< flash address of the next expected storage chunk, tells stale chunks */
+        const TStorageStreamChunk *chunk; /**< raw chunk being prefetched from, or packed one read ahead, NULL if awaited */
+        const uint8_t *source; /**< chunk data or packed block being prefetched from, NULL if awaited */
+        uint16_t sourceSize;
+        uint16_t sourceOffset; /**< source bytes already prefetched */
+        bool isSourceLast; /**< source holds the end of requested range */
+        uint16_t responseSize; /**< response bytes prefetched, header included */
+        TNFCMailboxBuffer response; /**< next response, assembled while phone reads the previous one from mailbox */
+        uint8_t packed[NFC_PACK_BLOCK_SIZE(STORAGE_STREAM_CHUNK_SIZE)]; /**< chunk packed, storage chunk is released at once to read the next one ahead */
+        TStorageStreamRequest streamRequest; /**< request sent to storage, should outlive the event */
+    } download; /**< log download over mailbox */
+    struct {
+        bool isCached; /**< written image is read back (or written) */
+        uint16_t offset; /**< image offset to search the next changed blocks from */
+        uint16_t size; /**< changed blocks being written */
+        uint8_t image[NFC_NDEF_IMAGE_SIZE]; /**< status image to write */
+        uint8_t written[NFC_NDEF_IMAGE_SIZE]; /**< image in EEPROM */
+    } ndef; /**< quick status record in user EEPROM */
     struct {
         uint8_t uid[NFC_UID_SIZE];
         uint8_t pwd[NFC_PASSWORD_SIZE];
@@ -59,6 +109,11 @@ typedef struct {
                 unsigned RF_WRITE:1;
             } bitFields;
         } interruptStatus;
+        struct {
+            bool isCached; /**< registers are read back, kept over actor reinitialization */
+            uint8_t gpo;
+            uint8_t mbMode;
+        } config; /**< static (EEPROM) config registers cache, only differing ones are written */
     } st25dvRegs;
 } TNFCActiveObject;
 
@@ -77,8 +132,11 @@ void NFC_Deinitialize(void);
 
 /* Microchip Harmony 3 specific */
 
-/** @brief Perform Actor tasks, mainly listen for events and process them */
-void NFC_Tasks(void);
+/**
+ * @brief Perform Actor tasks, handle a single event, run by scheduler while actor is ready
+ * @return true if event is handled
+ */
+bool NFC_Tasks(void);
 
 /**
 * @brief Callback for I2C ISR on success/error transfer.
@@ -98,8 +156,79 @@ void NFC_DispatchErrorOnInvalidTransfer(TNFCActiveObject *const nfcAO);
 
 void NFC_VerifyRetries(TNFCActiveObject *const nfcAO);
 
+/**
+ * @brief Reset prepare mailbox sub FSM, so it starts over on the next transfer success
+ * @memberof TNFCActiveObject
+ */
+void NFC_ResetPrepareMailboxFSM(TNFCActiveObject *const nfcAO);
+
 void NFC_ProcessPrepareMailboxFSM(TNFCActiveObject *const nfcAO, TEvent event);
 
+/**
+ * @brief Start answering the log (index) download request, previous download is dropped
+ * @details Log (index ring) range is opened as storage stream, chunks come as NFC_LOG_CHUNK_READY.
+ * Invalid request is answered by the single response with error status.
+ * @memberof TNFCActiveObject
+ * @param nfcAO
+ * @param request
+ */
+void NFC_StartLogDownload(TNFCActiveObject *const nfcAO, const TNFCProtocolLogRequest *const request);
+
+/**
+ * @brief Answer the request by single response, previous download is dropped
+ * @memberof TNFCActiveObject
+ * @param nfcAO
+ * @param command request command
+ * @param status NFC_PROTOCOL_STATUS_LAST on success, error status otherwise
+ * @param payload response payload, copied
+ * @param size payload size, up to NFC_PROTOCOL_PAYLOAD_MAX
+ */
+void NFC_Respond(TNFCActiveObject *const nfcAO, uint8_t command, NFC_PROTOCOL_STATUS status, const void *const payload, uint16_t size);
+
+/**
+ * @brief Parse request put to mailbox by phone and run its command
+ * @details Commands are looked up in static table by command code, request size is checked against the table
+ * @memberof TNFCActiveObject
+ * @param nfcAO
+ * @param request mailbox message
+ * @param size message size
+ */
+void NFC_DispatchCommand(TNFCActiveObject *const nfcAO, const uint8_t *const request, uint16_t size);
+
+/**
+ * @brief Abort download, e.g. when phone left RF field
+ * @memberof TNFCActiveObject
+ */
+void NFC_StopLogDownload(TNFCActiveObject *const nfcAO);
+
+/**
+ * @brief Take storage chunk to be sent
+ * @details Stale chunks of the previous stream are ignored. Packed chunk read ahead is kept till the block
+ * before it is prefetched.
+ * @memberof TNFCActiveObject
+ */
+void NFC_TakeLogChunk(TNFCActiveObject *const nfcAO, const TStorageStreamChunk *const chunk);
+
+/**
+ * @brief Check if the next response can be written to mailbox
+ * @memberof TNFCActiveObject
+ */
+bool NFC_IsResponseReady(TNFCActiveObject *const nfcAO);
+
+/**
+ * @brief Assemble the next response from storage chunks as far as data is available
+ * @details Response spans chunks boundaries, each chunk is returned to storage as soon as it is copied (or packed),
+ * so storage reads ahead while the previous response is still in mailbox.
+ * @memberof TNFCActiveObject
+ */
+void NFC_PrefetchResponse(TNFCActiveObject *const nfcAO);
+
+/**
+ * @brief Prefetched response is written to mailbox, start prefetching the next one
+ * @memberof TNFCActiveObject
+ */
+void NFC_ResponseWritten(TNFCActiveObject *const nfcAO);
+
 #ifdef    __cplusplus
 }
 #endif
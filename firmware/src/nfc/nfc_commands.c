@@ -0,0 +1,172 @@
+/**
+ * @brief NFC mailbox commands dispatcher
+ * @details Request is answered in one mailbox round trip (GET_LOG starts a download of many responses).
+ * Commands are looked up in static table by command code, like actors transitions tables.
+ * @see nfc_protocol.defs.h
+*/
+
+#include <time.h>
+
+#include "./nfc.h"
+#include "../sensors/sht3x-temperature-humidity/sht3x.h"
+
+extern TActiveObject *systemActorsList[ACTIVE_OBJECTS_MAX];
+
+typedef void (*TNFCCommandHandler)(TNFCActiveObject *const nfcAO, const uint8_t *const request);
+
+typedef struct {
+    uint8_t requestSize; /**< request is dropped if it is shorter */
+    TNFCCommandHandler handler;
+} TNFCCommand;
+
+static void _getLog(TNFCActiveObject *const nfcAO, const uint8_t *const request);
+
+static void _getStatus(TNFCActiveObject *const nfcAO, const uint8_t *const request);
+
+static void _getSummary(TNFCActiveObject *const nfcAO, const uint8_t *const request);
+
+static void _getQueues(TNFCActiveObject *const nfcAO, const uint8_t *const request);
+
+static void _setSampling(TNFCActiveObject *const nfcAO, const uint8_t *const request);
+
+static void _setTime(TNFCActiveObject *const nfcAO, const uint8_t *const request);
+
+_Static_assert((ACTIVE_OBJECTS_MAX * sizeof(TNFCProtocolQueueStats)) <= NFC_PROTOCOL_PAYLOAD_MAX,
+               "GET_QUEUES response exceeds mailbox");
+
+/* commands table */
+static const TNFCCommand nfcCommandsTable[NFC_PROTOCOL_CMD_MAX] = {
+        [NFC_PROTOCOL_CMD_GET_LOG] =        {.requestSize = sizeof(TNFCProtocolLogRequest), .handler = _getLog},
+        [NFC_PROTOCOL_CMD_GET_STATUS] =     {.requestSize = sizeof(TNFCProtocolRequestHeader), .handler = _getStatus},
+        [NFC_PROTOCOL_CMD_GET_SUMMARY] =    {.requestSize = sizeof(TNFCProtocolRequestHeader), .handler = _getSummary},
+        [NFC_PROTOCOL_CMD_SET_SAMPLING] =   {.requestSize = sizeof(TNFCProtocolSamplingRequest), .handler = _setSampling},
+        [NFC_PROTOCOL_CMD_SET_TIME] =       {.requestSize = sizeof(TNFCProtocolTimeRequest), .handler = _setTime},
+        [NFC_PROTOCOL_CMD_GET_INDEX] =      {.requestSize = sizeof(TNFCProtocolLogRequest), .handler = _getLog},
+        [NFC_PROTOCOL_CMD_GET_QUEUES] =     {.requestSize = sizeof(TNFCProtocolRequestHeader), .handler = _getQueues},
+};
+
+void NFC_DispatchCommand(TNFCActiveObject *const nfcAO, const uint8_t *const request, uint16_t size) {
+    const uint8_t command = request[NFC_MAILBOX_HEAD];
+
+    if ((command >= NFC_PROTOCOL_CMD_MAX) || (NULL == nfcCommandsTable[command].handler))
+        return NFC_Respond(nfcAO, command, NFC_PROTOCOL_STATUS_UNSUPPORTED, NULL, 0);
+
+    if (size < nfcCommandsTable[command].requestSize)
+        return NFC_Respond(nfcAO, command, NFC_PROTOCOL_STATUS_BAD_REQUEST, NULL, 0);
+
+    nfcCommandsTable[command].handler(nfcAO, request);
+};
+
+/**
+ * @brief RTC calendar to epoch seconds, RTC keeps UTC as SET_TIME writes it by gmtime_r()
+ * @note mktime() would apply local time zone, libc has no portable timegm()
+ */
+static uint32_t _toEpoch(const struct tm *const calendar) {
+    // days from civil: years start in March, so leap day is the last day of a year
+    const int32_t year = calendar->tm_year + 1900 - ((calendar->tm_mon < 2) ? 1 : 0);
+    const int32_t era = ((year >= 0) ? year : year - 399) / 400;
+    const uint32_t yearOfEra = (uint32_t) (year - era * 400);
+    const uint32_t month = (uint32_t) ((calendar->tm_mon + 10) % 12); // March is 0
+    const uint32_t dayOfYear = (153 * month + 2) / 5 + (uint32_t) calendar->tm_mday - 1;
+    const uint32_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    const int32_t days = era * 146097 + (int32_t) dayOfEra - 719468; // since 1970-01-01
+
+    return (uint32_t) days * 86400U + (uint32_t) (calendar->tm_hour * 3600 + calendar->tm_min * 60 + calendar->tm_sec);
+};
+
+static void _getLog(TNFCActiveObject *const nfcAO, const uint8_t *const request) {
+    NFC_StopLogDownload(nfcAO);
+    NFC_StartLogDownload(nfcAO, (const TNFCProtocolLogRequest *) request);
+};
+
+static void _getStatus(TNFCActiveObject *const nfcAO, const uint8_t *const request) {
+    struct tm now;
+    RTC_RTCCTimeGet(&now);
+
+    const bool isStorageRunning = (NULL != systemActorsList[STORAGE_AO_ID]);
+    const TStorageVerifyReport *const verify = STORAGE_GetVerifyReport();
+    const TNFCProtocolStatus status = {
+            .protocolVersion = NFC_PROTOCOL_VERSION,
+            .recordFormatVersion = STORAGE_RECORD_FORMAT_VERSION,
+            .time = _toEpoch(&now),
+            .logSize = isStorageRunning ? STORAGE_GetLogSize() : 0,
+            .samplingPeriodMs = SHT3X_GetMeasurePeriod(),
+            .indexSize = isStorageRunning ? STORAGE_GetIndexSize() : 0,
+            .oldestPosition = isStorageRunning ? STORAGE_GetOldestLogPosition() : 0,
+            .logPagesChecked = isStorageRunning ? verify->pagesChecked : 0,
+            .logPagesCorrupted = isStorageRunning ? verify->pagesCorrupted : 0
+    };
+
+    NFC_Respond(nfcAO, request[NFC_MAILBOX_HEAD], NFC_PROTOCOL_STATUS_LAST, &status, sizeof(TNFCProtocolStatus));
+};
+
+static void _getSummary(TNFCActiveObject *const nfcAO, const uint8_t *const request) {
+    if (NULL == systemActorsList[STORAGE_AO_ID])
+        return NFC_Respond(nfcAO, request[NFC_MAILBOX_HEAD], NFC_PROTOCOL_STATUS_BUSY, NULL, 0);
+
+    const TStorageSummary *const summary = STORAGE_GetSummary();
+    TNFCProtocolSummary response = {
+            .samples = summary->samples,
+            .temperatureLow = STORAGE_SUMMARY_TEMPERATURE_LOW,
+            .temperatureHigh = STORAGE_SUMMARY_TEMPERATURE_HIGH
+    };
+
+    if (0 != summary->samples) {
+        response.firstTimestamp = summary->firstTimestamp;
+        response.lastTimestamp = summary->lastTimestamp;
+        response.temperatureMin = summary->temperatureMin;
+        response.temperatureMax = summary->temperatureMax;
+        response.temperatureMean = STORAGE_SUMMARY_GetMeanTemperature(summary);
+        response.meanKineticTemperature = STORAGE_SUMMARY_GetMeanKineticTemperature(summary);
+        response.humidityMin = summary->humidityMin;
+        response.humidityMax = summary->humidityMax;
+        response.secondsAbove = summary->secondsAbove;
+        response.secondsBelow = summary->secondsBelow;
+        response.excursions = summary->excursions;
+        response.range = summary->range;
+    }
+
+    NFC_Respond(nfcAO, request[NFC_MAILBOX_HEAD], NFC_PROTOCOL_STATUS_LAST, &response, sizeof(TNFCProtocolSummary));
+};
+
+static void _getQueues(TNFCActiveObject *const nfcAO, const uint8_t *const request) {
+    TNFCProtocolQueueStats queues[ACTIVE_OBJECTS_MAX];
+    uint8_t count = 0;
+
+    for (uint8_t id = 0; id < ACTIVE_OBJECTS_MAX; id++) {
+        const TEventQueueStats *const stats = SCHEDULER_GetQueueStats(id);
+
+        if (NULL == stats) continue;
+
+        queues[count++] = (TNFCProtocolQueueStats) {
+                .actorId = id,
+                .capacity = (uint8_t) stats->capacity,
+                .highWater = (uint8_t) stats->highWater,
+                .enqueues = stats->enqueues,
+                .dequeues = stats->dequeues,
+                .overflows = stats->overflows,
+                .maxLatencyUs = SYS_TIME_CountToUS(stats->maxLatency)
+        };
+    }
+
+    NFC_Respond(nfcAO, request[NFC_MAILBOX_HEAD], NFC_PROTOCOL_STATUS_LAST, queues,
+                count * sizeof(TNFCProtocolQueueStats));
+};
+
+static void _setSampling(TNFCActiveObject *const nfcAO, const uint8_t *const request) {
+    const TNFCProtocolSamplingRequest *const sampling = (const TNFCProtocolSamplingRequest *) request;
+    const bool isSet = SHT3X_SetMeasurePeriod(sampling->periodMs);
+
+    NFC_Respond(nfcAO, sampling->command, isSet ? NFC_PROTOCOL_STATUS_LAST : NFC_PROTOCOL_STATUS_OUT_OF_RANGE, NULL, 0);
+};
+
+static void _setTime(TNFCActiveObject *const nfcAO, const uint8_t *const request) {
+    const TNFCProtocolTimeRequest *const timeRequest = (const TNFCProtocolTimeRequest *) request;
+    const time_t time = (time_t) timeRequest->time;
+    struct tm now;
+
+    gmtime_r(&time, &now);
+    const bool isSet = RTC_RTCCTimeSet(&now);
+
+    NFC_Respond(nfcAO, timeRequest->command, isSet ? NFC_PROTOCOL_STATUS_LAST : NFC_PROTOCOL_STATUS_OUT_OF_RANGE, NULL, 0);
+};
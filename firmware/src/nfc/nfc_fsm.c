@@ -1,9 +1,13 @@
 #include "./nfc.h"
 
+extern TActiveObject *systemActorsList[ACTIVE_OBJECTS_MAX];
+
 // st25dv nfc commands registers
 static const uint8_t ST25DV_UID_REG[] = {0x00, 0x18};
 static const uint8_t ST25DV_MAILBOX_RAM_REG[] = {0x20, 0x08};
 static const uint8_t ST25DV_ITSTS_DYN_REG[] = {0x20, 0x05}; // IT_STS_Dyn Interrupt status dynamic register
+static const uint8_t ST25DV_MB_LEN_DYN_REG[] = {0x20, 0x07}; // MB_LEN_Dyn size of the message in mailbox minus 1
+static const uint8_t ST25DV_NDEF_REG[] = {NFC_NDEF_ADDRESS >> 8, NFC_NDEF_ADDRESS & 0xFF}; // NDEF status in user EEPROM
 
 static const TState *_idle(TActiveObject *const AO, TEvent event);
 
@@ -13,10 +17,46 @@ static const TState *_prepareMailbox(TActiveObject *const AO, TEvent event);
 
 static const TState *_writeMailbox(TActiveObject *const AO, TEvent event);
 
+static const TState *_retryWriteMailbox(TActiveObject *const AO, TEvent event);
+
+static const TState *_mailboxWritten(TActiveObject *const AO, TEvent event);
+
+static const TState *_readMailboxLength(TActiveObject *const AO, TEvent event);
+
+static const TState *_readMailbox(TActiveObject *const AO, TEvent event);
+
+static const TState *_handleMailboxMessage(TActiveObject *const AO, TEvent event);
+
+static const TState *_takeLogChunk(TActiveObject *const AO, TEvent event);
+
 static const TState *_readInterruptStatus(TActiveObject *const AO, TEvent event);
 
 static const TState *_handleInterruptStatus(TActiveObject *const AO, TEvent event);
 
+static const TState *_onFieldFalling(TActiveObject *const AO, TEvent event);
+
+static const TState *_onFieldRising(TActiveObject *const AO, TEvent event);
+
+static const TState *_onRFGetMessage(TActiveObject *const AO, TEvent event);
+
+static const TState *_onRFPutMessage(TActiveObject *const AO, TEvent event);
+
+static const TState *_updateNDEF(TActiveObject *const AO, TEvent event);
+
+static const TState *_readNDEF(TActiveObject *const AO, TEvent event);
+
+static const TState *_retryReadNDEF(TActiveObject *const AO, TEvent event);
+
+static const TState *_ndefRead(TActiveObject *const AO, TEvent event);
+
+static const TState *_writeNDEF(TActiveObject *const AO, TEvent event);
+
+static const TState *_retryWriteNDEF(TActiveObject *const AO, TEvent event);
+
+static const TState *_ndefWritten(TActiveObject *const AO, TEvent event);
+
+static const TState *_abortNDEF(TActiveObject *const AO, TEvent event);
+
 static const TState *_error(TActiveObject *const AO, TEvent event);
 
 static bool _refreshRetries(TActiveObject *const AO, void *const ctx);
@@ -35,32 +75,121 @@ static inline bool _isMailboxEmpty(TNFCActiveObject *const nfcAO) {
 const TState nfcStatesList[NFC_STATES_MAX] = {
         [NFC_ST_INIT] =                     {.name = NFC_ST_INIT},
         [NFC_ST_IDLE] =                     {.name = NFC_ST_IDLE},
-        [NFC_ST_READ_UID] =                 {.name = NFC_ST_READ_UID},
-        [NFC_ST_READ_INTERRUPT_STATUS] =    {.name = NFC_ST_READ_INTERRUPT_STATUS},
+        [NFC_ST_READ_UID] =                 {.name = NFC_ST_READ_UID, .onExit = _refreshRetries},
+        [NFC_ST_READ_INTERRUPT_STATUS] =    {.name = NFC_ST_READ_INTERRUPT_STATUS, .onExit = _refreshRetries},
         [NFC_SUPER_ST_PREPARE_MAILBOX] =    {.name = NFC_SUPER_ST_PREPARE_MAILBOX, .onExit = _refreshRetries},
         [NFC_ST_WRITE_MAILBOX] =            {.name = NFC_ST_WRITE_MAILBOX, .onExit = _refreshRetries},
+        [NFC_ST_READ_MAILBOX_LENGTH] =      {.name = NFC_ST_READ_MAILBOX_LENGTH},
         [NFC_ST_READ_MAILBOX] =             {.name = NFC_ST_READ_MAILBOX, .onExit = _refreshRetries},
+        [NFC_ST_READ_NDEF] =                {.name = NFC_ST_READ_NDEF, .onExit = _refreshRetries},
+        [NFC_ST_WRITE_NDEF] =               {.name = NFC_ST_WRITE_NDEF, .onExit = _refreshRetries},
         [NFC_ST_ERROR] =                    {.name = NFC_ST_ERROR}
 };
 
 /* state transitions table */
 const TEventHandler nfcTransitionTable[NFC_STATES_MAX][NFC_SIG_MAX] = {
         [NFC_ST_INIT]=                      {[NFC_READ_UID]=_readUID, [NFC_ERROR]=_error},
-        [NFC_ST_READ_UID]=                  {[NFC_I2C_TRANSFER_SUCCESS]=_prepareMailbox, [NFC_I2C_TRANSFER_FAIL]=_error, [NFC_ERROR]=_error},
+        [NFC_ST_READ_UID]=                  {[NFC_I2C_TRANSFER_SUCCESS]=_prepareMailbox, [NFC_I2C_TRANSFER_FAIL]=_readUID, [NFC_I2C_TRANSFER_MAX_RETRIES]=_error, [NFC_ERROR]=_error},
         /* Prepare mailbox (enable Fast Transfer mode) */
-        [NFC_SUPER_ST_PREPARE_MAILBOX]=     {[NFC_PREPARE_MAILBOX_SUCCESS]=_idle, [NFC_I2C_TRANSFER_SUCCESS]=_prepareMailbox, [NFC_I2C_TRANSFER_FAIL]=_prepareMailbox, [NFC_I2C_TRANSFER_MAX_RETRIES]=_error, [NFC_ERROR]=_error},/* Check RF field */
-        [NFC_ST_IDLE]=                      {[NFC_GPO_PULSE]=_readInterruptStatus, [NFC_WRITE_MAILBOX]=_writeMailbox, [NFC_ERROR]=_error},
-        [NFC_ST_READ_INTERRUPT_STATUS]=     {[NFC_I2C_TRANSFER_SUCCESS]=_handleInterruptStatus, /*[NFC_GPO_PULSE]=_readInterruptStatus*/ /*[NFC_I2C_TRANSFER_FAIL]=_error TODO */ [NFC_ERROR]=_error},
+        [NFC_SUPER_ST_PREPARE_MAILBOX]=     {[NFC_PREPARE_MAILBOX_SUCCESS]=_idle, [NFC_I2C_TRANSFER_SUCCESS]=_prepareMailbox, [NFC_I2C_TRANSFER_FAIL]=_prepareMailbox, [NFC_PREPARE_MAILBOX_NEXT]=_prepareMailbox, [NFC_I2C_TRANSFER_MAX_RETRIES]=_error, [NFC_ERROR]=_error},/* Check RF field */
+        /* GPO pulse is latched, it is served by idle state, interrupts are fanned out to idle state in a row */
+        [NFC_ST_IDLE]=                      {[NFC_GPO_PULSE]=_idle, [NFC_FIELD_FALLING]=_onFieldFalling, [NFC_FIELD_RISING]=_onFieldRising, [NFC_RF_GET_MSG]=_onRFGetMessage, [NFC_RF_PUT_MSG]=_onRFPutMessage, [NFC_NDEF_UPDATE]=_idle, [NFC_WRITE_MAILBOX]=_writeMailbox, [NFC_READ_MAILBOX]=_readMailboxLength, [NFC_LOG_CHUNK_READY]=_takeLogChunk, [NFC_ERROR]=_error},
+        [NFC_ST_READ_INTERRUPT_STATUS]=     {[NFC_I2C_TRANSFER_SUCCESS]=_handleInterruptStatus, [NFC_I2C_TRANSFER_FAIL]=_readInterruptStatus, [NFC_I2C_TRANSFER_MAX_RETRIES]=_error, [NFC_FIELD_FALLING]=_onFieldFalling, [NFC_FIELD_RISING]=_onFieldRising, [NFC_LOG_CHUNK_READY]=_takeLogChunk, [NFC_ERROR]=_error},
 
         /* Mailbox (exchange data between I2C and RF) */
-        [NFC_ST_WRITE_MAILBOX]=             {[NFC_I2C_TRANSFER_SUCCESS]=_idle, [NFC_ERROR]=_error},
-        [NFC_ST_READ_MAILBOX]=              {[NFC_I2C_TRANSFER_SUCCESS]=_idle, [NFC_ERROR]=_error},
+        [NFC_ST_WRITE_MAILBOX]=             {[NFC_I2C_TRANSFER_SUCCESS]=_mailboxWritten, [NFC_I2C_TRANSFER_FAIL]=_retryWriteMailbox, [NFC_I2C_TRANSFER_MAX_RETRIES]=_error, [NFC_FIELD_FALLING]=_onFieldFalling, [NFC_FIELD_RISING]=_onFieldRising, [NFC_LOG_CHUNK_READY]=_takeLogChunk, [NFC_ERROR]=_error},
+        /* request is dropped on read fail, phone repeats it on response timeout */
+        [NFC_ST_READ_MAILBOX_LENGTH]=       {[NFC_I2C_TRANSFER_SUCCESS]=_readMailbox, [NFC_I2C_TRANSFER_FAIL]=_idle, [NFC_FIELD_FALLING]=_onFieldFalling, [NFC_FIELD_RISING]=_onFieldRising, [NFC_LOG_CHUNK_READY]=_takeLogChunk, [NFC_ERROR]=_error},
+        [NFC_ST_READ_MAILBOX]=              {[NFC_I2C_TRANSFER_SUCCESS]=_handleMailboxMessage, [NFC_I2C_TRANSFER_FAIL]=_idle, [NFC_FIELD_FALLING]=_onFieldFalling, [NFC_FIELD_RISING]=_onFieldRising, [NFC_LOG_CHUNK_READY]=_takeLogChunk, [NFC_ERROR]=_error},
+
+        /* NDEF status (write waits for EEPROM programming between pages), given up on no retries left till next update */
+        [NFC_ST_READ_NDEF]=                 {[NFC_I2C_TRANSFER_SUCCESS]=_ndefRead, [NFC_I2C_TRANSFER_FAIL]=_retryReadNDEF, [NFC_FIELD_FALLING]=_onFieldFalling, [NFC_FIELD_RISING]=_onFieldRising, [NFC_LOG_CHUNK_READY]=_takeLogChunk, [NFC_ERROR]=_error},
+        [NFC_ST_WRITE_NDEF]=                {[NFC_I2C_TRANSFER_SUCCESS]=_ndefWritten, [NFC_I2C_TRANSFER_FAIL]=_retryWriteNDEF, [NFC_NDEF_WRITE]=_writeNDEF, [NFC_FIELD_FALLING]=_onFieldFalling, [NFC_FIELD_RISING]=_onFieldRising, [NFC_LOG_CHUNK_READY]=_takeLogChunk, [NFC_ERROR]=_error},
 
         [NFC_ST_ERROR]=                     {[NFC_ERROR]=_error},
 };
 
+// queue mailbox message of given size, message should be already in buffer
+static inline void _transferMailbox(TNFCActiveObject *const nfcAO, TNFCMailboxBuffer *const buffer, uint16_t size) {
+    nfcAO->retriesLeft--;
+    nfcAO->transferMailbox = buffer;
+    nfcAO->transferSize = size;
+    memcpy(buffer->cmd, ST25DV_MAILBOX_RAM_REG, NFC_CMD_SIZE);
+
+    DRV_I2C_WriteTransferAdd(
+            nfcAO->drvI2CHandle,
+            ST25DV_ADDR_DATA_I2C,
+            buffer->raw,
+            NFC_CMD_SIZE + size,
+            &(nfcAO->transferHandle)
+    );
+
+    NFC_DispatchErrorOnInvalidTransfer(nfcAO);
+    METRICS_I2C_TRANSFER(NFC_CMD_SIZE + size, nfcAO->i2cSetup.clockSpeed);
+};
+
+// update period timer stays expired till the update, status record is updated while phone is away,
+// EEPROM is left to RF otherwise
+static inline bool _isNDEFUpdateDue(TNFCActiveObject *const nfcAO) {
+    return !TIMERS_IsArmed(NFC_NDEF_UPDATE_TIMER_ID) && !nfcAO->isRFFieldPresent && !nfcAO->download.isActive;
+};
+
+// let app manager run sub apps according to the phone presence
+static inline void _dispatchFieldChange(APP_SIG sig) {
+    TActiveObject *mainAppAO = systemActorsList[MAIN_APP_AO_ID];
+
+    if (NULL != mainAppAO) SCHEDULER_Dispatch(mainAppAO, (TEvent) {.sig = sig});
+};
+
+// write changed blocks run of NDEF status image
+static inline void _transferNDEF(TNFCActiveObject *const nfcAO) {
+    const uint16_t address = NFC_NDEF_ADDRESS + nfcAO->ndef.offset;
+
+    nfcAO->retriesLeft--;
+    nfcAO->transferBuf.cmd[0] = (uint8_t) (address >> 8);
+    nfcAO->transferBuf.cmd[1] = (uint8_t) (address & 0xFF);
+    memcpy(nfcAO->transferBuf.mailbox, nfcAO->ndef.image + nfcAO->ndef.offset, nfcAO->ndef.size);
+
+    DRV_I2C_WriteTransferAdd(
+            nfcAO->drvI2CHandle,
+            ST25DV_ADDR_DATA_I2C,
+            nfcAO->transferBuf.raw,
+            NFC_CMD_SIZE + nfcAO->ndef.size,
+            &(nfcAO->transferHandle)
+    );
+
+    NFC_DispatchErrorOnInvalidTransfer(nfcAO);
+    METRICS_I2C_TRANSFER(NFC_CMD_SIZE + nfcAO->ndef.size, nfcAO->i2cSetup.clockSpeed);
+};
+
+/**
+ * @brief Go idle, read interrupt status first if GPO has pulsed, then write the next download response
+ * if it is prefetched and phone is ready for it, or update NDEF status if it is due
+ * @details Mailbox is not written till pending interrupts are read, phone may have put a request meanwhile
+ */
 static const TState *_idle(TActiveObject *const AO, TEvent event) {
-    return &(nfcStatesList[NFC_ST_IDLE]);
+    TNFCActiveObject *nfcAO = (TNFCActiveObject *) AO;
+
+    if (nfcAO->isGPOPending) return _readInterruptStatus(AO, event);
+
+    if (!NFC_IsResponseReady(nfcAO))
+        return _isNDEFUpdateDue(nfcAO) ? _updateNDEF(AO, event) : &(nfcStatesList[NFC_ST_IDLE]);
+
+    nfcAO->retriesLeft = NFC_TRANSFER_RETRIES_MAX; // each response has its own retries budget
+    nfcAO->download.isMailboxFree = false;
+    nfcAO->download.isResponseWriting = true;
+    _transferMailbox(nfcAO, &(nfcAO->download.response), nfcAO->download.responseSize);
+
+    return &(nfcStatesList[NFC_ST_WRITE_MAILBOX]);
+};
+
+/** @brief Mailbox is written, prefetch the next response while phone reads this one */
+static const TState *_mailboxWritten(TActiveObject *const AO, TEvent event) {
+    TNFCActiveObject *nfcAO = (TNFCActiveObject *) AO;
+
+    if (nfcAO->download.isResponseWriting) NFC_ResponseWritten(nfcAO);
+
+    return _idle(AO, event);
 };
 
 static const TState *_readUID(TActiveObject *const AO, TEvent event) {
@@ -77,40 +206,109 @@ static const TState *_readUID(TActiveObject *const AO, TEvent event) {
     );
 
     NFC_DispatchErrorOnInvalidTransfer(nfcAO);
+    METRICS_I2C_TRANSFER(NFC_CMD_SIZE + NFC_UID_SIZE, nfcAO->i2cSetup.clockSpeed);
+    // the first transfer, repeated if it fails at too fast clock
+    nfcAO->retriesLeft--;
+    NFC_VerifyRetries(nfcAO);
 
     return &(nfcStatesList[NFC_ST_READ_UID]);
 };
 
 /** @brief  Write to Mailbox
- * @note don't forget to write to me->transferBuf.mailbox first,
+ * @details Message is taken from event payload, empty payload writes zeroed mailbox
  * */
 static const TState *_writeMailbox(TActiveObject *const AO, TEvent event) {
     TNFCActiveObject *nfcAO = (TNFCActiveObject *) AO;
+    uint16_t size = ST25DV_MAILBOX_SIZE;
 
-    nfcAO->retriesLeft--;
     memset(nfcAO->transferBuf.raw, 0, NFC_CMD_SIZE + ST25DV_MAILBOX_SIZE);
 
-    // TODO take data from event
+    if ((NULL != event.payload) && (0 != event.size)) {
+        size = (event.size < ST25DV_MAILBOX_SIZE) ? event.size : ST25DV_MAILBOX_SIZE;
+        memcpy(nfcAO->transferBuf.mailbox, event.payload, size);
+    }
 
-    memcpy(nfcAO->transferBuf.cmd, ST25DV_MAILBOX_RAM_REG, NFC_CMD_SIZE);
+    _transferMailbox(nfcAO, &(nfcAO->transferBuf), size);
 
-    DRV_I2C_WriteTransferAdd(
+    return &(nfcStatesList[NFC_ST_WRITE_MAILBOX]);
+};
+
+static const TState *_retryWriteMailbox(TActiveObject *const AO, TEvent event) {
+    TNFCActiveObject *nfcAO = (TNFCActiveObject *) AO;
+
+    _transferMailbox(nfcAO, nfcAO->transferMailbox, nfcAO->transferSize);
+    NFC_VerifyRetries(nfcAO);
+
+    return &(nfcStatesList[NFC_ST_WRITE_MAILBOX]);
+};
+
+static const TState *_readMailboxLength(TActiveObject *const AO, TEvent event) {
+    TNFCActiveObject *nfcAO = (TNFCActiveObject *) AO;
+
+    DRV_I2C_WriteReadTransferAdd(
             nfcAO->drvI2CHandle,
             ST25DV_ADDR_DATA_I2C,
-            nfcAO->transferBuf.raw,
-            NFC_CMD_SIZE + ST25DV_MAILBOX_SIZE,
+            (void *const) &ST25DV_MB_LEN_DYN_REG,
+            NFC_CMD_SIZE,
+            &(nfcAO->mailboxLength),
+            NFC_SINGLE_BYTE_REG_SIZE,
             &(nfcAO->transferHandle)
     );
 
     NFC_DispatchErrorOnInvalidTransfer(nfcAO);
+    METRICS_I2C_TRANSFER(NFC_CMD_SIZE + NFC_SINGLE_BYTE_REG_SIZE, nfcAO->i2cSetup.clockSpeed);
 
-    return &(nfcStatesList[NFC_ST_WRITE_MAILBOX]);
+    return &(nfcStatesList[NFC_ST_READ_MAILBOX_LENGTH]);
+};
+
+/** @brief Read the whole message put by RF, mailbox is released for the response then */
+static const TState *_readMailbox(TActiveObject *const AO, TEvent event) {
+    TNFCActiveObject *nfcAO = (TNFCActiveObject *) AO;
+
+    DRV_I2C_WriteReadTransferAdd(
+            nfcAO->drvI2CHandle,
+            ST25DV_ADDR_DATA_I2C,
+            (void *const) &ST25DV_MAILBOX_RAM_REG,
+            NFC_CMD_SIZE,
+            nfcAO->transferBuf.mailbox,
+            nfcAO->mailboxLength + 1,
+            &(nfcAO->transferHandle)
+    );
+
+    NFC_DispatchErrorOnInvalidTransfer(nfcAO);
+    METRICS_I2C_TRANSFER(NFC_CMD_SIZE + nfcAO->mailboxLength + 1, nfcAO->i2cSetup.clockSpeed);
+
+    return &(nfcStatesList[NFC_ST_READ_MAILBOX]);
+};
+
+static const TState *_handleMailboxMessage(TActiveObject *const AO, TEvent event) {
+    TNFCActiveObject *nfcAO = (TNFCActiveObject *) AO;
+
+    nfcAO->download.isMailboxFree = true;
+    NFC_DispatchCommand(nfcAO, nfcAO->transferBuf.mailbox, nfcAO->mailboxLength + 1);
+
+    return _idle(AO, event);
+};
+
+/** @brief Storage chunk is accepted in any state, only idle one should start the response write */
+static const TState *_takeLogChunk(TActiveObject *const AO, TEvent event) {
+    TNFCActiveObject *nfcAO = (TNFCActiveObject *) AO;
+
+    if (sizeof(TStorageStreamChunk) == event.size) NFC_TakeLogChunk(nfcAO, event.payload);
+
+    if (&(nfcStatesList[NFC_ST_IDLE]) == AO->state) return _idle(AO, event);
+
+    return AO->state;
 };
 
+/** @brief Read IT_STS_Dyn once for the whole burst of GPO pulses, it is cleared on read */
 static const TState *_readInterruptStatus(TActiveObject *const AO, TEvent event) {
     TNFCActiveObject *nfcAO = (TNFCActiveObject *) AO;
 
+    // pulses from now on are latched again and served by the next read
+    nfcAO->isGPOPending = false;
     nfcAO->st25dvRegs.interruptStatus.raw = 0x00;
+    nfcAO->retriesLeft--;
 
     DRV_I2C_WriteReadTransferAdd(
             nfcAO->drvI2CHandle,
@@ -123,49 +321,193 @@ static const TState *_readInterruptStatus(TActiveObject *const AO, TEvent event)
     );
 
     NFC_DispatchErrorOnInvalidTransfer(nfcAO);
+    METRICS_I2C_TRANSFER(NFC_CMD_SIZE + NFC_ITSTS_SIZE, nfcAO->i2cSetup.clockSpeed);
+    METRICS_INC(gpoStatusReads);
+    NFC_VerifyRetries(nfcAO);
 
     return &(nfcStatesList[NFC_ST_READ_INTERRUPT_STATUS]);
 }
 
+/**
+ * @brief Fan out all interrupts of the burst as separate events
+ * @details Field events go first, mailbox event is the last one. Idle state is resumed by the fanned out events,
+ * so no transfer is started before they are handled. Message put by RF supersedes get of the previous one,
+ * mailbox holds the new request then.
+ */
 static const TState *_handleInterruptStatus(TActiveObject *const AO, TEvent event) {
     TNFCActiveObject *nfcAO = (TNFCActiveObject *) AO;
+    const bool isFieldChanged = nfcAO->st25dvRegs.interruptStatus.bitFields.FIELD_FALLING ||
+                                nfcAO->st25dvRegs.interruptStatus.bitFields.FIELD_RISING;
+    const bool isPutMessage = nfcAO->st25dvRegs.interruptStatus.bitFields.RF_PUT_MSG;
+    const bool isGetMessage = nfcAO->st25dvRegs.interruptStatus.bitFields.RF_GET_MSG && !isPutMessage;
 
-    if (nfcAO->st25dvRegs.interruptStatus.bitFields.RF_ACTIVITY) {
-        // TODO handle RF activity
-    };
-
-    if (nfcAO->st25dvRegs.interruptStatus.bitFields.RF_INTERRUPT) {
-        // TODO handle RF interrupt
-    };
+    // RF_ACTIVITY, RF_INTERRUPT, RF_WRITE are not enabled on GPO
 
-    if (nfcAO->st25dvRegs.interruptStatus.bitFields.FIELD_FALLING) {
-        // TODO handle FIELD falling
-         
-    };
+    // field state is known before any event of the burst may start a transfer, EEPROM is left to RF on any doubt
+    if (isFieldChanged) nfcAO->isRFFieldPresent = nfcAO->st25dvRegs.interruptStatus.bitFields.FIELD_RISING;
 
-    if (nfcAO->st25dvRegs.interruptStatus.bitFields.FIELD_RISING) {
-        // TODO handle FIELD rising
+    if (nfcAO->st25dvRegs.interruptStatus.bitFields.FIELD_FALLING)
+        SCHEDULER_Dispatch(&(nfcAO->super), (TEvent) {.sig = NFC_FIELD_FALLING});
 
-    };
+    if (nfcAO->st25dvRegs.interruptStatus.bitFields.FIELD_RISING)
+        SCHEDULER_Dispatch(&(nfcAO->super), (TEvent) {.sig = NFC_FIELD_RISING});
 
-    if (nfcAO->st25dvRegs.interruptStatus.bitFields.RF_PUT_MSG) {
-        // TODO handle RF put message
-        _LED_Clear();
-        ActiveObject_Dispatch(&(nfcAO->super), (TEvent) {.sig = NFC_READ_MAILBOX});
-    };
+    if (isGetMessage) SCHEDULER_Dispatch(&(nfcAO->super), (TEvent) {.sig = NFC_RF_GET_MSG});
 
-    if (nfcAO->st25dvRegs.interruptStatus.bitFields.RF_GET_MSG) {
-        // TODO handle RF get message
-        // _LED_Set();
-    };
+    if (isPutMessage) SCHEDULER_Dispatch(&(nfcAO->super), (TEvent) {.sig = NFC_RF_PUT_MSG});
 
-    if (nfcAO->st25dvRegs.interruptStatus.bitFields.RF_WRITE) {
-        // TODO handle RF write
-    };
+    if (isFieldChanged || isGetMessage || isPutMessage) return &(nfcStatesList[NFC_ST_IDLE]);
 
-    return &(nfcStatesList[NFC_ST_IDLE]);
+    return _idle(AO, event);
 }
 
+/**
+ * @brief Phone is gone, it resumes download by new request from the last received offset
+ * @details Field events are accepted in any state, only idle one should start pending transfer.
+ * Field presence is already updated from the interrupt status.
+ */
+static const TState *_onFieldFalling(TActiveObject *const AO, TEvent event) {
+    TNFCActiveObject *nfcAO = (TNFCActiveObject *) AO;
+
+    NFC_StopLogDownload(nfcAO);
+    _dispatchFieldChange(APP_SIG_NFC_RF_FIELD_DISAPPEAR);
+
+    if (&(nfcStatesList[NFC_ST_IDLE]) == AO->state) return _idle(AO, event);
+
+    return AO->state;
+};
+
+/** @brief Phone is in field, nothing to do till it puts a request */
+static const TState *_onFieldRising(TActiveObject *const AO, TEvent event) {
+    _dispatchFieldChange(APP_SIG_NFC_RF_FIELD_APPEARS);
+
+    if (&(nfcStatesList[NFC_ST_IDLE]) == AO->state) return _idle(AO, event);
+
+    return AO->state;
+};
+
+/** @brief Phone has read the response, mailbox is free for the next one */
+static const TState *_onRFGetMessage(TActiveObject *const AO, TEvent event) {
+    TNFCActiveObject *nfcAO = (TNFCActiveObject *) AO;
+
+    nfcAO->download.isMailboxFree = true;
+    NFC_PrefetchResponse(nfcAO); // unless prefetched already, see NFC_RESPONSE_PREFETCH
+
+    return _idle(AO, event);
+};
+
+/** @brief Phone has put the request, mailbox is busy till request is read */
+static const TState *_onRFPutMessage(TActiveObject *const AO, TEvent event) {
+    TNFCActiveObject *nfcAO = (TNFCActiveObject *) AO;
+
+    _LED_Clear();
+    nfcAO->download.isMailboxFree = false;
+
+    return _readMailboxLength(AO, event);
+};
+
+/** @brief Build status image from storage summary, it is written only if storage has samples */
+static const TState *_updateNDEF(TActiveObject *const AO, TEvent event) {
+    TNFCActiveObject *nfcAO = (TNFCActiveObject *) AO;
+
+    TIMERS_Arm(NFC_NDEF_UPDATE_TIMER_ID, AO, (TEvent) {.sig = NFC_NDEF_UPDATE}, NFC_NDEF_UPDATE_PERIOD_MS);
+
+    if ((NULL == systemActorsList[STORAGE_AO_ID]) || (0 == STORAGE_GetSummary()->samples))
+        return &(nfcStatesList[NFC_ST_IDLE]);
+
+    NFC_NDEF_Build(nfcAO->ndef.image, STORAGE_GetSummary(), STORAGE_GetLastSample());
+    nfcAO->ndef.offset = 0;
+    nfcAO->retriesLeft = NFC_TRANSFER_RETRIES_MAX;
+
+    if (!nfcAO->ndef.isCached) return _readNDEF(AO, event);
+
+    return _writeNDEF(AO, event);
+};
+
+/** @brief Read back image written before, once per boot, so unchanged blocks are not rewritten */
+static const TState *_readNDEF(TActiveObject *const AO, TEvent event) {
+    TNFCActiveObject *nfcAO = (TNFCActiveObject *) AO;
+
+    DRV_I2C_WriteReadTransferAdd(
+            nfcAO->drvI2CHandle,
+            ST25DV_ADDR_DATA_I2C,
+            (void *const) &ST25DV_NDEF_REG,
+            NFC_CMD_SIZE,
+            nfcAO->ndef.written,
+            NFC_NDEF_IMAGE_SIZE,
+            &(nfcAO->transferHandle)
+    );
+
+    NFC_DispatchErrorOnInvalidTransfer(nfcAO);
+    METRICS_I2C_TRANSFER(NFC_CMD_SIZE + NFC_NDEF_IMAGE_SIZE, nfcAO->i2cSetup.clockSpeed);
+    nfcAO->retriesLeft--;
+
+    return &(nfcStatesList[NFC_ST_READ_NDEF]);
+};
+
+// retries are checked before the transfer, so no transfer is in flight when update is given up
+static const TState *_retryReadNDEF(TActiveObject *const AO, TEvent event) {
+    TNFCActiveObject *nfcAO = (TNFCActiveObject *) AO;
+
+    if (NO_RETRIES_LEFT == nfcAO->retriesLeft) return _abortNDEF(AO, event);
+
+    return _readNDEF(AO, event);
+};
+
+static const TState *_ndefRead(TActiveObject *const AO, TEvent event) {
+    TNFCActiveObject *nfcAO = (TNFCActiveObject *) AO;
+
+    nfcAO->ndef.isCached = true;
+
+    return _writeNDEF(AO, event);
+};
+
+/** @brief Write the next run of changed blocks, go idle when image is written */
+static const TState *_writeNDEF(TActiveObject *const AO, TEvent event) {
+    TNFCActiveObject *nfcAO = (TNFCActiveObject *) AO;
+
+    if (!NFC_NDEF_FindDelta(nfcAO->ndef.image, nfcAO->ndef.written, nfcAO->ndef.offset, &(nfcAO->ndef.offset),
+                            &(nfcAO->ndef.size)))
+        return _idle(AO, event);
+
+    nfcAO->retriesLeft = NFC_TRANSFER_RETRIES_MAX; // each run has its own retries budget
+    _transferNDEF(nfcAO);
+
+    return &(nfcStatesList[NFC_ST_WRITE_NDEF]);
+};
+
+static const TState *_retryWriteNDEF(TActiveObject *const AO, TEvent event) {
+    TNFCActiveObject *nfcAO = (TNFCActiveObject *) AO;
+
+    if (NO_RETRIES_LEFT == nfcAO->retriesLeft) return _abortNDEF(AO, event);
+
+    _transferNDEF(nfcAO);
+
+    return &(nfcStatesList[NFC_ST_WRITE_NDEF]);
+};
+
+/** @brief Run is written, the next one waits till EEPROM page is programmed, ST25DV NACKs meanwhile */
+static const TState *_ndefWritten(TActiveObject *const AO, TEvent event) {
+    TNFCActiveObject *nfcAO = (TNFCActiveObject *) AO;
+
+    memcpy(nfcAO->ndef.written + nfcAO->ndef.offset, nfcAO->ndef.image + nfcAO->ndef.offset, nfcAO->ndef.size);
+    nfcAO->ndef.offset += nfcAO->ndef.size;
+    METRICS_ADD(eepromBytesWritten, nfcAO->ndef.size);
+
+    TIMERS_Arm(NFC_NDEF_WRITE_TIMER_ID, AO, (TEvent) {.sig = NFC_NDEF_WRITE}, NFC_NDEF_WRITE_TIME_MS);
+
+    return &(nfcStatesList[NFC_ST_WRITE_NDEF]);
+};
+
+/** @brief EEPROM content is not known after failed transfer, it is read back on the next update */
+static const TState *_abortNDEF(TActiveObject *const AO, TEvent event) {
+    TNFCActiveObject *nfcAO = (TNFCActiveObject *) AO;
+
+    nfcAO->ndef.isCached = false;
+
+    return _idle(AO, event);
+};
+
 static const TState *_prepareMailbox(TActiveObject *const AO, TEvent event) {
     TNFCActiveObject *nfcAO = (TNFCActiveObject *) AO;
 
@@ -194,12 +536,12 @@ static bool _refreshRetries(TActiveObject *const AO, void *const ctx) {
 // error on i2c transfer queuing
 void NFC_DispatchErrorOnInvalidTransfer(TNFCActiveObject *const nfcAO) {
     if (DRV_I2C_TRANSFER_HANDLE_INVALID == nfcAO->transferHandle) {
-        ActiveObject_Dispatch(&(nfcAO->super), (TEvent) {.sig = NFC_ERROR});
+        SCHEDULER_Dispatch(&(nfcAO->super), (TEvent) {.sig = NFC_ERROR});
     };
 };
 
 void NFC_VerifyRetries(TNFCActiveObject *const nfcAO) {
     if (NO_RETRIES_LEFT == nfcAO->retriesLeft) {
-        ActiveObject_Dispatch(&(nfcAO->super), (TEvent) {.sig = NFC_I2C_TRANSFER_MAX_RETRIES});
+        SCHEDULER_Dispatch(&(nfcAO->super), (TEvent) {.sig = NFC_I2C_TRANSFER_MAX_RETRIES});
     }
 };
@@ -0,0 +1,211 @@
+/**
+ * @brief NFC log download over Fast Transfer mailbox
+ * @details Storage streams the requested log range chunk by chunk, chunks are cut into mailbox responses.
+ * Next response is prefetched to its own buffer while phone reads the previous one from mailbox,
+ * so only I2C write is left between RF_GET_MSG and the next response being available.
+ * NFC_RESPONSE_PREFETCH 0 assembles it only once mailbox is free, to measure what prefetch saves.
+ * @see nfc_protocol.defs.h
+*/
+
+#include "./nfc.h"
+
+#if STORAGE_STREAM_CHUNK_SIZE > NFC_PACK_CHUNK_SIZE_MAX
+#error "storage chunk does not fit packed block"
+#endif
+
+extern TActiveObject *systemActorsList[ACTIVE_OBJECTS_MAX];
+
+static inline void _resetResponse(TNFCActiveObject *const nfcAO, uint8_t command) {
+    nfcAO->download.isActive = true;
+    nfcAO->download.isResponseReady = false;
+    nfcAO->download.isLastResponse = false;
+    nfcAO->download.command = command;
+    nfcAO->download.sequence = 0;
+    nfcAO->download.bytesLeft = 0;
+    nfcAO->download.chunk = NULL;
+    nfcAO->download.source = NULL;
+    nfcAO->download.responseSize = sizeof(TNFCProtocolResponseHeader);
+};
+
+static inline void _releaseChunk(TNFCActiveObject *const nfcAO) {
+    const TStorageStreamChunk *const chunk = nfcAO->download.chunk;
+
+    nfcAO->download.chunk = NULL;
+    nfcAO->download.chunkAddress = chunk->address + chunk->size;
+    if (nfcAO->download.streamRequest.ringEndAddress == nfcAO->download.chunkAddress)
+        nfcAO->download.chunkAddress = nfcAO->download.streamRequest.ringStartAddress;
+    SCHEDULER_Dispatch(systemActorsList[STORAGE_AO_ID], (TEvent) {.sig = STORAGE_STREAM_RELEASE});
+};
+
+// put header in front of payload prefetched, response is ready to be written
+static inline void _completeResponse(TNFCActiveObject *const nfcAO, uint8_t status) {
+    const uint16_t payloadSize = nfcAO->download.responseSize - sizeof(TNFCProtocolResponseHeader);
+    const TNFCProtocolResponseHeader header = {
+            .command = nfcAO->download.command,
+            .status = status,
+            .sequence = nfcAO->download.sequence++,
+            .offset = nfcAO->download.offset - payloadSize
+    };
+
+    memcpy(nfcAO->download.response.mailbox, &header, sizeof(TNFCProtocolResponseHeader));
+    nfcAO->download.isResponseReady = true;
+    nfcAO->download.isLastResponse = (NFC_PROTOCOL_STATUS_OK != status);
+};
+
+void NFC_StartLogDownload(TNFCActiveObject *const nfcAO, const TNFCProtocolLogRequest *const request) {
+    TActiveObject *storageAO = systemActorsList[STORAGE_AO_ID];
+    const bool isIndex = (NFC_PROTOCOL_CMD_GET_INDEX == request->command);
+
+    _resetResponse(nfcAO, request->command);
+    nfcAO->download.isPacked = (0 != (request->flags & NFC_PROTOCOL_FLAG_PACKED));
+    nfcAO->download.offset = request->offset;
+
+    if (NULL == storageAO) {
+        nfcAO->download.status = NFC_PROTOCOL_STATUS_BUSY;
+        return NFC_PrefetchResponse(nfcAO);
+    }
+
+    const uint32_t logSize = isIndex ? STORAGE_GetIndexSize() : STORAGE_GetLogSize();
+
+    if (request->offset > logSize) {
+        nfcAO->download.status = NFC_PROTOCOL_STATUS_OUT_OF_RANGE;
+        return NFC_PrefetchResponse(nfcAO);
+    }
+
+    const uint32_t bytesTillEnd = logSize - request->offset;
+    nfcAO->download.bytesLeft = ((NFC_PROTOCOL_LOG_SIZE_TILL_END == request->size) || (request->size > bytesTillEnd))
+                                ? bytesTillEnd : request->size;
+
+    // nothing to send, the only response is header
+    if (0 == nfcAO->download.bytesLeft) {
+        nfcAO->download.status = NFC_PROTOCOL_STATUS_LAST;
+        return NFC_PrefetchResponse(nfcAO);
+    }
+
+    nfcAO->download.status = NFC_PROTOCOL_STATUS_OK;
+    if (nfcAO->download.isPacked) nfcAO->download.offset = 0; // packed stream offset
+    nfcAO->download.chunkAddress = isIndex ? STORAGE_GetIndexAddress(request->offset) : STORAGE_GetLogAddress(request->offset);
+    nfcAO->download.streamRequest = (TStorageStreamRequest) {
+            .address = nfcAO->download.chunkAddress,
+            .size = nfcAO->download.bytesLeft,
+            .ringStartAddress = isIndex ? INDEX_DATA_START_ADDRESS : LOG_DATA_START_ADDRESS,
+            .ringEndAddress = isIndex ? INDEX_DATA_END_ADDRESS : LOG_DATA_END_ADDRESS,
+            .consumer = &(nfcAO->super),
+            .chunkReadySig = NFC_LOG_CHUNK_READY
+    };
+
+    SCHEDULER_Dispatch(storageAO, (TEvent) {
+            .sig = STORAGE_STREAM_OPEN,
+            .payload = &(nfcAO->download.streamRequest),
+            .size = sizeof(TStorageStreamRequest)
+    });
+};
+
+void NFC_Respond(TNFCActiveObject *const nfcAO, uint8_t command, NFC_PROTOCOL_STATUS status, const void *const payload, uint16_t size) {
+    NFC_StopLogDownload(nfcAO);
+
+    _resetResponse(nfcAO, command);
+    if (size > NFC_PROTOCOL_PAYLOAD_MAX) size = NFC_PROTOCOL_PAYLOAD_MAX;
+    if (0 != size) memcpy(nfcAO->download.response.mailbox + sizeof(TNFCProtocolResponseHeader), payload, size);
+    nfcAO->download.responseSize += size;
+    nfcAO->download.offset = size; // payload offset is 0
+    nfcAO->download.status = status;
+
+    NFC_PrefetchResponse(nfcAO);
+};
+
+void NFC_StopLogDownload(TNFCActiveObject *const nfcAO) {
+    TActiveObject *storageAO = systemActorsList[STORAGE_AO_ID];
+
+    if (nfcAO->download.isActive && (NFC_PROTOCOL_STATUS_OK == nfcAO->download.status) && (NULL != storageAO))
+        SCHEDULER_Dispatch(storageAO, (TEvent) {.sig = STORAGE_STREAM_CLOSE});
+
+    nfcAO->download.isActive = false;
+    nfcAO->download.bytesLeft = 0;
+    nfcAO->download.chunk = NULL;
+    nfcAO->download.source = NULL;
+};
+
+// chunk becomes the source, packed one is released at once, so storage reads the next chunk ahead
+static void _useChunk(TNFCActiveObject *const nfcAO) {
+    const TStorageStreamChunk *const chunk = nfcAO->download.chunk;
+
+    nfcAO->download.bytesLeft -= chunk->size;
+    nfcAO->download.isSourceLast = (0 == nfcAO->download.bytesLeft);
+    nfcAO->download.sourceOffset = 0;
+
+    if (nfcAO->download.isPacked) {
+        nfcAO->download.source = nfcAO->download.packed;
+        nfcAO->download.sourceSize = NFC_PACK_Encode(chunk->data, chunk->size, nfcAO->download.packed);
+        _releaseChunk(nfcAO);
+    } else {
+        nfcAO->download.source = chunk->data;
+        nfcAO->download.sourceSize = chunk->size;
+    }
+};
+
+void NFC_TakeLogChunk(TNFCActiveObject *const nfcAO, const TStorageStreamChunk *const chunk) {
+    if (!nfcAO->download.isActive || (NULL != nfcAO->download.chunk) ||
+        (NULL == chunk) || (chunk->address != nfcAO->download.chunkAddress) || (chunk->size > nfcAO->download.bytesLeft))
+        return;
+
+    nfcAO->download.chunk = chunk;
+
+    // chunk read ahead waits till packed block before it is prefetched
+    if (NULL != nfcAO->download.source) return;
+
+    _useChunk(nfcAO);
+    NFC_PrefetchResponse(nfcAO);
+};
+
+bool NFC_IsResponseReady(TNFCActiveObject *const nfcAO) {
+    return nfcAO->download.isActive && nfcAO->download.isMailboxFree && nfcAO->download.isResponseReady &&
+           !nfcAO->download.isResponseWriting;
+};
+
+void NFC_PrefetchResponse(TNFCActiveObject *const nfcAO) {
+    if (!nfcAO->download.isActive || nfcAO->download.isResponseReady) return;
+#if !NFC_RESPONSE_PREFETCH
+    if (!nfcAO->download.isMailboxFree) return;
+#endif
+
+    // error or empty range is answered by header only
+    if (NFC_PROTOCOL_STATUS_OK != nfcAO->download.status) return _completeResponse(nfcAO, nfcAO->download.status);
+
+    while ((NULL != nfcAO->download.source) && (ST25DV_MAILBOX_SIZE != nfcAO->download.responseSize)) {
+        const uint32_t sourceBytesLeft = nfcAO->download.sourceSize - nfcAO->download.sourceOffset;
+        const uint32_t responseFree = ST25DV_MAILBOX_SIZE - nfcAO->download.responseSize;
+        const uint32_t size = (sourceBytesLeft < responseFree) ? sourceBytesLeft : responseFree;
+
+        memcpy(nfcAO->download.response.mailbox + nfcAO->download.responseSize,
+               nfcAO->download.source + nfcAO->download.sourceOffset, size);
+
+        nfcAO->download.responseSize += size;
+        nfcAO->download.sourceOffset += size;
+        nfcAO->download.offset += size;
+
+        if (nfcAO->download.sourceOffset != nfcAO->download.sourceSize) continue;
+
+        // source is copied, raw chunk goes back to storage to read the next one to its buffer,
+        // packed block is followed by the chunk read ahead meanwhile if any
+        nfcAO->download.source = NULL;
+        if (!nfcAO->download.isPacked && (NULL != nfcAO->download.chunk)) _releaseChunk(nfcAO);
+        if (nfcAO->download.isSourceLast) return _completeResponse(nfcAO, NFC_PROTOCOL_STATUS_LAST);
+        if (NULL != nfcAO->download.chunk) _useChunk(nfcAO);
+    }
+
+    if (ST25DV_MAILBOX_SIZE == nfcAO->download.responseSize) return _completeResponse(nfcAO, NFC_PROTOCOL_STATUS_OK);
+};
+
+void NFC_ResponseWritten(TNFCActiveObject *const nfcAO) {
+    nfcAO->download.isResponseWriting = false;
+    nfcAO->download.isResponseReady = false;
+    nfcAO->download.responseSize = sizeof(TNFCProtocolResponseHeader);
+
+    if (nfcAO->download.isLastResponse) {
+        nfcAO->download.isActive = false;
+        return;
+    }
+
+    NFC_PrefetchResponse(nfcAO);
+};
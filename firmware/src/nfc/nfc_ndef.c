@@ -0,0 +1,74 @@
+#include "./nfc_ndef.h"
+
+// Type 5 tag CC: magic, version 1.0 with read/write access, 512 bytes memory, no special features
+static const uint8_t NFC_NDEF_CC[] = {0xE1, 0x40, 0x40, 0x00};
+static const uint8_t NFC_NDEF_RECORD_HEADER[] = {0xD1, 0x01, 3 + NFC_NDEF_TEXT_SIZE, 'T', 0x02, 'e', 'n'};
+
+#define NFC_NDEF_TLV                        (0x03)
+#define NFC_NDEF_TLV_TERMINATOR             (0xFE)
+
+// SHT3x raw temperature to tenths of degrees Celsius, T = -45 + 175 * raw / 65535
+static inline int32_t _decicelsius(uint16_t rawTemperature) {
+    return -450 + (int32_t) ((1750UL * rawTemperature + 32767UL) / 65535UL);
+};
+
+// SHT3x raw humidity to percents, RH = 100 * raw / 65535
+static inline unsigned long _percents(uint16_t rawHumidity) {
+    return (100UL * rawHumidity + 32767UL) / 65535UL;
+};
+
+// print temperature as [-]d.dC, sign is kept for -0.x
+static int _printTemperature(char *const text, size_t capacity, const char *const label, uint16_t rawTemperature) {
+    const int32_t decicelsius = _decicelsius(rawTemperature);
+    const uint32_t magnitude = (uint32_t) ((decicelsius < 0) ? -decicelsius : decicelsius);
+
+    return snprintf(text, capacity, "%s%s%lu.%luC", label, (decicelsius < 0) ? "-" : "",
+                    (unsigned long) (magnitude / 10), (unsigned long) (magnitude % 10));
+};
+
+void NFC_NDEF_Build(uint8_t *const image, const TStorageSummary *const summary, const TSensorsStorageData *const last) {
+    char text[NFC_NDEF_TEXT_SIZE + 1];
+    int length = 0;
+
+    memset(image, 0, NFC_NDEF_IMAGE_SIZE);
+    memcpy(image, NFC_NDEF_CC, sizeof(NFC_NDEF_CC));
+    image[4] = NFC_NDEF_TLV;
+    image[5] = NFC_NDEF_RECORD_SIZE;
+    memcpy(image + 6, NFC_NDEF_RECORD_HEADER, sizeof(NFC_NDEF_RECORD_HEADER));
+
+    // e.g. "OK T 5.3C RH 45% MIN 2.1C MAX 8.4C", ALARM on any excursion
+    length += snprintf(text + length, sizeof(text) - length, "%s", (0 == summary->excursions) ? "OK" : "ALARM");
+    length += _printTemperature(text + length, sizeof(text) - length, " T ",
+                                last->sht3XTemperatureHumiditySensorData.temperature);
+    length += snprintf(text + length, sizeof(text) - length, " RH %lu%%",
+                       _percents(last->sht3XTemperatureHumiditySensorData.humidity));
+    length += _printTemperature(text + length, sizeof(text) - length, " MIN ", summary->temperatureMin);
+    length += _printTemperature(text + length, sizeof(text) - length, " MAX ", summary->temperatureMax);
+
+    // pad by spaces, record size is fixed, the longest text fits
+    memset(text + length, ' ', NFC_NDEF_TEXT_SIZE - length);
+    memcpy(image + 6 + sizeof(NFC_NDEF_RECORD_HEADER), text, NFC_NDEF_TEXT_SIZE);
+    image[6 + NFC_NDEF_RECORD_SIZE] = NFC_NDEF_TLV_TERMINATOR;
+};
+
+bool NFC_NDEF_FindDelta(const uint8_t *const image, const uint8_t *const written, uint16_t from,
+                        uint16_t *const offset, uint16_t *const size) {
+    uint16_t start = from;
+
+    while ((start < NFC_NDEF_IMAGE_SIZE) && (0 == memcmp(image + start, written + start, NFC_NDEF_BLOCK_SIZE)))
+        start += NFC_NDEF_BLOCK_SIZE;
+
+    if (start >= NFC_NDEF_IMAGE_SIZE) return false;
+
+    const uint16_t pageEnd = (start / NFC_NDEF_WRITE_PAGE_SIZE + 1) * NFC_NDEF_WRITE_PAGE_SIZE;
+    uint16_t end = start + NFC_NDEF_BLOCK_SIZE;
+
+    while ((end < pageEnd) && (end < NFC_NDEF_IMAGE_SIZE) &&
+           (0 != memcmp(image + end, written + end, NFC_NDEF_BLOCK_SIZE)))
+        end += NFC_NDEF_BLOCK_SIZE;
+
+    *offset = start;
+    *size = end - start;
+
+    return true;
+};
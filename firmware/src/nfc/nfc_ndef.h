@@ -0,0 +1,60 @@
+/**
+ * @file nfc_ndef.h
+ * @brief NDEF quick status for any phone, no app and no mailbox protocol needed
+ *
+ * @details Status is a single NDEF Text record in ST25DV user EEPROM, prefixed by Type 5 tag capability container:
+ * CC (4), NDEF TLV (2), record header (4), language ("en") (3), text (NFC_NDEF_TEXT_SIZE), terminator TLV (1),
+ * zero padding to the EEPROM block. Text is padded by spaces to fixed size, so the record layout never changes and
+ * only blocks of changed values differ from the image written before.
+ *
+ * EEPROM is written by blocks (word endurance is per block), changed blocks in a row are written by single transfer
+ * which never crosses I2C write page.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "../storage/storage_summary.h"
+
+#ifdef    __cplusplus
+extern "C" {
+#endif
+
+#ifndef NFC_NDEF_H
+#define NFC_NDEF_H
+
+#define NFC_NDEF_ADDRESS                    (0x0000) // user EEPROM, area 1 is RF readable by default
+#define NFC_NDEF_BLOCK_SIZE                 (4) // EEPROM block
+#define NFC_NDEF_WRITE_PAGE_SIZE            (16) // I2C write page, programmed at once
+#define NFC_NDEF_TEXT_SIZE                  (48)
+#define NFC_NDEF_RECORD_SIZE                (4 + 3 + NFC_NDEF_TEXT_SIZE) // header, "en", text
+#define NFC_NDEF_IMAGE_SIZE                 (((4 + 2 + NFC_NDEF_RECORD_SIZE + 1) + NFC_NDEF_BLOCK_SIZE - 1) / NFC_NDEF_BLOCK_SIZE * NFC_NDEF_BLOCK_SIZE)
+
+/**
+ * @brief Build EEPROM image of status record
+ * @param image NFC_NDEF_IMAGE_SIZE bytes
+ * @param summary summary of stored samples, should have samples
+ * @param last the last stored sample
+ */
+void NFC_NDEF_Build(uint8_t *const image, const TStorageSummary *const summary, const TSensorsStorageData *const last);
+
+/**
+ * @brief Find the next run of changed blocks to write
+ * @param image new image
+ * @param written image in EEPROM
+ * @param from image offset to search from, block aligned
+ * @param[out] offset run offset
+ * @param[out] size run size, run never crosses I2C write page
+ * @return true if run is found, false if images are the same from the offset on
+ */
+bool NFC_NDEF_FindDelta(const uint8_t *const image, const uint8_t *const written, uint16_t from,
+                        uint16_t *const offset, uint16_t *const size);
+
+#ifdef    __cplusplus
+}
+#endif
+
+#endif //NFC_NDEF_H
@@ -0,0 +1,141 @@
+#include "./nfc_pack.h"
+
+#define LITERAL_RUN_MAX     (0x80)
+#define MATCH_TOKEN         (0x80)
+#define MATCH_LENGTH_MIN    (3)
+#define MATCH_LENGTH_MAX    (MATCH_LENGTH_MIN + 0x1F)
+#define MATCH_DISTANCE_MAX  (0x400)
+
+#define HASH_BITS           (8)
+#define HASH(p)             ((uint8_t) (((p)[0] * 33U + (p)[1]) * 33U + (p)[2]))
+
+// last chunk position + 1 of each 3-byte sequence hash, 0 - none
+static uint16_t hashTable[1 << HASH_BITS];
+
+static inline uint8_t *_putU16(uint8_t *out, uint16_t value) {
+    *out++ = (uint8_t) value;
+    *out++ = (uint8_t) (value >> 8);
+    return out;
+};
+
+static inline uint16_t _getU16(const uint8_t *in) {
+    return (uint16_t) (in[0] | (in[1] << 8));
+};
+
+static inline uint8_t *_putLiterals(uint8_t *out, const uint8_t *literals, size_t count) {
+    while (0 != count) {
+        const size_t run = (count < LITERAL_RUN_MAX) ? count : LITERAL_RUN_MAX;
+
+        *out++ = (uint8_t) (run - 1);
+        memcpy(out, literals, run);
+        out += run;
+        literals += run;
+        count -= run;
+    }
+    return out;
+};
+
+size_t NFC_PACK_Encode(const uint8_t *const in, size_t size, uint8_t *const out) {
+    if (size > NFC_PACK_CHUNK_SIZE_MAX) return 0;
+
+    // tokens are never longer than raw, stored raw block is the fallback once packing stops paying off
+    uint8_t *const tokens = out + NFC_PACK_HEADER_SIZE;
+    uint8_t *const tokensEnd = tokens + size;
+    uint8_t *cursor = tokens;
+    size_t literalsStart = 0;
+    size_t i = 0;
+
+    memset(hashTable, 0, sizeof(hashTable));
+
+    while (i + MATCH_LENGTH_MIN <= size) {
+        const uint8_t hash = HASH(in + i);
+        const size_t candidate = hashTable[hash];
+        size_t length = 0;
+
+        hashTable[hash] = (uint16_t) (i + 1);
+
+        if ((0 != candidate) && (i - (candidate - 1) <= MATCH_DISTANCE_MAX)) {
+            const uint8_t *const match = in + candidate - 1;
+            const size_t lengthMax = (size - i < MATCH_LENGTH_MAX) ? size - i : MATCH_LENGTH_MAX;
+
+            while ((length < lengthMax) && (match[length] == in[i + length])) length++;
+        }
+
+        if (length < MATCH_LENGTH_MIN) {
+            i++;
+            continue;
+        }
+
+        // worst case literal run costs 1 extra byte per 128
+        if (cursor + (i - literalsStart) + (i - literalsStart) / LITERAL_RUN_MAX + 3 > tokensEnd) break;
+
+        const size_t distance = i - (candidate - 1) - 1;
+        cursor = _putLiterals(cursor, in + literalsStart, i - literalsStart);
+        *cursor++ = (uint8_t) (MATCH_TOKEN | ((length - MATCH_LENGTH_MIN) << 2) | (distance >> 8));
+        *cursor++ = (uint8_t) distance;
+
+        i += length;
+        literalsStart = i;
+    }
+
+    const size_t literalsLeft = size - literalsStart;
+    const bool isPacked = cursor + literalsLeft + (literalsLeft + LITERAL_RUN_MAX - 1) / LITERAL_RUN_MAX < tokensEnd;
+
+    if (isPacked) {
+        cursor = _putLiterals(cursor, in + literalsStart, literalsLeft);
+    } else {
+        memcpy(tokens, in, size);
+        cursor = tokensEnd;
+    }
+
+    _putU16(_putU16(out, (uint16_t) size), isPacked ? (uint16_t) (cursor - tokens) : 0);
+
+    return cursor - out;
+};
+
+size_t NFC_PACK_Decode(const uint8_t *const in, size_t size, uint8_t *const out, size_t capacity) {
+    if (size < NFC_PACK_HEADER_SIZE) return 0;
+
+    const size_t rawSize = _getU16(in);
+    const size_t packedSize = _getU16(in + 2);
+    const uint8_t *cursor = in + NFC_PACK_HEADER_SIZE;
+
+    if (rawSize > capacity) return 0;
+
+    if (0 == packedSize) {
+        if (NFC_PACK_HEADER_SIZE + rawSize > size) return 0;
+        memcpy(out, cursor, rawSize);
+        return rawSize;
+    }
+
+    if (NFC_PACK_HEADER_SIZE + packedSize > size) return 0;
+
+    const uint8_t *const tokensEnd = cursor + packedSize;
+    size_t length = 0;
+
+    while (cursor < tokensEnd) {
+        const uint8_t token = *cursor++;
+
+        if (token < MATCH_TOKEN) {
+            const size_t run = token + 1;
+            if ((cursor + run > tokensEnd) || (length + run > rawSize)) return 0;
+
+            memcpy(out + length, cursor, run);
+            cursor += run;
+            length += run;
+            continue;
+        }
+
+        if (cursor >= tokensEnd) return 0;
+
+        const size_t matchLength = ((token >> 2) & 0x1F) + MATCH_LENGTH_MIN;
+        const size_t distance = (((token & 0x03) << 8) | *cursor++) + 1;
+        if ((distance > length) || (length + matchLength > rawSize)) return 0;
+
+        // byte by byte, match may overlap its own output (runs)
+        for (size_t j = 0; j < matchLength; j++, length++)
+            out[length] = out[length - distance];
+    }
+
+    return (length == rawSize) ? length : 0;
+};
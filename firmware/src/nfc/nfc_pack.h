@@ -0,0 +1,52 @@
+/**
+ * @file nfc_pack.h
+ * @brief Log chunks packing for NFC download
+ *
+ * @details Byte aligned LZ77 with the chunk itself as the window, so no extra window memory is needed.
+ * Each storage chunk is packed to an independent block: raw size u16, packed size u16 (0 - block is stored raw),
+ * then tokens. Token byte below 0x80 is a literal run of (token + 1) bytes following it. Token byte 0x80 and above
+ * is a match of 3..34 bytes at 1..1024 bytes back: length - 3 in bits [6:2], distance - 1 in bits [1:0] of token
+ * and the next byte. Erased page tails, repeated delta records and sector headers shrink the most.
+ * All fields are little endian.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#ifdef    __cplusplus
+extern "C" {
+#endif
+
+#ifndef NFC_PACK_H
+#define NFC_PACK_H
+
+#define NFC_PACK_HEADER_SIZE                (4) // raw size + packed size
+#define NFC_PACK_CHUNK_SIZE_MAX             (1024) // match distance limit
+#define NFC_PACK_BLOCK_SIZE(rawSize)        (NFC_PACK_HEADER_SIZE + (rawSize)) // worst case is stored raw
+
+/**
+ * @brief Pack chunk to a block
+ * @param in chunk
+ * @param size chunk size, up to NFC_PACK_CHUNK_SIZE_MAX
+ * @param out block, NFC_PACK_BLOCK_SIZE(size) bytes
+ * @return block size, 0 if chunk is too big
+ */
+size_t NFC_PACK_Encode(const uint8_t *const in, size_t size, uint8_t *const out);
+
+/**
+ * @brief Unpack block, reference for the phone side
+ * @param in block
+ * @param size block bytes available
+ * @param out chunk
+ * @param capacity
+ * @return chunk size, 0 on malformed or truncated block
+ */
+size_t NFC_PACK_Decode(const uint8_t *const in, size_t size, uint8_t *const out, size_t capacity);
+
+#ifdef    __cplusplus
+}
+#endif
+
+#endif //NFC_PACK_H
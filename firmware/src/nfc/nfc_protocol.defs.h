@@ -0,0 +1,157 @@
+/**
+ * @file nfc_protocol.defs.h
+ * @brief Messages exchanged with the phone over ST25DV fast transfer mailbox
+ *
+ * @details Phone puts request message to the mailbox, device answers with one or more response messages,
+ * next one is written as soon as phone reads the previous one (RF_GET_MSG). All fields are little endian.
+ * Every request starts with command and flags bytes, all commands but GET_LOG are answered by a single response.
+ *
+ * Log download: phone requests byte range of the log, offset 0 is the start of the oldest sector.
+ * Log content is sent as is (sectors headers, record blocks and erased pages tails), so phone decodes it
+ * with the same record format as storage. Each response carries sequence number and log offset of its payload,
+ * so phone detects lost messages and resumes download by new request from the last received offset.
+ *
+ * With NFC_PROTOCOL_FLAG_PACKED log is sent as packed blocks, one per storage chunk (see nfc_pack.h),
+ * response offset is the offset in packed stream then, resume offset is the sum of raw sizes of blocks received.
+ *
+ * Index download: GET_INDEX is the same as GET_LOG, over the index ring. Index is an array of 32-byte entries
+ * (see TStorageIndexEntry): zone map entry per completed log sector (time range, min/max temperature and humidity)
+ * and entry per temperature excursion (start/end records and times, extremes). Entries refer to records by log
+ * position, log offset is the position minus oldestPosition of status. Entries with CRC mismatch are erased padding,
+ * entries below oldestPosition refer to overwritten records. Phone reads the index first, then requests only
+ * log ranges of interest.
+ *
+ * Diagnostics: GET_QUEUES answers usage of every actor events queue (peak, counters, max dispatch to handle latency)
+ * to right-size queues from field data. GET_STATUS reports log integrity verified on boot: pages checked and corrupted.
+ */
+
+#include <stdint.h>
+
+#ifdef    __cplusplus
+extern "C" {
+#endif
+
+#ifndef NFC_PROTOCOL_DEFS_H
+#define NFC_PROTOCOL_DEFS_H
+
+#define NFC_PROTOCOL_VERSION                (1)
+#define NFC_PROTOCOL_PAYLOAD_MAX            (ST25DV_MAILBOX_SIZE - sizeof(TNFCProtocolResponseHeader))
+#define NFC_PROTOCOL_LOG_SIZE_TILL_END      (0) // request size to download log till its end
+
+/* GET_LOG request flags */
+#define NFC_PROTOCOL_FLAG_PACKED            (0x01) // send log packed
+
+/** @brief request commands */
+typedef enum {
+    NFC_PROTOCOL_CMD_NONE = 0x00,
+    NFC_PROTOCOL_CMD_GET_LOG = 0x01,
+    NFC_PROTOCOL_CMD_GET_STATUS = 0x02,
+    NFC_PROTOCOL_CMD_GET_SUMMARY = 0x03,
+    NFC_PROTOCOL_CMD_SET_SAMPLING = 0x04,
+    NFC_PROTOCOL_CMD_SET_TIME = 0x05,
+    NFC_PROTOCOL_CMD_GET_INDEX = 0x06,
+    NFC_PROTOCOL_CMD_GET_QUEUES = 0x07,
+    NFC_PROTOCOL_CMD_MAX
+} NFC_PROTOCOL_CMD;
+
+/** @brief response statuses */
+typedef enum {
+    NFC_PROTOCOL_STATUS_OK = 0x00, /**< more responses follow */
+    NFC_PROTOCOL_STATUS_LAST = 0x01, /**< the last response to the request */
+    NFC_PROTOCOL_STATUS_BAD_REQUEST = 0x02,
+    NFC_PROTOCOL_STATUS_OUT_OF_RANGE = 0x03,
+    NFC_PROTOCOL_STATUS_BUSY = 0x04, /**< storage is not available, e.g. USB is connected */
+    NFC_PROTOCOL_STATUS_UNSUPPORTED = 0x05, /**< unknown command */
+} NFC_PROTOCOL_STATUS;
+
+/** @brief head of every response message, payload follows */
+typedef struct __attribute__((packed)) {
+    uint8_t command; /**< request command */
+    uint8_t status; /**< NFC_PROTOCOL_STATUS */
+    uint16_t sequence; /**< response number within request, from 0 */
+    uint32_t offset; /**< log (or packed stream) offset of the payload */
+} TNFCProtocolResponseHeader;
+
+/** @brief head of every request, the whole request of commands without parameters */
+typedef struct __attribute__((packed)) {
+    uint8_t command; /**< NFC_PROTOCOL_CMD */
+    uint8_t flags; /**< command specific, 0 if none */
+} TNFCProtocolRequestHeader;
+
+/** @brief NFC_PROTOCOL_CMD_GET_LOG (GET_INDEX) request */
+typedef struct __attribute__((packed)) {
+    uint8_t command; /**< NFC_PROTOCOL_CMD_GET_LOG or NFC_PROTOCOL_CMD_GET_INDEX */
+    uint8_t flags; /**< NFC_PROTOCOL_FLAG_... */
+    uint32_t offset; /**< log (index) offset to start from */
+    uint32_t size; /**< bytes to download, NFC_PROTOCOL_LOG_SIZE_TILL_END for the whole rest of log */
+} TNFCProtocolLogRequest;
+
+/** @brief NFC_PROTOCOL_CMD_SET_SAMPLING request */
+typedef struct __attribute__((packed)) {
+    uint8_t command; /**< NFC_PROTOCOL_CMD_SET_SAMPLING */
+    uint8_t flags; /**< reserved, 0 */
+    uint32_t periodMs; /**< sensors sampling period */
+} TNFCProtocolSamplingRequest;
+
+/** @brief NFC_PROTOCOL_CMD_SET_TIME request */
+typedef struct __attribute__((packed)) {
+    uint8_t command; /**< NFC_PROTOCOL_CMD_SET_TIME */
+    uint8_t flags; /**< reserved, 0 */
+    uint32_t time; /**< UTC, seconds since 1970 */
+} TNFCProtocolTimeRequest;
+
+/** @brief NFC_PROTOCOL_CMD_GET_STATUS response payload */
+typedef struct __attribute__((packed)) {
+    uint8_t protocolVersion; /**< NFC_PROTOCOL_VERSION */
+    uint8_t recordFormatVersion; /**< log records format */
+    uint32_t time; /**< device time, UTC, seconds since 1970 */
+    uint32_t logSize; /**< bytes to download the whole log */
+    uint32_t samplingPeriodMs; /**< sensors sampling period */
+    uint32_t indexSize; /**< bytes to download the whole index */
+    uint32_t oldestPosition; /**< log position of log offset 0, index entries below it are stale */
+    uint32_t logPagesChecked; /**< by the last log integrity verification since boot, 0 if none completed yet */
+    uint32_t logPagesCorrupted; /**< pages with CRC mismatch or torn records found by it */
+} TNFCProtocolStatus;
+
+/**
+ * @brief NFC_PROTOCOL_CMD_GET_SUMMARY response payload, statistics of all samples stored
+ * @details Temperature and humidity are SHT3x raw values as in log records, T = -45 + 175 * raw / 65535 C,
+ * RH = 100 * raw / 65535 %. Time is counted by sampling intervals.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t samples; /**< samples stored, the rest of fields are 0 if none */
+    uint32_t firstTimestamp; /**< UTC, seconds since 1970 */
+    uint32_t lastTimestamp;
+    uint16_t temperatureMin;
+    uint16_t temperatureMax;
+    uint16_t temperatureMean;
+    uint16_t meanKineticTemperature;
+    uint16_t humidityMin;
+    uint16_t humidityMax;
+    uint16_t temperatureLow; /**< excursion thresholds */
+    uint16_t temperatureHigh;
+    uint32_t secondsAbove; /**< time above high threshold */
+    uint32_t secondsBelow; /**< time below low threshold */
+    uint32_t excursions; /**< times temperature left the range */
+    uint8_t range; /**< range of the last sample: 0 - in, 1 - above, 2 - below */
+} TNFCProtocolSummary;
+
+/**
+ * @brief NFC_PROTOCOL_CMD_GET_QUEUES response payload entry, payload is an entry per scheduled actor
+ * @details Counters are since boot and wrap.
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t actorId; /**< SYSTEM_ACTIVE_OBJECT_IDS */
+    uint8_t capacity; /**< queue slots */
+    uint8_t highWater; /**< max events queued at once */
+    uint32_t enqueues; /**< events dispatched */
+    uint32_t dequeues; /**< events handled */
+    uint32_t overflows; /**< events dropped on full queue */
+    uint32_t maxLatencyUs; /**< max time from dispatch to handling, 0 if not measured */
+} TNFCProtocolQueueStats;
+
+#ifdef    __cplusplus
+}
+#endif
+
+#endif //NFC_PROTOCOL_DEFS_H
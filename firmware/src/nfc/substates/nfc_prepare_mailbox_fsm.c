@@ -1,6 +1,10 @@
 /**
  * @brief NFC Prepare Mailbox sub FSM
- * @details Mailbox MODE access for W when I2C security session is open
+ * @details Mailbox MODE access for W when I2C security session is open.
+ * Static (EEPROM) config registers are read back once and cached, only differing ones are written, security session
+ * is opened only to write them. Mailbox is enabled on each start, as MB_CTRL_Dyn is dynamic.
+ * Static register write is programmed to EEPROM, ST25DV NACKs I2C meanwhile, so the next step waits for it
+ * as NDEF write does.
 */
 
 #include "../nfc.h"
@@ -10,9 +14,10 @@ static const uint8_t ST25DV_GPO_REG[] = {0x00, 0x00};
 static const uint8_t ST25DV_MB_MODE_REG[] = {0x00, 0x0D};
 static const uint8_t ST25DV_I2C_PWD_REG[] = {0x09, 0x00};
 
-// states are placed in order of execution to prepare NFC mailbox
+// states are placed in order of execution to prepare NFC mailbox, steps not needed are skipped
 typedef enum {
     NFC_PREPARE_MAILBOX_ST_INIT = 0,
+    NFC_PREPARE_MAILBOX_ST_READ_CONFIG,
     NFC_PREPARE_MAILBOX_ST_PRESENT_I2C_PWD,
     NFC_PREPARE_MAILBOX_ST_ALLOW_MB_MODE_WRITE,
     NFC_PREPARE_MAILBOX_ST_ENABLE_FT_MODE,
@@ -20,6 +25,8 @@ typedef enum {
     NFC_PREPARE_MAILBOX_ST_FT_MODE_ENABLED
 } NFC_PREPARE_MAILBOX_STATE;
 
+static void _readConfig(TNFCActiveObject *const nfcAO);
+
 static void _presentI2CPwd(TNFCActiveObject *const nfcAO);
 
 static void _allowMBModeWrite(TNFCActiveObject *const nfcAO);
@@ -28,16 +35,84 @@ static void _enableFTMode(TNFCActiveObject *const nfcAO);
 
 static void _enableGPOPulseOnRF(TNFCActiveObject *const nfcAO);
 
+static inline bool _isMBModeWriteNeeded(TNFCActiveObject *const nfcAO) {
+    return !(nfcAO->st25dvRegs.config.mbMode & ST25DV_MB_MODE_RW_MASK);
+};
+
+static inline bool _isGPOWriteNeeded(TNFCActiveObject *const nfcAO) {
+    return ST25DV_GPO_CONFIG != nfcAO->st25dvRegs.config.gpo;
+};
+
+static bool _isStepNeeded(TNFCActiveObject *const nfcAO, NFC_PREPARE_MAILBOX_STATE state) {
+    switch (state) {
+        case NFC_PREPARE_MAILBOX_ST_READ_CONFIG:
+            return !nfcAO->st25dvRegs.config.isCached;
+        case NFC_PREPARE_MAILBOX_ST_PRESENT_I2C_PWD:
+            return _isMBModeWriteNeeded(nfcAO) || _isGPOWriteNeeded(nfcAO);
+        case NFC_PREPARE_MAILBOX_ST_ALLOW_MB_MODE_WRITE:
+            return _isMBModeWriteNeeded(nfcAO);
+        case NFC_PREPARE_MAILBOX_ST_GPO_PULSE_ON_RF:
+            return _isGPOWriteNeeded(nfcAO);
+        default:
+            return true;
+    }
+};
+
+// static registers are in EEPROM
+static inline bool _isEEPROMWrite(NFC_PREPARE_MAILBOX_STATE state) {
+    return (NFC_PREPARE_MAILBOX_ST_ALLOW_MB_MODE_WRITE == state) || (NFC_PREPARE_MAILBOX_ST_GPO_PULSE_ON_RF == state);
+};
+
+// cache is updated by read back registers, or by written ones
+static void _updateConfigCache(TNFCActiveObject *const nfcAO, NFC_PREPARE_MAILBOX_STATE state) {
+    switch (state) {
+        case NFC_PREPARE_MAILBOX_ST_READ_CONFIG:
+            nfcAO->st25dvRegs.config.gpo = nfcAO->transferBuf.mailbox[ST25DV_GPO_OFFSET];
+            nfcAO->st25dvRegs.config.mbMode = nfcAO->transferBuf.mailbox[ST25DV_MB_MODE_OFFSET];
+            nfcAO->st25dvRegs.config.isCached = true;
+            return;
+        case NFC_PREPARE_MAILBOX_ST_ALLOW_MB_MODE_WRITE:
+            nfcAO->st25dvRegs.config.mbMode |= ST25DV_MB_MODE_RW_MASK;
+            return;
+        case NFC_PREPARE_MAILBOX_ST_GPO_PULSE_ON_RF:
+            nfcAO->st25dvRegs.config.gpo = ST25DV_GPO_CONFIG;
+            return;
+        default:
+            return;
+    }
+};
+
+void NFC_ResetPrepareMailboxFSM(TNFCActiveObject *const nfcAO) {
+    nfcAO->prepareMailboxState = NFC_PREPARE_MAILBOX_ST_INIT;
+};
+
 void NFC_ProcessPrepareMailboxFSM(TNFCActiveObject *const nfcAO, TEvent event) {
-    static NFC_PREPARE_MAILBOX_STATE FTModeState = NFC_PREPARE_MAILBOX_ST_INIT;
+    NFC_PREPARE_MAILBOX_STATE FTModeState = nfcAO->prepareMailboxState;
 
     if (NFC_I2C_TRANSFER_SUCCESS == event.sig) {
-        FTModeState++; // go to next state in chain @see NFC_PREPARE_MAILBOX_STATE
+        const bool isEEPROMWrite = _isEEPROMWrite(FTModeState);
+
+        _updateConfigCache(nfcAO, FTModeState);
+
+        // go to next needed state in chain @see NFC_PREPARE_MAILBOX_STATE
+        do {
+            FTModeState++;
+        } while (!_isStepNeeded(nfcAO, FTModeState));
+
+        nfcAO->prepareMailboxState = FTModeState;
+
+        // next state runs on NFC_PREPARE_MAILBOX_NEXT, once EEPROM is programmed
+        if (isEEPROMWrite)
+            return TIMERS_Arm(NFC_NDEF_WRITE_TIMER_ID, &nfcAO->super, (TEvent) {.sig = NFC_PREPARE_MAILBOX_NEXT},
+                              NFC_NDEF_WRITE_TIME_MS);
     }
 
     /* on NFC_I2C_TRANSFER_FAIL the state remains the same, and we retry appropriate state handler function */
 
     switch (FTModeState) {
+        case NFC_PREPARE_MAILBOX_ST_READ_CONFIG:
+            _readConfig(nfcAO);
+            break;
         case NFC_PREPARE_MAILBOX_ST_PRESENT_I2C_PWD:
             _presentI2CPwd(nfcAO);
             break;
@@ -51,14 +126,32 @@ void NFC_ProcessPrepareMailboxFSM(TNFCActiveObject *const nfcAO, TEvent event) {
             _enableGPOPulseOnRF(nfcAO);
             break;
         case NFC_PREPARE_MAILBOX_ST_FT_MODE_ENABLED:
-            ActiveObject_Dispatch(&nfcAO->super,
-                                  (TEvent) {.sig = NFC_PREPARE_MAILBOX_SUCCESS}); // notify parent FSM that mailbox is ready
+            SCHEDULER_Dispatch(&nfcAO->super,
+                               (TEvent) {.sig = NFC_PREPARE_MAILBOX_SUCCESS}); // notify parent FSM that mailbox is ready
             break;
         default:
             break; // TODO assert?
     }
 }
 
+/** @brief Read back static config registers GPO..MB_MODE by single transfer */
+static void _readConfig(TNFCActiveObject *const nfcAO) {
+    DRV_I2C_WriteReadTransferAdd(
+            nfcAO->drvI2CHandle,
+            ST25DV_ADDR_SYST_I2C,
+            (void *const) &ST25DV_GPO_REG,
+            NFC_CMD_SIZE,
+            nfcAO->transferBuf.mailbox,
+            NFC_STATIC_CONFIG_SIZE,
+            &(nfcAO->transferHandle)
+    );
+
+    NFC_DispatchErrorOnInvalidTransfer(nfcAO);
+    METRICS_I2C_TRANSFER(NFC_CMD_SIZE + NFC_STATIC_CONFIG_SIZE, nfcAO->i2cSetup.clockSpeed);
+    nfcAO->retriesLeft--;
+    NFC_VerifyRetries(nfcAO);
+};
+
 /** @brief  Presents I2C password, to authorize the I2C writes to protected areas. E.g. MB_CTRL_Dyn*/
 static void _presentI2CPwd(TNFCActiveObject *const nfcAO) {
     memset(nfcAO->transferBuf.raw, 0, NFC_CMD_SIZE + ST25DV_MAILBOX_SIZE);
@@ -81,6 +174,7 @@ static void _presentI2CPwd(TNFCActiveObject *const nfcAO) {
     );
 
     NFC_DispatchErrorOnInvalidTransfer(nfcAO);
+    METRICS_I2C_TRANSFER(NFC_CMD_SIZE + NFC_PASSWORD_SIZE + NFC_PASSWORD_VALIDATION_SIZE + NFC_PASSWORD_SIZE, nfcAO->i2cSetup.clockSpeed);
     nfcAO->retriesLeft--;
     NFC_VerifyRetries(nfcAO);
 };
@@ -101,8 +195,7 @@ static void _allowMBModeWrite(TNFCActiveObject *const nfcAO) {
     );
 
     NFC_DispatchErrorOnInvalidTransfer(nfcAO);
-
-    NFC_DispatchErrorOnInvalidTransfer(nfcAO);
+    METRICS_I2C_TRANSFER(NFC_CMD_SIZE + NFC_SINGLE_BYTE_REG_SIZE, nfcAO->i2cSetup.clockSpeed);
     nfcAO->retriesLeft--;
     NFC_VerifyRetries(nfcAO);
 };
@@ -123,6 +216,7 @@ static void _enableFTMode(TNFCActiveObject *const nfcAO) {
     );
 
     NFC_DispatchErrorOnInvalidTransfer(nfcAO);
+    METRICS_I2C_TRANSFER(NFC_CMD_SIZE + NFC_SINGLE_BYTE_REG_SIZE, nfcAO->i2cSetup.clockSpeed);
     nfcAO->retriesLeft--;
     NFC_VerifyRetries(nfcAO);
 };
@@ -132,8 +226,7 @@ static void _enableGPOPulseOnRF(TNFCActiveObject *const nfcAO) {
     memset(nfcAO->transferBuf.raw, 0, NFC_CMD_SIZE + ST25DV_MAILBOX_SIZE);
 
     memcpy(nfcAO->transferBuf.cmd, ST25DV_GPO_REG, NFC_CMD_SIZE);
-    nfcAO->transferBuf.mailbox[NFC_MAILBOX_HEAD] =
-            ST25DV_GPO_ENABLE_MASK | ST25DV_GPO_RFPUTMSG_MASK | ST25DV_GPO_RFGETMSG_MASK | ST25DV_GPO_FIELDCHANGE_MASK;
+    nfcAO->transferBuf.mailbox[NFC_MAILBOX_HEAD] = ST25DV_GPO_CONFIG;
 
     DRV_I2C_WriteTransferAdd(
             nfcAO->drvI2CHandle,
@@ -144,6 +237,7 @@ static void _enableGPOPulseOnRF(TNFCActiveObject *const nfcAO) {
     );
 
     NFC_DispatchErrorOnInvalidTransfer(nfcAO);
+    METRICS_I2C_TRANSFER(NFC_CMD_SIZE + NFC_SINGLE_BYTE_REG_SIZE, nfcAO->i2cSetup.clockSpeed);
     nfcAO->retriesLeft--;
     NFC_VerifyRetries(nfcAO);
 }
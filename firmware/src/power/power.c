@@ -0,0 +1,91 @@
+#include "./power.h"
+#include "../storage/storage_manager.h"
+
+#if POWER_SLEEP_SIMULATED
+static bool isLoopBusy = true;
+static bool isSimulatedSleep = false;
+static uint64_t simulatedSleepStart = 0;
+#endif
+
+#if METRICS_ENABLED
+static uint64_t sleepTicks = 0;
+
+// sleep time accounted in SYS_TIME ticks, converted on each wake to not lose sub ms sleeps
+static inline void _accountSleep(uint64_t start, bool isStandby) {
+    const uint64_t ticks = SYS_TIME_Counter64Get() - start;
+
+    if (0 == ticks) return;
+
+    sleepTicks += ticks;
+    metrics.sleepTimeMs = (uint32_t) ((sleepTicks * 1000U) / SYS_TIME_FrequencyGet());
+    METRICS_INC(wakes);
+    if (isStandby) METRICS_INC(standbyWakes);
+};
+#endif
+
+// MEMORY driver is polled till its transfer is done, USB stack is polled while cable is on
+static inline bool _isSleepAllowed(void) {
+    return !STORAGE_IsTransferPending() && !USB_VBUS_SENSE_Get();
+};
+
+// SERCOM clocks stop in STANDBY, transfer in flight needs IDLE
+static inline bool _isStandbyAllowed(void) {
+    return !SERCOM0_I2C_IsBusy() && !SERCOM1_SPI_IsBusy();
+};
+
+void POWER_Initialize(void) {
+    SCB->SCR |= SCB_SCR_SEVONPEND_Msk;
+};
+
+void POWER_KeepAwake(void) {
+#if POWER_SLEEP_SIMULATED
+    isLoopBusy = true;
+#endif
+    __SEV();
+};
+
+#if POWER_SLEEP_SIMULATED
+
+/** @brief Loop keeps spinning, time from the first idle pass till the next busy one is accounted as sleep */
+void POWER_Idle(void) {
+    const bool isIdle = !isLoopBusy && _isSleepAllowed();
+
+    isLoopBusy = false;
+
+    if (isIdle && !isSimulatedSleep) {
+        isSimulatedSleep = true;
+        simulatedSleepStart = SYS_TIME_Counter64Get();
+    } else if (!isIdle && isSimulatedSleep) {
+        isSimulatedSleep = false;
+#if METRICS_ENABLED
+        _accountSleep(simulatedSleepStart, false);
+#endif
+    }
+};
+
+#else
+
+void POWER_Idle(void) {
+    if (!_isSleepAllowed()) return;
+
+    const bool isStandby = _isStandbyAllowed();
+#if METRICS_ENABLED
+    const uint64_t start = SYS_TIME_Counter64Get();
+#endif
+
+    if (isStandby) {
+        SCB->SCR |= SCB_SCR_SLEEPDEEP_Msk;
+    } else {
+        SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+        PM_REGS->PM_SLEEP = PM_SLEEP_IDLE(1U);
+    }
+
+    // returns at once if event register is set since the previous WFE
+    __WFE();
+
+#if METRICS_ENABLED
+    _accountSleep(start, isStandby);
+#endif
+};
+
+#endif
@@ -0,0 +1,54 @@
+/**
+ * @file power.h
+ * @brief Tickless sleep of the main loop when there is nothing to do
+ *
+ * @details Main loop sleeps at the end of a pass by WFE. Event register is set by each event processed by actors
+ * (SEV, actors may dispatch to each other) and by any interrupt pended since the previous WFE (SEVONPEND), so WFE
+ * returns at once if anything happened since the last sleep, and an event dispatched from ISR after the actor had
+ * polled its queue is never slept over.
+ *
+ * Sleep is STANDBY if no SERCOM transfer is in flight, IDLE otherwise. SYS_TIME counter runs in STANDBY from
+ * the 32 kHz oscillator, so the nearest SYS_TIME deadline wakes the loop, RTC keeps the calendar only.
+ * Loop does not sleep while MEMORY driver transfer is pending (driver is polled) and while USB is powered.
+ *
+ * Define POWER_SLEEP_SIMULATED as 1 to only account the time the loop would sleep, debugger stays attached then.
+ */
+
+#ifndef POWER_H
+#define POWER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "../config/default/configuration.h"
+#include "../config/default/definitions.h"
+#include "../config/common.defs.h"
+#include "../metrics/metrics.h"
+
+#ifdef    __cplusplus
+extern "C" {
+#endif
+
+#ifndef POWER_SLEEP_SIMULATED
+#define POWER_SLEEP_SIMULATED               (0)
+#endif
+
+/** @brief Mark the loop pass busy, the next pass runs without sleep */
+#define POWER_EVENT_PROCESSED()             POWER_KeepAwake()
+
+/** @brief Enable interrupts as wake up events */
+void POWER_Initialize(void);
+
+/** @brief Sleep till the next interrupt if the loop pass has processed no events, called at the end of each pass */
+void POWER_Idle(void);
+
+/** @brief Keep the loop awake for the next pass */
+void POWER_KeepAwake(void);
+
+#ifdef    __cplusplus
+}
+#endif
+
+#endif //POWER_H
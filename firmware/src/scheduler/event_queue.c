@@ -0,0 +1,60 @@
+#include "./event_queue.h"
+
+void EVENT_QUEUE_Initialize(TEventQueue *const queue, TEvent *const events, uint32_t *const timestamps,
+                            uint32_t capacity) {
+    const uint32_t primask = __get_PRIMASK();
+
+    // actor may be reinitialized while ISRs still dispatch to it
+    __disable_irq();
+    queue->events = (0 == capacity) ? NULL : events;
+    queue->timestamps = timestamps;
+    queue->mask = (0 == capacity) ? 0 : capacity - 1;
+    queue->head = 0;
+    queue->tail = 0;
+    queue->stats.capacity = (uint16_t) capacity;
+    __set_PRIMASK(primask);
+};
+
+bool EVENT_QUEUE_Push(TEventQueue *const queue, TEvent event, uint32_t timestamp) {
+    const uint32_t primask = __get_PRIMASK();
+    bool isPushed = false;
+
+    __disable_irq();
+    if ((NULL != queue->events) && ((queue->tail - queue->head) <= queue->mask)) {
+        const uint32_t tail = queue->tail;
+        const uint16_t size = (uint16_t) (tail + 1 - queue->head);
+
+        queue->events[tail & queue->mask] = event;
+        if (NULL != queue->timestamps) queue->timestamps[tail & queue->mask] = timestamp;
+        // slot is filled before it is published to consumer
+        __DMB();
+        queue->tail = tail + 1;
+        isPushed = true;
+
+        queue->stats.enqueues++;
+        if (size > queue->stats.highWater) queue->stats.highWater = size;
+    } else {
+        queue->stats.overflows++;
+    }
+    __set_PRIMASK(primask);
+
+    return isPushed;
+};
+
+bool EVENT_QUEUE_Pop(TEventQueue *const queue, TEvent *const event, uint32_t now) {
+    const uint32_t head = queue->head;
+
+    if (head == queue->tail) return false;
+
+    // slot is read after tail is, and before it is released to producers
+    __DMB();
+    *event = queue->events[head & queue->mask];
+    const uint32_t latency = (NULL == queue->timestamps) ? 0 : now - queue->timestamps[head & queue->mask];
+    __DMB();
+    queue->head = head + 1;
+
+    queue->stats.dequeues++;
+    if (latency > queue->stats.maxLatency) queue->stats.maxLatency = latency;
+
+    return true;
+};
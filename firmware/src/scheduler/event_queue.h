@@ -0,0 +1,86 @@
+/**
+ * @file event_queue.h
+ * @brief Ring buffer of actor events, pushed from ISRs and main loop, popped by the actor only
+ *
+ * @details Indexes are free running and wrap by capacity mask, capacity should be a power of two.
+ * Push masks interrupts while the slot is filled and published, so producers in ISRs and main loop never interleave.
+ * Pop is lock free: the only consumer reads the slot and then releases it by the head index, a producer may push
+ * meanwhile but never into an unreleased slot. Event pushed to full queue is dropped and counted.
+ *
+ * Usage stats are kept over queue reinitialization, to right-size capacities from field data. With timestamps slots
+ * given, each event is stamped on push and the max push to pop latency is kept too.
+ */
+
+#ifndef EVENT_QUEUE_H
+#define EVENT_QUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "../config/default/configuration.h"
+#include "../config/default/definitions.h"
+#include "../../../libraries/active-object-fsm/src/active_object/active_object.h"
+
+#ifdef    __cplusplus
+extern "C" {
+#endif
+
+#define EVENT_QUEUE_IS_VALID_CAPACITY(capacity)     ((0 != (capacity)) && (0 == ((capacity) & ((capacity) - 1))))
+
+/** @brief queue usage, counters wrap */
+typedef struct {
+    uint32_t enqueues; /**< events pushed */
+    uint32_t dequeues; /**< events popped */
+    uint32_t overflows; /**< events dropped on full queue */
+    uint32_t maxLatency; /**< max time from push to pop, in timestamps units, 0 without timestamps */
+    uint16_t highWater; /**< max events queued at once */
+    uint16_t capacity;
+} TEventQueueStats;
+
+/** @brief events ring buffer */
+typedef struct {
+    TEvent *events; /**< slots, owned by actor */
+    uint32_t *timestamps; /**< push timestamps of slots, optional */
+    uint32_t mask; /**< capacity - 1 */
+    volatile uint32_t head; /**< next slot to pop, written by consumer only */
+    volatile uint32_t tail; /**< next slot to push, written by producers with interrupts masked */
+    TEventQueueStats stats;
+} TEventQueue;
+
+/**
+ * @brief Empty queue, stats are kept over actor reinitialization
+ * @param queue
+ * @param events slots
+ * @param timestamps push timestamps slots of the same capacity, NULL if latency is not measured
+ * @param capacity power of two, 0 makes queue drop all events (as not initialized queue does)
+ */
+void EVENT_QUEUE_Initialize(TEventQueue *const queue, TEvent *const events, uint32_t *const timestamps,
+                            uint32_t capacity);
+
+/**
+ * @brief Push event, ISR safe
+ * @param timestamp push time, ignored without timestamps slots
+ * @return false if queue is full and event is dropped
+ */
+bool EVENT_QUEUE_Push(TEventQueue *const queue, TEvent event, uint32_t timestamp);
+
+/**
+ * @brief Pop the oldest event, should be called by queue consumer only
+ * @param[out] event
+ * @param now pop time, in timestamps units
+ * @return false if queue is empty
+ */
+bool EVENT_QUEUE_Pop(TEventQueue *const queue, TEvent *const event, uint32_t now);
+
+/** @brief Events in queue, snapshot */
+static inline uint32_t EVENT_QUEUE_GetSize(const TEventQueue *const queue) {
+    return queue->tail - queue->head;
+};
+
+#ifdef    __cplusplus
+}
+#endif
+
+#endif //EVENT_QUEUE_H
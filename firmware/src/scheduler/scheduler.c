@@ -0,0 +1,138 @@
+#include "./scheduler.h"
+#include "../init_manager/init_manager.h"
+
+#define SCHEDULER_READY_BIT(priority)       (1UL << (priority))
+#define SCHEDULER_TIMESTAMPS_MAX            (INIT_QUEUE_MAX_CAPACITY + APP_QUEUE_MAX_CAPACITY + \
+                                             STORAGE_QUEUE_MAX_CAPACITY + NFC_QUEUE_MAX_CAPACITY + \
+                                             SHT3X_QUEUE_MAX_CAPACITY)
+
+#if METRICS_ENABLED
+#define SCHEDULER_TIMESTAMP()               SYS_TIME_CounterGet()
+#else
+#define SCHEDULER_TIMESTAMP()               (0)
+#endif
+
+/* actors steps by priority */
+static const TSchedulerActorTasks schedulerActorsTasks[SCHEDULER_PRIORITIES_MAX] = {
+        [SCHEDULER_PRIORITY_STORAGE] =      STORAGE_Tasks,
+        [SCHEDULER_PRIORITY_SHT3X] =        SHT3X_Tasks,
+        [SCHEDULER_PRIORITY_NFC] =          NFC_Tasks,
+        [SCHEDULER_PRIORITY_MAIN_APP] =     APP_Tasks,
+        [SCHEDULER_PRIORITY_INIT] =         INIT_Tasks,
+};
+
+/* ready bit by actor ID, 0 for not scheduled actors */
+static const uint32_t schedulerReadyBits[ACTIVE_OBJECTS_MAX] = {
+        [STORAGE_AO_ID] =       SCHEDULER_READY_BIT(SCHEDULER_PRIORITY_STORAGE),
+        [SHT3X_AO_ID] =         SCHEDULER_READY_BIT(SCHEDULER_PRIORITY_SHT3X),
+        [NFC_AO_ID] =           SCHEDULER_READY_BIT(SCHEDULER_PRIORITY_NFC),
+        [MAIN_APP_AO_ID] =      SCHEDULER_READY_BIT(SCHEDULER_PRIORITY_MAIN_APP),
+        [INIT_AO_ID] =          SCHEDULER_READY_BIT(SCHEDULER_PRIORITY_INIT),
+};
+
+_Static_assert(EVENT_QUEUE_IS_VALID_CAPACITY(INIT_QUEUE_MAX_CAPACITY), "INIT queue capacity is not power of two");
+_Static_assert(EVENT_QUEUE_IS_VALID_CAPACITY(APP_QUEUE_MAX_CAPACITY), "APP queue capacity is not power of two");
+_Static_assert(EVENT_QUEUE_IS_VALID_CAPACITY(STORAGE_QUEUE_MAX_CAPACITY), "STORAGE queue capacity is not power of two");
+_Static_assert(EVENT_QUEUE_IS_VALID_CAPACITY(NFC_QUEUE_MAX_CAPACITY), "NFC queue capacity is not power of two");
+_Static_assert(EVENT_QUEUE_IS_VALID_CAPACITY(SHT3X_QUEUE_MAX_CAPACITY), "SHT3X queue capacity is not power of two");
+
+static TEventQueue schedulerQueues[ACTIVE_OBJECTS_MAX];
+static volatile uint32_t readyBits = 0;
+static volatile uint32_t suspendedBits = 0;
+
+#if METRICS_ENABLED
+static uint32_t schedulerTimestamps[SCHEDULER_TIMESTAMPS_MAX];
+static uint32_t schedulerTimestampsUsed = 0;
+#endif
+
+// dispatch timestamps slots are taken once, on actor first initialization
+static uint32_t *_getTimestamps(SYSTEM_ACTIVE_OBJECT_IDS id, uint32_t capacity) {
+#if METRICS_ENABLED
+    if (NULL != schedulerQueues[id].timestamps) return schedulerQueues[id].timestamps;
+    if ((schedulerTimestampsUsed + capacity) > SCHEDULER_TIMESTAMPS_MAX) return NULL;
+
+    schedulerTimestampsUsed += capacity;
+
+    return &schedulerTimestamps[schedulerTimestampsUsed - capacity];
+#else
+    return NULL;
+#endif
+};
+
+// bitmaps are modified from ISRs too, read-modify-write is done with interrupts masked
+static inline void _setBits(volatile uint32_t *const bits, uint32_t mask) {
+    const uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    *bits |= mask;
+    __set_PRIMASK(primask);
+};
+
+static inline void _clearBits(volatile uint32_t *const bits, uint32_t mask) {
+    const uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    *bits &= ~mask;
+    __set_PRIMASK(primask);
+};
+
+void SCHEDULER_InitializeActor(TActiveObject *const AO, SYSTEM_ACTIVE_OBJECT_IDS id, TEvent *const events,
+                               uint32_t capacity) {
+    // library keeps actor ID and state, its queue is left unused
+    ActiveObject_Initialize(AO, id, events, capacity);
+    EVENT_QUEUE_Initialize(&schedulerQueues[id], events, _getTimestamps(id, capacity), capacity);
+};
+
+bool SCHEDULER_Dispatch(TActiveObject *const AO, TEvent event) {
+    if (!EVENT_QUEUE_Push(&schedulerQueues[AO->id], event, SCHEDULER_TIMESTAMP())) {
+        METRICS_INC(eventsDropped);
+        return false;
+    }
+
+    // marked after the event is queued, actor is never run ahead of its event
+    _setBits(&readyBits, schedulerReadyBits[AO->id]);
+    return true;
+};
+
+TEvent SCHEDULER_ProcessQueue(TActiveObject *const AO) {
+    TEvent event = {.sig = 0};
+
+    EVENT_QUEUE_Pop(&schedulerQueues[AO->id], &event, SCHEDULER_TIMESTAMP());
+
+    return event;
+};
+
+void SCHEDULER_Tasks(void) {
+    uint8_t events = 0;
+
+    while (events < SCHEDULER_EVENTS_PER_PASS_MAX) {
+        const uint32_t runnableBits = readyBits & ~suspendedBits;
+
+        if (0 == runnableBits) return;
+
+        const uint8_t priority = 31U - __CLZ(runnableBits);
+        const uint32_t readyBit = SCHEDULER_READY_BIT(priority);
+
+        _clearBits(&readyBits, readyBit);
+
+        if (!schedulerActorsTasks[priority]()) continue;
+
+        // queue may hold more events
+        _setBits(&readyBits, readyBit);
+        events++;
+    }
+};
+
+void SCHEDULER_Suspend(SYSTEM_ACTIVE_OBJECT_IDS id) {
+    _setBits(&suspendedBits, schedulerReadyBits[id]);
+};
+
+void SCHEDULER_Resume(SYSTEM_ACTIVE_OBJECT_IDS id) {
+    _clearBits(&suspendedBits, schedulerReadyBits[id]);
+};
+
+const TEventQueueStats *SCHEDULER_GetQueueStats(SYSTEM_ACTIVE_OBJECT_IDS id) {
+    if (0 == schedulerReadyBits[id]) return NULL;
+
+    return &schedulerQueues[id].stats;
+};
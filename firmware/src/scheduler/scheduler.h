@@ -0,0 +1,102 @@
+/**
+ * @file scheduler.h
+ * @brief Run to completion scheduler of active objects
+ *
+ * @details Events are dispatched by SCHEDULER_Dispatch(), from main loop and ISRs alike. It queues the event to
+ * the actor and marks the actor ready in the bitmap, bit number is the actor priority. SCHEDULER_Tasks() runs
+ * the highest priority ready actor one event at a time and picks again after each event, so an event dispatched to
+ * a higher priority actor is handled next and a burst of events is drained in one pass. Actors without events are
+ * not polled at all.
+ *
+ * Actor is unmarked before its queue is polled and marked again after each handled event, so an event dispatched
+ * from ISR meanwhile is never lost. Actor is unmarked for good only when its queue turns out empty.
+ *
+ * Events are kept in scheduler own ISR safe queues, one per actor, @see event_queue.h. Actors queues of AO library
+ * are left unused, the library gives no guarantee for dispatch from ISRs. Event is dropped on full queue, dispatch
+ * returns false then, so the dispatcher may release what the event payload refers to.
+ *
+ * App manager suspends actors which should not run in its state, events are kept in their queues till resume.
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "../config/default/configuration.h"
+#include "../config/default/definitions.h"
+#include "../config/common.defs.h"
+#include "../../../libraries/active-object-fsm/src/active_object/active_object.h"
+#include "../metrics/metrics.h"
+#include "./event_queue.h"
+
+#ifdef    __cplusplus
+extern "C" {
+#endif
+
+// events handled per pass at most, polled drivers (MEMORY, USB) and sleep check are not starved by bursts
+#define SCHEDULER_EVENTS_PER_PASS_MAX       (16)
+
+/** @brief actors priorities, the higher the sooner */
+typedef enum {
+    SCHEDULER_PRIORITY_STORAGE = 0,
+    SCHEDULER_PRIORITY_SHT3X,
+    SCHEDULER_PRIORITY_NFC,
+    SCHEDULER_PRIORITY_MAIN_APP,
+    SCHEDULER_PRIORITY_INIT,
+    SCHEDULER_PRIORITIES_MAX
+} SCHEDULER_PRIORITY;
+
+/**
+ * @brief Actor step, handles a single event
+ * @return true if event is handled, false if actor queue is empty or actor is not initialized
+ */
+typedef bool (*TSchedulerActorTasks)(void);
+
+/**
+ * @brief Initialize actor and its events queue, queued events are dropped
+ * @param AO actor
+ * @param id actor ID
+ * @param events queue slots
+ * @param capacity power of two
+ */
+void SCHEDULER_InitializeActor(TActiveObject *const AO, SYSTEM_ACTIVE_OBJECT_IDS id, TEvent *const events,
+                               uint32_t capacity);
+
+/**
+ * @brief Dispatch event to actor and mark actor ready, ISR safe
+ * @param AO actor, events to not scheduled actors are only queued
+ * @param event
+ * @return false if actor queue is full and event is dropped, event payload stays owned by dispatcher then
+ */
+bool SCHEDULER_Dispatch(TActiveObject *const AO, TEvent event);
+
+/**
+ * @brief Pop the oldest event of actor, should be called by the actor only
+ * @return event, NO_EVENT (0) signal if queue is empty
+ */
+TEvent SCHEDULER_ProcessQueue(TActiveObject *const AO);
+
+/** @brief Run ready actors in priority order, should be called from main loop */
+void SCHEDULER_Tasks(void);
+
+/** @brief Stop running actor, its events are kept queued */
+void SCHEDULER_Suspend(SYSTEM_ACTIVE_OBJECT_IDS id);
+
+/** @brief Run actor again, events queued while suspended are handled */
+void SCHEDULER_Resume(SYSTEM_ACTIVE_OBJECT_IDS id);
+
+/**
+ * @brief Get actor queue usage, max latency is in SYS_TIME counts (0 if metrics are disabled)
+ * @return NULL for not scheduled actor
+ */
+const TEventQueueStats *SCHEDULER_GetQueueStats(SYSTEM_ACTIVE_OBJECT_IDS id);
+
+#ifdef    __cplusplus
+}
+#endif
+
+#endif //SCHEDULER_H
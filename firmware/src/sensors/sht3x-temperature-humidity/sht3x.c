@@ -38,11 +38,26 @@ static DRV_HANDLE _openI2CDriver(void) {
     return drvI2CHandle;
 };
 
+/**
+ * @brief Lower client clock to standard mode on bus error, or on any error till a transfer succeeds at current clock
+ * @details Retried transfer goes at the new clock.
+ */
+static void _fallbackI2CClockOnError(DRV_I2C_TRANSFER_HANDLE transferHandle) {
+    if (SHT3X_I2C_CLOCK_SPEED_FALLBACK == sht3xAO.i2cSetup.clockSpeed) return;
+    if (sht3xAO.isI2CClockVerified && (DRV_I2C_ERROR_BUS != DRV_I2C_ErrorGet(transferHandle))) return;
+
+    sht3xAO.i2cSetup.clockSpeed = SHT3X_I2C_CLOCK_SPEED_FALLBACK;
+    sht3xAO.isI2CClockVerified = false;
+    sht3xAO.isI2CClockFallenBack = true;
+    DRV_I2C_TransferSetup(sht3xAO.drvI2CHandle, &sht3xAO.i2cSetup);
+    METRICS_INC(i2cClockFallbacks);
+};
+
 /** SHT3X Global Functions */
 
 TActiveObject *SHT3X_Initialize(void) {
     // init super AO
-    ActiveObject_Initialize(&sht3xAO.super, SHT3X_AO_ID, events, SHT3X_QUEUE_MAX_CAPACITY);
+    SCHEDULER_InitializeActor(&sht3xAO.super, SHT3X_AO_ID, events, SHT3X_QUEUE_MAX_CAPACITY);
     sht3xAO.super.state = &sht3xStatesList[SHT3X_ST_INIT];
 
     // open I2C driver, get handler
@@ -52,11 +67,12 @@ TActiveObject *SHT3X_Initialize(void) {
     sht3xAO.drvI2CHandle = drvI2CHandle;
     sht3xAO.transferHandle = DRV_I2C_TRANSFER_HANDLE_INVALID;
     sht3xAO.sensorRegs.status = 0;
+    sht3xAO.measurePeriodMs = SHT3X_MEASURE_PERIOD_MS_DFLT;
     // TODO check that all fields are cleared
 
     // error on i2c driver open
     if (DRV_HANDLE_INVALID == drvI2CHandle) {
-        ActiveObject_Dispatch(&sht3xAO.super, (TEvent) {.sig = SHT3X_ERROR});
+        SCHEDULER_Dispatch(&sht3xAO.super, (TEvent) {.sig = SHT3X_ERROR});
     };
 
     // set I2C handler @see https://microchip-mplab-harmony.github.io/core/index.html?GUID-C99FBA78-A80D-40EE-B863-E40151E30C73
@@ -66,18 +82,40 @@ TActiveObject *SHT3X_Initialize(void) {
             (uintptr_t) &sht3xAO
     );
 
+    // own clock for sensor transfers, driver switches bus clock between clients
+    sht3xAO.i2cSetup.clockSpeed = SHT3X_I2C_CLOCK_SPEED;
+    sht3xAO.isI2CClockVerified = false;
+    sht3xAO.isI2CClockFallenBack = false;
+    if (!DRV_I2C_TransferSetup(sht3xAO.drvI2CHandle, &sht3xAO.i2cSetup))
+        sht3xAO.i2cSetup.clockSpeed = SHT3X_I2C_CLOCK_SPEED_FALLBACK;
+
     return (TActiveObject *) &sht3xAO;
 }
 
+bool SHT3X_SetMeasurePeriod(uint32_t periodMs) {
+    if ((periodMs < SHT3X_MEASURE_PERIOD_MS_MIN) || (periodMs > SHT3X_MEASURE_PERIOD_MS_MAX)) return false;
+
+    sht3xAO.measurePeriodMs = periodMs;
+    return true;
+}
+
+uint32_t SHT3X_GetMeasurePeriod(void) {
+    return sht3xAO.measurePeriodMs;
+}
+
 void SHT3X_Deinitialize(void) {
     sht3xAO.super.state = NULL;
+    TIMERS_Cancel(SHT3X_MEASURE_TIMER_ID);
+    TIMERS_Cancel(SHT3X_READ_MEASURE_TIMER_ID);
 }
 
-void SHT3X_Tasks(void) {
-    if (NULL == sht3xAO.super.state) return; // not initialized yet
+bool SHT3X_Tasks(void) {
+    if (NULL == sht3xAO.super.state) return false; // not initialized yet
 
-    const TEvent event = ActiveObject_ProcessQueue(&sht3xAO.super);
-    if (SHT3X_NO_EVENT == event.sig) return;
+    const TEvent event = SCHEDULER_ProcessQueue(&sht3xAO.super);
+    if (SHT3X_NO_EVENT == event.sig) return false;
+    METRICS_EVENT_PROCESSED(SHT3X_AO_ID);
+    POWER_EVENT_PROCESSED();
 
     const TState *nextState = FSM_ProcessEventToNextStateFromTransitionTable(&sht3xAO.super, event, SHT3X_STATES_MAX,
                                                                              SHT3X_SIG_MAX, sht3xTransitionTable);
@@ -91,6 +129,8 @@ void SHT3X_Tasks(void) {
 #endif
 
     if (FSM_IsValidState(nextState)) FSM_TraverseAOToNextState(&sht3xAO.super, nextState);
+
+    return true;
 };
 
 /**
@@ -111,17 +151,22 @@ void SHT3X_TransferEventHandler(
 
             /* All data from or to the buffer was transferred successfully. */
         case DRV_I2C_TRANSFER_EVENT_COMPLETE:
-            return ActiveObject_Dispatch(&sht3xAO.super, (TEvent) {.sig = SHT3X_TRANSFER_SUCCESS});
+            sht3xAO.isI2CClockVerified = true;
+            SCHEDULER_Dispatch(&sht3xAO.super, (TEvent) {.sig = SHT3X_TRANSFER_SUCCESS});
+            return;
 
             /* There was an error while processing the buffer transfer request. */
         case DRV_I2C_TRANSFER_EVENT_ERROR:
-            return ActiveObject_Dispatch(&sht3xAO.super, (TEvent) {.sig = SHT3X_TRANSFER_FAIL});
+            _fallbackI2CClockOnError(transferHandle);
+            SCHEDULER_Dispatch(&sht3xAO.super, (TEvent) {.sig = SHT3X_TRANSFER_FAIL});
+            return;
 
             /* Transfer Handle given is expired. It means transfer
             is completed but with or without error is not known. */
         case DRV_I2C_TRANSFER_EVENT_HANDLE_EXPIRED:
         case DRV_I2C_TRANSFER_EVENT_HANDLE_INVALID:
-            return ActiveObject_Dispatch(&sht3xAO.super, (TEvent) {.sig = SHT3X_ERROR});
+            SCHEDULER_Dispatch(&sht3xAO.super, (TEvent) {.sig = SHT3X_ERROR});
+            return;
         default:
             SYS_DEBUG_PRINT(SYS_ERROR_INFO, "SHT3X_TransferEventHandler: unknown event %d\n", event);
             return;
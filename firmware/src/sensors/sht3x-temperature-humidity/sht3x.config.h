@@ -7,11 +7,17 @@ extern "C" {
 
 #define SHT3X_I2C_ADDR_DFLT             (0x44)
 
+#define SHT3X_I2C_CLOCK_SPEED           (1000000) // SHT3x supports Fast-mode Plus
+#define SHT3X_I2C_CLOCK_SPEED_FALLBACK  (100000) // standard mode, if bus fails at Fast-mode Plus
+
 #define SHT3X_CMD_SIZE                  (2)
 #define SHT3X_STATUS_REG_SIZE           (2)
 #define SHT3X_MEASUREMENTS_SIZE         (6)
 
 #define SHT3X_MEASURE_TIME_MS           (15)
+#define SHT3X_MEASURE_PERIOD_MS_DFLT    (1000)
+#define SHT3X_MEASURE_PERIOD_MS_MIN     (SHT3X_MEASURE_TIME_MS * 2) // measurement should complete within period
+#define SHT3X_MEASURE_PERIOD_MS_MAX     (24UL * 60 * 60 * 1000)
 
 #define SHT3X_QUEUE_MAX_CAPACITY        (8)
 
@@ -19,6 +19,10 @@
 #include "../../../../libraries/active-object-fsm/src/active_object/active_object.h"
 #include "../../../../libraries/active-object-fsm/src/fsm/fsm.h"
 #include "../../init_manager/init.config.h"
+#include "../../metrics/metrics.h"
+#include "../../power/power.h"
+#include "../../scheduler/scheduler.h"
+#include "../../timers/timers.h"
 #include "./sht3x.config.h"
 
 #ifdef    __cplusplus
@@ -33,6 +37,10 @@ typedef struct {
     TActiveObject super;
     DRV_HANDLE drvI2CHandle;
     DRV_I2C_TRANSFER_HANDLE transferHandle;
+    DRV_I2C_TRANSFER_SETUP i2cSetup; /**< client clock, applied by driver on each transfer of this client */
+    bool isI2CClockVerified; /**< transfer succeeded at current clock, so NACKs are not blamed on it */
+    bool isI2CClockFallenBack; /**< clock was lowered on the last fail, transfer is worth a retry */
+    uint32_t measurePeriodMs; /**< sampling period, applied from the next measurement */
     struct {
         uint16_t status;
         uint8_t measurements[SHT3X_MEASUREMENTS_SIZE];
@@ -53,10 +61,23 @@ TActiveObject*  SHT3X_Initialize(void);
  */
 void SHT3X_Deinitialize(void);
 
+/**
+ * @brief Set sampling period
+ * @param periodMs from SHT3X_MEASURE_PERIOD_MS_MIN to SHT3X_MEASURE_PERIOD_MS_MAX
+ * @return false if period is out of range
+ */
+bool SHT3X_SetMeasurePeriod(uint32_t periodMs);
+
+/** @return sampling period, ms */
+uint32_t SHT3X_GetMeasurePeriod(void);
+
 /* Microchip Harmony 3 specific */
 
-/** @brief Perform Actor tasks, mainly listen for events and process them */
-void SHT3X_Tasks(void);
+/**
+ * @brief Perform Actor tasks, handle a single event, run by scheduler while actor is ready
+ * @return true if event is handled
+ */
+bool SHT3X_Tasks(void);
 
 /**
  * @brief Callback for I2C ISR on success/error transfer.
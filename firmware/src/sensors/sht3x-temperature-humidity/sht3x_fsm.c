@@ -15,16 +15,14 @@ static const TState *_measure(TActiveObject *const AO, TEvent event);
 
 static const TState *_readMeasurements(TActiveObject *const AO, TEvent event);
 
-static const TState *_error(TActiveObject *const AO, TEvent event);
-
-static void _dispatchReadMeasurements(TActiveObject *const AO);
+static const TState *_retryOnI2CClockFallback(TActiveObject *const AO, TEvent event);
 
-static void _tempDispatchMeasure(TActiveObject *const AO); // TODO replace it by scheduler
+static const TState *_error(TActiveObject *const AO, TEvent event);
 
 // error on i2c transfer queuing
 static inline void _dispatchErrorOnInvalidTransfer(TSHT3xActiveObject *const sht3xAO) {
     if (DRV_I2C_TRANSFER_HANDLE_INVALID == sht3xAO->transferHandle) {
-        ActiveObject_Dispatch(&(sht3xAO->super), (TEvent) {.sig = SHT3X_ERROR});
+        SCHEDULER_Dispatch(&(sht3xAO->super), (TEvent) {.sig = SHT3X_ERROR});
     };
 };
 
@@ -43,22 +41,18 @@ const TState sht3xStatesList[SHT3X_STATES_MAX] = {
 const TEventHandler sht3xTransitionTable[SHT3X_STATES_MAX][SHT3X_SIG_MAX] = {
         [SHT3X_ST_INIT]=                {[SHT3X_READ_STATUS]=_readStatus, [SHT3X_MEASURE]=_measure, [SHT3X_ERROR]=_error},
         [SHT3X_ST_IDLE]=                {[SHT3X_READ_STATUS]=_readStatus, [SHT3X_MEASURE]=_measure, [SHT3X_ERROR]=_error},
-        [SHT3X_ST_READ_STATUS]=         {[SHT3X_TRANSFER_SUCCESS]=_idle, [SHT3X_TRANSFER_FAIL]=_error, [SHT3X_ERROR]=_error},
+        [SHT3X_ST_READ_STATUS]=         {[SHT3X_TRANSFER_SUCCESS]=_idle, [SHT3X_TRANSFER_FAIL]=_retryOnI2CClockFallback, [SHT3X_ERROR]=_error},
         [SHT3X_ST_MEASURE]=             {[SHT3X_TRANSFER_SUCCESS]=NULL, [SHT3X_TRANSFER_FAIL]=_error, [SHT3X_READ_MEASURE]=_readMeasurements, [SHT3X_ERROR]=_error},
-        [SHT3X_ST_READ_MEASURE]=        {[SHT3X_TRANSFER_SUCCESS]=_idle, [SHT3X_TRANSFER_FAIL]=_error, [SHT3X_ERROR]=_error},
+        [SHT3X_ST_READ_MEASURE]=        {[SHT3X_TRANSFER_SUCCESS]=_idle, [SHT3X_TRANSFER_FAIL]=_retryOnI2CClockFallback, [SHT3X_ERROR]=_error},
         [SHT3X_ST_ERROR]=               {[SHT3X_ERROR]=_error}
 };
 
-static const TState *_idle(TActiveObject *const sht3xAO, TEvent event) {
+static const TState *_idle(TActiveObject *const AO, TEvent event) {
+    TSHT3xActiveObject *sht3xAO = (TSHT3xActiveObject *) AO;
     LED_Off();
 
-    // temporary schedule measurement
-    SYS_TIME_CallbackRegisterMS(
-            (SYS_TIME_CALLBACK) _tempDispatchMeasure,
-            (uintptr_t) sht3xAO,
-            1000,
-            SYS_TIME_SINGLE
-    );
+    // schedule the next measurement
+    TIMERS_Arm(SHT3X_MEASURE_TIMER_ID, AO, (TEvent) {.sig = SHT3X_MEASURE}, sht3xAO->measurePeriodMs);
 
     return &(sht3xStatesList[SHT3X_ST_IDLE]);
 };
@@ -81,6 +75,7 @@ static const TState *_readStatus(TActiveObject *const AO, TEvent event) {
     );
 
     _dispatchErrorOnInvalidTransfer(sht3xAO);
+    METRICS_I2C_TRANSFER(SHT3X_CMD_SIZE + SHT3X_STATUS_REG_SIZE, sht3xAO->i2cSetup.clockSpeed);
 
     return &(sht3xStatesList[SHT3X_ST_READ_STATUS]);
 };
@@ -104,14 +99,10 @@ static const TState *_measure(TActiveObject *const AO, TEvent event) {
     );
 
     _dispatchErrorOnInvalidTransfer(sht3xAO);
+    METRICS_I2C_TRANSFER(SHT3X_CMD_SIZE, sht3xAO->i2cSetup.clockSpeed);
 
     // schedule measurement read cause SHT3x sensor needs some time to measure temperature/humidity
-    SYS_TIME_CallbackRegisterMS(
-            (SYS_TIME_CALLBACK) _dispatchReadMeasurements,
-            (uintptr_t) AO,
-            SHT3X_MEASURE_TIME_MS,
-            SYS_TIME_SINGLE
-    );
+    TIMERS_Arm(SHT3X_READ_MEASURE_TIMER_ID, AO, (TEvent) {.sig = SHT3X_READ_MEASURE}, SHT3X_MEASURE_TIME_MS);
 
     return &(sht3xStatesList[SHT3X_ST_MEASURE]);
 };
@@ -131,16 +122,22 @@ static const TState *_readMeasurements(TActiveObject *const AO, TEvent event) {
     );
 
     _dispatchErrorOnInvalidTransfer(sht3xAO);
+    METRICS_I2C_TRANSFER(SHT3X_MEASUREMENTS_SIZE, sht3xAO->i2cSetup.clockSpeed);
 
     return &(sht3xStatesList[SHT3X_ST_READ_MEASURE]);
 };
 
-static const TState *_error(TActiveObject *const AO, TEvent event) { return &(sht3xStatesList[SHT3X_ST_ERROR]); };
+/** @brief Read failed at too fast clock is repeated once at fallback one, sensor keeps its data till read */
+static const TState *_retryOnI2CClockFallback(TActiveObject *const AO, TEvent event) {
+    TSHT3xActiveObject *sht3xAO = (TSHT3xActiveObject *) AO;
+
+    if (!sht3xAO->isI2CClockFallenBack) return _error(AO, event);
+
+    sht3xAO->isI2CClockFallenBack = false;
 
-static void _dispatchReadMeasurements(TActiveObject *const AO) {
-    ActiveObject_Dispatch(AO, (TEvent) {.sig = SHT3X_READ_MEASURE});
-}
+    if (&(sht3xStatesList[SHT3X_ST_READ_STATUS]) == AO->state) return _readStatus(AO, event);
 
-static void _tempDispatchMeasure(TActiveObject *const AO) {
-    ActiveObject_Dispatch(AO, (TEvent) {.sig = SHT3X_MEASURE});
-};
\ No newline at end of file
+    return _readMeasurements(AO, event);
+};
+
+static const TState *_error(TActiveObject *const AO, TEvent event) { return &(sht3xStatesList[SHT3X_ST_ERROR]); };
@@ -0,0 +1,37 @@
+/**
+ * @file storage_crc.h
+ * @brief CRC-16 of log record blocks
+ *
+ * @details CRC-16/MCRF4XX: reflected CCITT polynomial 0x1021 (0x8408), init 0xFFFF, no final xor.
+ * Table-driven slicing-by-4: aligned part of the data is processed a 32-bit word per step with 4 lookups,
+ * ~9 cycles/byte on Cortex-M0+ with tables in flash, instead of ~14 for bytewise table and ~43 for bitwise CRC
+ * (instruction count estimate, see host test_storage_crc). Tables are const and stay in MCU flash (2KB).
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef    __cplusplus
+extern "C" {
+#endif
+
+#ifndef STORAGE_CRC_H
+#define STORAGE_CRC_H
+
+#define STORAGE_CRC16_INIT                      (0xFFFF)
+#define STORAGE_CRC16_SIZE                      (2)
+
+/**
+ * @brief Continue CRC with the next chunk of data
+ * @param crc CRC of the preceding data, STORAGE_CRC16_INIT to start
+ * @param data
+ * @param size
+ * @return CRC of the preceding data and the chunk
+ */
+uint16_t STORAGE_CRC16_Update(uint16_t crc, const uint8_t *data, size_t size);
+
+#ifdef    __cplusplus
+}
+#endif
+
+#endif //STORAGE_CRC_H
@@ -52,6 +52,73 @@ typedef struct {
     TLocation location;
 } TLogsStartStopStorageData;
 
+/**
+ * @brief Summary statistics of all samples stored, updated on each append
+ * @details Temperature and humidity are SHT3x raw values, as in log records. Time is counted by sampling intervals,
+ * interval is attributed to the range of the sample it starts with.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t samples; /**< samples stored */
+    uint32_t firstTimestamp;
+    uint32_t lastTimestamp;
+    uint16_t temperatureMin;
+    uint16_t temperatureMax;
+    uint16_t humidityMin;
+    uint16_t humidityMax;
+    uint64_t temperatureSum; /**< for mean temperature */
+    uint64_t kineticSum; /**< sum of Arrhenius factors relative to reference temperature, fixed point, for mean kinetic temperature */
+    uint32_t secondsAbove; /**< time above high temperature threshold */
+    uint32_t secondsBelow; /**< time below low temperature threshold */
+    uint32_t excursions; /**< times temperature left the range */
+    uint8_t range; /**< STORAGE_SUMMARY_RANGE of the last sample */
+} TStorageSummary;
+
+/**
+ * @brief Storage write cursor checkpoint, appended to journal sector on each completed log page
+ * @details Summary of samples stored before write cursor is kept along, so it survives reboot without log scan.
+ * Slot is valid when CRC matches, so erased (0xFF) or torn slots are rejected. Slot should not cross flash page.
+ */
+typedef struct {
+    uint32_t writeAddress;
+    uint32_t sequence;
+    uint32_t indexPosition; /**< index ring write cursor, entries are never written below it */
+    TStorageSummary summary;
+    uint8_t reserved[1];
+    uint16_t crc; /**< CRC-16 of all the slot bytes before */
+} TStorageCheckpoint;
+
+/**
+ * @brief Log index entry, appended to index ring: zone map of completed log sector or temperature excursion
+ * @details Entry refers to log records by log position: sector sequence * sector size + offset in sector,
+ * it does not depend on where ring wraps, entry is stale once its sector is overwritten by the ring.
+ * Erased (0xFF) entries are padding, entry is valid when CRC matches.
+ */
+typedef struct {
+    uint8_t type; /**< STORAGE_INDEX_ENTRY */
+    uint8_t range; /**< excursion: STORAGE_SUMMARY_RANGE */
+    uint8_t flags; /**< STORAGE_INDEX_FLAG_... */
+    uint8_t reserved;
+    uint32_t startPosition; /**< zone: sector start, excursion: 1st record out of range */
+    uint32_t endPosition; /**< zone: sector end, excursion: record after the last one out of range */
+    uint32_t startTimestamp;
+    uint32_t endTimestamp;
+    uint16_t temperatureMin;
+    uint16_t temperatureMax;
+    uint16_t humidityMin;
+    uint16_t humidityMax;
+    uint16_t samples; /**< samples in zone (excursion) */
+    uint16_t crc; /**< CRC-16 of all the entry bytes before */
+} TStorageIndexEntry;
+
+/**
+ * @brief Log sector header, written at the start of each sector of the ring
+ * @details Sector with the max sequence is the tail one, the oldest sequence is (tail - sectors in ring + 2)
+ */
+typedef struct {
+    uint32_t sequence;
+    uint32_t sequenceInverted;
+} TStorageSectorHeader;
+
 #ifdef    __cplusplus
 }
 #endif
@@ -0,0 +1,98 @@
+#include "./storage_index.h"
+
+static inline void _openEntry(TStorageIndexEntry *const entry, uint8_t type, uint8_t flags,
+                              const TSensorsStorageData *const sample, uint32_t position) {
+    memset(entry, 0, STORAGE_INDEX_ENTRY_SIZE);
+    entry->type = type;
+    entry->flags = flags;
+    entry->startPosition = position;
+    entry->startTimestamp = sample->timestamp;
+    entry->temperatureMin = UINT16_MAX;
+    entry->humidityMin = UINT16_MAX;
+};
+
+static inline void _accountSample(TStorageIndexEntry *const entry, const TSensorsStorageData *const sample) {
+    const uint16_t temperature = sample->sht3XTemperatureHumiditySensorData.temperature;
+    const uint16_t humidity = sample->sht3XTemperatureHumiditySensorData.humidity;
+
+    if (temperature < entry->temperatureMin) entry->temperatureMin = temperature;
+    if (temperature > entry->temperatureMax) entry->temperatureMax = temperature;
+    if (humidity < entry->humidityMin) entry->humidityMin = humidity;
+    if (humidity > entry->humidityMax) entry->humidityMax = humidity;
+    entry->endTimestamp = sample->timestamp;
+    if (UINT16_MAX != entry->samples) entry->samples++;
+};
+
+// seal entry with CRC and queue it, entry is dropped if batch page is full
+static inline void _closeEntry(TStorageIndex *const index, TStorageIndexEntry *const entry, uint32_t endPosition) {
+    entry->endPosition = endPosition;
+    entry->crc = STORAGE_CRC16_Update(STORAGE_CRC16_INIT, (const uint8_t *) entry, offsetof(TStorageIndexEntry, crc));
+
+    if (index->pending < STORAGE_INDEX_PENDING_MAX) {
+        index->entries[index->pending++] = *entry;
+    } else {
+        index->dropped++;
+    }
+
+    entry->type = STORAGE_INDEX_ENTRY_NONE;
+};
+
+void STORAGE_INDEX_Reset(TStorageIndex *const index, uint32_t position) {
+    memset(index, 0, sizeof(TStorageIndex));
+    index->position = position;
+};
+
+void STORAGE_INDEX_Update(TStorageIndex *const index, const TSensorsStorageData *const sample,
+                          uint32_t position, uint8_t previousRange, uint8_t range) {
+    if (STORAGE_INDEX_ENTRY_NONE == index->zone.type)
+        _openEntry(&(index->zone), STORAGE_INDEX_ENTRY_ZONE, index->zoneFlags, sample, position);
+    _accountSample(&(index->zone), sample);
+
+    if ((range != previousRange) && (STORAGE_INDEX_ENTRY_NONE != index->excursion.type))
+        _closeEntry(index, &(index->excursion), position);
+
+    // out of the same range with no excursion open, it was started before reboot
+    if ((STORAGE_SUMMARY_RANGE_IN != range) && (STORAGE_INDEX_ENTRY_NONE == index->excursion.type)) {
+        _openEntry(&(index->excursion), STORAGE_INDEX_ENTRY_EXCURSION,
+                   (range == previousRange) ? STORAGE_INDEX_FLAG_PARTIAL : 0, sample, position);
+        index->excursion.range = range;
+    }
+
+    if (STORAGE_INDEX_ENTRY_NONE != index->excursion.type) _accountSample(&(index->excursion), sample);
+};
+
+void STORAGE_INDEX_CloseZone(TStorageIndex *const index, uint32_t sectorPosition, uint32_t sectorSize) {
+    if (STORAGE_INDEX_ENTRY_NONE == index->zone.type) return;
+
+    // zone starts at its 1st sample, but sector is the whole zone anyway
+    index->zone.startPosition = sectorPosition;
+    index->zoneFlags = 0;
+    _closeEntry(index, &(index->zone), sectorPosition + sectorSize);
+};
+
+void STORAGE_INDEX_ResumeZone(TStorageIndex *const index) {
+    index->zoneFlags = STORAGE_INDEX_FLAG_PARTIAL;
+    index->zone.flags |= STORAGE_INDEX_FLAG_PARTIAL;
+};
+
+bool STORAGE_INDEX_TakeBatch(TStorageIndex *const index, uint32_t pageSize) {
+    if ((0 != index->batchSize) || (0 == index->pending)) return false;
+
+    const uint32_t batchBytes = index->pending * STORAGE_INDEX_ENTRY_SIZE;
+    const uint32_t pageFree = pageSize - (index->position % pageSize);
+
+    // rest of the page stays erased, it is skipped as padding
+    if (batchBytes > pageFree) index->position += pageFree;
+
+    index->batchPosition = index->position;
+    index->batchSize = index->pending;
+    index->position += batchBytes;
+
+    return true;
+};
+
+void STORAGE_INDEX_BatchWritten(TStorageIndex *const index) {
+    index->pending -= index->batchSize;
+    memmove(index->entries, index->entries + index->batchSize, index->pending * STORAGE_INDEX_ENTRY_SIZE);
+    index->batchSize = 0;
+};
@@ -0,0 +1,113 @@
+/**
+ * @file storage_index.h
+ * @brief Log index: zone map of log sectors and temperature excursions, so log ranges of interest are found
+ * without reading the log
+ *
+ * @details Entries are built as samples are appended and wait in RAM till the next checkpoint, then they are
+ * written as a batch into a single page of the index ring. Checkpoint with advanced index cursor goes first,
+ * so batch torn by power loss leaves erased entries only, and entries are never programmed twice.
+ *
+ * Zone entry is closed once its log sector is complete. Excursion entry is closed once temperature is back
+ * in range or crosses to the other side of the range. Zone (excursion) started before reboot is marked partial,
+ * as its samples before the tail page (excursion start) are not known after reboot.
+ * Summary range is used for excursions, so thresholds are the same.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "./storage_data.defs.h"
+#include "./storage_crc.h"
+#include "./storage_summary.h"
+
+#ifdef    __cplusplus
+extern "C" {
+#endif
+
+#ifndef STORAGE_INDEX_H
+#define STORAGE_INDEX_H
+
+#define STORAGE_INDEX_ENTRY_SIZE                (sizeof(TStorageIndexEntry))
+#define STORAGE_INDEX_PENDING_MAX               (DRV_AT25DF_PAGE_SIZE / STORAGE_INDEX_ENTRY_SIZE) // batch is one page
+
+/* entry flags */
+#define STORAGE_INDEX_FLAG_PARTIAL              (0x01) // started before reboot, start and extremes are of samples known
+
+/** @brief index entry types */
+typedef enum {
+    STORAGE_INDEX_ENTRY_NONE = 0x00,
+    STORAGE_INDEX_ENTRY_ZONE = 0x01,
+    STORAGE_INDEX_ENTRY_EXCURSION = 0x02,
+    STORAGE_INDEX_ENTRY_ERASED = 0xFF,
+} STORAGE_INDEX_ENTRY;
+
+/**
+ * @brief Index builder state
+ */
+typedef struct {
+    uint32_t position; /**< bytes ever appended to index ring, next batch goes at or above it */
+    uint32_t batchPosition; /**< position of the batch being written */
+    uint8_t batchSize; /**< entries being written, head of pending ones */
+    uint8_t pending; /**< entries waiting to be written, batch included */
+    uint32_t dropped; /**< entries dropped on pending overflow */
+    uint8_t zoneFlags; /**< flags of the zone to be opened */
+    TStorageIndexEntry zone; /**< zone of the tail sector, open while it has samples */
+    TStorageIndexEntry excursion; /**< excursion in progress, open while its type is set */
+    TStorageIndexEntry entries[STORAGE_INDEX_PENDING_MAX]; /**< closed entries, sealed with CRC */
+} TStorageIndex;
+
+/**
+ * @brief Reset builder, nothing open and nothing pending
+ * @param index
+ * @param position index ring cursor
+ */
+void STORAGE_INDEX_Reset(TStorageIndex *const index, uint32_t position);
+
+/**
+ * @brief Account sample appended to the log
+ * @param index
+ * @param sample
+ * @param position log position of the sample record
+ * @param previousRange temperature range of the previous sample, see summary
+ * @param range temperature range of the sample
+ */
+void STORAGE_INDEX_Update(TStorageIndex *const index, const TSensorsStorageData *const sample,
+                          uint32_t position, uint8_t previousRange, uint8_t range);
+
+/**
+ * @brief Close zone of the completed log sector
+ * @param index
+ * @param sectorPosition log position of the sector start
+ * @param sectorSize
+ */
+void STORAGE_INDEX_CloseZone(TStorageIndex *const index, uint32_t sectorPosition, uint32_t sectorSize);
+
+/**
+ * @brief Mark the next zone as partial, used when log is resumed in the middle of sector
+ * @details Excursion is resumed by itself: sample out of the same range as the previous one opens partial excursion
+ * @param index
+ */
+void STORAGE_INDEX_ResumeZone(TStorageIndex *const index);
+
+/**
+ * @brief Take pending entries as the next batch, batch never crosses index ring page
+ * @details Position is advanced past the batch, so it can be checkpointed before the batch is written
+ * @param index
+ * @param pageSize index ring page size
+ * @return true if there is a batch to write
+ */
+bool STORAGE_INDEX_TakeBatch(TStorageIndex *const index, uint32_t pageSize);
+
+/**
+ * @brief Drop written batch from pending entries
+ * @param index
+ */
+void STORAGE_INDEX_BatchWritten(TStorageIndex *const index);
+
+#ifdef    __cplusplus
+}
+#endif
+
+#endif //STORAGE_INDEX_H
@@ -5,9 +5,20 @@ extern const TEventHandler storageTransitionTable[STORAGE_STATES_MAX][STORAGE_SI
 static TEvent events[STORAGE_QUEUE_MAX_CAPACITY];
 static TSTORAGEActiveObject storageAO;
 
+_Static_assert(0 == (DRV_AT25DF_PAGE_SIZE % sizeof(TStorageCheckpoint)), "checkpoint slot crosses flash page");
+_Static_assert(0 == (DRV_AT25DF_PAGE_SIZE % sizeof(TStorageIndexEntry)), "index entry crosses flash page");
+
+static void _configureBrownOut(uint32_t action, uint8_t level);
+
+static void _enableBrownOutWarning(void);
+
+static void _flushBlocking(void);
+
+static inline bool _isTransferPending(void);
+
 TActiveObject *STORAGE_Initialize(void) {
     // init super AO
-    ActiveObject_Initialize(&storageAO.super, STORAGE_AO_ID, events, STORAGE_QUEUE_MAX_CAPACITY);
+    SCHEDULER_InitializeActor(&storageAO.super, STORAGE_AO_ID, events, STORAGE_QUEUE_MAX_CAPACITY);
     storageAO.super.state = &storageStatesList[STORAGE_ST_INIT];
 
     // open MEMORY driver, get handler
@@ -17,12 +28,29 @@ TActiveObject *STORAGE_Initialize(void) {
     // init AO fields
     storageAO.drvMemoryHandle = drvMemoryHandle;
     storageAO.transferHandle = DRV_I2C_TRANSFER_HANDLE_INVALID;
-    storageAO.flash.currentPage = 0;
+    storageAO.flash.writeAddress = LOG_DATA_START_ADDRESS;
+    storageAO.flash.sequence = 0;
+    storageAO.flash.isEraseAheadPending = false;
+    storageAO.flash.isFlushPending = false;
+    storageAO.flash.checkpointSlot = 0;
+    storageAO.flash.flushAddress = LOG_DATA_START_ADDRESS;
+    storageAO.flash.isTailPageLoaded = false;
+    storageAO.verify.pagesChecked = 0;
+    storageAO.verify.pagesCorrupted = 0;
+    storageAO.verify.report = (TStorageVerifyReport) {0};
+    storageAO.stream.isOpen = false;
+    storageAO.stream.isReading = false;
+    storageAO.stream.isReadDiscarded = false;
+    storageAO.dataToStore = NULL;
+    storageAO.recordPoolReserved = 0;
+    TIMERS_Cancel(STORAGE_FLUSH_TIMER_ID);
+    STORAGE_SUMMARY_Reset(&storageAO.summary);
+    STORAGE_INDEX_Reset(&storageAO.index, 0);
     STORAGE_CLearPageBuffer(&storageAO);
 
     // error on driver opening error
     if (DRV_HANDLE_INVALID == storageAO.drvMemoryHandle) {
-        ActiveObject_Dispatch(&storageAO.super, (TEvent) {.sig = STORAGE_ERROR});
+        SCHEDULER_Dispatch(&storageAO.super, (TEvent) {.sig = STORAGE_ERROR});
     }
 
     // set MEMORY handler
@@ -32,6 +60,8 @@ TActiveObject *STORAGE_Initialize(void) {
             (uintptr_t) &storageAO
     );
 
+    _enableBrownOutWarning();
+
     // for tests, empty some memory if needed
 //    DRV_MEMORY_AsyncErase(
 //            storageAO->drvMemoryHandle,
@@ -43,16 +73,105 @@ TActiveObject *STORAGE_Initialize(void) {
     return (TActiveObject *) &storageAO;
 };
 
+uint32_t STORAGE_GetOldestLogSectorAddress(void) {
+    return LOG_OLDEST_SECTOR_ADDRESS(storageAO.flash.sequence);
+}
+
+uint32_t STORAGE_GetOldestLogPosition(void) {
+    return LOG_OLDEST_SECTOR_SEQUENCE(storageAO.flash.sequence) * LOG_SECTOR_SIZE;
+}
+
+uint32_t STORAGE_GetLogSize(void) {
+    const uint32_t oldestAddress = LOG_OLDEST_SECTOR_ADDRESS(storageAO.flash.sequence);
+    const uint32_t endAddress = PAGE_START_ADDRESS(storageAO.flash.writeAddress) + DRV_AT25DF_PAGE_SIZE;
+
+    if (endAddress > oldestAddress) return endAddress - oldestAddress;
+
+    // ring wrapped
+    return (LOG_DATA_END_ADDRESS - oldestAddress) + (endAddress - LOG_DATA_START_ADDRESS);
+}
+
+uint32_t STORAGE_GetLogAddress(uint32_t offset) {
+    const uint32_t oldestAddress = LOG_OLDEST_SECTOR_ADDRESS(storageAO.flash.sequence);
+
+    if (offset < LOG_DATA_END_ADDRESS - oldestAddress) return oldestAddress + offset;
+
+    return LOG_DATA_START_ADDRESS + (offset - (LOG_DATA_END_ADDRESS - oldestAddress));
+}
+
+uint32_t STORAGE_GetIndexSize(void) {
+    return storageAO.index.position - INDEX_OLDEST_POSITION(storageAO.index.position);
+}
+
+uint32_t STORAGE_GetIndexAddress(uint32_t offset) {
+    return INDEX_ADDRESS(INDEX_OLDEST_POSITION(storageAO.index.position) + offset);
+}
+
+const TStorageSummary *STORAGE_GetSummary(void) {
+    return &storageAO.summary;
+}
+
+const TStorageVerifyReport *STORAGE_GetVerifyReport(void) {
+    return &storageAO.verify.report;
+}
+
+const TSensorsStorageData *STORAGE_GetLastSample(void) {
+    return &storageAO.encoder.last;
+}
+
+TSensorsStorageData *STORAGE_ReserveRecord(void) {
+    for (uint8_t i = 0; i < STORAGE_RECORD_POOL_SIZE; i++) {
+        if (storageAO.recordPoolReserved & (1U << i)) continue;
+
+        storageAO.recordPoolReserved |= (1U << i);
+        return &(storageAO.recordPool[i]);
+    }
+
+    return NULL;
+}
+
+bool STORAGE_CommitRecord(TSensorsStorageData *const record) {
+    const bool isDispatched = SCHEDULER_Dispatch(&storageAO.super, (TEvent) {
+            .sig = STORAGE_STORE_DATA_IN_TAIL,
+            .payload = record,
+            .size = sizeof(TSensorsStorageData)
+    });
+
+    // storage never sees the record on full queue, it would stay reserved for good
+    if (!isDispatched) STORAGE_ReleaseRecord(&storageAO, record);
+
+    return isDispatched;
+}
+
+void STORAGE_ReleaseRecord(TSTORAGEActiveObject *const storageAO, const TSensorsStorageData *const record) {
+    const ptrdiff_t i = record - storageAO->recordPool;
+
+    if ((i < 0) || (i >= STORAGE_RECORD_POOL_SIZE)) return;
+
+    storageAO->recordPoolReserved &= ~(1U << i);
+}
+
 void STORAGE_Deinitialize(void) {
+    _flushBlocking();
+
+    TIMERS_Cancel(STORAGE_FLUSH_TIMER_ID);
     storageAO.super.state = NULL;
     DRV_MEMORY_Close(storageAO.drvMemoryHandle);
 };
 
-void STORAGE_Tasks(void) {
-    if (NULL == storageAO.super.state) return; // not initialized yet
+bool STORAGE_IsTransferPending(void) {
+    if (NULL == storageAO.super.state) return false;
+
+    return _isTransferPending();
+}
+
+bool STORAGE_Tasks(void) {
+    if (NULL == storageAO.super.state) return false; // not initialized yet
 
-    const TEvent event = ActiveObject_ProcessQueue(&storageAO.super);
-    if (STORAGE_NO_EVENT == event.sig) return;
+    const TEvent event = SCHEDULER_ProcessQueue(&storageAO.super);
+    if (STORAGE_NO_EVENT == event.sig) return false;
+    METRICS_EVENT_PROCESSED(STORAGE_AO_ID);
+    POWER_EVENT_PROCESSED();
 
     const TState *nextState = FSM_ProcessEventToNextStateFromTransitionTable(&storageAO.super, event,
                                                                              STORAGE_STATES_MAX, STORAGE_SIG_MAX,
@@ -65,6 +184,12 @@ void STORAGE_Tasks(void) {
 #endif
 
     if (FSM_IsValidState(nextState)) FSM_TraverseAOToNextState(&storageAO.super, nextState);
+
+    // record is encoded or dropped by now, unless it is kept pending for the next page
+    if ((STORAGE_STORE_DATA_IN_TAIL == event.sig) && (event.payload != storageAO.dataToStore))
+        STORAGE_ReleaseRecord(&storageAO, event.payload);
+
+    return true;
 };
 
 void STORAGE_CLearPageBuffer(TSTORAGEActiveObject *const storageAO) {
@@ -74,13 +199,103 @@ void STORAGE_CLearPageBuffer(TSTORAGEActiveObject *const storageAO) {
 void STORAGE_TransferEventHandler(DRV_MEMORY_EVENT event, DRV_MEMORY_COMMAND_HANDLE commandHandle, uintptr_t context) {
     switch (event) {
         case DRV_MEMORY_EVENT_COMMAND_COMPLETE: {
-            return ActiveObject_Dispatch((TActiveObject *) context, (TEvent) {.sig = STORAGE_TRANSFER_SUCCESS});
+            SCHEDULER_Dispatch((TActiveObject *) context, (TEvent) {.sig = STORAGE_TRANSFER_SUCCESS});
+            return;
         }
         case DRV_MEMORY_EVENT_COMMAND_ERROR: {
-            return ActiveObject_Dispatch((TActiveObject *) context, (TEvent) {.sig = STORAGE_TRANSFER_FAIL});
+            SCHEDULER_Dispatch((TActiveObject *) context, (TEvent) {.sig = STORAGE_TRANSFER_FAIL});
+            return;
         }
         default: {
             break;
         }
     }
-}
\ No newline at end of file
+}
+/**
+ * @brief BOD33 early warning, flush tail page while there is still power to program flash
+ * @details Flush is latched and goes first, BOD33 is switched back to reset at once at STORAGE_BROWN_OUT_RESET_LEVEL,
+ * so the flush has the supply fall from warning to reset level, and MCU never runs the flash below its minimum VCC.
+ * Warning is not re-armed if supply recovers, it is on the next boot.
+ */
+void SYSCTRL_Handler(void) {
+    if (SYSCTRL_REGS->SYSCTRL_INTFLAG & SYSCTRL_INTFLAG_BOD33DET_Msk) {
+        SYSCTRL_REGS->SYSCTRL_INTFLAG = SYSCTRL_INTFLAG_BOD33DET_Msk;
+
+        if (NULL != storageAO.super.state)
+            SCHEDULER_Dispatch(&storageAO.super, (TEvent) {.sig = STORAGE_FLUSH});
+
+        SYSCTRL_REGS->SYSCTRL_INTENCLR = SYSCTRL_INTENCLR_BOD33DET_Msk;
+        _configureBrownOut(SYSCTRL_BOD33_ACTION_RESET, STORAGE_BROWN_OUT_RESET_LEVEL);
+    }
+}
+
+static void _configureBrownOut(uint32_t action, uint8_t level) {
+    uint32_t bod33 = SYSCTRL_REGS->SYSCTRL_BOD33 & ~SYSCTRL_BOD33_ENABLE_Msk;
+
+    // BOD33 should be disabled while its configuration is changed
+    SYSCTRL_REGS->SYSCTRL_BOD33 = bod33;
+    while (!(SYSCTRL_REGS->SYSCTRL_PCLKSR & SYSCTRL_PCLKSR_B33SRDY_Msk));
+
+    bod33 &= ~(SYSCTRL_BOD33_ACTION_Msk | SYSCTRL_BOD33_LEVEL_Msk);
+    bod33 |= action | SYSCTRL_BOD33_LEVEL(level) | SYSCTRL_BOD33_HYST_Msk;
+    SYSCTRL_REGS->SYSCTRL_BOD33 = bod33;
+    while (!(SYSCTRL_REGS->SYSCTRL_PCLKSR & SYSCTRL_PCLKSR_B33SRDY_Msk));
+
+    SYSCTRL_REGS->SYSCTRL_BOD33 = bod33 | SYSCTRL_BOD33_ENABLE_Msk;
+    while (!(SYSCTRL_REGS->SYSCTRL_PCLKSR & SYSCTRL_PCLKSR_BOD33RDY_Msk));
+}
+
+/**
+ * @brief Reconfigure BOD33 from reset (fuses) to interrupt on STORAGE_BROWN_OUT_WARNING_LEVEL
+ * @note POR still resets the MCU on power loss, BOD33 reset is restored by the warning
+ */
+static void _enableBrownOutWarning(void) {
+    _configureBrownOut(SYSCTRL_BOD33_ACTION_INTERRUPT, STORAGE_BROWN_OUT_WARNING_LEVEL);
+
+    SYSCTRL_REGS->SYSCTRL_INTFLAG = SYSCTRL_INTFLAG_BOD33DET_Msk;
+    SYSCTRL_REGS->SYSCTRL_INTENSET = SYSCTRL_INTENSET_BOD33DET_Msk;
+    NVIC_SetPriority(SYSCTRL_IRQn, 3);
+    NVIC_EnableIRQ(SYSCTRL_IRQn);
+}
+
+static inline bool _isTransferPending(void) {
+    if (DRV_MEMORY_COMMAND_HANDLE_INVALID == storageAO.transferHandle) return false;
+
+    const DRV_MEMORY_COMMAND_STATUS status = DRV_MEMORY_CommandStatusGet(storageAO.drvMemoryHandle,
+                                                                         storageAO.transferHandle);
+
+    return (DRV_MEMORY_COMMAND_QUEUED == status) || (DRV_MEMORY_COMMAND_IN_PROGRESS == status);
+}
+
+// wait until queued MEMORY transfer is done, polling driver tasks as main loop does
+static void _waitTransferComplete(void) {
+    while (_isTransferPending()) DRV_MEMORY_Tasks(sysObj.drvMemory0);
+}
+
+/** @brief Write records accumulated in tail page, used when actor is stopped and can't process events anymore */
+static void _flushBlocking(void) {
+    if (NULL == storageAO.super.state) return;
+
+    _waitTransferComplete();
+
+    if (!storageAO.flash.isTailPageLoaded) return;
+
+    const uint32_t offset = storageAO.flash.writeAddress - storageAO.flash.tailPageAddress;
+    storageAO.flash.writeAddress += STORAGE_RECORD_Seal(&storageAO.encoder, storageAO.pageBuffer + offset,
+                                                        DRV_AT25DF_PAGE_SIZE - offset);
+
+    if (storageAO.flash.writeAddress <= storageAO.flash.flushAddress) return;
+
+    memcpy(storageAO.flushBuffer, storageAO.pageBuffer, DRV_AT25DF_PAGE_SIZE);
+    DRV_MEMORY_AsyncWrite(
+            storageAO.drvMemoryHandle,
+            &(storageAO.transferHandle),
+            storageAO.flushBuffer,
+            storageAO.flash.tailPageAddress / DRV_AT25DF_PAGE_SIZE, // write block is a page
+            WRITE_BLOCKS_IN_PAGE);
+    METRICS_INC(flashTransactions);
+    METRICS_ADD(flashBytesWritten, DRV_AT25DF_PAGE_SIZE);
+
+    _waitTransferComplete();
+    storageAO.flash.flushAddress = storageAO.flash.writeAddress;
+}
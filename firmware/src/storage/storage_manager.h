@@ -20,6 +20,14 @@
 #include "../../../../libraries/active-object-fsm/src/active_object/active_object.h"
 #include "../../../libraries/active-object-fsm/src/fsm/fsm.h"
 #include "../init_manager/init.config.h"
+#include "../metrics/metrics.h"
+#include "../power/power.h"
+#include "../scheduler/scheduler.h"
+#include "../timers/timers.h"
+#include "./storage_data.defs.h"
+#include "./storage_record.h"
+#include "./storage_summary.h"
+#include "./storage_index.h"
 
 #ifdef    __cplusplus
 extern "C" {
@@ -32,14 +40,49 @@ extern "C" {
 #define READ_BLOCK_SIZE                         (1)
 #define PARTITION_0_ADDRESS                     (0x200) // 512KB
 #define BOOT_SECTOR_SIZE                        (0x1000) // 1 erase block equal (4096)
-#define LOG_DATA_START_ADDRESS                  (BOOT_SECTOR_SIZE) // 1st page after boot sector
-#define END_OF_PAGE_ADDRESS                     (DRV_AT25DF_PAGE_SIZE - 1)
+#define CHECKPOINT_SECTOR_ADDRESS               (BOOT_SECTOR_SIZE) // journal sector right after boot sector
+#define CHECKPOINT_SECTOR_SIZE                  (DRV_AT25DF_ERASE_BUFFER_SIZE)
+#define CHECKPOINT_SLOTS_MAX                    (CHECKPOINT_SECTOR_SIZE / sizeof(TStorageCheckpoint))
+#define CHECKPOINT_SLOT_ADDRESS(slot)           (CHECKPOINT_SECTOR_ADDRESS + ((slot) * sizeof(TStorageCheckpoint)))
+#define INDEX_DATA_START_ADDRESS                (CHECKPOINT_SECTOR_ADDRESS + CHECKPOINT_SECTOR_SIZE) // index ring right after checkpoint journal
+#define INDEX_SECTOR_SIZE                       (DRV_AT25DF_ERASE_BUFFER_SIZE)
+#define INDEX_SECTORS_MAX                       (DRV_AT25DF_FLASH_SIZE / 0x40000) // zone entries of the whole log ring take a half
+#define INDEX_DATA_SIZE                         (INDEX_SECTORS_MAX * INDEX_SECTOR_SIZE)
+#define INDEX_DATA_END_ADDRESS                  (INDEX_DATA_START_ADDRESS + INDEX_DATA_SIZE)
+#define INDEX_ADDRESS(position)                 (INDEX_DATA_START_ADDRESS + ((position) % INDEX_DATA_SIZE))
+// sector of the cursor is erased once batch enters it, so sectors ahead of it hold the oldest entries
+#define INDEX_END_OF_SECTOR(position)           (((position) + INDEX_SECTOR_SIZE - 1) & ~(uint32_t) (INDEX_SECTOR_SIZE - 1))
+#define INDEX_OLDEST_POSITION(position)         ((INDEX_END_OF_SECTOR(position) > INDEX_DATA_SIZE) ? (INDEX_END_OF_SECTOR(position) - INDEX_DATA_SIZE) : 0)
+#define LOG_DATA_START_ADDRESS                  (INDEX_DATA_END_ADDRESS) // 1st page after index ring
+#define LOG_DATA_END_ADDRESS                    (DRV_AT25DF_FLASH_SIZE)
+#define LOG_SECTOR_SIZE                         (DRV_AT25DF_ERASE_BUFFER_SIZE) // log is a ring of erase sectors
+#define LOG_SECTORS_MAX                         ((LOG_DATA_END_ADDRESS - LOG_DATA_START_ADDRESS) / LOG_SECTOR_SIZE)
+#define LOG_PAGES_IN_SECTOR                     (LOG_SECTOR_SIZE / DRV_AT25DF_PAGE_SIZE)
+#define LOG_SECTOR_ADDRESS(sector)              (LOG_DATA_START_ADDRESS + ((sector) * LOG_SECTOR_SIZE))
+#define LOG_SECTOR_INDEX(address)               (((address) - LOG_DATA_START_ADDRESS) / LOG_SECTOR_SIZE)
+#define LOG_SECTOR_OFFSET(address)              (((address) - LOG_DATA_START_ADDRESS) & (LOG_SECTOR_SIZE - 1))
+#define LOG_SECTOR_HEADER_SIZE                  (sizeof(TStorageSectorHeader))
+// sector after the tail one is erased ahead, so the next one holds the oldest records once ring is wrapped
+#define LOG_OLDEST_SECTOR_ADDRESS(sequence)     (((sequence) < LOG_SECTORS_MAX - 1) ? LOG_DATA_START_ADDRESS : LOG_SECTOR_ADDRESS(((sequence) + 2) % LOG_SECTORS_MAX))
+#define LOG_OLDEST_SECTOR_SEQUENCE(sequence)    (((sequence) < LOG_SECTORS_MAX - 1) ? 0 : ((sequence) + 2 - LOG_SECTORS_MAX))
+// position of address in sector with given sequence, it grows monotonically regardless of ring wraps
+#define LOG_POSITION(sequence, address)         (((sequence) * LOG_SECTOR_SIZE) + LOG_SECTOR_OFFSET(address))
+#define LOG_PAGE_ADDRESS(page)                  (LOG_DATA_START_ADDRESS + ((page) * DRV_AT25DF_PAGE_SIZE))
+#define LOG_PAGE_PROBE_SIZE                     (0x10) // 1st record slot is enough to tell written page from erased one
+#define PAGE_START_ADDRESS(address)             ((address) & ~(uint32_t) (DRV_AT25DF_PAGE_SIZE - 1))
+#define PAGE_OFFSET(address)                    ((address) & (DRV_AT25DF_PAGE_SIZE - 1))
 #define READ_BLOCKS_IN_PAGE                     (DRV_AT25DF_PAGE_SIZE / READ_BLOCK_SIZE)
 #define WRITE_BLOCKS_IN_PAGE                    (1)
 #define BOOT_SECTOR_PAGES_TO_VALIDATE           (1) // Amount of pages on flash to verify with boot sector header in NVM
 #define IS_EQUAL_PAGES                          (0)
-#define IS_ENOUGH_PLACE_TO_STORE                (0)
 #define ERASED_PAGE_PATTERN                     (0xFF)
+#define STORAGE_FLUSH_TIMEOUT_MS                (60000) // max time for records to stay in RAM tail page
+#define STORAGE_BROWN_OUT_WARNING_LEVEL         (39) // BOD33 level ~2.84V, see BOD33 characteristics in datasheet
+#define STORAGE_BROWN_OUT_RESET_LEVEL           (36) // ~2.74V, ~34mV per level, AT25DF321 flash needs VCC 2.7V min
+#define STORAGE_RECORD_POOL_SIZE                (4) // samples reserved by producers and not encoded to tail page yet, up to 8
+#define STORAGE_STREAM_CHUNK_SIZE               (4 * DRV_AT25DF_PAGE_SIZE) // bytes read by single SPI transfer for log export
+#define STORAGE_STREAM_BUFFERS                  (2) // one chunk is handed out to consumer while next one is read
+#define STORAGE_VERIFY_LOG_ON_BOOT              (1) // verify whole log CRC once tail is found, ~70s for full 8MB flash at 1MHz SPI
     
 extern const unsigned char FATBootSectorImage[DRV_MEMORY_BOOT_SECTOR_SIZE_PAGES * DRV_AT25DF_PAGE_SIZE];
 
@@ -51,14 +94,32 @@ typedef enum {
     STORAGE_ST_READ_BOOT_SECTOR,
     STORAGE_ST_VERIFY_BOOT_SECTOR,
     STORAGE_ST_WRITE_BOOT_SECTOR,
+    STORAGE_ST_SEEK_CHECKPOINT,
+    STORAGE_ST_SEEK_TAIL_SECTOR,
     STORAGE_ST_SEEK_LAST_NONEMPTY_PAGE,
-    STORAGE_ST_STORE_DATA_IN_TAIL,
-    STORAGE_ST_STORE_DATA,
+    STORAGE_ST_LOAD_TAIL_PAGE,
+    STORAGE_ST_FLUSH,
+    STORAGE_ST_ERASE_CHECKPOINT,
+    STORAGE_ST_WRITE_CHECKPOINT,
+    STORAGE_ST_ERASE_AHEAD,
+    STORAGE_ST_ERASE_INDEX,
+    STORAGE_ST_WRITE_INDEX,
+    STORAGE_ST_VERIFY_LOG,
+    STORAGE_ST_STREAM_READ,
     STORAGE_ST_ERROR,
     STORAGE_STATES_MAX
 } STORAGE_STATE;
 
-/** @brief storage manager events signals */
+/**
+ * @brief storage manager events signals
+ * @note STORAGE_STORE_DATA_IN_TAIL payload is TSensorsStorageData of the actor's record pool, it is compressed by storage.
+ * Use STORAGE_ReserveRecord and STORAGE_CommitRecord to send it.
+ * @note STORAGE_VERIFY_LOG checks CRC of all log pages, result is in verify report
+ * @note STORAGE_STREAM_OPEN payload is TStorageStreamRequest, chunks are dispatched to consumer one by one,
+ * consumer dispatches STORAGE_STREAM_RELEASE once it is done with the chunk.
+ * Records still in RAM tail page are not streamed, dispatch STORAGE_FLUSH before stream is opened to get them.
+ * Index ring is streamed the same way, index entries are written on checkpoint (page completion or flush).
+ */
 typedef enum {
     STORAGE_NO_EVENT = 0,
     STORAGE_CHECK_MEMORY_BOOT_SECTOR,
@@ -67,12 +128,42 @@ typedef enum {
     STORAGE_FIND_LAST_NON_EMPTY_PAGE,
     STORAGE_FIND_LAST_NON_EMPTY_PAGE_SUCCESS,
     STORAGE_STORE_DATA_IN_TAIL,
+    STORAGE_FLUSH,
+    STORAGE_VERIFY_LOG,
+    STORAGE_STREAM_OPEN,
+    STORAGE_STREAM_RELEASE,
+    STORAGE_STREAM_CLOSE,
     STORAGE_TRANSFER_SUCCESS,
     STORAGE_TRANSFER_FAIL,
     STORAGE_ERROR,
     STORAGE_SIG_MAX
 } STORAGE_SIG;
 
+/** @brief Log stream request, STORAGE_STREAM_OPEN payload, it is copied by storage */
+typedef struct {
+    uint32_t address; /**< log (index) flash address to stream from */
+    uint32_t size; /**< bytes to stream, stream wraps around the ring */
+    uint32_t ringStartAddress; /**< LOG_DATA_START_ADDRESS or INDEX_DATA_START_ADDRESS */
+    uint32_t ringEndAddress; /**< LOG_DATA_END_ADDRESS or INDEX_DATA_END_ADDRESS */
+    TActiveObject *consumer; /**< actor to dispatch chunks to */
+    uint32_t chunkReadySig; /**< consumer signal, payload is const TStorageStreamChunk* valid until STORAGE_STREAM_RELEASE */
+} TStorageStreamRequest;
+
+/** @brief Log integrity verification report, of the last run completed */
+typedef struct {
+    uint32_t runs; /**< runs completed since storage initialization */
+    uint32_t pagesChecked; /**< log pages verified, from the oldest sector to the tail page */
+    uint32_t pagesCorrupted; /**< pages with CRC mismatch or torn records */
+} TStorageVerifyReport;
+
+/** @brief Log stream chunk handed out to consumer */
+typedef struct {
+    uint32_t address; /**< flash address of the chunk */
+    uint32_t size; /**< chunk data size */
+    const uint8_t *data; /**< chunk data */
+    bool isLast; /**< stream is closed once this chunk is released */
+} TStorageStreamChunk;
+
 /**
 * @brief STORAGE Active Object Type
 * @extends TActiveObject
@@ -82,11 +173,44 @@ typedef struct {
     DRV_HANDLE drvMemoryHandle; /**< MEMORY driver handle */
     DRV_MEMORY_COMMAND_HANDLE transferHandle; /**< MEMORY driver transfer handle */
     struct {
-        uint8_t currentPage; /**< current page to process */
+        uint32_t writeAddress; /**< byte write cursor, flash address to append next record at */
+        uint32_t flushAddress; /**< flash is programmed up to this address, records above are in tail page buffer only */
+        uint32_t tailPageAddress; /**< flash address of the page mirrored in page buffer */
+        bool isTailPageLoaded; /**< page buffer holds tail page content and accumulates new records */
+        uint32_t sequence; /**< sequence number of the tail sector, incremented on each new sector in the ring */
+        bool isEraseAheadPending; /**< sector after the tail one should be erased on idle */
+        bool isFlushPending; /**< flush was requested while flash was busy, it is done on idle */
+        uint32_t checkpointSlot; /**< next free slot in checkpoint journal */
+        uint32_t seekLow; /**< tail search: all sectors (pages, journal slots) below are written */
+        uint32_t seekHigh; /**< tail search: this sector (page, journal slot) and all above are erased */
+        uint32_t seekProbe; /**< tail search: sector (page, journal slot) being probed */
     } flash; /**< flash memory state representation */
-    void* dataToStore; /**< pointer to data to store in flash */
-    size_t dataToStoreSize; /**< size of data to store in flash */
-    uint8_t pageBuffer[DRV_AT25DF_PAGE_SIZE]; /**< page buffer to read to or to write from*/
+    struct {
+        uint32_t pageAddress; /**< page being verified */
+        uint32_t pagesChecked; /**< pages verified by the current run */
+        uint32_t pagesCorrupted; /**< pages with CRC mismatch or torn records */
+        TStorageVerifyReport report; /**< of the last run completed */
+    } verify; /**< log integrity verification */
+    struct {
+        TStorageStreamRequest request; /**< consumer, next address to read and bytes left to read */
+        bool isOpen; /**< stream has chunks to read or to hand out */
+        bool isReading; /**< chunk read is in progress */
+        bool isReadDiscarded; /**< stream was reopened or closed while chunk was read */
+        bool isHandedOut; /**< consumer holds the chunk to be delivered */
+        uint8_t fillIndex; /**< buffer to read the next chunk to */
+        uint8_t deliverIndex; /**< buffer to hand out next */
+        uint8_t chunksFilled; /**< buffers with data, handed out one included */
+        TStorageStreamChunk chunks[STORAGE_STREAM_BUFFERS]; /**< chunks descriptors */
+        uint8_t buffers[STORAGE_STREAM_BUFFERS][STORAGE_STREAM_CHUNK_SIZE]; /**< double buffer, chunk is read while previous one is consumed */
+    } stream; /**< log export stream */
+    const TSensorsStorageData *dataToStore; /**< sample pending to be appended, when it does not fit into tail page */
+    TSensorsStorageData recordPool[STORAGE_RECORD_POOL_SIZE]; /**< samples are written by producers right here, no copies till encoding */
+    uint8_t recordPoolReserved; /**< bitmask of pool records reserved by producers or pending to be encoded */
+    TStorageRecordCodec encoder; /**< tail page block encoder, samples are stored compressed */
+    TStorageSummary summary; /**< statistics of samples appended, checkpointed with write cursor */
+    TStorageIndex index; /**< index entries builder and index ring cursor */
+    uint8_t pageBuffer[DRV_AT25DF_PAGE_SIZE]; /**< tail page write-combining buffer, also used for reads on boot */
+    uint8_t flushBuffer[DRV_AT25DF_PAGE_SIZE]; /**< page snapshot being written, so records still can be appended meanwhile, also used for log verification reads */
 } TSTORAGEActiveObject;
 
 /**
@@ -96,17 +220,110 @@ typedef struct {
 */
 TActiveObject* STORAGE_Initialize(void);
 
+/**
+ * @brief Get address of the oldest log sector
+ * @details Sector ring maps sequence numbers to sectors, so no flash search is needed
+ * @return flash address of the oldest sector header
+ */
+uint32_t STORAGE_GetOldestLogSectorAddress(void);
+
+/**
+ * @brief Get log position of the oldest log sector, index entries below it are stale
+ * @details Log offset of index entry position is the position minus the oldest one
+ * @return position of the oldest sector header
+ */
+uint32_t STORAGE_GetOldestLogPosition(void);
+
+/**
+ * @brief Get log size, from the oldest sector header to the end of the tail page
+ * @details Log offsets are counted from the oldest sector, so they do not depend on where ring wraps
+ * @return log size in bytes
+ */
+uint32_t STORAGE_GetLogSize(void);
+
+/**
+ * @brief Convert log offset to flash address
+ * @param offset bytes from the oldest sector header, less than STORAGE_GetLogSize()
+ * @return flash address
+ */
+uint32_t STORAGE_GetLogAddress(uint32_t offset);
+
+/**
+ * @brief Get index size, from the oldest entry kept in index ring to the index cursor
+ * @details Index is an array of TStorageIndexEntry, erased entries are padding
+ * @return index size in bytes
+ */
+uint32_t STORAGE_GetIndexSize(void);
+
+/**
+ * @brief Convert index offset to flash address
+ * @param offset bytes from the oldest entry, less than STORAGE_GetIndexSize()
+ * @return flash address
+ */
+uint32_t STORAGE_GetIndexAddress(uint32_t offset);
+
+/**
+ * @brief Get summary statistics of all samples stored
+ * @details Samples still in RAM tail page are included
+ * @return summary, valid till the next sample is appended
+ */
+const TStorageSummary *STORAGE_GetSummary(void);
+
+/**
+ * @brief Get log integrity verification report
+ * @details Log is verified once its tail is found on boot (STORAGE_VERIFY_LOG_ON_BOOT) or on STORAGE_VERIFY_LOG
+ * @return report of the last run completed, no runs yet if it is in progress
+ */
+const TStorageVerifyReport *STORAGE_GetVerifyReport(void);
+
+/**
+ * @brief Get the last sample stored
+ * @return sample, valid if summary has samples, till the next sample is appended
+ */
+const TSensorsStorageData *STORAGE_GetLastSample(void);
+
+/**
+ * @brief Reserve record in storage pool for producer to write sample to
+ * @details Record stays owned by storage till it is encoded to tail page, so producer may reuse its own buffers at once.
+ * Should be called from main loop (actors) context.
+ * @return record to fill and commit, NULL if pool is exhausted (storage is behind, sample should be dropped)
+ */
+TSensorsStorageData *STORAGE_ReserveRecord(void);
+
+/**
+ * @brief Send filled record to be stored in the log tail
+ * @param record reserved with STORAGE_ReserveRecord, producer should not access it anymore
+ * @return false if storage queue is full: sample is dropped and record is back in the pool
+ */
+bool STORAGE_CommitRecord(TSensorsStorageData *const record);
+
+/**
+ * @brief Return record to the pool once it is encoded or dropped
+ * @details Releasing record which is not reserved or does not belong to the pool is a no-op
+ * @memberof TSTORAGEActiveObject
+ */
+void STORAGE_ReleaseRecord(TSTORAGEActiveObject *const storageAO, const TSensorsStorageData *const record);
+
 /**
  * @brief Deinitialize the actor
- * @details Sets to NO_STATE, all pending events will be lost. Closes MEMORY driver.
+ * @details Flushes tail page (blocking), then sets to NO_STATE, all pending events will be lost. Closes MEMORY driver.
  * @memberof TSTORAGEActiveObject
  */
 void STORAGE_Deinitialize(void);
 
+/**
+ * @brief Check if MEMORY driver transfer is queued or in progress, driver tasks should be polled then
+ * @return false if storage is not running
+ */
+bool STORAGE_IsTransferPending(void);
+
 /* Microchip Harmony 3 specific */
 
-/** @brief Perform Actor tasks, mainly listen for events and process them */
-void STORAGE_Tasks(void);
+/**
+ * @brief Perform Actor tasks, handle a single event, run by scheduler while actor is ready
+ * @return true if event is handled
+ */
+bool STORAGE_Tasks(void);
 
 /**
 * @brief Clean page buffer
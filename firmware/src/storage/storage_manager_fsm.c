@@ -10,17 +10,213 @@ static const TState *_writeMemoryBootSector(TActiveObject *const AO, TEvent even
 
 static const TState *_verifyMemoryBootSector(TActiveObject *const AO, TEvent event);
 
-static const TState *_seekLastLogsNonEmptyPage(TActiveObject *const AO, TEvent event);
+static const TState *_seekCheckpoint(TActiveObject *const AO, TEvent event);
+
+static const TState *_bisectCheckpoint(TActiveObject *const AO, TEvent event);
+
+static const TState *_seekTailSector(TActiveObject *const AO, TEvent event);
+
+static const TState *_bisectTailSector(TActiveObject *const AO, TEvent event);
+
+static const TState *_bisectLogsTail(TActiveObject *const AO, TEvent event);
+
+static const TState *_tailFound(TActiveObject *const AO, TEvent event);
 
 static const TState *_storeDataInTail(TActiveObject *const AO, TEvent event);
 
-static const TState *_storeData(TActiveObject *const AO, TEvent event);
+static const TState *_loadTailPage(TActiveObject *const AO, TEvent event);
+
+static const TState *_appendPendingData(TActiveObject *const AO, TEvent event);
+
+static const TState *_storeDataWhileBusy(TActiveObject *const AO, TEvent event);
+
+static const TState *_flush(TActiveObject *const AO, TEvent event);
+
+static const TState *_flushWhileBusy(TActiveObject *const AO, TEvent event);
+
+static const TState *_flushComplete(TActiveObject *const AO, TEvent event);
+
+static const TState *_checkpoint(TActiveObject *const AO, TEvent event);
+
+static const TState *_writeCheckpoint(TActiveObject *const AO, TEvent event);
+
+static const TState *_writeIndexBatch(TActiveObject *const AO, TEvent event);
+
+static const TState *_indexBatchWritten(TActiveObject *const AO, TEvent event);
+
+static const TState *_eraseAheadComplete(TActiveObject *const AO, TEvent event);
+
+static const TState *_verifyLog(TActiveObject *const AO, TEvent event);
+
+static const TState *_verifyLogPage(TActiveObject *const AO, TEvent event);
+
+static const TState *_streamOpen(TActiveObject *const AO, TEvent event);
+
+static const TState *_streamRelease(TActiveObject *const AO, TEvent event);
+
+static const TState *_streamClose(TActiveObject *const AO, TEvent event);
+
+static const TState *_streamChunkRead(TActiveObject *const AO, TEvent event);
+
+extern const TState storageStatesList[STORAGE_STATES_MAX];
 
 // error on MEMORY transfer queuing
 static inline void _dispatchErrorOnInvalidTransfer(TSTORAGEActiveObject *const storageAO) {
     if (DRV_I2C_TRANSFER_HANDLE_INVALID == storageAO->transferHandle) {
-        ActiveObject_Dispatch(&(storageAO->super), (TEvent) {.sig = STORAGE_ERROR});
+        SCHEDULER_Dispatch(&(storageAO->super), (TEvent) {.sig = STORAGE_ERROR});
+    };
+};
+
+/** @brief checks if buffer content is equal to erased flash pattern */
+static inline bool _isErased(const uint8_t *const buffer, size_t size) {
+    for (size_t i = 0; i < size; i++)
+        if (ERASED_PAGE_PATTERN != buffer[i])
+            return false;
+    return true;
+};
+
+// read few bytes to page buffer to test whether flash area was ever written
+static inline void _probeFlash(TSTORAGEActiveObject *const storageAO, uint32_t address, size_t size) {
+    DRV_MEMORY_AsyncRead(
+            storageAO->drvMemoryHandle,
+            &(storageAO->transferHandle),
+            storageAO->pageBuffer,
+            address,
+            size / READ_BLOCK_SIZE
+    );
+
+    _dispatchErrorOnInvalidTransfer(storageAO);
+    METRICS_INC(flashTransactions);
+    METRICS_ADD(flashBytesRead, size);
+};
+
+static inline bool _isTailPageFull(TSTORAGEActiveObject *const storageAO) {
+    return storageAO->flash.isTailPageLoaded &&
+           (storageAO->flash.writeAddress >= storageAO->flash.tailPageAddress + DRV_AT25DF_PAGE_SIZE);
+};
+
+// (re)start flush timeout once tail page gets records not yet written to flash
+static inline void _armFlushTimeout(TSTORAGEActiveObject *const storageAO) {
+    if (TIMERS_IsArmed(STORAGE_FLUSH_TIMER_ID)) return;
+
+    TIMERS_Arm(STORAGE_FLUSH_TIMER_ID, &(storageAO->super), (TEvent) {.sig = STORAGE_FLUSH}, STORAGE_FLUSH_TIMEOUT_MS);
+};
+
+static inline void _cancelFlushTimeout(TSTORAGEActiveObject *const storageAO) {
+    TIMERS_Cancel(STORAGE_FLUSH_TIMER_ID);
+};
+
+// account sample in summary and index, record address is where it is appended
+static inline void _accountSample(TSTORAGEActiveObject *const storageAO, const TSensorsStorageData *const sample, uint32_t address) {
+    const uint8_t previousRange = storageAO->summary.range;
+
+    STORAGE_SUMMARY_Update(&(storageAO->summary), sample);
+    STORAGE_INDEX_Update(&(storageAO->index), sample, LOG_POSITION(storageAO->flash.sequence, address), previousRange,
+                         storageAO->summary.range);
+};
+
+// encode sample to tail page buffer if it fits, no flash access
+static inline bool _appendToTailPage(TSTORAGEActiveObject *const storageAO, const TSensorsStorageData *const sample) {
+    const uint32_t offset = storageAO->flash.writeAddress - storageAO->flash.tailPageAddress;
+
+    if (offset >= DRV_AT25DF_PAGE_SIZE) return false;
+
+    const size_t size = STORAGE_RECORD_Encode(&(storageAO->encoder), sample, storageAO->pageBuffer + offset,
+                                              DRV_AT25DF_PAGE_SIZE - offset);
+    if (0 == size) return false;
+
+    _accountSample(storageAO, sample, storageAO->flash.writeAddress);
+    storageAO->flash.writeAddress += size;
+    METRICS_INC(samplesStored);
+
+    _armFlushTimeout(storageAO);
+
+    return true;
+};
+
+// read whole log page to flush buffer, page buffer keeps accumulating records meanwhile
+static inline void _readLogPage(TSTORAGEActiveObject *const storageAO, uint32_t pageAddress) {
+    DRV_MEMORY_AsyncRead(
+            storageAO->drvMemoryHandle,
+            &(storageAO->transferHandle),
+            storageAO->flushBuffer,
+            pageAddress,
+            READ_BLOCKS_IN_PAGE
+    );
+
+    _dispatchErrorOnInvalidTransfer(storageAO);
+    METRICS_INC(flashTransactions);
+    METRICS_ADD(flashBytesRead, DRV_AT25DF_PAGE_SIZE);
+};
+
+static inline bool _isStreamReadPending(TSTORAGEActiveObject *const storageAO) {
+    return storageAO->stream.isOpen && !storageAO->stream.isReading && (0 != storageAO->stream.request.size) &&
+           (storageAO->stream.chunksFilled < STORAGE_STREAM_BUFFERS);
+};
+
+// read next stream chunk with single transfer, chunk never crosses end of the ring
+static inline void _readStreamChunk(TSTORAGEActiveObject *const storageAO) {
+    TStorageStreamRequest *const request = &(storageAO->stream.request);
+    TStorageStreamChunk *const chunk = &(storageAO->stream.chunks[storageAO->stream.fillIndex]);
+    uint32_t size = STORAGE_STREAM_CHUNK_SIZE;
+
+    if (size > request->size) size = request->size;
+    if (size > request->ringEndAddress - request->address) size = request->ringEndAddress - request->address;
+
+    chunk->address = request->address;
+    chunk->size = size;
+    chunk->data = storageAO->stream.buffers[storageAO->stream.fillIndex];
+    chunk->isLast = (size == request->size);
+
+    DRV_MEMORY_AsyncRead(
+            storageAO->drvMemoryHandle,
+            &(storageAO->transferHandle),
+            storageAO->stream.buffers[storageAO->stream.fillIndex],
+            chunk->address,
+            size / READ_BLOCK_SIZE
+    );
+
+    _dispatchErrorOnInvalidTransfer(storageAO);
+    METRICS_INC(flashTransactions);
+    METRICS_ADD(flashBytesRead, size);
+
+    request->address += size;
+    if (request->address >= request->ringEndAddress) request->address = request->ringStartAddress;
+    request->size -= size;
+    storageAO->stream.isReading = true;
+};
+
+static inline void _deliverStreamChunk(TSTORAGEActiveObject *const storageAO) {
+    SCHEDULER_Dispatch(storageAO->stream.request.consumer, (TEvent) {
+            .sig = storageAO->stream.request.chunkReadySig,
+            .payload = &(storageAO->stream.chunks[storageAO->stream.deliverIndex]),
+            .size = sizeof(TStorageStreamChunk)
+    });
+    storageAO->stream.isHandedOut = true;
+};
+
+// stream events are accepted in any state, only idle one should start pending flash job
+static inline const TState *_stayOrIdle(TActiveObject *const AO, TEvent event) {
+    if (&(storageStatesList[STORAGE_ST_IDLE]) == AO->state) return _idle(AO, event);
+
+    return AO->state;
+};
+
+// bisection midpoint of the tail search range, remembered as probed one
+static inline uint32_t _seekMiddle(TSTORAGEActiveObject *const storageAO) {
+    storageAO->flash.seekProbe = storageAO->flash.seekLow + (storageAO->flash.seekHigh - storageAO->flash.seekLow) / 2;
+    return storageAO->flash.seekProbe;
+};
+
+// start new sector of the ring in tail page buffer, header goes to flash with first flushed records
+static inline void _putSectorHeader(TSTORAGEActiveObject *const storageAO) {
+    const TStorageSectorHeader header = {
+            .sequence = storageAO->flash.sequence,
+            .sequenceInverted = ~storageAO->flash.sequence
     };
+
+    memcpy(storageAO->pageBuffer, &header, sizeof(TStorageSectorHeader));
+    storageAO->flash.isEraseAheadPending = true;
 };
 
 /* states */
@@ -30,10 +226,19 @@ const TState storageStatesList[STORAGE_STATES_MAX] = {
         [STORAGE_ST_READ_BOOT_SECTOR] =         {.name = STORAGE_ST_READ_BOOT_SECTOR},
         [STORAGE_ST_VERIFY_BOOT_SECTOR] =       {.name = STORAGE_ST_VERIFY_BOOT_SECTOR, .onExit = (TStateHook) STORAGE_CLearPageBuffer},
         [STORAGE_ST_WRITE_BOOT_SECTOR] =        {.name = STORAGE_ST_WRITE_BOOT_SECTOR},
+        [STORAGE_ST_SEEK_CHECKPOINT] =          {.name = STORAGE_ST_SEEK_CHECKPOINT},
+        [STORAGE_ST_SEEK_TAIL_SECTOR] =         {.name = STORAGE_ST_SEEK_TAIL_SECTOR},
         [STORAGE_ST_SEEK_LAST_NONEMPTY_PAGE] =  {.name = STORAGE_ST_SEEK_LAST_NONEMPTY_PAGE, .onEnter = (TStateHook) STORAGE_CLearPageBuffer, .onExit = (TStateHook) STORAGE_CLearPageBuffer},
-        [STORAGE_ST_IDLE] =                     {.name = STORAGE_ST_IDLE, .onEnter = (TStateHook) STORAGE_CLearPageBuffer},
-        [STORAGE_ST_STORE_DATA_IN_TAIL] =       {.name = STORAGE_ST_STORE_DATA_IN_TAIL, .onEnter = (TStateHook) STORAGE_CLearPageBuffer},
-        [STORAGE_ST_STORE_DATA] =               {.name = STORAGE_ST_STORE_DATA, .onExit = (TStateHook) STORAGE_CLearPageBuffer},
+        [STORAGE_ST_IDLE] =                     {.name = STORAGE_ST_IDLE},
+        [STORAGE_ST_LOAD_TAIL_PAGE] =           {.name = STORAGE_ST_LOAD_TAIL_PAGE, .onEnter = (TStateHook) STORAGE_CLearPageBuffer},
+        [STORAGE_ST_FLUSH] =                    {.name = STORAGE_ST_FLUSH},
+        [STORAGE_ST_ERASE_CHECKPOINT] =         {.name = STORAGE_ST_ERASE_CHECKPOINT},
+        [STORAGE_ST_WRITE_CHECKPOINT] =         {.name = STORAGE_ST_WRITE_CHECKPOINT},
+        [STORAGE_ST_ERASE_AHEAD] =              {.name = STORAGE_ST_ERASE_AHEAD},
+        [STORAGE_ST_ERASE_INDEX] =              {.name = STORAGE_ST_ERASE_INDEX},
+        [STORAGE_ST_WRITE_INDEX] =              {.name = STORAGE_ST_WRITE_INDEX},
+        [STORAGE_ST_VERIFY_LOG] =               {.name = STORAGE_ST_VERIFY_LOG},
+        [STORAGE_ST_STREAM_READ] =              {.name = STORAGE_ST_STREAM_READ},
         [STORAGE_ST_ERROR] =                    {.name = STORAGE_ST_ERROR}
 };
 
@@ -41,12 +246,21 @@ const TState storageStatesList[STORAGE_STATES_MAX] = {
 const TEventHandler storageTransitionTable[STORAGE_STATES_MAX][STORAGE_SIG_MAX] = {
         [STORAGE_ST_INIT]=                      {[STORAGE_CHECK_MEMORY_BOOT_SECTOR] = _readMemoryBootSector, [STORAGE_ERROR]=_error},
         [STORAGE_ST_READ_BOOT_SECTOR]=          {[STORAGE_TRANSFER_SUCCESS]=_verifyMemoryBootSector, [STORAGE_TRANSFER_FAIL]=_error, [STORAGE_ERROR]=_error},
-        [STORAGE_ST_VERIFY_BOOT_SECTOR]=        {[STORAGE_VERIFY_MEMORY_BOOT_SECTOR_SUCCESS]=_seekLastLogsNonEmptyPage, [STORAGE_WRITE_MEMORY_BOOT_SECTOR]=_writeMemoryBootSector, [STORAGE_ERROR]=_error},
-        [STORAGE_ST_WRITE_BOOT_SECTOR]=         {[STORAGE_TRANSFER_SUCCESS]=_seekLastLogsNonEmptyPage /* TODO check whether STORAGE_TRANSFER_SUCCESS occurs after all 10 blocks or after each*/, [STORAGE_TRANSFER_FAIL]=_error, [STORAGE_ERROR]=_error},
-        [STORAGE_ST_SEEK_LAST_NONEMPTY_PAGE]=   {[STORAGE_TRANSFER_SUCCESS]=_seekLastLogsNonEmptyPage, [STORAGE_TRANSFER_FAIL]=_error, [STORAGE_FIND_LAST_NON_EMPTY_PAGE_SUCCESS]=_idle, [STORAGE_ERROR]=_error},
-        [STORAGE_ST_IDLE]=                      {[STORAGE_STORE_DATA_IN_TAIL]=_storeDataInTail, [STORAGE_ERROR]=_error},
-        [STORAGE_ST_STORE_DATA_IN_TAIL]=        {[STORAGE_TRANSFER_SUCCESS]=_storeData, [STORAGE_TRANSFER_FAIL]=_error, [STORAGE_ERROR]=_error},
-        [STORAGE_ST_STORE_DATA]=                {[STORAGE_TRANSFER_SUCCESS]=_idle, [STORAGE_TRANSFER_FAIL]=_error, [STORAGE_STORE_DATA_IN_TAIL]=_storeDataInTail, [STORAGE_ERROR]=_error},
+        [STORAGE_ST_VERIFY_BOOT_SECTOR]=        {[STORAGE_VERIFY_MEMORY_BOOT_SECTOR_SUCCESS]=_seekCheckpoint, [STORAGE_WRITE_MEMORY_BOOT_SECTOR]=_writeMemoryBootSector, [STORAGE_ERROR]=_error},
+        [STORAGE_ST_WRITE_BOOT_SECTOR]=         {[STORAGE_TRANSFER_SUCCESS]=_seekCheckpoint /* TODO check whether STORAGE_TRANSFER_SUCCESS occurs after all 10 blocks or after each*/, [STORAGE_TRANSFER_FAIL]=_error, [STORAGE_ERROR]=_error},
+        [STORAGE_ST_SEEK_CHECKPOINT]=           {[STORAGE_TRANSFER_SUCCESS]=_bisectCheckpoint, [STORAGE_TRANSFER_FAIL]=_error, [STORAGE_FIND_LAST_NON_EMPTY_PAGE]=_seekTailSector, [STORAGE_FIND_LAST_NON_EMPTY_PAGE_SUCCESS]=_tailFound, [STORAGE_ERROR]=_error},
+        [STORAGE_ST_SEEK_TAIL_SECTOR]=          {[STORAGE_TRANSFER_SUCCESS]=_bisectTailSector, [STORAGE_TRANSFER_FAIL]=_error, [STORAGE_FIND_LAST_NON_EMPTY_PAGE_SUCCESS]=_tailFound, [STORAGE_ERROR]=_error},
+        [STORAGE_ST_SEEK_LAST_NONEMPTY_PAGE]=   {[STORAGE_TRANSFER_SUCCESS]=_bisectLogsTail, [STORAGE_TRANSFER_FAIL]=_error, [STORAGE_FIND_LAST_NON_EMPTY_PAGE_SUCCESS]=_tailFound, [STORAGE_ERROR]=_error},
+        [STORAGE_ST_IDLE]=                      {[STORAGE_STORE_DATA_IN_TAIL]=_storeDataInTail, [STORAGE_FLUSH]=_flush, [STORAGE_VERIFY_LOG]=_verifyLog, [STORAGE_STREAM_OPEN]=_streamOpen, [STORAGE_STREAM_RELEASE]=_streamRelease, [STORAGE_STREAM_CLOSE]=_streamClose, [STORAGE_ERROR]=_error},
+        [STORAGE_ST_LOAD_TAIL_PAGE]=            {[STORAGE_TRANSFER_SUCCESS]=_loadTailPage, [STORAGE_TRANSFER_FAIL]=_error, [STORAGE_STORE_DATA_IN_TAIL]=_storeDataWhileBusy, [STORAGE_FLUSH]=_flushWhileBusy, [STORAGE_STREAM_OPEN]=_streamOpen, [STORAGE_STREAM_RELEASE]=_streamRelease, [STORAGE_STREAM_CLOSE]=_streamClose, [STORAGE_ERROR]=_error},
+        [STORAGE_ST_FLUSH]=                     {[STORAGE_TRANSFER_SUCCESS]=_flushComplete, [STORAGE_TRANSFER_FAIL]=_error, [STORAGE_STORE_DATA_IN_TAIL]=_storeDataWhileBusy, [STORAGE_FLUSH]=_flushWhileBusy, [STORAGE_STREAM_OPEN]=_streamOpen, [STORAGE_STREAM_RELEASE]=_streamRelease, [STORAGE_STREAM_CLOSE]=_streamClose, [STORAGE_ERROR]=_error},
+        [STORAGE_ST_ERASE_CHECKPOINT]=          {[STORAGE_TRANSFER_SUCCESS]=_writeCheckpoint, [STORAGE_TRANSFER_FAIL]=_error, [STORAGE_STORE_DATA_IN_TAIL]=_storeDataWhileBusy, [STORAGE_FLUSH]=_flushWhileBusy, [STORAGE_STREAM_OPEN]=_streamOpen, [STORAGE_STREAM_RELEASE]=_streamRelease, [STORAGE_STREAM_CLOSE]=_streamClose, [STORAGE_ERROR]=_error},
+        [STORAGE_ST_WRITE_CHECKPOINT]=          {[STORAGE_TRANSFER_SUCCESS]=_writeIndexBatch, [STORAGE_TRANSFER_FAIL]=_error, [STORAGE_STORE_DATA_IN_TAIL]=_storeDataWhileBusy, [STORAGE_FLUSH]=_flushWhileBusy, [STORAGE_STREAM_OPEN]=_streamOpen, [STORAGE_STREAM_RELEASE]=_streamRelease, [STORAGE_STREAM_CLOSE]=_streamClose, [STORAGE_ERROR]=_error},
+        [STORAGE_ST_ERASE_AHEAD]=               {[STORAGE_TRANSFER_SUCCESS]=_eraseAheadComplete, [STORAGE_TRANSFER_FAIL]=_error, [STORAGE_STORE_DATA_IN_TAIL]=_storeDataWhileBusy, [STORAGE_FLUSH]=_flushWhileBusy, [STORAGE_STREAM_OPEN]=_streamOpen, [STORAGE_STREAM_RELEASE]=_streamRelease, [STORAGE_STREAM_CLOSE]=_streamClose, [STORAGE_ERROR]=_error},
+        [STORAGE_ST_ERASE_INDEX]=               {[STORAGE_TRANSFER_SUCCESS]=_writeCheckpoint, [STORAGE_TRANSFER_FAIL]=_error, [STORAGE_STORE_DATA_IN_TAIL]=_storeDataWhileBusy, [STORAGE_FLUSH]=_flushWhileBusy, [STORAGE_STREAM_OPEN]=_streamOpen, [STORAGE_STREAM_RELEASE]=_streamRelease, [STORAGE_STREAM_CLOSE]=_streamClose, [STORAGE_ERROR]=_error},
+        [STORAGE_ST_WRITE_INDEX]=               {[STORAGE_TRANSFER_SUCCESS]=_indexBatchWritten, [STORAGE_TRANSFER_FAIL]=_error, [STORAGE_STORE_DATA_IN_TAIL]=_storeDataWhileBusy, [STORAGE_FLUSH]=_flushWhileBusy, [STORAGE_STREAM_OPEN]=_streamOpen, [STORAGE_STREAM_RELEASE]=_streamRelease, [STORAGE_STREAM_CLOSE]=_streamClose, [STORAGE_ERROR]=_error},
+        [STORAGE_ST_VERIFY_LOG]=                {[STORAGE_TRANSFER_SUCCESS]=_verifyLogPage, [STORAGE_TRANSFER_FAIL]=_error, [STORAGE_STORE_DATA_IN_TAIL]=_storeDataWhileBusy, [STORAGE_FLUSH]=_flushWhileBusy, [STORAGE_STREAM_OPEN]=_streamOpen, [STORAGE_STREAM_RELEASE]=_streamRelease, [STORAGE_STREAM_CLOSE]=_streamClose, [STORAGE_ERROR]=_error},
+        [STORAGE_ST_STREAM_READ]=               {[STORAGE_TRANSFER_SUCCESS]=_streamChunkRead, [STORAGE_TRANSFER_FAIL]=_error, [STORAGE_STORE_DATA_IN_TAIL]=_storeDataWhileBusy, [STORAGE_FLUSH]=_flushWhileBusy, [STORAGE_STREAM_OPEN]=_streamOpen, [STORAGE_STREAM_RELEASE]=_streamRelease, [STORAGE_STREAM_CLOSE]=_streamClose, [STORAGE_ERROR]=_error},
         [STORAGE_ST_ERROR]=                     {[STORAGE_ERROR]=_error},
 };
 
@@ -54,8 +268,37 @@ static const TState *_error(TActiveObject *const AO, TEvent event) {
     return &(storageStatesList[STORAGE_ST_ERROR]);
 };
 
+/**
+ * @brief Go idle, flush latched while busy, erase sector after the tail one or read next stream chunk first if needed
+ * @details Sector is erased ahead as soon as tail enters the previous one, so appends never wait for sector erase.
+ * Erase goes first, so tail never reaches the sector being erased while stream keeps flash busy.
+ * Latched flush goes before both, it may come from brown-out warning.
+ */
 static const TState *_idle(TActiveObject *const AO, TEvent event) {
-    return &(storageStatesList[STORAGE_ST_IDLE]);
+    TSTORAGEActiveObject *storageAO = (TSTORAGEActiveObject *) AO;
+
+    if (storageAO->flash.isFlushPending) return _flush(AO, event);
+
+    if (!storageAO->flash.isEraseAheadPending) {
+        if (!_isStreamReadPending(storageAO)) return &(storageStatesList[STORAGE_ST_IDLE]);
+
+        _readStreamChunk(storageAO);
+
+        return &(storageStatesList[STORAGE_ST_STREAM_READ]);
+    }
+
+    /** @note erase block is 4096 bytes */
+    DRV_MEMORY_AsyncErase(
+            storageAO->drvMemoryHandle,
+            &(storageAO->transferHandle),
+            LOG_SECTOR_ADDRESS((storageAO->flash.sequence + 1) % LOG_SECTORS_MAX) / DRV_AT25DF_ERASE_BUFFER_SIZE,
+            1
+    );
+
+    _dispatchErrorOnInvalidTransfer(storageAO);
+    METRICS_INC(flashTransactions);
+
+    return &(storageStatesList[STORAGE_ST_ERASE_AHEAD]);
 };
 
 static const TState *_readMemoryBootSector(TActiveObject *const AO, TEvent event) {
@@ -72,6 +315,8 @@ static const TState *_readMemoryBootSector(TActiveObject *const AO, TEvent event
     );
 
     _dispatchErrorOnInvalidTransfer(storageAO);
+    METRICS_INC(flashTransactions);
+    METRICS_ADD(flashBytesRead, BOOT_SECTOR_PAGES_TO_VALIDATE * DRV_AT25DF_PAGE_SIZE);
 
     return &(storageStatesList[STORAGE_ST_READ_BOOT_SECTOR]);
 };
@@ -81,9 +326,9 @@ static const TState *_verifyMemoryBootSector(TActiveObject *const AO, TEvent eve
 
     if (IS_EQUAL_PAGES ==
         memcmp(storageAO->pageBuffer, (FATBootSectorImage + PARTITION_0_ADDRESS), DRV_AT25DF_PAGE_SIZE)) {
-        ActiveObject_Dispatch(&(storageAO->super), (TEvent) {.sig = STORAGE_VERIFY_MEMORY_BOOT_SECTOR_SUCCESS});
+        SCHEDULER_Dispatch(&(storageAO->super), (TEvent) {.sig = STORAGE_VERIFY_MEMORY_BOOT_SECTOR_SUCCESS});
     } else {
-        ActiveObject_Dispatch(&(storageAO->super), (TEvent) {.sig = STORAGE_WRITE_MEMORY_BOOT_SECTOR});
+        SCHEDULER_Dispatch(&(storageAO->super), (TEvent) {.sig = STORAGE_WRITE_MEMORY_BOOT_SECTOR});
     }
 
     return &(storageStatesList[STORAGE_ST_VERIFY_BOOT_SECTOR]);
@@ -102,94 +347,657 @@ static const TState *_writeMemoryBootSector(TActiveObject *const AO, TEvent even
     );
 
     _dispatchErrorOnInvalidTransfer(storageAO);
-
-    // set current page to next after boot sector
-    storageAO->flash.currentPage = DRV_MEMORY_BOOT_SECTOR_SIZE_PAGES;
+    METRICS_INC(flashTransactions);
+    METRICS_ADD(flashBytesWritten, DRV_MEMORY_BOOT_SECTOR_SIZE_PAGES * DRV_AT25DF_PAGE_SIZE);
 
     return &(storageStatesList[STORAGE_ST_WRITE_BOOT_SECTOR]);
 }
 
-static const TState *_seekLastLogsNonEmptyPage(TActiveObject *const AO, TEvent event) {
+/**
+ * @brief Start search of the last write cursor checkpoint
+ * @details Journal slots are appended in order, so written slots are followed by erased ones and can be bisected too.
+ */
+static const TState *_seekCheckpoint(TActiveObject *const AO, TEvent event) {
     TSTORAGEActiveObject *storageAO = (TSTORAGEActiveObject *) AO;
 
-    DRV_MEMORY_AsyncRead(
-            storageAO->drvMemoryHandle,
-            &(storageAO->transferHandle),
-            storageAO->pageBuffer,
-            (storageAO->flash.currentPage * DRV_AT25DF_PAGE_SIZE) +
-            BOOT_SECTOR_SIZE, // offset from boot sector check page by page
-            READ_BLOCKS_IN_PAGE
-    );
+    storageAO->flash.seekLow = 0;
+    storageAO->flash.seekHigh = CHECKPOINT_SLOTS_MAX;
+    storageAO->flash.writeAddress = LOG_DATA_START_ADDRESS;
+
+    _probeFlash(storageAO, CHECKPOINT_SLOT_ADDRESS(_seekMiddle(storageAO)), sizeof(TStorageCheckpoint));
+
+    return &(storageStatesList[STORAGE_ST_SEEK_CHECKPOINT]);
+}
+
+/**
+ * @brief Narrow checkpoint search range by the probed slot, probe next one or finish
+ * @details Last written slot is the last non-erased probe, so its content is kept on the way instead of reading it again.
+ * Resumes from the checkpoint if it is valid, otherwise falls back to log tail search.
+ */
+static const TState *_bisectCheckpoint(TActiveObject *const AO, TEvent event) {
+    TSTORAGEActiveObject *storageAO = (TSTORAGEActiveObject *) AO;
+    const uint32_t probedSlot = storageAO->flash.seekProbe;
 
-    // if storageAO.pageBuffer empty - inspected page is suitable for new data, if not, then increment storageAO.page and repeat
-    if (IS_EQUAL_PAGES == memcmp(storageAO->pageBuffer, (void *) ERASED_PAGE_PATTERN, DRV_AT25DF_PAGE_SIZE)) {
-        ActiveObject_Dispatch(&(storageAO->super), (TEvent) {.sig = STORAGE_FIND_LAST_NON_EMPTY_PAGE_SUCCESS});
+    if (_isErased(storageAO->pageBuffer, sizeof(TStorageCheckpoint))) {
+        storageAO->flash.seekHigh = probedSlot;
     } else {
-        storageAO->flash.currentPage++;
-        ActiveObject_Dispatch(&(storageAO->super), (TEvent) {.sig = STORAGE_FIND_LAST_NON_EMPTY_PAGE});
+        TStorageCheckpoint checkpoint;
+        memcpy(&checkpoint, storageAO->pageBuffer, sizeof(TStorageCheckpoint));
+
+        const bool isValidCheckpoint = (checkpoint.crc == STORAGE_CRC16_Update(STORAGE_CRC16_INIT, (const uint8_t *) &checkpoint,
+                                                                               offsetof(TStorageCheckpoint, crc))) &&
+                                       (checkpoint.writeAddress >= LOG_DATA_START_ADDRESS) &&
+                                       (checkpoint.writeAddress < LOG_DATA_END_ADDRESS);
+
+        storageAO->flash.writeAddress = isValidCheckpoint ? checkpoint.writeAddress : 0;
+        storageAO->flash.sequence = checkpoint.sequence;
+
+        if (isValidCheckpoint) {
+            storageAO->summary = checkpoint.summary;
+            STORAGE_INDEX_Reset(&(storageAO->index), checkpoint.indexPosition);
+        } else {
+            STORAGE_SUMMARY_Reset(&(storageAO->summary));
+            STORAGE_INDEX_Reset(&(storageAO->index), 0);
+        }
+        storageAO->flash.seekLow = probedSlot + 1;
     }
 
+    if (storageAO->flash.seekLow < storageAO->flash.seekHigh) {
+        _probeFlash(storageAO, CHECKPOINT_SLOT_ADDRESS(_seekMiddle(storageAO)), sizeof(TStorageCheckpoint));
+
+        return &(storageStatesList[STORAGE_ST_SEEK_CHECKPOINT]);
+    }
+
+    storageAO->flash.checkpointSlot = storageAO->flash.seekHigh;
+    // previous run might be stopped before sector after the tail one was erased
+    storageAO->flash.isEraseAheadPending = true;
+
+    // empty journal or torn last slot, find log tail by flash content
+    if ((0 == storageAO->flash.checkpointSlot) || (0 == storageAO->flash.writeAddress)) {
+        SCHEDULER_Dispatch(&(storageAO->super), (TEvent) {.sig = STORAGE_FIND_LAST_NON_EMPTY_PAGE});
+    } else {
+        SCHEDULER_Dispatch(&(storageAO->super), (TEvent) {.sig = STORAGE_FIND_LAST_NON_EMPTY_PAGE_SUCCESS});
+    }
+
+    return &(storageStatesList[STORAGE_ST_SEEK_CHECKPOINT]);
+}
+
+/**
+ * @brief Start search of the log tail
+ * @details Sector with sequence N is N-th in the ring, so sectors of the current lap are followed by erased sector and previous lap ones.
+ * Binary search over sectors and then over pages of the tail sector takes
+ * log2(LOG_SECTORS_MAX) + log2(LOG_PAGES_IN_SECTOR) probes (15 for 8MB flash) instead of a page by page scan.
+ */
+static const TState *_seekTailSector(TActiveObject *const AO, TEvent event) {
+    TSTORAGEActiveObject *storageAO = (TSTORAGEActiveObject *) AO;
+
+    storageAO->flash.seekLow = 0;
+    storageAO->flash.seekHigh = LOG_SECTORS_MAX;
+    storageAO->flash.seekProbe = 0; // 1st sector sequence tells the current lap
+
+    _probeFlash(storageAO, LOG_SECTOR_ADDRESS(0), sizeof(TStorageSectorHeader));
+
+    return &(storageStatesList[STORAGE_ST_SEEK_TAIL_SECTOR]);
+}
+
+// continue tail search with pages of the tail sector, its 1st page has header so it is written
+static inline const TState *_seekTailPage(TSTORAGEActiveObject *const storageAO, uint32_t tailSector) {
+    storageAO->flash.seekLow = tailSector * LOG_PAGES_IN_SECTOR + 1;
+    storageAO->flash.seekHigh = (tailSector + 1) * LOG_PAGES_IN_SECTOR;
+
+    _probeFlash(storageAO, LOG_PAGE_ADDRESS(_seekMiddle(storageAO)), LOG_PAGE_PROBE_SIZE);
+
+    return &(storageStatesList[STORAGE_ST_SEEK_LAST_NONEMPTY_PAGE]);
+};
+
+/** @brief Narrow tail search range by the probed sector header, probe next one or continue with pages of the tail sector */
+static const TState *_bisectTailSector(TActiveObject *const AO, TEvent event) {
+    TSTORAGEActiveObject *storageAO = (TSTORAGEActiveObject *) AO;
+    const uint32_t probedSector = storageAO->flash.seekProbe;
+
+    TStorageSectorHeader header;
+    memcpy(&header, storageAO->pageBuffer, sizeof(TStorageSectorHeader));
+    const bool isValidHeader = (header.sequence == ~header.sequenceInverted);
+
+    // empty search range marks probe of the last sector, done when the 1st one has no header
+    if (storageAO->flash.seekLow == storageAO->flash.seekHigh) {
+        if (isValidHeader) {
+            storageAO->flash.sequence = header.sequence;
+            return _seekTailPage(storageAO, LOG_SECTORS_MAX - 1);
+        }
+
+        // empty log, start from the 1st sector
+        storageAO->flash.sequence = 0;
+        storageAO->flash.writeAddress = LOG_DATA_START_ADDRESS;
+        SCHEDULER_Dispatch(&(storageAO->super), (TEvent) {.sig = STORAGE_FIND_LAST_NON_EMPTY_PAGE_SUCCESS});
+
+        return &(storageStatesList[STORAGE_ST_SEEK_TAIL_SECTOR]);
+    }
+
+    if (0 == probedSector) {
+        // 1st sector is erased ahead when the last one is the tail, or log is empty
+        if (!isValidHeader) {
+            storageAO->flash.seekLow = LOG_SECTORS_MAX;
+            storageAO->flash.seekHigh = LOG_SECTORS_MAX;
+            storageAO->flash.seekProbe = LOG_SECTORS_MAX - 1;
+            _probeFlash(storageAO, LOG_SECTOR_ADDRESS(LOG_SECTORS_MAX - 1), sizeof(TStorageSectorHeader));
+
+            return &(storageStatesList[STORAGE_ST_SEEK_TAIL_SECTOR]);
+        }
+
+        storageAO->flash.sequence = header.sequence;
+    }
+
+    if (isValidHeader && (header.sequence == storageAO->flash.sequence + probedSector)) {
+        storageAO->flash.seekLow = probedSector + 1;
+    } else {
+        storageAO->flash.seekHigh = probedSector;
+    }
+
+    if (storageAO->flash.seekLow < storageAO->flash.seekHigh) {
+        _probeFlash(storageAO, LOG_SECTOR_ADDRESS(_seekMiddle(storageAO)), sizeof(TStorageSectorHeader));
+
+        return &(storageStatesList[STORAGE_ST_SEEK_TAIL_SECTOR]);
+    }
+
+    // 1st sector is of the current lap, so the tail one is found
+    const uint32_t tailSector = storageAO->flash.seekLow - 1;
+    storageAO->flash.sequence += tailSector;
+
+    return _seekTailPage(storageAO, tailSector);
+}
+
+/** @brief Narrow tail search range by the probed page, probe next one or finish */
+static const TState *_bisectLogsTail(TActiveObject *const AO, TEvent event) {
+    TSTORAGEActiveObject *storageAO = (TSTORAGEActiveObject *) AO;
+    const uint32_t probedPage = storageAO->flash.seekProbe;
+
+    if (_isErased(storageAO->pageBuffer, LOG_PAGE_PROBE_SIZE)) {
+        storageAO->flash.seekHigh = probedPage;
+    } else {
+        storageAO->flash.seekLow = probedPage + 1;
+    }
+
+    if (storageAO->flash.seekLow < storageAO->flash.seekHigh) {
+        _probeFlash(storageAO, LOG_PAGE_ADDRESS(_seekMiddle(storageAO)), LOG_PAGE_PROBE_SIZE);
+
+        return &(storageStatesList[STORAGE_ST_SEEK_LAST_NONEMPTY_PAGE]);
+    }
+
+    // last written page may still have free place, exact offset is resolved on first store
+    storageAO->flash.writeAddress = LOG_PAGE_ADDRESS(storageAO->flash.seekHigh - 1);
+    SCHEDULER_Dispatch(&(storageAO->super), (TEvent) {.sig = STORAGE_FIND_LAST_NON_EMPTY_PAGE_SUCCESS});
+
     return &(storageStatesList[STORAGE_ST_SEEK_LAST_NONEMPTY_PAGE]);
 }
 
+/** @brief Log tail is found on boot, verify the log if configured */
+static const TState *_tailFound(TActiveObject *const AO, TEvent event) {
+#if STORAGE_VERIFY_LOG_ON_BOOT
+    return _verifyLog(AO, event);
+#else
+    return _idle(AO, event);
+#endif
+}
+
+/**
+ * @brief Store record to the log tail
+ * @details Records are combined in RAM tail page and written to flash on page fill, flush timeout or STORAGE_FLUSH.
+ * Tail page is read from flash only once after boot, as resumed page may be partially written.
+ */
 static const TState *_storeDataInTail(TActiveObject *const AO, TEvent event) {
     TSTORAGEActiveObject *storageAO = (TSTORAGEActiveObject *) AO;
 
-    // read current page
-    DRV_MEMORY_AsyncRead(
+    if (sizeof(TSensorsStorageData) != event.size) return _idle(AO, event);
+
+    storageAO->dataToStore = event.payload;
+
+    return _appendPendingData(AO, event);
+}
+
+static const TState *_loadTailPage(TActiveObject *const AO, TEvent event) {
+    TSTORAGEActiveObject *storageAO = (TSTORAGEActiveObject *) AO;
+    const uint32_t pageAddress = PAGE_START_ADDRESS(storageAO->flash.writeAddress);
+
+    const uint32_t blockStart = (0 == LOG_SECTOR_OFFSET(pageAddress)) ? LOG_SECTOR_HEADER_SIZE : 0;
+    const uint32_t checkpointAddress = storageAO->flash.writeAddress; // page start if tail is found by search
+    uint32_t freePlaceInPageAddr = blockStart;
+    uint32_t sealedEnd = blockStart;
+    TSensorsStorageData sample;
+
+    // decode page block to find its end and restore encoder state, so new samples continue deltas
+    STORAGE_RECORD_Reset(&(storageAO->encoder));
+    size_t recordSize;
+    while (0 != (recordSize = STORAGE_RECORD_Decode(&(storageAO->encoder), storageAO->pageBuffer + freePlaceInPageAddr,
+                                                    DRV_AT25DF_PAGE_SIZE - freePlaceInPageAddr, &sample))) {
+        freePlaceInPageAddr += recordSize;
+        if (storageAO->encoder.isSealed) sealedEnd = freePlaceInPageAddr;
+    };
+
+    // sealed samples above checkpoint are accounted again, summary and index entries not checkpointed are restored
+    TStorageRecordCodec decoder;
+    STORAGE_RECORD_Reset(&decoder);
+    for (uint32_t offset = blockStart; offset < sealedEnd; offset += recordSize) {
+        recordSize = STORAGE_RECORD_Decode(&decoder, storageAO->pageBuffer + offset, sealedEnd - offset, &sample);
+        if (0 == recordSize) break;
+        if (!decoder.isSealed && (pageAddress + offset >= checkpointAddress)) _accountSample(storageAO, &sample, pageAddress + offset);
+    }
+
+    // zone samples before checkpoint are not known
+    if (checkpointAddress > pageAddress - LOG_SECTOR_OFFSET(pageAddress) + LOG_SECTOR_HEADER_SIZE)
+        STORAGE_INDEX_ResumeZone(&(storageAO->index));
+
+    // not erased after last record or records are not sealed, page is torn or of unknown format, skip it
+    if (((freePlaceInPageAddr < DRV_AT25DF_PAGE_SIZE) && (ERASED_PAGE_PATTERN != storageAO->pageBuffer[freePlaceInPageAddr])) ||
+        !storageAO->encoder.isSealed)
+        freePlaceInPageAddr = DRV_AT25DF_PAGE_SIZE;
+
+    storageAO->flash.tailPageAddress = pageAddress;
+    storageAO->flash.writeAddress = pageAddress + freePlaceInPageAddr;
+    storageAO->flash.flushAddress = storageAO->flash.writeAddress;
+    storageAO->flash.isTailPageLoaded = true;
+
+    // 1st page of sector starts with header, put it if sector is not started yet
+    if ((0 == LOG_SECTOR_OFFSET(pageAddress)) && _isErased(storageAO->pageBuffer, sizeof(TStorageSectorHeader))) {
+        _putSectorHeader(storageAO);
+        storageAO->flash.flushAddress = pageAddress;
+    }
+
+    return _appendPendingData(AO, event);
+}
+
+/** @brief Append pending record to tail page, load tail page first if needed, flush page once it is full */
+static const TState *_appendPendingData(TActiveObject *const AO, TEvent event) {
+    TSTORAGEActiveObject *storageAO = (TSTORAGEActiveObject *) AO;
+
+    if ((NULL != storageAO->dataToStore) && !storageAO->flash.isTailPageLoaded) {
+        // read current page
+        DRV_MEMORY_AsyncRead(
+                storageAO->drvMemoryHandle,
+                &(storageAO->transferHandle),
+                storageAO->pageBuffer,
+                PAGE_START_ADDRESS(storageAO->flash.writeAddress),
+                READ_BLOCKS_IN_PAGE
+        );
+
+        _dispatchErrorOnInvalidTransfer(storageAO);
+        METRICS_INC(flashTransactions);
+        METRICS_ADD(flashBytesRead, DRV_AT25DF_PAGE_SIZE);
+
+        return &(storageStatesList[STORAGE_ST_LOAD_TAIL_PAGE]);
+    }
+
+    if ((NULL != storageAO->dataToStore) && _appendToTailPage(storageAO, storageAO->dataToStore)) {
+        STORAGE_ReleaseRecord(storageAO, storageAO->dataToStore);
+        storageAO->dataToStore = NULL;
+    }
+
+    // record which does not fit stays pending till next page
+    if (_isTailPageFull(storageAO) || (NULL != storageAO->dataToStore)) return _flush(AO, event);
+
+    return _idle(AO, event);
+}
+
+/**
+ * @brief Keep combining records while flash is busy with flush or checkpoint
+ * @details Page buffer is not used by these transfers. Record which does not fit (or tail page is not loaded yet)
+ * is kept pending, only if there is no other pending one, otherwise it is dropped.
+ */
+static const TState *_storeDataWhileBusy(TActiveObject *const AO, TEvent event) {
+    TSTORAGEActiveObject *storageAO = (TSTORAGEActiveObject *) AO;
+
+    if (sizeof(TSensorsStorageData) != event.size) return AO->state;
+
+    if ((NULL == storageAO->dataToStore) &&
+        !(storageAO->flash.isTailPageLoaded && _appendToTailPage(storageAO, event.payload))) {
+        storageAO->dataToStore = event.payload;
+    }
+
+    return AO->state;
+}
+
+/**
+ * @brief Latch flush requested while flash is busy, it is done once the state machine gets idle
+ * @details Flush comes from flush timeout, which is not re-armed, or from brown-out warning, so it should never be dropped.
+ */
+static const TState *_flushWhileBusy(TActiveObject *const AO, TEvent event) {
+    TSTORAGEActiveObject *storageAO = (TSTORAGEActiveObject *) AO;
+
+    storageAO->flash.isFlushPending = true;
+
+    return AO->state;
+}
+
+/**
+ * @brief Write tail page snapshot to flash, if it has records not written yet
+ * @details Records are sealed with CRC before each write, so records torn by power loss during programming are detected
+ */
+static const TState *_flush(TActiveObject *const AO, TEvent event) {
+    TSTORAGEActiveObject *storageAO = (TSTORAGEActiveObject *) AO;
+
+    _cancelFlushTimeout(storageAO);
+    storageAO->flash.isFlushPending = false;
+
+    if (!storageAO->flash.isTailPageLoaded) return _flushComplete(AO, event);
+
+    // encoder always keeps place for the seal
+    const uint32_t offset = storageAO->flash.writeAddress - storageAO->flash.tailPageAddress;
+    storageAO->flash.writeAddress += STORAGE_RECORD_Seal(&(storageAO->encoder), storageAO->pageBuffer + offset,
+                                                         DRV_AT25DF_PAGE_SIZE - offset);
+
+    if (storageAO->flash.writeAddress <= storageAO->flash.flushAddress) return _flushComplete(AO, event);
+
+    memcpy(storageAO->flushBuffer, storageAO->pageBuffer, DRV_AT25DF_PAGE_SIZE);
+
+    // NOR programming of already written bytes with same value keeps them, so whole page is written
+    DRV_MEMORY_AsyncWrite(
             storageAO->drvMemoryHandle,
             &(storageAO->transferHandle),
-            storageAO->pageBuffer,
-            (storageAO->flash.currentPage * DRV_AT25DF_PAGE_SIZE),
-            READ_BLOCKS_IN_PAGE
-    );
+            storageAO->flushBuffer,
+            storageAO->flash.tailPageAddress / DRV_AT25DF_PAGE_SIZE, // write block is a page
+            WRITE_BLOCKS_IN_PAGE);
 
     _dispatchErrorOnInvalidTransfer(storageAO);
+    METRICS_INC(flashTransactions);
+    METRICS_ADD(flashBytesWritten, DRV_AT25DF_PAGE_SIZE);
 
-    storageAO->dataToStore = event.payload;
-    storageAO->dataToStoreSize = event.size;
+    storageAO->flash.flushAddress = storageAO->flash.writeAddress;
 
-    return &(storageStatesList[STORAGE_ST_STORE_DATA_IN_TAIL]);
+    return &(storageStatesList[STORAGE_ST_FLUSH]);
 }
 
-static const TState *_storeData(TActiveObject *const AO, TEvent event) {
+/** @brief Move to next page once full tail page is written, records appended during flush are written first */
+static const TState *_flushComplete(TActiveObject *const AO, TEvent event) {
     TSTORAGEActiveObject *storageAO = (TSTORAGEActiveObject *) AO;
 
-    uint8_t freePlaceInPageAddr = 0;
+    const bool isTailPageComplete = storageAO->flash.isTailPageLoaded &&
+                                    (_isTailPageFull(storageAO) || (NULL != storageAO->dataToStore));
 
-    // find free place in page (should be equal to data size)
-    while (freePlaceInPageAddr < END_OF_PAGE_ADDRESS) {
-        if (IS_ENOUGH_PLACE_TO_STORE ==
-            memcmp(storageAO->pageBuffer + freePlaceInPageAddr, (void *) ERASED_PAGE_PATTERN,
-                   storageAO->dataToStoreSize))
-            break;
-        freePlaceInPageAddr += storageAO->dataToStoreSize; // offset is same as data size
-    };
+    // index entries closed since the last checkpoint get to flash with flushed records
+    if (!isTailPageComplete) return (0 != storageAO->index.pending) ? _checkpoint(AO, event) : _idle(AO, event);
 
-    if (freePlaceInPageAddr >= END_OF_PAGE_ADDRESS) {
-        // no free place in page, increment page and repeat
-        storageAO->flash.currentPage++;
-        ActiveObject_Dispatch(&(storageAO->super), (TEvent) {
-                .sig = STORAGE_STORE_DATA_IN_TAIL,
-                .payload = storageAO->dataToStore,
-                .size = storageAO->dataToStoreSize
-        });
+    if (storageAO->flash.writeAddress > storageAO->flash.flushAddress) return _flush(AO, event);
+
+    const uint32_t tailSectorAddress = storageAO->flash.tailPageAddress - LOG_SECTOR_OFFSET(storageAO->flash.tailPageAddress);
+    uint32_t nextPageAddress = storageAO->flash.tailPageAddress + DRV_AT25DF_PAGE_SIZE;
+
+    // wrap around the ring, oldest sector is already erased ahead
+    if (nextPageAddress >= LOG_DATA_END_ADDRESS) nextPageAddress = LOG_DATA_START_ADDRESS;
+
+    storageAO->flash.tailPageAddress = nextPageAddress;
+    storageAO->flash.writeAddress = nextPageAddress;
+    storageAO->flash.flushAddress = nextPageAddress;
+    memset(storageAO->pageBuffer, ERASED_PAGE_PATTERN, DRV_AT25DF_PAGE_SIZE);
+    STORAGE_RECORD_Reset(&(storageAO->encoder)); // each page is independent block
+
+    if (0 == LOG_SECTOR_OFFSET(nextPageAddress)) {
+        STORAGE_INDEX_CloseZone(&(storageAO->index), LOG_POSITION(storageAO->flash.sequence, tailSectorAddress), LOG_SECTOR_SIZE);
+        storageAO->flash.sequence++;
+        _putSectorHeader(storageAO);
+        storageAO->flash.writeAddress += LOG_SECTOR_HEADER_SIZE;
+    }
 
-        return &(storageStatesList[STORAGE_ST_STORE_DATA]);
+    return _checkpoint(AO, event);
+}
+
+/**
+ * @brief Take pending index entries as a batch and checkpoint write cursor
+ * @details Index sector is erased when batch enters it, before the checkpoint with index cursor past the batch,
+ * so batch is always written to erased flash.
+ */
+static const TState *_checkpoint(TActiveObject *const AO, TEvent event) {
+    TSTORAGEActiveObject *storageAO = (TSTORAGEActiveObject *) AO;
+
+    if (!STORAGE_INDEX_TakeBatch(&(storageAO->index), DRV_AT25DF_PAGE_SIZE) ||
+        (0 != (storageAO->index.batchPosition % INDEX_SECTOR_SIZE)))
+        return _writeCheckpoint(AO, event);
+
+    /** @note erase block is 4096 bytes */
+    DRV_MEMORY_AsyncErase(
+            storageAO->drvMemoryHandle,
+            &(storageAO->transferHandle),
+            INDEX_ADDRESS(storageAO->index.batchPosition) / DRV_AT25DF_ERASE_BUFFER_SIZE,
+            1
+    );
+
+    _dispatchErrorOnInvalidTransfer(storageAO);
+    METRICS_INC(flashTransactions);
+
+    return &(storageStatesList[STORAGE_ST_ERASE_INDEX]);
+}
+
+/**
+ * @brief Append write cursor to checkpoint journal
+ * @details Slot is programmed with page write of 0xFF padded buffer, so other slots in page stay untouched.
+ * Flush buffer is used, as page buffer already accumulates records of the new tail page.
+ * Journal sector is erased once all slots are used, that is once per CHECKPOINT_SLOTS_MAX log pages
+ * (and flushes with index entries pending).
+ */
+static const TState *_writeCheckpoint(TActiveObject *const AO, TEvent event) {
+    TSTORAGEActiveObject *storageAO = (TSTORAGEActiveObject *) AO;
+
+    if (storageAO->flash.checkpointSlot >= CHECKPOINT_SLOTS_MAX) {
+        /** @note erase block is 4096 bytes */
+        DRV_MEMORY_AsyncErase(
+                storageAO->drvMemoryHandle,
+                &(storageAO->transferHandle),
+                CHECKPOINT_SECTOR_ADDRESS / DRV_AT25DF_ERASE_BUFFER_SIZE,
+                1
+        );
+
+        _dispatchErrorOnInvalidTransfer(storageAO);
+        METRICS_INC(flashTransactions);
+
+        storageAO->flash.checkpointSlot = 0;
+
+        return &(storageStatesList[STORAGE_ST_ERASE_CHECKPOINT]);
+    }
+
+    const uint32_t slotAddress = CHECKPOINT_SLOT_ADDRESS(storageAO->flash.checkpointSlot);
+    TStorageCheckpoint checkpoint = {
+            .writeAddress = storageAO->flash.writeAddress,
+            .sequence = storageAO->flash.sequence,
+            .indexPosition = storageAO->index.position,
+            .summary = storageAO->summary
     };
+    checkpoint.crc = STORAGE_CRC16_Update(STORAGE_CRC16_INIT, (const uint8_t *) &checkpoint, offsetof(TStorageCheckpoint, crc));
 
-    // append data to page buffer
-    memcpy(storageAO->pageBuffer + freePlaceInPageAddr, storageAO->dataToStore, storageAO->dataToStoreSize);
+    memset(storageAO->flushBuffer, ERASED_PAGE_PATTERN, DRV_AT25DF_PAGE_SIZE);
+    memcpy(storageAO->flushBuffer + PAGE_OFFSET(slotAddress), &checkpoint, sizeof(TStorageCheckpoint));
 
-    // write page buffer to flash
     DRV_MEMORY_AsyncWrite(
             storageAO->drvMemoryHandle,
             &(storageAO->transferHandle),
-            storageAO->pageBuffer,
-            (storageAO->flash.currentPage * DRV_AT25DF_PAGE_SIZE),
+            storageAO->flushBuffer,
+            slotAddress / DRV_AT25DF_PAGE_SIZE, // write block is a page
+            WRITE_BLOCKS_IN_PAGE);
+
+    _dispatchErrorOnInvalidTransfer(storageAO);
+    METRICS_INC(flashTransactions);
+    METRICS_ADD(flashBytesWritten, DRV_AT25DF_PAGE_SIZE);
+
+    storageAO->flash.checkpointSlot++;
+
+    return &(storageStatesList[STORAGE_ST_WRITE_CHECKPOINT]);
+}
+
+/** @brief Write index batch taken by checkpoint, batch is programmed with 0xFF padded page as checkpoint slot is */
+static const TState *_writeIndexBatch(TActiveObject *const AO, TEvent event) {
+    TSTORAGEActiveObject *storageAO = (TSTORAGEActiveObject *) AO;
+
+    if (0 == storageAO->index.batchSize) return _appendPendingData(AO, event);
+
+    const uint32_t batchAddress = INDEX_ADDRESS(storageAO->index.batchPosition);
+
+    memset(storageAO->flushBuffer, ERASED_PAGE_PATTERN, DRV_AT25DF_PAGE_SIZE);
+    memcpy(storageAO->flushBuffer + PAGE_OFFSET(batchAddress), storageAO->index.entries,
+           storageAO->index.batchSize * STORAGE_INDEX_ENTRY_SIZE);
+
+    DRV_MEMORY_AsyncWrite(
+            storageAO->drvMemoryHandle,
+            &(storageAO->transferHandle),
+            storageAO->flushBuffer,
+            batchAddress / DRV_AT25DF_PAGE_SIZE, // write block is a page
             WRITE_BLOCKS_IN_PAGE);
 
     _dispatchErrorOnInvalidTransfer(storageAO);
+    METRICS_INC(flashTransactions);
+    METRICS_ADD(flashBytesWritten, DRV_AT25DF_PAGE_SIZE);
+
+    return &(storageStatesList[STORAGE_ST_WRITE_INDEX]);
+}
+
+static const TState *_indexBatchWritten(TActiveObject *const AO, TEvent event) {
+    TSTORAGEActiveObject *storageAO = (TSTORAGEActiveObject *) AO;
+
+    STORAGE_INDEX_BatchWritten(&(storageAO->index));
+
+    return _appendPendingData(AO, event);
+}
+
+static const TState *_eraseAheadComplete(TActiveObject *const AO, TEvent event) {
+    TSTORAGEActiveObject *storageAO = (TSTORAGEActiveObject *) AO;
+
+    storageAO->flash.isEraseAheadPending = false;
+
+    // records combined while erasing
+    return _appendPendingData(AO, event);
+}
+
+/**
+ * @brief Start log integrity verification, from the oldest sector to the tail page
+ * @details Pages are read one by one to flush buffer, records are still combined in page buffer meanwhile.
+ * Flush timeout elapsed during verification is restarted once it is done.
+ */
+static const TState *_verifyLog(TActiveObject *const AO, TEvent event) {
+    TSTORAGEActiveObject *storageAO = (TSTORAGEActiveObject *) AO;
+
+    storageAO->verify.pageAddress = LOG_OLDEST_SECTOR_ADDRESS(storageAO->flash.sequence);
+    storageAO->verify.pagesChecked = 0;
+    storageAO->verify.pagesCorrupted = 0;
+
+    _readLogPage(storageAO, storageAO->verify.pageAddress);
+
+    return &(storageStatesList[STORAGE_ST_VERIFY_LOG]);
+}
+
+/** @brief Check CRC of the read page, read the next one or finish on the tail page */
+static const TState *_verifyLogPage(TActiveObject *const AO, TEvent event) {
+    TSTORAGEActiveObject *storageAO = (TSTORAGEActiveObject *) AO;
+    const uint32_t pageAddress = storageAO->verify.pageAddress;
+    const uint32_t tailPageAddress = storageAO->flash.isTailPageLoaded ? storageAO->flash.tailPageAddress
+                                                                       : PAGE_START_ADDRESS(storageAO->flash.writeAddress);
+
+    bool isValidPage;
+    if (0 == LOG_SECTOR_OFFSET(pageAddress)) {
+        TStorageSectorHeader header;
+        memcpy(&header, storageAO->flushBuffer, sizeof(TStorageSectorHeader));
+
+        isValidPage = ((header.sequence == ~header.sequenceInverted) || _isErased(storageAO->flushBuffer, DRV_AT25DF_PAGE_SIZE)) &&
+                      STORAGE_RECORD_IsValidBlock(storageAO->flushBuffer + LOG_SECTOR_HEADER_SIZE,
+                                                  DRV_AT25DF_PAGE_SIZE - LOG_SECTOR_HEADER_SIZE);
+    } else {
+        isValidPage = STORAGE_RECORD_IsValidBlock(storageAO->flushBuffer, DRV_AT25DF_PAGE_SIZE);
+    }
 
-    return &(storageStatesList[STORAGE_ST_STORE_DATA]);
-}
\ No newline at end of file
+    storageAO->verify.pagesChecked++;
+    if (!isValidPage) storageAO->verify.pagesCorrupted++;
+
+    if (pageAddress != tailPageAddress) {
+        storageAO->verify.pageAddress += DRV_AT25DF_PAGE_SIZE;
+        if (storageAO->verify.pageAddress >= LOG_DATA_END_ADDRESS) storageAO->verify.pageAddress = LOG_DATA_START_ADDRESS;
+
+        _readLogPage(storageAO, storageAO->verify.pageAddress);
+
+        return &(storageStatesList[STORAGE_ST_VERIFY_LOG]);
+    }
+
+    storageAO->verify.report = (TStorageVerifyReport) {
+            .runs = storageAO->verify.report.runs + 1,
+            .pagesChecked = storageAO->verify.pagesChecked,
+            .pagesCorrupted = storageAO->verify.pagesCorrupted
+    };
+    SYS_DEBUG_PRINT(SYS_ERROR_INFO, "STORAGE verify: %lu pages, %lu corrupted\r\n",
+                    storageAO->verify.pagesChecked, storageAO->verify.pagesCorrupted);
+
+    if (storageAO->flash.isTailPageLoaded && (storageAO->flash.writeAddress > storageAO->flash.flushAddress))
+        _armFlushTimeout(storageAO);
+
+    // records combined while verifying
+    return _appendPendingData(AO, event);
+}
+
+/**
+ * @brief Open log stream for consumer, previous stream is replaced
+ * @details Chunks are read with multi-page transfers in between appends, next chunk is read while consumer holds previous one.
+ */
+static const TState *_streamOpen(TActiveObject *const AO, TEvent event) {
+    TSTORAGEActiveObject *storageAO = (TSTORAGEActiveObject *) AO;
+
+    if (sizeof(TStorageStreamRequest) != event.size) return _stayOrIdle(AO, event);
+
+    const TStorageStreamRequest *const request = event.payload;
+
+    const bool isLogRing = (LOG_DATA_START_ADDRESS == request->ringStartAddress) &&
+                           (LOG_DATA_END_ADDRESS == request->ringEndAddress);
+    const bool isIndexRing = (INDEX_DATA_START_ADDRESS == request->ringStartAddress) &&
+                             (INDEX_DATA_END_ADDRESS == request->ringEndAddress);
+
+    if ((NULL == request->consumer) || !(isLogRing || isIndexRing) || (request->address < request->ringStartAddress) ||
+        (request->address >= request->ringEndAddress) || (request->size > request->ringEndAddress - request->ringStartAddress))
+        return _stayOrIdle(AO, event);
+
+    storageAO->stream.request = *request;
+    storageAO->stream.isOpen = (0 != request->size);
+    storageAO->stream.isReadDiscarded = storageAO->stream.isReading;
+    storageAO->stream.isHandedOut = false;
+    storageAO->stream.fillIndex = 0;
+    storageAO->stream.deliverIndex = 0;
+    storageAO->stream.chunksFilled = 0;
+
+    return _stayOrIdle(AO, event);
+}
+
+/** @brief Consumer is done with the chunk, hand out next one if it is read already */
+static const TState *_streamRelease(TActiveObject *const AO, TEvent event) {
+    TSTORAGEActiveObject *storageAO = (TSTORAGEActiveObject *) AO;
+
+    if (!storageAO->stream.isOpen || !storageAO->stream.isHandedOut) return _stayOrIdle(AO, event);
+
+    storageAO->stream.isHandedOut = false;
+    storageAO->stream.chunksFilled--;
+    if (storageAO->stream.chunks[storageAO->stream.deliverIndex].isLast) storageAO->stream.isOpen = false;
+    storageAO->stream.deliverIndex = (storageAO->stream.deliverIndex + 1) % STORAGE_STREAM_BUFFERS;
+
+    if (0 != storageAO->stream.chunksFilled) _deliverStreamChunk(storageAO);
+
+    return _stayOrIdle(AO, event);
+}
+
+static const TState *_streamClose(TActiveObject *const AO, TEvent event) {
+    TSTORAGEActiveObject *storageAO = (TSTORAGEActiveObject *) AO;
+
+    storageAO->stream.isOpen = false;
+    storageAO->stream.isHandedOut = false;
+    storageAO->stream.isReadDiscarded = storageAO->stream.isReading;
+
+    return _stayOrIdle(AO, event);
+}
+
+static const TState *_streamChunkRead(TActiveObject *const AO, TEvent event) {
+    TSTORAGEActiveObject *storageAO = (TSTORAGEActiveObject *) AO;
+
+    storageAO->stream.isReading = false;
+
+    if (storageAO->stream.isReadDiscarded) {
+        storageAO->stream.isReadDiscarded = false;
+    } else {
+        storageAO->stream.fillIndex = (storageAO->stream.fillIndex + 1) % STORAGE_STREAM_BUFFERS;
+        storageAO->stream.chunksFilled++;
+
+        if (!storageAO->stream.isHandedOut) _deliverStreamChunk(storageAO);
+    }
+
+    // records combined while reading
+    return _appendPendingData(AO, event);
+}
@@ -0,0 +1,259 @@
+#include "./storage_record.h"
+
+#define FIELD_CLASS_ZERO    (0)
+#define FIELD_CLASS_8BIT    (1)
+#define FIELD_CLASS_16BIT   (2)
+#define FIELD_CLASS_32BIT   (3)
+
+#define TAG_TIME_POS        (6)
+#define TAG_TEMPERATURE_POS (4)
+#define TAG_HUMIDITY_POS    (2)
+#define TAG_LIGHT_POS       (0)
+#define TAG_FIELD_CLASS(tag, pos) (((tag) >> (pos)) & 0x03)
+
+static const uint8_t fieldClassSize[] = {
+        [FIELD_CLASS_ZERO] = 0,
+        [FIELD_CLASS_8BIT] = 1,
+        [FIELD_CLASS_16BIT] = 2,
+        [FIELD_CLASS_32BIT] = 4
+};
+
+static inline uint32_t _zigZagEncode(int32_t value) {
+    return ((uint32_t) value << 1) ^ (uint32_t) (value >> 31);
+};
+
+static inline int32_t _zigZagDecode(uint32_t value) {
+    return (int32_t) (value >> 1) ^ -(int32_t) (value & 1);
+};
+
+static inline uint8_t _fieldClass(uint32_t zigZagValue) {
+    if (0 == zigZagValue) return FIELD_CLASS_ZERO;
+    if (zigZagValue <= UINT8_MAX) return FIELD_CLASS_8BIT;
+    if (zigZagValue <= UINT16_MAX) return FIELD_CLASS_16BIT;
+    return FIELD_CLASS_32BIT;
+};
+
+// little endian, so format does not depend on MCU
+static inline uint8_t *_put(uint8_t *out, uint32_t value, uint8_t size) {
+    for (uint8_t i = 0; i < size; i++)
+        *out++ = (uint8_t) (value >> (8 * i));
+    return out;
+};
+
+static inline const uint8_t *_get(const uint8_t *in, uint32_t *value, uint8_t size) {
+    *value = 0;
+    for (uint8_t i = 0; i < size; i++)
+        *value |= (uint32_t) (*in++) << (8 * i);
+    return in;
+};
+
+// size of keyframe or delta record by its tag, 0 for malformed one
+static size_t _recordSize(uint8_t tag, bool isBlockStarted) {
+    if (STORAGE_RECORD_KEYFRAME_TAG == tag) return STORAGE_RECORD_KEYFRAME_SIZE;
+
+    const uint8_t timeClass = TAG_FIELD_CLASS(tag, TAG_TIME_POS);
+    const uint8_t temperatureClass = TAG_FIELD_CLASS(tag, TAG_TEMPERATURE_POS);
+    const uint8_t humidityClass = TAG_FIELD_CLASS(tag, TAG_HUMIDITY_POS);
+    const uint8_t lightClass = TAG_FIELD_CLASS(tag, TAG_LIGHT_POS);
+
+    // erased flash, delta before keyframe or 32-bit class of 16-bit field
+    if (!isBlockStarted || (FIELD_CLASS_32BIT == timeClass) ||
+        (FIELD_CLASS_32BIT == temperatureClass) || (FIELD_CLASS_32BIT == humidityClass))
+        return 0;
+
+    return 1 + fieldClassSize[timeClass] + fieldClassSize[temperatureClass] +
+           fieldClassSize[humidityClass] + fieldClassSize[lightClass];
+};
+
+static size_t _encodeKeyframe(const TSensorsStorageData *const sample, uint8_t *out) {
+    uint8_t *const start = out;
+
+    *out++ = STORAGE_RECORD_KEYFRAME_TAG;
+    out = _put(out, sample->timestamp, 4);
+    out = _put(out, sample->sht3XTemperatureHumiditySensorData.temperature, 2);
+    out = _put(out, sample->sht3XTemperatureHumiditySensorData.humidity, 2);
+    out = _put(out, sample->ambientLightSensorData.ambientLight, 4);
+
+    return out - start;
+};
+
+void STORAGE_RECORD_Reset(TStorageRecordCodec *const codec) {
+    codec->lastInterval = 0;
+    codec->isBlockStarted = false;
+    codec->crc = STORAGE_CRC16_INIT;
+    codec->isSealed = true;
+};
+
+size_t STORAGE_RECORD_Encode(TStorageRecordCodec *const codec, const TSensorsStorageData *const sample, uint8_t *const out, size_t capacity) {
+    uint8_t record[STORAGE_RECORD_SIZE_MAX];
+    uint8_t *recordEnd = record;
+    uint32_t interval = 0;
+
+    if (!codec->isBlockStarted) {
+        *recordEnd++ = STORAGE_RECORD_FORMAT_VERSION;
+        recordEnd += _encodeKeyframe(sample, recordEnd);
+    } else {
+        // deltas wrap around field width, so decoder restores values exactly
+        interval = sample->timestamp - codec->last.timestamp;
+        const uint32_t time = _zigZagEncode((int32_t) (interval - codec->lastInterval));
+        const uint32_t temperature = _zigZagEncode((int16_t) (sample->sht3XTemperatureHumiditySensorData.temperature -
+                                                              codec->last.sht3XTemperatureHumiditySensorData.temperature));
+        const uint32_t humidity = _zigZagEncode((int16_t) (sample->sht3XTemperatureHumiditySensorData.humidity -
+                                                           codec->last.sht3XTemperatureHumiditySensorData.humidity));
+        const uint32_t light = _zigZagEncode((int32_t) (sample->ambientLightSensorData.ambientLight -
+                                                        codec->last.ambientLightSensorData.ambientLight));
+        const uint8_t timeClass = _fieldClass(time);
+
+        if (FIELD_CLASS_32BIT == timeClass) {
+            // interval changed too much, restart deltas from absolute values
+            interval = 0;
+            recordEnd += _encodeKeyframe(sample, recordEnd);
+        } else {
+            const uint8_t temperatureClass = _fieldClass(temperature);
+            const uint8_t humidityClass = _fieldClass(humidity);
+            const uint8_t lightClass = _fieldClass(light);
+
+            *recordEnd++ = (timeClass << TAG_TIME_POS) | (temperatureClass << TAG_TEMPERATURE_POS) |
+                           (humidityClass << TAG_HUMIDITY_POS) | (lightClass << TAG_LIGHT_POS);
+            recordEnd = _put(recordEnd, time, fieldClassSize[timeClass]);
+            recordEnd = _put(recordEnd, temperature, fieldClassSize[temperatureClass]);
+            recordEnd = _put(recordEnd, humidity, fieldClassSize[humidityClass]);
+            recordEnd = _put(recordEnd, light, fieldClassSize[lightClass]);
+        }
+    }
+
+    const size_t recordSize = recordEnd - record;
+    if (recordSize + STORAGE_RECORD_SEAL_SIZE > capacity) return 0;
+
+    memcpy(out, record, recordSize);
+    codec->last = *sample;
+    codec->lastInterval = interval;
+    codec->isBlockStarted = true;
+    codec->crc = STORAGE_CRC16_Update(codec->crc, record, recordSize);
+    codec->isSealed = false;
+
+    return recordSize;
+};
+
+size_t STORAGE_RECORD_Seal(TStorageRecordCodec *const codec, uint8_t *const out, size_t capacity) {
+    if (codec->isSealed || (STORAGE_RECORD_SEAL_SIZE > capacity)) return 0;
+
+    out[0] = STORAGE_RECORD_SEAL_TAG;
+    _put(out + 1, codec->crc, STORAGE_CRC16_SIZE);
+    codec->crc = STORAGE_CRC16_Update(codec->crc, out, STORAGE_RECORD_SEAL_SIZE);
+    codec->isSealed = true;
+
+    return STORAGE_RECORD_SEAL_SIZE;
+};
+
+size_t STORAGE_RECORD_Decode(TStorageRecordCodec *const codec, const uint8_t *const in, size_t size, TSensorsStorageData *const sample) {
+    const uint8_t *const inEnd = in + size;
+    const uint8_t *cursor = in;
+    uint32_t value;
+
+    if (!codec->isBlockStarted) {
+        if ((cursor >= inEnd) || (STORAGE_RECORD_FORMAT_VERSION != *cursor)) return 0;
+        cursor++;
+    }
+
+    if (cursor >= inEnd) return 0;
+    const uint8_t tag = *cursor++;
+
+    if (STORAGE_RECORD_SEAL_TAG == tag) {
+        if (codec->isSealed || (cursor + STORAGE_CRC16_SIZE > inEnd)) return 0;
+
+        cursor = _get(cursor, &value, STORAGE_CRC16_SIZE);
+        if (codec->crc != value) return 0;
+
+        codec->crc = STORAGE_CRC16_Update(codec->crc, in, cursor - in);
+        codec->isSealed = true;
+
+        return cursor - in;
+    }
+
+    const size_t recordSize = _recordSize(tag, codec->isBlockStarted);
+    if ((0 == recordSize) || (cursor + recordSize - 1 > inEnd)) return 0;
+
+    if (STORAGE_RECORD_KEYFRAME_TAG == tag) {
+        cursor = _get(cursor, &value, 4);
+        sample->timestamp = value;
+        cursor = _get(cursor, &value, 2);
+        sample->sht3XTemperatureHumiditySensorData.temperature = value;
+        cursor = _get(cursor, &value, 2);
+        sample->sht3XTemperatureHumiditySensorData.humidity = value;
+        cursor = _get(cursor, &value, 4);
+        sample->ambientLightSensorData.ambientLight = value;
+
+        codec->lastInterval = 0;
+    } else {
+        const uint8_t timeClass = TAG_FIELD_CLASS(tag, TAG_TIME_POS);
+        const uint8_t temperatureClass = TAG_FIELD_CLASS(tag, TAG_TEMPERATURE_POS);
+        const uint8_t humidityClass = TAG_FIELD_CLASS(tag, TAG_HUMIDITY_POS);
+        const uint8_t lightClass = TAG_FIELD_CLASS(tag, TAG_LIGHT_POS);
+
+        cursor = _get(cursor, &value, fieldClassSize[timeClass]);
+        codec->lastInterval += _zigZagDecode(value);
+        sample->timestamp = codec->last.timestamp + codec->lastInterval;
+
+        cursor = _get(cursor, &value, fieldClassSize[temperatureClass]);
+        sample->sht3XTemperatureHumiditySensorData.temperature =
+                codec->last.sht3XTemperatureHumiditySensorData.temperature + _zigZagDecode(value);
+
+        cursor = _get(cursor, &value, fieldClassSize[humidityClass]);
+        sample->sht3XTemperatureHumiditySensorData.humidity =
+                codec->last.sht3XTemperatureHumiditySensorData.humidity + _zigZagDecode(value);
+
+        cursor = _get(cursor, &value, fieldClassSize[lightClass]);
+        sample->ambientLightSensorData.ambientLight = codec->last.ambientLightSensorData.ambientLight + _zigZagDecode(value);
+    }
+
+    codec->last = *sample;
+    codec->isBlockStarted = true;
+    codec->crc = STORAGE_CRC16_Update(codec->crc, in, cursor - in);
+    codec->isSealed = false;
+
+    return cursor - in;
+};
+
+bool STORAGE_RECORD_IsValidBlock(const uint8_t *const block, size_t size) {
+    size_t cursor = 0;
+    size_t crcEnd = 0; // block bytes below are already in CRC
+    uint16_t crc = STORAGE_CRC16_INIT;
+    bool isBlockStarted = false;
+    bool isSealed = true;
+
+    if ((0 != size) && (STORAGE_RECORD_FORMAT_VERSION == block[0])) cursor++;
+
+    while ((0 != cursor) && (cursor < size) && (0xFF != block[cursor])) {
+        const uint8_t tag = block[cursor];
+
+        if (STORAGE_RECORD_SEAL_TAG == tag) {
+            if (isSealed || (cursor + STORAGE_RECORD_SEAL_SIZE > size)) return false;
+
+            uint32_t value;
+            crc = STORAGE_CRC16_Update(crc, block + crcEnd, cursor - crcEnd);
+            _get(block + cursor + 1, &value, STORAGE_CRC16_SIZE);
+            if (crc != value) return false;
+
+            crcEnd = cursor;
+            cursor += STORAGE_RECORD_SEAL_SIZE;
+            isSealed = true;
+            continue;
+        }
+
+        const size_t recordSize = _recordSize(tag, isBlockStarted);
+        if ((0 == recordSize) || (cursor + recordSize > size)) return false;
+
+        cursor += recordSize;
+        isBlockStarted = true;
+        isSealed = false;
+    }
+
+    if (!isSealed) return false;
+
+    // nothing but erased flash after the last seal
+    for (; cursor < size; cursor++)
+        if (0xFF != block[cursor]) return false;
+
+    return true;
+};
@@ -0,0 +1,103 @@
+/**
+ * @file storage_record.h
+ * @brief Compressed sensors samples format stored in log pages
+ *
+ * @details Each log page is an independent block: format version byte and keyframe with absolute sample values,
+ * followed by delta records. Delta record is a tag byte with 2-bit size class per field and zig-zag encoded deltas,
+ * timestamp is stored as delta of sampling interval, so fixed interval sampling costs no bytes for time.
+ *
+ * Tag byte layout, MSB first: time[7:6] temperature[5:4] humidity[3:2] ambient light[1:0].
+ * Field size class: 0 - delta is zero, 1 - 1 byte, 2 - 2 bytes, 3 - 4 bytes (ambient light only).
+ * Time class 3 marks keyframe (tag 0xC0) with absolute values, so tag is never equal to erased flash 0xFF.
+ *
+ * Seal record (tag 0xC1) closes every chunk of records programmed to flash at once, it holds CRC-16 of all block bytes
+ * before the seal tag. Records not followed by a valid seal were torn by power loss while page was programmed.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "./storage_data.defs.h"
+#include "./storage_crc.h"
+
+#ifdef    __cplusplus
+extern "C" {
+#endif
+
+#ifndef STORAGE_RECORD_H
+#define STORAGE_RECORD_H
+
+#define STORAGE_RECORD_FORMAT_VERSION           (2)
+#define STORAGE_RECORD_KEYFRAME_TAG             (0xC0)
+#define STORAGE_RECORD_SEAL_TAG                 (0xC1)
+#define STORAGE_RECORD_SEAL_SIZE                (1 + STORAGE_CRC16_SIZE) // tag + CRC
+#define STORAGE_RECORD_KEYFRAME_SIZE            (1 + 4 + 2 + 2 + 4) // tag + timestamp + temperature + humidity + ambient light
+#define STORAGE_RECORD_BLOCK_START_SIZE         (1 + STORAGE_RECORD_KEYFRAME_SIZE) // version + keyframe
+#define STORAGE_RECORD_SIZE_MAX                 (STORAGE_RECORD_BLOCK_START_SIZE)
+
+/**
+ * @brief Encoder (or decoder) state of the block, last sample is the base for the next delta
+ */
+typedef struct {
+    TSensorsStorageData last; /**< last encoded (decoded) sample */
+    uint32_t lastInterval; /**< last sampling interval, base for the timestamp delta */
+    bool isBlockStarted; /**< version and keyframe are already in block */
+    uint16_t crc; /**< CRC of block bytes encoded (decoded) so far */
+    bool isSealed; /**< no records after the last seal */
+} TStorageRecordCodec;
+
+/**
+ * @brief Reset codec to start new block
+ * @param codec
+ */
+void STORAGE_RECORD_Reset(TStorageRecordCodec *const codec);
+
+/**
+ * @brief Encode sample as the next record of block
+ * @details Nothing is written and codec state is kept if record does not fit.
+ * Place for the seal is kept free after the record, so block can always be sealed.
+ * @param codec block state
+ * @param sample sample to encode
+ * @param out place in block to encode to
+ * @param capacity free bytes left in block
+ * @return encoded record size, 0 if record does not fit
+ */
+size_t STORAGE_RECORD_Encode(TStorageRecordCodec *const codec, const TSensorsStorageData *const sample, uint8_t *const out, size_t capacity);
+
+/**
+ * @brief Seal records encoded since the last seal
+ * @param codec block state
+ * @param out place in block to encode to
+ * @param capacity free bytes left in block
+ * @return seal size, 0 if block is already sealed
+ */
+size_t STORAGE_RECORD_Seal(TStorageRecordCodec *const codec, uint8_t *const out, size_t capacity);
+
+/**
+ * @brief Decode the next record of block
+ * @details Seal record is checked against CRC of decoded bytes, sample is not changed then and codec isSealed is set
+ * @param codec block state
+ * @param in place in block to decode from
+ * @param size bytes left in block
+ * @param sample decoded sample
+ * @return decoded record size, 0 on end of block data (erased flash), on malformed record or on CRC mismatch
+ */
+size_t STORAGE_RECORD_Decode(TStorageRecordCodec *const codec, const uint8_t *const in, size_t size, TSensorsStorageData *const sample);
+
+/**
+ * @brief Verify block integrity without decoding samples
+ * @details Only record tags are parsed to find seals, CRC runs over the whole sealed chunks at once.
+ * Block is valid when it is erased, or when all seals match and the last sealed record is followed by erased flash.
+ * @param block
+ * @param size
+ * @return true if block is valid
+ */
+bool STORAGE_RECORD_IsValidBlock(const uint8_t *const block, size_t size);
+
+#ifdef    __cplusplus
+}
+#endif
+
+#endif //STORAGE_RECORD_H
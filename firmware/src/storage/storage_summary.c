@@ -0,0 +1,73 @@
+#include "./storage_summary.h"
+
+static inline float _kelvin(uint16_t rawTemperature) {
+    return 228.15f + 175.0f * (float) rawTemperature / 65535.0f;
+};
+
+static inline uint16_t _rawTemperature(float kelvin) {
+    const float raw = (kelvin - 228.15f) * 65535.0f / 175.0f + 0.5f;
+
+    if (raw <= 0.0f) return 0;
+    if (raw >= 65535.0f) return UINT16_MAX;
+    return (uint16_t) raw;
+};
+
+static inline uint8_t _range(uint16_t rawTemperature) {
+    if (rawTemperature > STORAGE_SUMMARY_TEMPERATURE_HIGH) return STORAGE_SUMMARY_RANGE_ABOVE;
+    if (rawTemperature < STORAGE_SUMMARY_TEMPERATURE_LOW) return STORAGE_SUMMARY_RANGE_BELOW;
+    return STORAGE_SUMMARY_RANGE_IN;
+};
+
+void STORAGE_SUMMARY_Reset(TStorageSummary *const summary) {
+    memset(summary, 0, sizeof(TStorageSummary));
+    summary->temperatureMin = UINT16_MAX;
+    summary->humidityMin = UINT16_MAX;
+    summary->range = STORAGE_SUMMARY_RANGE_IN;
+};
+
+void STORAGE_SUMMARY_Update(TStorageSummary *const summary, const TSensorsStorageData *const sample) {
+    const uint16_t temperature = sample->sht3XTemperatureHumiditySensorData.temperature;
+    const uint16_t humidity = sample->sht3XTemperatureHumiditySensorData.humidity;
+    const uint8_t range = _range(temperature);
+
+    if (0 == summary->samples) {
+        summary->firstTimestamp = sample->timestamp;
+    } else if (sample->timestamp > summary->lastTimestamp) {
+        const uint32_t interval = sample->timestamp - summary->lastTimestamp;
+
+        if (STORAGE_SUMMARY_RANGE_ABOVE == summary->range) summary->secondsAbove += interval;
+        if (STORAGE_SUMMARY_RANGE_BELOW == summary->range) summary->secondsBelow += interval;
+    }
+
+    if ((STORAGE_SUMMARY_RANGE_IN != range) && (range != summary->range)) summary->excursions++;
+
+    if (temperature < summary->temperatureMin) summary->temperatureMin = temperature;
+    if (temperature > summary->temperatureMax) summary->temperatureMax = temperature;
+    if (humidity < summary->humidityMin) summary->humidityMin = humidity;
+    if (humidity > summary->humidityMax) summary->humidityMax = humidity;
+
+    const float exponent = STORAGE_SUMMARY_ACTIVATION_ENERGY_K *
+                           (1.0f / STORAGE_SUMMARY_REFERENCE_TEMPERATURE_K - 1.0f / _kelvin(temperature));
+
+    summary->temperatureSum += temperature;
+    summary->kineticSum += (uint64_t) (expf(exponent) * (float) STORAGE_SUMMARY_KINETIC_ONE + 0.5f);
+    summary->samples++;
+    summary->lastTimestamp = sample->timestamp;
+    summary->range = range;
+};
+
+uint16_t STORAGE_SUMMARY_GetMeanTemperature(const TStorageSummary *const summary) {
+    if (0 == summary->samples) return 0;
+
+    return (uint16_t) (summary->temperatureSum / summary->samples);
+};
+
+uint16_t STORAGE_SUMMARY_GetMeanKineticTemperature(const TStorageSummary *const summary) {
+    if ((0 == summary->samples) || (0 == summary->kineticSum)) return 0;
+
+    const float meanFactor = (float) summary->kineticSum / (float) STORAGE_SUMMARY_KINETIC_ONE / (float) summary->samples;
+    const float kelvin = STORAGE_SUMMARY_ACTIVATION_ENERGY_K /
+                         (STORAGE_SUMMARY_ACTIVATION_ENERGY_K / STORAGE_SUMMARY_REFERENCE_TEMPERATURE_K - logf(meanFactor));
+
+    return _rawTemperature(kelvin);
+};
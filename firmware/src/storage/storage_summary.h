@@ -0,0 +1,73 @@
+/**
+ * @file storage_summary.h
+ * @brief Summary statistics of stored samples, so log questions are answered without reading the log
+ *
+ * @details Statistics are accumulated incrementally on each sample appended to the log and never recalculated,
+ * they cover all samples stored since the checkpoint journal was started, records overwritten by the ring included.
+ *
+ * Mean kinetic temperature: MKT = (dH/R) / (dH/R / Tref - ln(mean(exp(dH/R * (1/Tref - 1/T))))),
+ * Arrhenius factors are relative to reference temperature, so their sum is kept as fixed point integer without
+ * precision loss on long logs.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+#include "./storage_data.defs.h"
+
+#ifdef    __cplusplus
+extern "C" {
+#endif
+
+#ifndef STORAGE_SUMMARY_H
+#define STORAGE_SUMMARY_H
+
+// SHT3x raw temperature of degrees Celsius, T = -45 + 175 * raw / 65535
+#define STORAGE_SUMMARY_RAW_TEMPERATURE(celsius)    ((uint16_t) (((celsius) + 45.0) * 65535.0 / 175.0 + 0.5))
+#define STORAGE_SUMMARY_TEMPERATURE_LOW             STORAGE_SUMMARY_RAW_TEMPERATURE(2) // cold chain 2..8 C
+#define STORAGE_SUMMARY_TEMPERATURE_HIGH            STORAGE_SUMMARY_RAW_TEMPERATURE(8)
+#define STORAGE_SUMMARY_ACTIVATION_ENERGY_K         (10000.0f) // dH/R, 83.144 kJ/mol
+#define STORAGE_SUMMARY_REFERENCE_TEMPERATURE_K     (298.15f) // 25 C
+#define STORAGE_SUMMARY_KINETIC_ONE                 (1UL << 24) // fixed point 1.0 of Arrhenius factor
+
+/** @brief temperature range of the sample */
+typedef enum {
+    STORAGE_SUMMARY_RANGE_IN = 0,
+    STORAGE_SUMMARY_RANGE_ABOVE,
+    STORAGE_SUMMARY_RANGE_BELOW,
+} STORAGE_SUMMARY_RANGE;
+
+/**
+ * @brief Reset summary to no samples
+ * @param summary
+ */
+void STORAGE_SUMMARY_Reset(TStorageSummary *const summary);
+
+/**
+ * @brief Account the next stored sample
+ * @details Interval from the previous sample is counted only if time goes forward
+ * @param summary
+ * @param sample
+ */
+void STORAGE_SUMMARY_Update(TStorageSummary *const summary, const TSensorsStorageData *const sample);
+
+/**
+ * @param summary
+ * @return mean SHT3x raw temperature, 0 if there are no samples
+ */
+uint16_t STORAGE_SUMMARY_GetMeanTemperature(const TStorageSummary *const summary);
+
+/**
+ * @param summary
+ * @return mean kinetic temperature as SHT3x raw value, 0 if there are no samples
+ */
+uint16_t STORAGE_SUMMARY_GetMeanKineticTemperature(const TStorageSummary *const summary);
+
+#ifdef    __cplusplus
+}
+#endif
+
+#endif //STORAGE_SUMMARY_H
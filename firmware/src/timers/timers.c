@@ -0,0 +1,218 @@
+#include "./timers.h"
+#include "../scheduler/scheduler.h"
+
+#define TIMERS_NO_TIMER                     (0xFF)
+#define TIMERS_WHEEL_SLOT_MASK              (TIMERS_WHEEL_SLOTS - 1)
+
+_Static_assert(TIMERS_MAX < TIMERS_NO_TIMER, "timers do not fit slot lists links");
+_Static_assert((TIMERS_WHEEL_LEVELS * TIMERS_WHEEL_SLOT_BITS) == 32, "wheel does not cover SYS_TIME counter");
+
+typedef struct {
+    TActiveObject *AO; /**< actor to dispatch to, NULL if timer is not armed */
+    TEvent event;
+    uint32_t deadline; /**< SYS_TIME counter ticks */
+    uint8_t level;
+    uint8_t slot;
+    uint8_t next; /**< slot list links */
+    uint8_t prev;
+} TTimer;
+
+static TTimer timers[TIMERS_MAX];
+static uint8_t wheel[TIMERS_WHEEL_LEVELS][TIMERS_WHEEL_SLOTS]; /**< slots lists heads */
+static uint16_t occupiedSlots[TIMERS_WHEEL_LEVELS]; /**< bit per non empty slot */
+static uint32_t wheelTime = 0; /**< ticks the wheel is advanced to */
+
+static SYS_TIME_HANDLE compareTimer = SYS_TIME_HANDLE_INVALID;
+static bool isCompareProgrammed = false;
+static uint32_t compareTime = 0;
+static volatile bool isCompareDue = false;
+
+static void _onCompare(uintptr_t context);
+
+// round up and add a tick, timer is armed at any phase of the current tick
+static inline uint32_t _msToTicks(uint32_t ms) {
+    if (ms > TIMERS_TIMEOUT_MS_MAX) ms = TIMERS_TIMEOUT_MS_MAX;
+
+    return (uint32_t) (((uint64_t) ms * SYS_TIME_FrequencyGet() + 999U) / 1000U) + 1;
+};
+
+static void _link(uint8_t id, uint8_t level, uint8_t slot) {
+    TTimer *const timer = &timers[id];
+
+    timer->level = level;
+    timer->slot = slot;
+    timer->prev = TIMERS_NO_TIMER;
+    timer->next = wheel[level][slot];
+    if (TIMERS_NO_TIMER != timer->next) timers[timer->next].prev = id;
+
+    wheel[level][slot] = id;
+    occupiedSlots[level] |= (1U << slot);
+};
+
+static void _unlink(uint8_t id) {
+    TTimer *const timer = &timers[id];
+
+    if (TIMERS_NO_TIMER != timer->next) timers[timer->next].prev = timer->prev;
+
+    if (TIMERS_NO_TIMER != timer->prev) {
+        timers[timer->prev].next = timer->next;
+    } else {
+        wheel[timer->level][timer->slot] = timer->next;
+        if (TIMERS_NO_TIMER == timer->next) occupiedSlots[timer->level] &= ~(1U << timer->slot);
+    }
+};
+
+static void _expire(uint8_t id) {
+    TActiveObject *const AO = timers[id].AO;
+
+    timers[id].AO = NULL;
+    SCHEDULER_Dispatch(AO, timers[id].event);
+};
+
+// slot level is the highest digit deadline differs from wheel time in, timer is cascaded right at its deadline
+static void _insert(uint8_t id) {
+    const uint32_t deadline = timers[id].deadline;
+
+    if (deadline == wheelTime) return _expire(id);
+
+    const uint8_t level = (31U - __CLZ(deadline ^ wheelTime)) / TIMERS_WHEEL_SLOT_BITS;
+    const uint8_t slot = (deadline >> (level * TIMERS_WHEEL_SLOT_BITS)) & TIMERS_WHEEL_SLOT_MASK;
+
+    _link(id, level, slot);
+};
+
+/**
+ * @brief Find the nearest non empty slot, its timers are due or cascaded when wheel time reaches its start
+ * @param[out] time slot start
+ * @param[out] level
+ * @param[out] slot
+ * @return false if no timer is armed
+ */
+static bool _findNextSlot(uint32_t *const time, uint8_t *const level, uint8_t *const slot) {
+    bool isFound = false;
+    uint32_t nearestDistance = 0;
+
+    for (uint8_t l = 0; l < TIMERS_WHEEL_LEVELS; l++) {
+        if (0 == occupiedSlots[l]) continue;
+
+        const uint8_t shift = l * TIMERS_WHEEL_SLOT_BITS;
+        const uint8_t current = (wheelTime >> shift) & TIMERS_WHEEL_SLOT_MASK;
+        // slots after the current one, wrapped around, the current one is empty
+        const uint32_t rotated = ((uint32_t) occupiedSlots[l] >> (current + 1)) |
+                                 ((uint32_t) occupiedSlots[l] << (TIMERS_WHEEL_SLOTS - current - 1));
+        const uint8_t steps = (uint8_t) __builtin_ctz(rotated) + 1;
+        const uint32_t start = ((wheelTime >> shift) + steps) << shift;
+        const uint32_t distance = start - wheelTime;
+
+        if (isFound && (distance >= nearestDistance)) continue;
+
+        isFound = true;
+        nearestDistance = distance;
+        *time = start;
+        *level = l;
+        *slot = (current + steps) & TIMERS_WHEEL_SLOT_MASK;
+    }
+
+    return isFound;
+};
+
+static void _advance(uint32_t now) {
+    uint32_t time;
+    uint8_t level, slot;
+
+    while (_findNextSlot(&time, &level, &slot) && ((time - wheelTime) <= (now - wheelTime))) {
+        uint8_t id = wheel[level][slot];
+
+        wheelTime = time;
+        wheel[level][slot] = TIMERS_NO_TIMER;
+        occupiedSlots[level] &= ~(1U << slot);
+
+        while (TIMERS_NO_TIMER != id) {
+            const uint8_t next = timers[id].next;
+
+            if (0 == level) {
+                _expire(id);
+            } else {
+                _insert(id);
+            }
+
+            id = next;
+        }
+    }
+
+    wheelTime = now;
+};
+
+// single compare for the nearest slot, reprogrammed only if it changes
+static void _programCompare(void) {
+    uint32_t time;
+    uint8_t level, slot;
+
+    if (!_findNextSlot(&time, &level, &slot)) {
+        if (isCompareProgrammed) SYS_TIME_TimerStop(compareTimer);
+        isCompareProgrammed = false;
+        return;
+    }
+
+    if (isCompareProgrammed && (time == compareTime)) return;
+
+    const int32_t remaining = (int32_t) (time - SYS_TIME_CounterGet());
+    const uint32_t count = (remaining > 0) ? (uint32_t) remaining : 1;
+
+    isCompareProgrammed = (SYS_TIME_SUCCESS ==
+                           SYS_TIME_TimerReload(compareTimer, 0, count, _onCompare, (uintptr_t) NULL, SYS_TIME_SINGLE));
+    compareTime = time;
+};
+
+void TIMERS_Initialize(void) {
+    memset(wheel, TIMERS_NO_TIMER, sizeof(wheel));
+    memset(occupiedSlots, 0, sizeof(occupiedSlots));
+    memset(timers, 0, sizeof(timers));
+    wheelTime = SYS_TIME_CounterGet();
+
+    compareTimer = SYS_TIME_TimerCreate(0, 1, _onCompare, (uintptr_t) NULL, SYS_TIME_SINGLE);
+    isCompareProgrammed = false;
+};
+
+void TIMERS_Tasks(void) {
+    if (!isCompareDue) return;
+
+    isCompareDue = false;
+    isCompareProgrammed = false;
+
+    _advance(SYS_TIME_CounterGet());
+    _programCompare();
+};
+
+void TIMERS_Arm(SYSTEM_TIMER_IDS id, TActiveObject *const AO, TEvent event, uint32_t ms) {
+    const uint32_t now = SYS_TIME_CounterGet();
+
+    _advance(now);
+
+    if (NULL != timers[id].AO) _unlink(id);
+
+    timers[id].AO = AO;
+    timers[id].event = event;
+    timers[id].deadline = now + _msToTicks(ms);
+    _insert(id);
+
+    _programCompare();
+};
+
+void TIMERS_Cancel(SYSTEM_TIMER_IDS id) {
+    if (NULL == timers[id].AO) return;
+
+    _unlink(id);
+    timers[id].AO = NULL;
+
+    _programCompare();
+};
+
+bool TIMERS_IsArmed(SYSTEM_TIMER_IDS id) {
+    return NULL != timers[id].AO;
+};
+
+/** @note called from SYS_TIME ISR, wheel is advanced by main loop */
+static void _onCompare(uintptr_t context) {
+    isCompareDue = true;
+};
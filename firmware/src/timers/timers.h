@@ -0,0 +1,65 @@
+/**
+ * @file timers.h
+ * @brief Actors timeouts, delivered as events into actors queues
+ *
+ * @details Timers are static, one per SYSTEM_TIMER_IDS entry, so they are re-armed and cancelled by ID and never run
+ * out. Timers are kept in hierarchical timer wheel over SYS_TIME counter ticks: 8 levels of 16 slots, level is chosen
+ * by the highest 4-bit digit the deadline differs from wheel time in, so insert and cancel are O(1). Slot of upper
+ * level is cascaded to lower levels when wheel time reaches it, level 0 slot expires its timers.
+ *
+ * Wheel is tickless: it is advanced to the current time on each arm and on each hardware compare, empty slots are
+ * skipped by levels occupancy bitmaps. A single SYS_TIME timer is programmed for the nearest non empty slot, its TC3
+ * compare runs in STANDBY too, so it wakes the main loop from sleep when the nearest timeout (or cascade) is due.
+ *
+ * Timers are armed and cancelled from main loop only.
+ */
+
+#ifndef TIMERS_H
+#define TIMERS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../config/default/configuration.h"
+#include "../config/default/definitions.h"
+#include "../config/common.defs.h"
+#include "../../../libraries/active-object-fsm/src/active_object/active_object.h"
+
+#ifdef    __cplusplus
+extern "C" {
+#endif
+
+#define TIMERS_WHEEL_LEVELS                 (8)
+#define TIMERS_WHEEL_SLOT_BITS              (4)
+#define TIMERS_WHEEL_SLOTS                  (1 << TIMERS_WHEEL_SLOT_BITS)
+#define TIMERS_TIMEOUT_MS_MAX               (7UL * 24 * 60 * 60 * 1000) // ticks stay far below counter half range
+
+/** @brief Create hardware compare timer, should be called before actors are initialized */
+void TIMERS_Initialize(void);
+
+/** @brief Advance wheel on hardware compare and dispatch expired timers events, should be called from main loop */
+void TIMERS_Tasks(void);
+
+/**
+ * @brief Arm single shot timer, armed timer is re-armed
+ * @param id timer
+ * @param AO actor to dispatch event to
+ * @param event
+ * @param ms timeout, never shorter, up to TIMERS_TIMEOUT_MS_MAX
+ */
+void TIMERS_Arm(SYSTEM_TIMER_IDS id, TActiveObject *const AO, TEvent event, uint32_t ms);
+
+/** @brief Cancel timer, its event is not dispatched, does nothing if timer is not armed */
+void TIMERS_Cancel(SYSTEM_TIMER_IDS id);
+
+/** @return true if timer is armed and not expired yet */
+bool TIMERS_IsArmed(SYSTEM_TIMER_IDS id);
+
+#ifdef    __cplusplus
+}
+#endif
+
+#endif //TIMERS_H
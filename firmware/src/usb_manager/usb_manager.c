@@ -1,6 +1,6 @@
 #include "./usb_manager.h"
 
-extern TActiveObject systemActorsList[ACTIVE_OBJECTS_MAX];
+extern TActiveObject *systemActorsList[ACTIVE_OBJECTS_MAX];
 
 static void _onVUSBChange(uintptr_t context);
 
@@ -22,12 +22,12 @@ void USB_Tasks(void) {
 }
 
 static void _onVUSBChange(uintptr_t context) {
-    TActiveObject* mainAppAO = &systemActorsList[MAIN_APP_AO_ID];
+    TActiveObject* mainAppAO = systemActorsList[MAIN_APP_AO_ID];
     bool usbCableConnected = USB_VBUS_SENSE_Get();
 
     if (usbCableConnected) {
-        ActiveObject_Dispatch(mainAppAO, (TEvent) {.sig = APP_SIG_USB_CABLE_CONNECTED});
+        SCHEDULER_Dispatch(mainAppAO, (TEvent) {.sig = APP_SIG_USB_CABLE_CONNECTED});
     } else {
-        ActiveObject_Dispatch(mainAppAO, (TEvent) {.sig = APP_SIG_USB_CABLE_DISCONNECTED});
+        SCHEDULER_Dispatch(mainAppAO, (TEvent) {.sig = APP_SIG_USB_CABLE_DISCONNECTED});
     }
 };
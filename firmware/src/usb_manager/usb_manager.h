@@ -24,6 +24,7 @@
 #include "../../../libraries/active-object-fsm/src/fsm/fsm.h"
 #include "../init_manager/init_manager.h"
 #include "../app_manager/app_manager.h"
+#include "../scheduler/scheduler.h"
 
 #ifdef    __cplusplus
 extern "C" {